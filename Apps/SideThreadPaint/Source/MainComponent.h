@@ -1,48 +1,14 @@
 #pragma once
 
 #include <juce_gui_basics/juce_gui_basics.h>
+#include <shared_realtime/shared_realtime.h>
 #include <thread>
+#include "WavePath.h"
 
 using namespace juce;
 
 namespace GuiApp
 {
-//Helpers to calculate the wavetable path
-namespace PathCalcs
-{
-    inline float getY(float x, float freq)
-    {
-        return std::sin(x * MathConstants<float>::twoPi * freq);
-    }
-
-    inline Point<float> getPoint(int x, float freq, Rectangle<float> bounds)
-    {
-        auto scaledX = jmap((float) x, 0.f, bounds.getWidth(), 0.f, 1.f);
-        auto y = getY(scaledX, freq);
-        auto scaledY = jmap(y, -1.f, 1.f, 0.f, bounds.getHeight());
-
-        return {(float) x, scaledY};
-    }
-
-    inline Path getPath(Rectangle<int> bounds, float freq)
-    {
-        Path wavePath;
-        wavePath.startNewSubPath(getPoint(0, freq, bounds.toFloat()));
-
-        for (int x = 1; x < bounds.getWidth(); ++x)
-            wavePath.lineTo(getPoint(x, freq, bounds.toFloat()));
-
-        return wavePath;
-    }
-
-    inline void paintPath(Graphics& g, Rectangle<int> bounds, float freq)
-    {
-        auto path = getPath(bounds, freq);
-        g.setColour(Colours::lightblue);
-        g.strokePath(path, PathStrokeType(1.0f));
-    }
-} // namespace PathCalcs
-
 //Checks for the existance of "Desktop/Threading.txt" as a flag for the threading
 inline bool shouldUseThreading()
 {
@@ -52,18 +18,20 @@ inline bool shouldUseThreading()
     return config.existsAsFile();
 }
 
-//A simple "Job", storing the frequency and scale from whoever dispatched the job
+//A simple "Job", storing the frequency, scale and bounds from whoever dispatched the job.
+//It's plain data, so it can be passed to the thread through a SeqLock
 struct PaintJobInfo
 {
     PaintJobInfo() = default;
-    PaintJobInfo(float freqToUse, float scaleToUse)
+    PaintJobInfo(float freqToUse, float scaleToUse, Rectangle<float> boundsToUse)
         : freq(freqToUse)
         , scale(scaleToUse)
+        , bounds(boundsToUse)
     {
     }
-    bool run(Image& result, Rectangle<float> bounds) const noexcept
+    bool run(Image& result, WavePath& wave) const
     {
-        if (scale > 0.f)
+        if (scale > 0.f && !bounds.isEmpty())
         {
             auto scaledBounds = bounds * scale;
             auto intBounds = scaledBounds.toNearestInt();
@@ -87,7 +55,7 @@ struct PaintJobInfo
                 AffineTransform::scale(scaledBounds.getWidth() / bounds.getWidth(),
                                        scaledBounds.getHeight() / bounds.getHeight()));
 
-            PathCalcs::paintPath(g, bounds.toNearestInt(), freq);
+            wave.paint(g, bounds.toNearestInt(), freq);
 
             return true;
         }
@@ -97,6 +65,7 @@ struct PaintJobInfo
 
     float freq = 0.f;
     float scale = 0.f;
+    Rectangle<float> bounds;
 };
 
 //A painter thread class.
@@ -105,6 +74,10 @@ struct PaintJobInfo
 //And paints the last 'job' sent to it.
 //The thread will only look at the very latest job so it's finen to pass jobs to it
 //At a higher or lower rate
+//
+//Nothing is locked: jobs come in through a SeqLock, and the images go back out through
+//a TripleBuffer, so the thread paints into an image of its own while the message thread
+//draws the last one finished, and neither ever waits for the other
 struct PaintThread
 {
     PaintThread(Component& parentToUse)
@@ -129,45 +102,50 @@ struct PaintThread
 
     void hiResTimerCallback()
     {
+        //Only a job we haven't run yet:
+        const auto version = nextJob.getVersion();
+
+        if (version == lastJobVersion)
+            return;
+
+        //If the message thread is writing the job right now, we'll get it next time
         PaintJobInfo jobToDo;
 
-        {
-            ScopedLock sl(lock);
-            jobToDo = nextJob;
-            nextJob = {};
-        }
+        if (!nextJob.tryRead(jobToDo))
+            return;
 
-        //Still on the side thread, runs the pain job:
-        if (jobToDo.run(threadImage, bounds))
+        lastJobVersion = version;
+
+        //Still on the side thread, runs the paint job into an image only this thread uses:
+        if (jobToDo.run(images.getWriteBuffer(), wave))
         {
-            //When the job is finished, we send an async call (message thread)
-            //To blend the image back into the dispatched component
-            auto imageCopy = threadImage.createCopy();
+            //When the job is finished, we hand the image over and send an async call
+            //(message thread) to blend it back into the dispatched component
+            images.publish();
 
             MessageManager::callAsync(
-                [imageCopy, this]
+                [safeParent = Component::SafePointer<Component>(&parent)]
                 {
-                    cachedImage = imageCopy;
-                    parent.repaint();
+                    if (safeParent != nullptr)
+                        safeParent->repaint();
                 });
         }
     }
 
     //Passes the job into the line by copy
-    void addJob(const PaintJobInfo& jobToUse)
-    {
-        ScopedLock sl(lock);
-        nextJob = jobToUse;
-    }
+    void addJob(const PaintJobInfo& jobToUse) { nextJob.write(jobToUse); }
 
-    void setBounds(Rectangle<int> boundsToUse) { bounds = boundsToUse.toFloat(); }
+    //The last image the thread finished (message thread only)
+    const Image& getLatestImage() { return images.read(); }
 
     Component& parent;
-    Image threadImage;
-    Image cachedImage;
-    Rectangle<float> bounds;
-    CriticalSection lock;
-    PaintJobInfo nextJob;
+    Realtime::SeqLock<PaintJobInfo> nextJob;
+    juce::uint32 lastJobVersion = nextJob.getVersion();
+    Realtime::TripleBuffer<Image> images;
+
+    //Only ever touched by the thread
+    WavePath wave;
+
     std::unique_ptr<std::thread> thread;
     std::atomic<bool> running {true};
 };
@@ -189,13 +167,11 @@ struct ComplicatedPath
 
         //If we're multithreading, we're dispatching all data by copy into the thread:
         if (shouldUseThreading())
-            thread.addJob({frequency, scaleFactor});
+            thread.addJob({frequency, scaleFactor, getLocalBounds().toFloat()});
         else
             repaint();
     }
 
-    void resized() override { thread.setBounds(getLocalBounds()); }
-
     void paint(Graphics& g) override
     {
         //We need to store the "real" scale factor so we can use it in out paint later...
@@ -203,12 +179,13 @@ struct ComplicatedPath
 
         //If we're multithreading, we're just painting a precalculated image:
         if (shouldUseThreading())
-            g.drawImage(thread.cachedImage, getLocalBounds().toFloat());
+            g.drawImage(thread.getLatestImage(), getLocalBounds().toFloat());
         else
-            PathCalcs::paintPath(g, getLocalBounds(), frequency);
+            wave.paint(g, getLocalBounds(), frequency);
     }
 
     PaintThread thread {*this};
+    WavePath wave;
     float scaleFactor = 1.f;
     float frequency = 0.f;
 };
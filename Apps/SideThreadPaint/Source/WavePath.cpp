@@ -0,0 +1,80 @@
+#include "WavePath.h"
+
+namespace GuiApp
+{
+namespace PathCalcs
+{
+    //sin(2 * pi * t), for any t in [-0.5, 0.5)
+    static inline float sinOfCycles(float t) noexcept
+    {
+        //Folded into [-0.25, 0.25] cycles, where the polynomial is accurate to a few
+        //millionths, by sin(pi - x) = sin(x). With abs and copysign rather than
+        //comparisons, so there are no branches to keep the loop from vectorising
+        const auto folded = std::copysign(0.25f - std::abs(std::abs(t) - 0.25f), t);
+
+        const auto x = folded * MathConstants<float>::twoPi;
+        const auto x2 = x * x;
+
+        return x * (1.f + x2 * (-1.f / 6.f + x2 * (1.f / 120.f + x2 * (-1.f / 5040.f + x2 * (1.f / 362880.f)))));
+    }
+
+    void fillSine(float* destination, int numPoints, float width, float height, float freq) noexcept
+    {
+        if (width <= 0.f)
+            return;
+
+        //sin(-x) = -sin(x), so the phase only ever counts up
+        const auto cyclesPerPixel = std::abs(freq) / width;
+        const auto centre = height * 0.5f;
+        const auto amplitude = freq < 0.f ? -centre : centre;
+
+        for (int x = 0; x < numPoints; ++x)
+        {
+            //The phase is positive, so truncating rounds it to the nearest whole cycle
+            const auto cycles = (float) x * cyclesPerPixel;
+            const auto t = cycles - (float) (int) (cycles + 0.5f);
+
+            destination[x] = centre + amplitude * sinOfCycles(t);
+        }
+    }
+} // namespace PathCalcs
+
+const Path& WavePath::getPath(Rectangle<int> bounds, float freq)
+{
+    if (isValid && bounds == cachedBounds && freq == cachedFreq)
+        return path;
+
+    const auto numPoints = bounds.getWidth();
+
+    if (ys.size() < (size_t) numPoints)
+        ys.resize((size_t) numPoints);
+
+    PathCalcs::fillSine(
+        ys.data(), numPoints, (float) bounds.getWidth(), (float) bounds.getHeight(), freq);
+
+    //Clearing keeps the storage, so once it's grown, rebuilding it allocates nothing
+    path.clear();
+
+    if (numPoints > 0)
+    {
+        path.preallocateSpace(3 * numPoints);
+        path.startNewSubPath(0.f, ys[0]);
+
+        for (int x = 1; x < numPoints; ++x)
+            path.lineTo((float) x, ys[(size_t) x]);
+    }
+
+    cachedBounds = bounds;
+    cachedFreq = freq;
+    isValid = true;
+
+    return path;
+}
+
+void WavePath::paint(Graphics& g, Rectangle<int> bounds, float freq)
+{
+    const auto& wavePath = getPath(bounds, freq);
+    g.setColour(Colours::lightblue);
+    g.strokePath(wavePath, PathStrokeType(1.0f));
+}
+} // namespace GuiApp
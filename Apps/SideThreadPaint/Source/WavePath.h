@@ -0,0 +1,35 @@
+#pragma once
+
+#include <juce_gui_basics/juce_gui_basics.h>
+
+using namespace juce;
+
+namespace GuiApp
+{
+//Helpers to calculate the wavetable path
+namespace PathCalcs
+{
+    //Fills destination with the y of every pixel column of a sine wave, freq cycles across
+    //width, scaled to [0, height]. The polynomial has no branches, so the loop vectorises.
+    //Accurate to well under a pixel, even at 4K
+    void fillSine(float* destination, int numPoints, float width, float height, float freq) noexcept;
+} // namespace PathCalcs
+
+//The wave one component draws. The path is rebuilt only when the bounds or the
+//frequency change, and then into the same storage, so a frame allocates nothing once
+//the widest path so far has been drawn
+class WavePath
+{
+public:
+    const Path& getPath(Rectangle<int> bounds, float freq);
+    void paint(Graphics& g, Rectangle<int> bounds, float freq);
+
+private:
+    Rectangle<int> cachedBounds;
+    float cachedFreq = 0.f;
+    bool isValid = false;
+
+    std::vector<float> ys;
+    Path path;
+};
+} // namespace GuiApp
@@ -0,0 +1,129 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include "PluginProcessor.h"
+#include "RandomWalkSequencerEditor.h"
+#include <numeric>
+
+namespace
+{
+constexpr int numReportedFrames = 500;
+
+//Paints the component and its children into the image, the way the message thread
+//would paint it into a window
+float renderFrame(juce::Component& component, juce::Image& image)
+{
+    juce::Graphics g(image);
+    component.paintEntireComponent(g, false);
+
+    return image.getPixelAt(image.getWidth() / 2, image.getHeight() / 2).getBrightness();
+}
+
+//Renders the component over and over, and reports the mean and 99th percentile frame
+//time, as a warning so it shows in the output. Catch's own statistics only go as far
+//as the mean and the standard deviation, which hide the occasional slow frame
+void reportFrameTimes(const std::string& name, juce::Component& component, juce::Image& image)
+{
+    std::vector<double> frameMicros;
+    frameMicros.reserve(numReportedFrames);
+
+    for (int frame = 0; frame < numReportedFrames; ++frame)
+    {
+        const auto start = juce::Time::getHighResolutionTicks();
+        renderFrame(component, image);
+        const auto elapsed = juce::Time::getHighResolutionTicks() - start;
+
+        frameMicros.push_back(juce::Time::highResolutionTicksToSeconds(elapsed) * 1.0e6);
+    }
+
+    std::sort(frameMicros.begin(), frameMicros.end());
+
+    const auto mean = std::accumulate(frameMicros.begin(), frameMicros.end(), 0.0) / (double) frameMicros.size();
+    const auto p99 = frameMicros[(size_t) (0.99 * (double) (frameMicros.size() - 1))];
+
+    WARN(name << ": mean " << juce::String(mean, 1) << " us, p99 " << juce::String(p99, 1)
+              << " us, worst " << juce::String(frameMicros.back(), 1) << " us per frame");
+}
+
+//A sequencer with a random pattern, the given number of active steps, and the playhead
+//part way through it
+struct RenderFixture
+{
+    explicit RenderFixture(int numActiveSteps)
+    {
+        auto& sequencer = processor.getSequencer();
+        sequencer.randomizeSequence();
+        sequencer.setDensity(numActiveSteps);
+
+        juce::MidiBuffer midi;
+        sequencer.prepareToPlay(44100.0, 512);
+        sequencer.setPlaying(true);
+
+        for (int block = 0; block < 20; ++block)
+        {
+            midi.clear();
+            sequencer.processBlock(midi, 512, {});
+        }
+    }
+
+    AudioPluginAudioProcessor processor;
+    RandomWalkSequencerEditor editor {processor};
+};
+} // namespace
+
+TEST_CASE("Editor rendering, StepDisplay", "[!benchmark]")
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    for (auto numActiveSteps: {4, 16})
+    {
+        RenderFixture fixture(numActiveSteps);
+        auto& stepDisplay = fixture.editor.getStepDisplay();
+
+        for (auto size: {juce::Point<int>(560, 200), juce::Point<int>(1120, 400), juce::Point<int>(3840, 1200)})
+        {
+            stepDisplay.setSize(size.x, size.y);
+            juce::Image image(juce::Image::ARGB, size.x, size.y, true);
+
+            const auto name = "StepDisplay, " + std::to_string(size.x) + "x" + std::to_string(size.y) + ", "
+                              + std::to_string(numActiveSteps) + " active steps";
+
+            reportFrameTimes(name, stepDisplay, image);
+
+            BENCHMARK(name)
+            {
+                return renderFrame(stepDisplay, image);
+            };
+        }
+    }
+}
+
+TEST_CASE("Editor rendering, the whole editor", "[!benchmark]")
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    for (auto numActiveSteps: {4, 16})
+    {
+        RenderFixture fixture(numActiveSteps);
+        auto& editor = fixture.editor;
+
+        //The editor is never smaller than it sets itself up, so the first size is its own
+        const auto minimumSize = editor.getBounds().getBottomRight();
+
+        for (auto scale: {1, 2, 3})
+        {
+            editor.setSize(minimumSize.x * scale, minimumSize.y * scale);
+            juce::Image image(juce::Image::ARGB, editor.getWidth(), editor.getHeight(), true);
+
+            const auto name = "Editor, " + std::to_string(editor.getWidth()) + "x"
+                              + std::to_string(editor.getHeight()) + ", " + std::to_string(numActiveSteps)
+                              + " active steps";
+
+            reportFrameTimes(name, editor, image);
+
+            BENCHMARK(name)
+            {
+                return renderFrame(editor, image);
+            };
+        }
+    }
+}
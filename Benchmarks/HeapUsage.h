@@ -0,0 +1,24 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#if JUCE_MAC
+    #include <malloc/malloc.h>
+#elif JUCE_LINUX
+    #include <malloc.h>
+#endif
+
+//Heap in use by the whole process, where the allocator can tell: 0 elsewhere
+inline size_t getHeapBytesInUse()
+{
+#if JUCE_MAC
+    malloc_statistics_t stats {};
+    malloc_zone_statistics(nullptr, &stats);
+    return stats.size_in_use;
+#elif JUCE_LINUX && defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    const auto info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+#else
+    return 0;
+#endif
+}
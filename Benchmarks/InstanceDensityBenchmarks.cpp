@@ -0,0 +1,214 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include "PluginProcessor.h"
+#include "HeapUsage.h"
+
+namespace
+{
+constexpr double sampleRate = 48000.0;
+constexpr int blockSize = 128;
+constexpr int numCallbacks = 2000;
+
+//A host transport that's always playing, shared by every instance the way a host's is
+struct PlayingPlayHead : public juce::AudioPlayHead
+{
+    juce::Optional<PositionInfo> getPosition() const override
+    {
+        PositionInfo info;
+        info.setIsPlaying(true);
+        info.setBpm(120.0);
+        info.setTimeInSamples(timeInSamples);
+        return info;
+    }
+
+    juce::int64 timeInSamples = 0;
+};
+
+//One plugin instance in the simulated session, and its editor if it has one open
+struct Instance
+{
+    explicit Instance(bool withEditor)
+    {
+        if (withEditor)
+            editor.reset(processor.createEditorAndMakeActive());
+    }
+
+    AudioPluginAudioProcessor processor;
+
+    //After the processor, so it's deleted first
+    std::unique_ptr<juce::AudioProcessorEditor> editor;
+};
+
+struct DensityResult
+{
+    size_t bytesPerInstance = 0;
+    double constructionMicrosPerInstance = 0.0;
+    double meanCallbackMicros = 0.0;
+    double meanLoadPercent = 0.0;
+    double worstCallbackMicros = 0.0;
+    double worstInstanceBlockMicros = 0.0;
+};
+
+//A session of instances, run one after another on a single simulated audio callback,
+//the way a host runs the plugins of one project on its audio thread
+class Session
+{
+public:
+    Session(int numInstances, bool withEditors)
+    {
+        const auto heapBefore = getHeapBytesInUse();
+        const auto start = juce::Time::getHighResolutionTicks();
+
+        for (int i = 0; i < numInstances; ++i)
+            instances.push_back(std::make_unique<Instance>(withEditors));
+
+        const auto elapsed = juce::Time::getHighResolutionTicks() - start;
+        const auto heapAfter = getHeapBytesInUse();
+
+        result.constructionMicrosPerInstance =
+            juce::Time::highResolutionTicksToSeconds(elapsed) * 1.0e6 / (double) numInstances;
+        result.bytesPerInstance = heapAfter > heapBefore ? (heapAfter - heapBefore) / (size_t) numInstances : 0;
+
+        for (auto& instance: instances)
+        {
+            auto& processor = instance->processor;
+            processor.setPlayHead(&playHead);
+            processor.prepareToPlay(sampleRate, blockSize);
+
+            auto& sequencer = processor.getSequencer();
+            sequencer.setSyncToHostTransport(true);
+            sequencer.setDensity(16);
+            sequencer.randomizeSequence();
+        }
+
+        //Every instance gets its own MIDI buffer, large enough never to grow
+        midiBuffers.resize((size_t) numInstances);
+
+        for (auto& midi: midiBuffers)
+            midi.ensureSize(4096);
+    }
+
+    ~Session()
+    {
+        for (auto& instance: instances)
+        {
+            instance->processor.setPlayHead(nullptr);
+            instance->processor.releaseResources();
+        }
+    }
+
+    //One audio callback: every instance processes a block
+    //@return The time the slowest instance took, in microseconds
+    double runCallback()
+    {
+        double worstInstanceMicros = 0.0;
+
+        for (size_t i = 0; i < instances.size(); ++i)
+        {
+            auto& midi = midiBuffers[i];
+            midi.clear();
+
+            const auto start = juce::Time::getHighResolutionTicks();
+            instances[i]->processor.processBlock(audio, midi);
+            const auto elapsed = juce::Time::getHighResolutionTicks() - start;
+
+            worstInstanceMicros =
+                juce::jmax(worstInstanceMicros, juce::Time::highResolutionTicksToSeconds(elapsed) * 1.0e6);
+        }
+
+        playHead.timeInSamples += blockSize;
+        return worstInstanceMicros;
+    }
+
+    //Runs the callbacks, and fills in the CPU figures of the result
+    DensityResult measure()
+    {
+        const auto deadlineMicros = 1.0e6 * blockSize / sampleRate;
+        double totalMicros = 0.0;
+
+        for (int callback = 0; callback < numCallbacks; ++callback)
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+            const auto worstInstanceMicros = runCallback();
+            const auto elapsed = juce::Time::getHighResolutionTicks() - start;
+            const auto callbackMicros = juce::Time::highResolutionTicksToSeconds(elapsed) * 1.0e6;
+
+            totalMicros += callbackMicros;
+            result.worstCallbackMicros = juce::jmax(result.worstCallbackMicros, callbackMicros);
+            result.worstInstanceBlockMicros = juce::jmax(result.worstInstanceBlockMicros, worstInstanceMicros);
+        }
+
+        result.meanCallbackMicros = totalMicros / numCallbacks;
+        result.meanLoadPercent = 100.0 * result.meanCallbackMicros / deadlineMicros;
+        return result;
+    }
+
+private:
+    std::vector<std::unique_ptr<Instance>> instances;
+    std::vector<juce::MidiBuffer> midiBuffers;
+    juce::AudioBuffer<float> audio {2, blockSize};
+    PlayingPlayHead playHead;
+    DensityResult result;
+};
+
+//Writes the results next to the benchmark runner, one row per session size, so a
+//regression in how the plugin scales shows up as a change in the slope of a column
+void writeCsv(const juce::String& fileName, const std::vector<std::pair<int, DensityResult>>& rows)
+{
+    juce::String csv("instances,bytes_per_instance,construction_us_per_instance,"
+                     "mean_callback_us,mean_load_percent,worst_callback_us,worst_instance_block_us\n");
+
+    for (const auto& [numInstances, r]: rows)
+    {
+        csv << numInstances << "," << juce::String((juce::int64) r.bytesPerInstance) << ","
+            << juce::String(r.constructionMicrosPerInstance, 2) << "," << juce::String(r.meanCallbackMicros, 2)
+            << "," << juce::String(r.meanLoadPercent, 2) << "," << juce::String(r.worstCallbackMicros, 2) << ","
+            << juce::String(r.worstInstanceBlockMicros, 2) << "\n";
+    }
+
+    const auto file = juce::File(BENCHMARK_RESULTS_DIR).getChildFile(fileName);
+
+    if (file.replaceWithText(csv))
+        WARN("Wrote " << file.getFullPathName());
+    else
+        WARN("Couldn't write " << file.getFullPathName());
+}
+
+void runDensitySweep(bool withEditors)
+{
+    std::vector<std::pair<int, DensityResult>> rows;
+
+    for (auto numInstances: {1, 10, 50, 100, 200, 400})
+    {
+        Session session(numInstances, withEditors);
+        rows.emplace_back(numInstances, session.measure());
+
+        const auto& r = rows.back().second;
+        WARN(numInstances << " instances" << (withEditors ? " with editors" : "") << ": "
+                          << juce::String((double) r.bytesPerInstance / 1024.0, 1) << " KiB and "
+                          << juce::String(r.constructionMicrosPerInstance, 1) << " us to construct each, "
+                          << juce::String(r.meanLoadPercent, 2) << " % of the callback on average, worst callback "
+                          << juce::String(r.worstCallbackMicros, 1) << " us");
+    }
+
+    writeCsv(withEditors ? "InstanceDensityWithEditors.csv" : "InstanceDensity.csv", rows);
+}
+} // namespace
+
+TEST_CASE("Instance density, sequencers on one audio callback", "[!benchmark]")
+{
+    runDensitySweep(false);
+
+    Session session(100, false);
+
+    BENCHMARK("One callback, 100 instances")
+    {
+        return session.runCallback();
+    };
+}
+
+TEST_CASE("Instance density, sequencers with their editors open", "[!benchmark]")
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    runDensitySweep(true);
+}
@@ -0,0 +1,101 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include "MidiFileWriter.h"
+
+namespace
+{
+//32 lanes of 16 step loops, from a fixed seed
+constexpr int numLanes = 32;
+constexpr int loopLength = 16;
+
+struct Lanes
+{
+    Lanes()
+    {
+        juce::Random random(42);
+
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            for (int i = 0; i < loopLength; ++i)
+            {
+                notes[lane][i] = 36 + random.nextInt(60);
+                velocities[lane][i] = (juce::uint8) (1 + random.nextInt(127));
+                plays[lane][i] = random.nextInt(4) != 0;
+            }
+
+            lanes[lane] = { notes[lane], velocities[lane], plays[lane], loopLength, 1 + lane % 16 };
+        }
+    }
+
+    int notes[numLanes][loopLength] {};
+    juce::uint8 velocities[numLanes][loopLength] {};
+    bool plays[numLanes][loopLength] {};
+    ExportLane lanes[numLanes];
+};
+
+//The way JUCE would write it: every note into a MidiMessageSequence, then MidiFile
+size_t writeWithMidiFile(const Lanes& lanes, const ExportSettings& settings)
+{
+    juce::MidiFile file;
+    file.setTicksPerQuarterNote(MidiFileWriter::ticksPerQuarterNote);
+
+    const auto noteTicks = (double) std::llround((double) settings.stepLengthInTicks * settings.gate);
+
+    for (const auto& lane: lanes.lanes)
+    {
+        juce::MidiMessageSequence track;
+
+        if (file.getNumTracks() == 0)
+            track.addEvent(juce::MidiMessage::tempoMetaEvent(juce::roundToInt(60000000.0 / settings.bpm)));
+
+        for (int loop = 0; loop < settings.numLoops; ++loop)
+        {
+            for (int position = 0; position < lane.loopLength; ++position)
+            {
+                if (!lane.plays[position])
+                    continue;
+
+                const auto time = (double) ((loop * lane.loopLength + position) * settings.stepLengthInTicks);
+                track.addEvent(juce::MidiMessage::noteOn(lane.channel, lane.notes[position], lane.velocities[position]), time);
+                track.addEvent(juce::MidiMessage::noteOff(lane.channel, lane.notes[position]), time + noteTicks);
+            }
+        }
+
+        file.addTrack(track);
+    }
+
+    juce::MemoryOutputStream stream;
+    file.writeTo(stream);
+    return stream.getDataSize();
+}
+} // namespace
+
+TEST_CASE("MIDI file export, 1000 bars of 32 lanes", "[!benchmark]")
+{
+    Lanes lanes;
+
+    //Sixteenths, so a 16 step loop is a bar
+    ExportSettings settings;
+    settings.stepLengthInTicks = MidiFileWriter::ticksPerQuarterNote / 4;
+    settings.numLoops = 1000;
+
+    juce::MemoryBlock data;
+    data.setSize(MidiFileWriter::getMaxFileSize(lanes.lanes, numLanes, settings));
+
+    BENCHMARK("MidiMessageSequence and MidiFile")
+    {
+        return writeWithMidiFile(lanes, settings);
+    };
+
+    BENCHMARK("MidiFileWriter, into a memory block")
+    {
+        juce::MemoryBlock destination;
+        MidiFileWriter::write(lanes.lanes, numLanes, settings, destination);
+        return destination.getSize();
+    };
+
+    BENCHMARK("MidiFileWriter, into a preallocated buffer")
+    {
+        return MidiFileWriter::write(lanes.lanes, numLanes, settings, static_cast<juce::uint8*>(data.getData()));
+    };
+}
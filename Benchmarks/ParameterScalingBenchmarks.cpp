@@ -0,0 +1,136 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/benchmark/catch_constructor.hpp>
+#include "MaxParametersPlugin/Source/PluginProcessor.h"
+#include "PluginProcessor.h"
+#include "HeapUsage.h"
+
+namespace
+{
+//Stands in for a host's plugin wrapper, which hears about every parameter change
+struct CountingListener : juce::AudioProcessorListener
+{
+    void audioProcessorParameterChanged(juce::AudioProcessor*, int, float) override { ++numChanges; }
+    void audioProcessorChanged(juce::AudioProcessor*, const ChangeDetails&) override {}
+
+    int numChanges = 0;
+};
+
+//Flips every parameter, the way a preset change or a host-side randomise does, and
+//returns the number of changes the listener heard of
+int setAllParameters(juce::AudioProcessor& processor, CountingListener& listener, float value)
+{
+    listener.numChanges = 0;
+
+    for (auto* param: processor.getParameters())
+        param->setValueNotifyingHost(value);
+
+    return listener.numChanges;
+}
+
+//Reports the heap a new processor takes up, as a warning so it shows in the output
+template <typename Processor, typename... Args>
+void reportMemory(const std::string& name, int numParams, Args... args)
+{
+    const auto before = getHeapBytesInUse();
+    auto processor = std::make_unique<Processor>(args...);
+    const auto after = getHeapBytesInUse();
+
+    if (before == 0)
+        return;
+
+    const auto bytes = (double) after - (double) before;
+    WARN(name << ": " << juce::String(bytes / 1024.0, 1) << " KiB on the heap, "
+              << juce::String(bytes / juce::jmax(1, numParams), 1) << " bytes per parameter");
+}
+
+void benchmarkMaxParameters(int numParams)
+{
+    const auto name = std::to_string(numParams) + " parameters";
+    reportMemory<MaxParamsProcessor>("MaxParametersPlugin, " + name, numParams, numParams);
+
+    BENCHMARK_ADVANCED("Construction: " + name)(Catch::Benchmark::Chronometer meter)
+    {
+        std::vector<Catch::Benchmark::storage_for<MaxParamsProcessor>> processors((size_t) meter.runs());
+        meter.measure([&](int run) { processors[(size_t) run].construct(numParams); });
+    };
+
+    MaxParamsProcessor source(numParams);
+    MaxParamsProcessor destination(numParams);
+
+    CountingListener listener;
+    source.addListener(&listener);
+    REQUIRE(setAllParameters(source, listener, 1.0f) == numParams);
+
+    juce::MemoryBlock state;
+    source.getStateInformation(state);
+
+    BENCHMARK("getStateInformation and setStateInformation: " + name)
+    {
+        juce::MemoryBlock data;
+        source.getStateInformation(data);
+        destination.setStateInformation(data.getData(), (int) data.getSize());
+        return data.getSize();
+    };
+
+    float value = 0.0f;
+
+    BENCHMARK("setValueNotifyingHost on every parameter: " + name)
+    {
+        value = 1.0f - value;
+        return setAllParameters(source, listener, value);
+    };
+
+    source.removeListener(&listener);
+}
+} // namespace
+
+TEST_CASE("MaxParametersPlugin parameter scaling, 1000 parameters", "[!benchmark]")
+{
+    benchmarkMaxParameters(1000);
+}
+
+TEST_CASE("MaxParametersPlugin parameter scaling, 10000 parameters", "[!benchmark]")
+{
+    benchmarkMaxParameters(MaxParamsProcessor::defaultNumParams);
+}
+
+TEST_CASE("MaxParametersPlugin parameter scaling, 100000 parameters", "[!benchmark]")
+{
+    benchmarkMaxParameters(100000);
+}
+
+TEST_CASE("RandomWalkSequencer parameter costs", "[!benchmark]")
+{
+    AudioPluginAudioProcessor source;
+    const auto numParams = source.getParameters().size();
+    reportMemory<AudioPluginAudioProcessor>("RandomWalkSequencer, " + std::to_string(numParams) + " parameters", numParams);
+
+    BENCHMARK_ADVANCED("Construction")(Catch::Benchmark::Chronometer meter)
+    {
+        std::vector<Catch::Benchmark::storage_for<AudioPluginAudioProcessor>> processors((size_t) meter.runs());
+        meter.measure([&](int run) { processors[(size_t) run].construct(); });
+    };
+
+    AudioPluginAudioProcessor destination;
+
+    BENCHMARK("getStateInformation and setStateInformation")
+    {
+        juce::MemoryBlock data;
+        source.getStateInformation(data);
+        destination.setStateInformation(data.getData(), (int) data.getSize());
+        return data.getSize();
+    };
+
+    CountingListener listener;
+    source.addListener(&listener);
+    float value = 0.0f;
+
+    BENCHMARK("setValueNotifyingHost on every parameter")
+    {
+        value = 1.0f - value;
+        return setAllParameters(source, listener, value);
+    };
+
+    source.removeListener(&listener);
+}
@@ -0,0 +1,111 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include "MaxParametersPlugin/Source/PluginProcessor.h"
+
+namespace
+{
+//The way PluginHelpers used to save and restore parameters: a child tree per parameter,
+//each looked up by name, with the ID worked out afresh at every step
+juce::String getParamID(juce::AudioProcessorParameter* param)
+{
+    if (auto paramWithID = dynamic_cast<juce::AudioProcessorParameterWithID*>(param))
+        return paramWithID->paramID;
+
+    return param->getName(50);
+}
+
+juce::ValueTree saveChildTrees(const juce::AudioProcessor& processor)
+{
+    auto params = juce::ValueTree("Params");
+
+    for (auto& param: processor.getParameters())
+    {
+        auto paramTree = juce::ValueTree(getParamID(param));
+        paramTree.setProperty("Value", param->getValue(), nullptr);
+        params.appendChild(paramTree, nullptr);
+    }
+
+    return params;
+}
+
+void loadChildTrees(const juce::AudioProcessor& processor, const juce::ValueTree& tree)
+{
+    for (auto& param: processor.getParameters())
+    {
+        auto paramTree = tree.getChildWithName(getParamID(param));
+
+        if (paramTree.isValid())
+            param->setValueNotifyingHost(paramTree["Value"]);
+    }
+}
+
+//Every other parameter on, so restoring changes half of them
+void setAlternateValues(MaxParamsProcessor& processor)
+{
+    const auto& params = processor.getParameters();
+
+    for (int index = 0; index < params.size(); ++index)
+        params[index]->setValueNotifyingHost((index & 1) != 0 ? 1.0f : 0.0f);
+}
+} // namespace
+
+TEST_CASE("Parameter state of MaxParametersPlugin, 10000 parameters", "[!benchmark]")
+{
+    MaxParamsProcessor source;
+    setAlternateValues(source);
+
+    MaxParamsProcessor destination;
+    const PluginHelpers::ParameterIndex index(destination);
+
+    const auto childTrees = saveChildTrees(source);
+    const auto packed = PluginHelpers::saveParamsTree(source);
+
+    juce::MemoryBlock state;
+    source.getStateInformation(state);
+
+    BENCHMARK("Building the index")
+    {
+        return PluginHelpers::ParameterIndex(destination).getNumParameters();
+    };
+
+    BENCHMARK("Save, a child tree per parameter")
+    {
+        return saveChildTrees(source).getNumChildren();
+    };
+
+    BENCHMARK("Save, packed")
+    {
+        return index.save().getNumProperties();
+    };
+
+    BENCHMARK("Restore, a child tree per parameter")
+    {
+        loadChildTrees(destination, childTrees);
+        return destination.getParameters().getLast()->getValue();
+    };
+
+    BENCHMARK("Restore, packed, through the index")
+    {
+        index.load(packed);
+        return destination.getParameters().getLast()->getValue();
+    };
+
+    BENCHMARK("Restore, packed, index built per call")
+    {
+        PluginHelpers::loadParamsTree(destination, packed);
+        return destination.getParameters().getLast()->getValue();
+    };
+
+    BENCHMARK("getStateInformation")
+    {
+        juce::MemoryBlock data;
+        source.getStateInformation(data);
+        return data.getSize();
+    };
+
+    BENCHMARK("setStateInformation")
+    {
+        destination.setStateInformation(state.getData(), (int) state.getSize());
+        return destination.getParameters().getLast()->getValue();
+    };
+}
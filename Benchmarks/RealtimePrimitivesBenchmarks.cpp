@@ -0,0 +1,273 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <shared_realtime/shared_realtime.h>
+#include <thread>
+
+namespace
+{
+//About the size of the sequencer's profiler stats
+struct Snapshot
+{
+    double values[20] {};
+};
+
+//The way LookaheadRenderer used to queue its steps: an AbstractFifo beside an array
+template <typename T, int capacity>
+class AbstractFifoQueue
+{
+public:
+    bool push(const T& item) noexcept
+    {
+        auto scope = fifo.write(1);
+
+        if (scope.blockSize1 < 1)
+            return false;
+
+        items[(size_t) scope.startIndex1] = item;
+        return true;
+    }
+
+    bool pop(T& item) noexcept
+    {
+        auto scope = fifo.read(1);
+
+        if (scope.blockSize1 < 1)
+            return false;
+
+        item = items[(size_t) scope.startIndex1];
+        return true;
+    }
+
+private:
+    juce::AbstractFifo fifo { capacity };
+    std::array<T, (size_t) capacity> items {};
+};
+
+//The way SideThreadPaint used to hand over its jobs: a copy under a lock
+template <typename T>
+class LockedValue
+{
+public:
+    void write(const T& newValue)
+    {
+        const juce::ScopedLock sl(lock);
+        value = newValue;
+    }
+
+    T read() const
+    {
+        const juce::ScopedLock sl(lock);
+        return value;
+    }
+
+private:
+    juce::CriticalSection lock;
+    T value {};
+};
+
+//Runs a writer on another thread for as long as it's in scope
+class BackgroundWriter
+{
+public:
+    template <typename WriteFunction>
+    explicit BackgroundWriter(WriteFunction write)
+        : thread([this, write]
+                 {
+                     for (juce::uint32 i = 0; !done; ++i)
+                         write(i);
+                 })
+    {
+    }
+
+    ~BackgroundWriter()
+    {
+        done = true;
+        thread.join();
+    }
+
+private:
+    std::atomic<bool> done {false};
+    std::thread thread;
+};
+
+//Pushes items from another thread and pops them here, the way the lookahead worker feeds
+//the audio thread
+template <typename Queue>
+juce::uint64 passAcrossThreads(Queue& queue, int numItems)
+{
+    std::thread producer([&queue, numItems]
+    {
+        for (int i = 0; i < numItems; ++i)
+            while (!queue.push(i))
+                std::this_thread::yield();
+    });
+
+    juce::uint64 sum = 0;
+
+    for (int received = 0; received < numItems;)
+    {
+        int value = 0;
+
+        if (queue.pop(value))
+        {
+            sum += (juce::uint64) value;
+            ++received;
+        }
+    }
+
+    producer.join();
+    return sum;
+}
+} // namespace
+
+TEST_CASE("Real-time primitives, SPSC queue", "[!benchmark]")
+{
+    Realtime::SpscQueue<int, 1024> spscQueue;
+    AbstractFifoQueue<int, 1024> abstractFifoQueue;
+
+    BENCHMARK("AbstractFifo, 1000 pushes and pops on one thread")
+    {
+        int sum = 0;
+
+        for (int i = 0; i < 1000; ++i)
+        {
+            int value = 0;
+            abstractFifoQueue.push(i);
+            abstractFifoQueue.pop(value);
+            sum += value;
+        }
+
+        return sum;
+    };
+
+    BENCHMARK("SpscQueue, 1000 pushes and pops on one thread")
+    {
+        int sum = 0;
+
+        for (int i = 0; i < 1000; ++i)
+        {
+            int value = 0;
+            spscQueue.push(i);
+            spscQueue.pop(value);
+            sum += value;
+        }
+
+        return sum;
+    };
+
+    BENCHMARK("AbstractFifo, 100000 items across threads")
+    {
+        return passAcrossThreads(abstractFifoQueue, 100000);
+    };
+
+    BENCHMARK("SpscQueue, 100000 items across threads")
+    {
+        return passAcrossThreads(spscQueue, 100000);
+    };
+}
+
+TEST_CASE("Real-time primitives, snapshots read while another thread writes", "[!benchmark]")
+{
+    Snapshot snapshot;
+
+    {
+        LockedValue<Snapshot> locked;
+        BackgroundWriter writer([&locked](juce::uint32 i)
+        {
+            Snapshot value;
+            value.values[0] = i;
+            locked.write(value);
+        });
+
+        BENCHMARK("CriticalSection, 1000 reads")
+        {
+            double sum = 0.0;
+
+            for (int i = 0; i < 1000; ++i)
+                sum += locked.read().values[0];
+
+            return sum;
+        };
+    }
+
+    {
+        Realtime::SeqLock<Snapshot> seqLock;
+        BackgroundWriter writer([&seqLock](juce::uint32 i)
+        {
+            Snapshot value;
+            value.values[0] = i;
+            seqLock.write(value);
+        });
+
+        BENCHMARK("SeqLock, 1000 reads, keeping the last copy when torn")
+        {
+            double sum = 0.0;
+
+            for (int i = 0; i < 1000; ++i)
+            {
+                seqLock.tryRead(snapshot);
+                sum += snapshot.values[0];
+            }
+
+            return sum;
+        };
+    }
+
+    {
+        Realtime::TripleBuffer<Snapshot> tripleBuffer;
+        BackgroundWriter writer([&tripleBuffer](juce::uint32 i)
+        {
+            tripleBuffer.getWriteBuffer().values[0] = i;
+            tripleBuffer.publish();
+        });
+
+        BENCHMARK("TripleBuffer, 1000 reads")
+        {
+            double sum = 0.0;
+
+            for (int i = 0; i < 1000; ++i)
+                sum += tripleBuffer.read().values[0];
+
+            return sum;
+        };
+    }
+}
+
+TEST_CASE("Real-time primitives, reading a shared object", "[!benchmark]")
+{
+    auto sharedObject = std::make_shared<Snapshot>();
+    juce::SpinLock spinLock;
+    Realtime::AtomicSwap<Snapshot> atomicSwap(std::make_unique<Snapshot>());
+
+    BENCHMARK("SpinLock and shared_ptr, 1000 reads")
+    {
+        double sum = 0.0;
+
+        for (int i = 0; i < 1000; ++i)
+        {
+            const juce::SpinLock::ScopedLockType sl(spinLock);
+            sum += sharedObject->values[0];
+        }
+
+        return sum;
+    };
+
+    BENCHMARK("AtomicSwap, 1000 reads")
+    {
+        double sum = 0.0;
+
+        for (int i = 0; i < 1000; ++i)
+        {
+            Realtime::AtomicSwap<Snapshot>::ReadScope scope(atomicSwap);
+            sum += scope->values[0];
+        }
+
+        return sum;
+    };
+
+    BENCHMARK("AtomicSwap, publishing and collecting")
+    {
+        atomicSwap.publish(std::make_unique<Snapshot>());
+        return atomicSwap.getNumRetired();
+    };
+}
@@ -0,0 +1,100 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include "SequencerEngine.h"
+
+namespace
+{
+//Pattern and loop image storage, sized for the largest configuration
+constexpr int maxSteps = 64;
+constexpr int maxLanes = 8;
+
+struct Buffers
+{
+    Buffers()
+    {
+        juce::Random random(42);
+
+        for (int i = 0; i < maxSteps; ++i)
+        {
+            notes[i] = random.nextInt(25) - 12;
+            enabled[i] = random.nextBool();
+        }
+
+        for (auto& value: values)
+            value = random.nextFloat();
+    }
+
+    int notes[maxSteps] {};
+    bool enabled[maxSteps] {};
+    float values[maxLanes * maxSteps] {};
+
+    int imageNotes[maxSteps] {};
+    juce::uint8 imageVelocities[maxSteps] {};
+    bool imagePlays[maxSteps] {};
+    float imageValues[maxLanes * maxSteps] {};
+};
+
+//Renders a loop image for every offset in both modes, the way a sequencer re-renders
+//as the offset is automated, and returns something that depends on every render
+template <typename Render>
+int renderAllOffsets(Buffers& buffers, int numSteps, Render&& render)
+{
+    StepPattern pattern { buffers.notes, buffers.enabled, buffers.values };
+    LoopImage image { buffers.imageNotes, buffers.imageVelocities, buffers.imagePlays, buffers.imageValues };
+    int result = 0;
+
+    for (int offset = 0; offset < numSteps; ++offset)
+    {
+        render(pattern, LoopParameters { 60, offset, numSteps / 2, (offset & 1) != 0 }, image);
+        result += buffers.imageNotes[offset] + buffers.imagePlays[numSteps - 1];
+    }
+
+    return result;
+}
+
+void benchmarkConfiguration(int numSteps, int numLanes)
+{
+    Buffers buffers;
+    auto specialised = SequencerEngines::getRenderLoop(numSteps, numLanes);
+    REQUIRE(specialised != nullptr);
+
+    auto name = std::to_string(numSteps) + " steps, " + std::to_string(numLanes) + " lanes";
+
+    BENCHMARK("Generic path: " + name)
+    {
+        return renderAllOffsets(buffers, numSteps, [numSteps, numLanes](auto& pattern, auto parameters, auto& image)
+        {
+            SequencerEngines::renderLoopGeneric(numSteps, numLanes, pattern, parameters, image);
+        });
+    };
+
+    BENCHMARK("Specialised engine: " + name)
+    {
+        return renderAllOffsets(buffers, numSteps, [specialised](auto& pattern, auto parameters, auto& image)
+        {
+            specialised(pattern, parameters, image);
+        });
+    };
+}
+} // namespace
+
+TEST_CASE("SequencerEngine loop rendering, 16 steps", "[!benchmark]")
+{
+    benchmarkConfiguration(16, 1);
+    benchmarkConfiguration(16, 4);
+    benchmarkConfiguration(16, 8);
+}
+
+TEST_CASE("SequencerEngine loop rendering, 32 steps", "[!benchmark]")
+{
+    benchmarkConfiguration(32, 1);
+    benchmarkConfiguration(32, 4);
+    benchmarkConfiguration(32, 8);
+}
+
+TEST_CASE("SequencerEngine loop rendering, 64 steps", "[!benchmark]")
+{
+    benchmarkConfiguration(64, 1);
+    benchmarkConfiguration(64, 4);
+    benchmarkConfiguration(64, 8);
+}
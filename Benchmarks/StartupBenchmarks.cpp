@@ -0,0 +1,66 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/benchmark/catch_constructor.hpp>
+#include "PluginProcessor.h"
+
+namespace
+{
+//A state saved by an instance that was played and edited, as a project would hold it
+juce::MemoryBlock getSavedState()
+{
+    AudioPluginAudioProcessor source;
+    source.prepareToPlay(48000.0, 512);
+    source.getSequencer().randomizeSequence(3);
+    source.getSequencer().setSequenceValue(5, -3);
+
+    juce::MemoryBlock state;
+    source.getStateInformation(state);
+    return state;
+}
+} // namespace
+
+TEST_CASE("Startup, what a host does with a new instance", "[!benchmark]")
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    const auto state = getSavedState();
+
+    //Scanning: the host creates the plugin, asks what it is and deletes it again
+    BENCHMARK("Host scan: construct, query and destroy")
+    {
+        AudioPluginAudioProcessor processor;
+        return processor.getName().length() + processor.getTotalNumOutputChannels()
+               + (processor.acceptsMidi() ? 1 : 0);
+    };
+
+    BENCHMARK_ADVANCED("Construct")(Catch::Benchmark::Chronometer meter)
+    {
+        std::vector<Catch::Benchmark::storage_for<AudioPluginAudioProcessor>> processors((size_t) meter.runs());
+        meter.measure([&](int run) { processors[(size_t) run].construct(); });
+    };
+
+    AudioPluginAudioProcessor processor;
+
+    BENCHMARK("Restore state")
+    {
+        processor.setStateInformation(state.getData(), (int) state.getSize());
+        return processor.getSequencer().getSequenceValue(5);
+    };
+
+    BENCHMARK("Open and close the editor")
+    {
+        std::unique_ptr<juce::AudioProcessorEditor> editor(processor.createEditorAndMakeActive());
+        return editor->getWidth();
+    };
+
+    //Loading a project: every instance is created, restored and prepared, and some
+    //have their editor opened
+    BENCHMARK("Construct, restore state, prepare and open the editor")
+    {
+        AudioPluginAudioProcessor loaded;
+        loaded.setStateInformation(state.getData(), (int) state.getSize());
+        loaded.prepareToPlay(48000.0, 512);
+
+        std::unique_ptr<juce::AudioProcessorEditor> editor(loaded.createEditorAndMakeActive());
+        return editor->getWidth();
+    };
+}
@@ -0,0 +1,68 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include "WavePath.h"
+
+namespace
+{
+//The way SideThreadPaint used to build its path: std::sin and two jmaps per pixel,
+//into a new Path every frame
+juce::Path getPathPerPixel(juce::Rectangle<int> bounds, float freq)
+{
+    const auto getPoint = [&bounds, freq](int x)
+    {
+        auto scaledX = juce::jmap((float) x, 0.f, (float) bounds.getWidth(), 0.f, 1.f);
+        auto y = std::sin(scaledX * juce::MathConstants<float>::twoPi * freq);
+        auto scaledY = juce::jmap(y, -1.f, 1.f, 0.f, (float) bounds.getHeight());
+
+        return juce::Point<float>((float) x, scaledY);
+    };
+
+    juce::Path wavePath;
+    wavePath.startNewSubPath(getPoint(0));
+
+    for (int x = 1; x < bounds.getWidth(); ++x)
+        wavePath.lineTo(getPoint(x));
+
+    return wavePath;
+}
+
+//One frame for each of 100 components, as ComplicatedPath draws them, the frequency
+//moving on every frame the way its timer moves it
+template <typename MakePath>
+float drawFrames(int width, MakePath makePath)
+{
+    const juce::Rectangle<int> bounds(width, 40);
+    float result = 0.f;
+
+    for (int frame = 0; frame < 100; ++frame)
+        result += makePath(bounds, (float) frame * 0.05f).getBounds().getHeight();
+
+    return result;
+}
+} // namespace
+
+TEST_CASE("Wave path, 100 frames", "[!benchmark]")
+{
+    for (auto width: {600, 3840})
+    {
+        const auto suffix = ", " + std::to_string(width) + " pixels wide";
+        GuiApp::WavePath wave;
+
+        BENCHMARK("std::sin per pixel, a new Path every frame" + suffix)
+        {
+            return drawFrames(width, [](auto bounds, float freq) { return getPathPerPixel(bounds, freq); });
+        };
+
+        BENCHMARK("Vectorised sine, reusing the Path" + suffix)
+        {
+            return drawFrames(width, [&wave](auto bounds, float freq) -> const juce::Path&
+                              { return wave.getPath(bounds, freq); });
+        };
+
+        BENCHMARK("Unchanged frequency, cached Path" + suffix)
+        {
+            return drawFrames(width, [&wave](auto bounds, float) -> const juce::Path&
+                              { return wave.getPath(bounds, 1.f); });
+        };
+    }
+}
@@ -0,0 +1,161 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <shared_processing_code/shared_processing_code.h>
+
+namespace
+{
+constexpr size_t tableSize = 400000;
+
+//The way WhiteNoise::Oscillator used to work: a table of noise per instance,
+//written out a sample and a channel at a time
+class PerInstanceTableOscillator
+{
+public:
+    PerInstanceTableOscillator()
+    {
+        samples.resize(tableSize);
+
+        for (auto& sample: samples)
+            sample = juce::jmap(rand.nextFloat(), -1.f, 1.f) * 0.5f;
+    }
+
+    void process(juce::AudioBuffer<float>& buffer) noexcept
+    {
+        for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+        {
+            auto nextSample = samples[(size_t) samplePos++];
+
+            if (samplePos >= (int) samples.size())
+                samplePos = 0;
+
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                buffer.setSample(channel, sample, nextSample);
+        }
+    }
+
+private:
+    int samplePos = 0;
+    juce::Random rand;
+    std::vector<float> samples;
+};
+
+//One immutable table for the whole process, each instance reading it from its own
+//place, copied out a block at a time
+class SharedTableOscillator
+{
+public:
+    SharedTableOscillator() : samplePos((size_t) juce::Random().nextInt((int) tableSize)) {}
+
+    void process(juce::AudioBuffer<float>& buffer) noexcept
+    {
+        const auto& table = getTable();
+        auto* destination = buffer.getWritePointer(0);
+        auto numSamples = (size_t) buffer.getNumSamples();
+
+        while (numSamples > 0)
+        {
+            const auto count = std::min(numSamples, tableSize - samplePos);
+            juce::FloatVectorOperations::copy(destination, table.data() + samplePos, (int) count);
+            destination += count;
+            numSamples -= count;
+            samplePos = (samplePos + count) % tableSize;
+        }
+
+        for (int channel = 1; channel < buffer.getNumChannels(); ++channel)
+            buffer.copyFrom(channel, 0, buffer, 0, 0, buffer.getNumSamples());
+    }
+
+private:
+    static const std::vector<float>& getTable()
+    {
+        static const std::vector<float> table = []
+        {
+            std::vector<float> samples(tableSize);
+            juce::Random random(42);
+
+            for (auto& sample: samples)
+                sample = juce::jmap(random.nextFloat(), -1.f, 1.f) * 0.5f;
+
+            return samples;
+        }();
+
+        return table;
+    }
+
+    size_t samplePos;
+};
+
+template <typename OscillatorType>
+float processBlocks(OscillatorType& oscillator, juce::AudioBuffer<float>& buffer, int numBlocks)
+{
+    float result = 0.0f;
+
+    for (int block = 0; block < numBlocks; ++block)
+    {
+        oscillator.process(buffer);
+        result += buffer.getSample(1, block % buffer.getNumSamples());
+    }
+
+    return result;
+}
+} // namespace
+
+TEST_CASE("White noise, 100 stereo blocks of 512 samples", "[!benchmark]")
+{
+    juce::AudioBuffer<float> buffer(2, 512);
+
+    PerInstanceTableOscillator perInstanceTable;
+    SharedTableOscillator sharedTable;
+    WhiteNoise::Oscillator vectorised;
+
+    BENCHMARK("Per-instance table, a sample at a time")
+    {
+        return processBlocks(perInstanceTable, buffer, 100);
+    };
+
+    BENCHMARK("Shared table, block copies")
+    {
+        return processBlocks(sharedTable, buffer, 100);
+    };
+
+    BENCHMARK("Vectorised xorshift, block copies")
+    {
+        return processBlocks(vectorised, buffer, 100);
+    };
+}
+
+TEST_CASE("White noise, constructing 64 instances", "[!benchmark]")
+{
+    //The shared table is built by the first instance, outside the measurement
+    SharedTableOscillator warmUp;
+
+    BENCHMARK("Per-instance table")
+    {
+        std::vector<std::unique_ptr<PerInstanceTableOscillator>> instances;
+
+        for (int i = 0; i < 64; ++i)
+            instances.push_back(std::make_unique<PerInstanceTableOscillator>());
+
+        return instances.size();
+    };
+
+    BENCHMARK("Shared table")
+    {
+        std::vector<std::unique_ptr<SharedTableOscillator>> instances;
+
+        for (int i = 0; i < 64; ++i)
+            instances.push_back(std::make_unique<SharedTableOscillator>());
+
+        return instances.size();
+    };
+
+    BENCHMARK("Vectorised xorshift")
+    {
+        std::vector<std::unique_ptr<WhiteNoise::Oscillator>> instances;
+
+        for (int i = 0; i < 64; ++i)
+            instances.push_back(std::make_unique<WhiteNoise::Oscillator>());
+
+        return instances.size();
+    };
+}
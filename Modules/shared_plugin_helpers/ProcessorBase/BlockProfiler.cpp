@@ -0,0 +1,111 @@
+#include "BlockProfiler.h"
+
+namespace PluginHelpers
+{
+BlockProfiler::ScopedBlock::ScopedBlock(BlockProfiler& profilerToUse,
+                                        int numSamplesInBlock,
+                                        double sampleRateToUse) noexcept
+    : profiler(profilerToUse)
+    , active(profilerToUse.isEnabled())
+    , numSamples(numSamplesInBlock)
+    , sampleRate(sampleRateToUse)
+{
+    if (active)
+    {
+        startViolations = getAudioThreadViolationsOnThisThread();
+        startTicks = juce::Time::getHighResolutionTicks();
+    }
+}
+
+BlockProfiler::ScopedBlock::~ScopedBlock() noexcept
+{
+    if (active)
+    {
+        const auto elapsedTicks = juce::Time::getHighResolutionTicks() - startTicks;
+        profiler.recordBlock(juce::Time::highResolutionTicksToSeconds(elapsedTicks),
+                             numSamples,
+                             sampleRate,
+                             getAudioThreadViolationsOnThisThread() - startViolations,
+                             eventsEmitted);
+    }
+}
+
+//==============================================================================
+void BlockProfiler::recordBlock(double elapsedSeconds,
+                                int numSamples,
+                                double sampleRate,
+                                juce::int64 numViolations,
+                                int numEvents) noexcept
+{
+    if (resetRequested.exchange(false, std::memory_order_relaxed))
+    {
+        stats = Stats();
+        totalBlockMicros = 0.0;
+    }
+
+    const auto micros = elapsedSeconds * 1.0e6;
+    const auto deadlineSeconds = sampleRate > 0.0 ? (double) numSamples / sampleRate : 0.0;
+    const auto loadPercent = deadlineSeconds > 0.0 ? 100.0 * elapsedSeconds / deadlineSeconds : 0.0;
+
+    ++stats.blocksProcessed;
+    totalBlockMicros += micros;
+
+    if (loadPercent > 100.0)
+        ++stats.overruns;
+
+    stats.violations += (juce::uint64) juce::jmax((juce::int64) 0, numViolations);
+    stats.eventsEmitted += (juce::uint64) juce::jmax(0, numEvents);
+    stats.lastBlockSize = numSamples;
+    stats.lastBlockMicros = micros;
+    stats.meanBlockMicros = totalBlockMicros / (double) stats.blocksProcessed;
+    stats.worstBlockMicros = juce::jmax(stats.worstBlockMicros, micros);
+    stats.lastLoadPercent = loadPercent;
+    stats.worstLoadPercent = juce::jmax(stats.worstLoadPercent, loadPercent);
+    ++stats.histogram[(size_t) getBucketForLoad(loadPercent)];
+
+    published.write(stats);
+}
+
+int BlockProfiler::getBucketForLoad(double loadPercent) noexcept
+{
+    for (size_t i = 0; i < bucketEdgesPercent.size(); ++i)
+        if (loadPercent < bucketEdgesPercent[i])
+            return (int) i;
+
+    return numBuckets - 1;
+}
+
+juce::String BlockProfiler::getBucketLabel(int bucket)
+{
+    //The edges are all whole percentages
+    const auto edge = [](size_t index) { return juce::String(juce::roundToInt(bucketEdgesPercent[index])); };
+
+    if (bucket <= 0)
+        return "<" + edge(0) + "%";
+
+    if (bucket >= numBuckets - 1)
+        return ">=" + edge(bucketEdgesPercent.size() - 1) + "%";
+
+    return edge((size_t) bucket - 1) + "-" + edge((size_t) bucket) + "%";
+}
+
+juce::String BlockProfiler::Stats::toString() const
+{
+    juce::String report;
+
+    report << "Blocks processed: " << juce::String((juce::int64) blocksProcessed) << juce::newLine
+           << "Overruns: " << juce::String((juce::int64) overruns) << juce::newLine
+           << "Audio thread violations: " << juce::String((juce::int64) violations) << juce::newLine
+           << "MIDI events emitted: " << juce::String((juce::int64) eventsEmitted) << juce::newLine
+           << "Last block: " << lastBlockSize << " samples, " << juce::String(lastBlockMicros, 2) << " us, "
+           << juce::String(lastLoadPercent, 2) << " % of its deadline" << juce::newLine
+           << "Mean block time: " << juce::String(meanBlockMicros, 2) << " us" << juce::newLine
+           << "Worst block: " << juce::String(worstBlockMicros, 2) << " us, "
+           << juce::String(worstLoadPercent, 2) << " % of its deadline" << juce::newLine;
+
+    for (int i = 0; i < numBuckets; ++i)
+        report << getBucketLabel(i) << ": " << juce::String((juce::int64) histogram[(size_t) i]) << juce::newLine;
+
+    return report;
+}
+} // namespace PluginHelpers
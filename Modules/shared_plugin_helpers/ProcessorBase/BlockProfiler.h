@@ -0,0 +1,99 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <shared_realtime/shared_realtime.h>
+#include "../RealtimeSafety/AudioThreadChecker.h"
+
+namespace PluginHelpers
+{
+//Per-block profiling of an audio callback: a histogram of how much of its deadline each
+//block took, the blocks that overran it, the MIDI events they emitted, and the allocations,
+//frees and locks made inside them (counted when the audio thread hooks are built in).
+//Written by the audio thread only, and published whole after every measured block, so an
+//editor reads a consistent set without locking. Off by default: a block then costs one
+//relaxed atomic load.
+class BlockProfiler
+{
+public:
+    static constexpr int numBuckets = 12;
+
+    //Upper edges of every bucket but the last, as a percentage of the block's deadline:
+    //the time the audio in it lasts. The last collects everything above the final edge
+    static constexpr std::array<double, numBuckets - 1> bucketEdgesPercent {
+        1.0, 2.0, 5.0, 10.0, 20.0, 30.0, 50.0, 70.0, 90.0, 100.0, 200.0 };
+
+    struct Stats
+    {
+        juce::uint64 blocksProcessed = 0;
+        juce::uint64 overruns = 0;          //Blocks that took longer than their deadline
+        juce::uint64 violations = 0;        //Allocations, frees and locks inside blocks
+        juce::uint64 eventsEmitted = 0;     //MIDI events the blocks added to their buffers
+        int lastBlockSize = 0;
+        double lastBlockMicros = 0.0;
+        double meanBlockMicros = 0.0;
+        double worstBlockMicros = 0.0;
+        double lastLoadPercent = 0.0;
+        double worstLoadPercent = 0.0;
+        std::array<juce::uint64, numBuckets> histogram {};
+
+        juce::String toString() const;
+    };
+
+    //Times one block while in scope, if the profiler is enabled
+    class ScopedBlock
+    {
+    public:
+        ScopedBlock(BlockProfiler& profilerToUse, int numSamplesInBlock, double sampleRateToUse) noexcept;
+        ~ScopedBlock() noexcept;
+
+        //Whether this block is being measured, so callers can skip counting what it emits
+        bool isActive() const noexcept { return active; }
+
+        //Sets the number of MIDI events the block emitted
+        void setEventsEmitted(int numEvents) noexcept { eventsEmitted = numEvents; }
+
+    private:
+        BlockProfiler& profiler;
+        const bool active;
+        const int numSamples;
+        const double sampleRate;
+        juce::int64 startTicks = 0;
+        juce::int64 startViolations = 0;
+        int eventsEmitted = 0;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedBlock)
+    };
+
+    void setEnabled(bool shouldBeEnabled) noexcept { enabled.store(shouldBeEnabled, std::memory_order_relaxed); }
+    bool isEnabled() const noexcept { return enabled.load(std::memory_order_relaxed); }
+
+    //Has the audio thread clear the stats at its next measured block
+    void requestReset() noexcept { resetRequested.store(true, std::memory_order_relaxed); }
+
+    //The stats the audio thread last published. Call this from one thread only, e.g. an
+    //editor's timer
+    Stats getStats() const noexcept { return published.read(); }
+
+    //Writes a report of the stats to a file, from the thread that reads them
+    bool dumpToFile(const juce::File& file) const { return file.replaceWithText(getStats().toString()); }
+
+    //Audio thread: records a block
+    void recordBlock(double elapsedSeconds,
+                     int numSamples,
+                     double sampleRate,
+                     juce::int64 numViolations,
+                     int numEvents = 0) noexcept;
+
+    static int getBucketForLoad(double loadPercent) noexcept;
+    static juce::String getBucketLabel(int bucket);
+
+private:
+    std::atomic<bool> enabled {false};
+    std::atomic<bool> resetRequested {false};
+
+    //The audio thread's running stats, and its side of the hand-over
+    Stats stats;
+    double totalBlockMicros = 0.0;
+    mutable Realtime::TripleBuffer<Stats> published;
+};
+} // namespace PluginHelpers
@@ -15,28 +15,124 @@ static juce::String getValueString()
     return {"Value"};
 }
 
-juce::ValueTree saveParamsTree(const juce::AudioProcessor& processor)
+static juce::Identifier getValuesID()
 {
-    auto params = juce::ValueTree("Params");
+    return {"Values"};
+}
+
+static juce::Identifier getIDsID()
+{
+    return {"IDs"};
+}
+
+//A binary property, also when it was read back as its base64 text
+static juce::MemoryBlock getBinaryProperty(const juce::ValueTree& tree, const juce::Identifier& name)
+{
+    const auto& value = tree[name];
+
+    if (auto* block = value.getBinaryData())
+        return *block;
+
+    juce::MemoryBlock block;
+
+    if (value.isString())
+        block.fromBase64Encoding(value.toString());
+
+    return block;
+}
+
+ParameterIndex::ParameterIndex(const juce::AudioProcessor& processor)
+    : parameters(processor.getParameters())
+    , indices(juce::jmax(101, parameters.size() * 2))
+{
+    ids.ensureStorageAllocated(parameters.size());
+
+    for (int index = 0; index < parameters.size(); ++index)
+    {
+        ids.add(getParamID(parameters[index]));
+
+        //With duplicate IDs, the first parameter gets the value
+        if (!indices.contains(ids[index]))
+            indices.set(ids[index], index);
+    }
+}
+
+int ParameterIndex::indexOf(const juce::String& id) const
+{
+    return indices.contains(id) ? indices[id] : -1;
+}
+
+juce::ValueTree ParameterIndex::save() const
+{
+    juce::MemoryOutputStream idTable;
+    juce::MemoryOutputStream values((size_t) parameters.size() * sizeof(float));
 
-    for (auto& param: processor.getParameters())
+    for (int index = 0; index < parameters.size(); ++index)
     {
-        auto paramTree = juce::ValueTree(getParamID(param));
-        paramTree.setProperty(getValueString(), param->getValue(), nullptr);
-        params.appendChild(paramTree, nullptr);
+        idTable.writeString(ids[index]);
+        values.writeFloat(parameters[index]->getValue());
     }
 
+    auto params = juce::ValueTree("Params");
+    params.setProperty(getIDsID(), idTable.getMemoryBlock(), nullptr);
+    params.setProperty(getValuesID(), values.getMemoryBlock(), nullptr);
     return params;
 }
 
-void loadParamsTree(const juce::AudioProcessor& processor, const juce::ValueTree& tree)
+void ParameterIndex::load(const juce::ValueTree& tree) const
+{
+    if (!tree.hasProperty(getValuesID()))
+    {
+        loadChildTrees(tree);
+        return;
+    }
+
+    const auto idTable = getBinaryProperty(tree, getIDsID());
+    const auto values = getBinaryProperty(tree, getValuesID());
+
+    auto* id = static_cast<const char*>(idTable.getData());
+    auto* const idTableEnd = id + idTable.getSize();
+    juce::MemoryInputStream valueStream(values, false);
+    const auto numValues = (int) (values.getSize() / sizeof(float));
+
+    for (int stored = 0; stored < numValues && id < idTableEnd; ++stored)
+    {
+        const auto value = valueStream.readFloat();
+        const auto length = (size_t) (std::find(id, idTableEnd, '\0') - id);
+
+        //A state saved by the same build has every parameter where it was, so the
+        //hash is only needed when the parameters have changed since
+        auto index = stored;
+
+        if (stored >= ids.size() || ids[stored].getNumBytesAsUTF8() != length
+            || std::memcmp(ids[stored].toRawUTF8(), id, length) != 0)
+            index = indexOf(juce::String::fromUTF8(id, (int) length));
+
+        if (index >= 0)
+            parameters[index]->setValueNotifyingHost(value);
+
+        id += length + 1;
+    }
+}
+
+void ParameterIndex::loadChildTrees(const juce::ValueTree& tree) const
 {
-    for (auto& param: processor.getParameters())
+    for (const auto& paramTree: tree)
     {
-        auto paramTree = tree.getChildWithName(getParamID(param));
+        const auto index = indexOf(paramTree.getType().toString());
 
-        if (paramTree.isValid())
-            param->setValueNotifyingHost(paramTree[getValueString()]);
+        if (index >= 0 && paramTree.hasProperty(getValueString()))
+            parameters[index]->setValueNotifyingHost(paramTree[getValueString()]);
     }
 }
-} // namespace PluginHelpers
\ No newline at end of file
+
+juce::ValueTree saveParamsTree(const juce::AudioProcessor& processor)
+{
+    return ParameterIndex(processor).save();
+}
+
+void loadParamsTree(const juce::AudioProcessor& processor, const juce::ValueTree& tree)
+{
+    ParameterIndex(processor).load(tree);
+}
+} // namespace PluginHelpers
@@ -4,8 +4,39 @@
 
 namespace PluginHelpers
 {
+//Maps a processor's parameter IDs to their indices, so saving and restoring its
+//parameters takes time linear in their number. Build it once the parameters are all
+//added: it doesn't see parameters added later.
+//
+//Parameters are saved as two binary properties of a "Params" tree: the values as a
+//packed array of little-endian floats, and the IDs as a table of null-terminated UTF-8
+//strings in the same order. Restoring matches by ID, so a state still loads after
+//parameters are added, removed or reordered, and also reads the older format of a
+//child tree per parameter.
+class ParameterIndex
+{
+public:
+    explicit ParameterIndex(const juce::AudioProcessor& processor);
+
+    int getNumParameters() const noexcept { return parameters.size(); }
+    const juce::String& getID(int index) const noexcept { return ids.getReference(index); }
+
+    //The index of the parameter with an ID, or -1 if there's none
+    int indexOf(const juce::String& id) const;
+
+    juce::ValueTree save() const;
+    void load(const juce::ValueTree& tree) const;
+
+private:
+    void loadChildTrees(const juce::ValueTree& tree) const;
+
+    juce::Array<juce::AudioProcessorParameter*> parameters;
+    juce::StringArray ids;
+    juce::HashMap<juce::String, int> indices;
+};
+
 juce::ValueTree saveParamsTree(const juce::AudioProcessor& processor);
 
 void loadParamsTree(const juce::AudioProcessor& processor,
                            const juce::ValueTree& tree);
-} // namespace PluginHelpers
\ No newline at end of file
+} // namespace PluginHelpers
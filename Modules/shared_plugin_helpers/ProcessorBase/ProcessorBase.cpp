@@ -88,6 +88,18 @@ void ProcessorBase::releaseResources()
 {
 }
 
+void ProcessorBase::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    ScopedAudioThread audioThread;
+    BlockProfiler::ScopedBlock profiledBlock(profiler, buffer.getNumSamples(), getSampleRate());
+    const int numIncomingEvents = profiledBlock.isActive() ? midiMessages.getNumEvents() : 0;
+
+    process(buffer, midiMessages);
+
+    if (profiledBlock.isActive())
+        profiledBlock.setEventsEmitted(midiMessages.getNumEvents() - numIncomingEvents);
+}
+
 juce::AudioProcessor::BusesProperties ProcessorBase::getDefaultProperties()
 {
     return BusesProperties()
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <juce_audio_utils/juce_audio_utils.h>
+#include "BlockProfiler.h"
 
 namespace PluginHelpers
 {
@@ -16,8 +17,17 @@ struct ProcessorBase : juce::AudioProcessor
 
     bool isBusesLayoutSupported(const BusesLayout& layouts) const override;
 
+    //Marks the calling thread as the audio thread, for the allocation and lock hooks,
+    //and times the block if profiling is on, around a call to process()
+    void processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages) final;
     using AudioProcessor::processBlock;
 
+    //Override this in place of processBlock
+    virtual void process(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages) = 0;
+
+    //Per-block profiling, off until enabled. Editors read its stats without locking
+    BlockProfiler& getProfiler() noexcept { return profiler; }
+
     void getStateInformation(juce::MemoryBlock& destData) override;
     void setStateInformation(const void* data, int sizeInBytes) override;
 
@@ -38,6 +48,9 @@ struct ProcessorBase : juce::AudioProcessor
     void changeProgramName(int index, const juce::String& newName) override;
 
     static BusesProperties getDefaultProperties();
+
+private:
+    BlockProfiler profiler;
 };
 }
 
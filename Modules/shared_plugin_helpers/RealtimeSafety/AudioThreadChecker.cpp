@@ -0,0 +1,236 @@
+#include "../shared_plugin_helpers.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace PluginHelpers
+{
+namespace
+{
+//Plain ints so that reading them from inside malloc can never allocate
+thread_local int audioThreadDepth = 0;
+thread_local int allowanceDepth = 0;
+thread_local juce::int64 threadViolationCount = 0;
+
+std::atomic<juce::int64> allocationCount {0};
+std::atomic<juce::int64> deallocationCount {0};
+std::atomic<juce::int64> lockCount {0};
+std::atomic<bool> trapOnViolation {false};
+
+void recordViolation(std::atomic<juce::int64>& counter) noexcept
+{
+    if (!isCheckingAudioThread())
+        return;
+
+    counter.fetch_add(1, std::memory_order_relaxed);
+    ++threadViolationCount;
+
+    if (trapOnViolation.load(std::memory_order_relaxed))
+    {
+        //The assertion handler may allocate itself, so don't recurse into it
+        ScopedAudioThreadAllowance allowance;
+        jassertfalse;
+    }
+}
+} // namespace
+
+ScopedAudioThread::ScopedAudioThread() noexcept
+{
+    ++audioThreadDepth;
+}
+
+ScopedAudioThread::~ScopedAudioThread() noexcept
+{
+    --audioThreadDepth;
+}
+
+ScopedAudioThreadAllowance::ScopedAudioThreadAllowance() noexcept
+{
+    ++allowanceDepth;
+}
+
+ScopedAudioThreadAllowance::~ScopedAudioThreadAllowance() noexcept
+{
+    --allowanceDepth;
+}
+
+bool isCheckingAudioThread() noexcept
+{
+    return audioThreadDepth > 0 && allowanceDepth == 0;
+}
+
+bool areAudioThreadHooksInstalled() noexcept
+{
+#if PLUGIN_HELPERS_AUDIO_THREAD_HOOKS || PLUGIN_HELPERS_AUDIO_THREAD_SYSTEM_HOOKS
+    return true;
+#else
+    return false;
+#endif
+}
+
+void setTrapOnAudioThreadViolation(bool shouldTrap) noexcept
+{
+    trapOnViolation.store(shouldTrap, std::memory_order_relaxed);
+}
+
+AudioThreadViolations getAudioThreadViolations() noexcept
+{
+    AudioThreadViolations violations;
+    violations.allocations = allocationCount.load(std::memory_order_relaxed);
+    violations.deallocations = deallocationCount.load(std::memory_order_relaxed);
+    violations.lockAcquisitions = lockCount.load(std::memory_order_relaxed);
+    return violations;
+}
+
+void resetAudioThreadViolations() noexcept
+{
+    allocationCount.store(0, std::memory_order_relaxed);
+    deallocationCount.store(0, std::memory_order_relaxed);
+    lockCount.store(0, std::memory_order_relaxed);
+}
+
+juce::int64 getAudioThreadViolationsOnThisThread() noexcept
+{
+    return threadViolationCount;
+}
+
+void recordAudioThreadAllocation() noexcept
+{
+    recordViolation(allocationCount);
+}
+
+void recordAudioThreadDeallocation() noexcept
+{
+    recordViolation(deallocationCount);
+}
+
+void recordAudioThreadLock() noexcept
+{
+    recordViolation(lockCount);
+}
+} // namespace PluginHelpers
+
+#if PLUGIN_HELPERS_AUDIO_THREAD_SYSTEM_HOOKS && defined(__GLIBC__)
+
+//Interposes the C allocator and pthread mutexes of the final executable.
+//Everything still ends up in glibc, so memory from any layer can be freed by any other.
+//operator new goes through malloc here, so it doesn't need its own hook.
+#include <dlfcn.h>
+#include <pthread.h>
+
+extern "C"
+{
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void __libc_free(void* ptr);
+
+void* malloc(size_t size) noexcept
+{
+    PluginHelpers::recordAudioThreadAllocation();
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) noexcept
+{
+    PluginHelpers::recordAudioThreadAllocation();
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) noexcept
+{
+    PluginHelpers::recordAudioThreadAllocation();
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr) noexcept
+{
+    if (ptr != nullptr)
+        PluginHelpers::recordAudioThreadDeallocation();
+
+    __libc_free(ptr);
+}
+
+int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept
+{
+    using LockFunction = int (*)(pthread_mutex_t*);
+    static std::atomic<LockFunction> realLock {nullptr};
+
+    auto lock = realLock.load(std::memory_order_relaxed);
+
+    if (lock == nullptr)
+    {
+        lock = reinterpret_cast<LockFunction>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+        realLock.store(lock, std::memory_order_relaxed);
+    }
+
+    PluginHelpers::recordAudioThreadLock();
+    return lock(mutex);
+}
+}
+
+#elif PLUGIN_HELPERS_AUDIO_THREAD_HOOKS
+
+//Portable fallback: only C++ allocations are seen.
+//The aligned overloads are left alone, their default versions don't call these.
+void* operator new(std::size_t size)
+{
+    PluginHelpers::recordAudioThreadAllocation();
+
+    if (auto* ptr = std::malloc(size == 0 ? 1 : size))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    PluginHelpers::recordAudioThreadAllocation();
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    if (ptr != nullptr)
+        PluginHelpers::recordAudioThreadDeallocation();
+
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    operator delete(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    operator delete(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    operator delete(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    operator delete(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+    operator delete(ptr);
+}
+
+#endif
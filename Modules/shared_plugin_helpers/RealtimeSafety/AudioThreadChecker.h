@@ -0,0 +1,69 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+namespace PluginHelpers
+{
+//Debug/test helpers for catching real-time safety violations.
+//
+//The audio callback marks its thread with ScopedAudioThread. While a thread is marked,
+//heap allocations, frees and mutex acquisitions are counted (and optionally trapped
+//with an assertion) by the hooks enabled through these module options:
+//
+//PLUGIN_HELPERS_AUDIO_THREAD_HOOKS: replaces the global operator new/delete.
+//PLUGIN_HELPERS_AUDIO_THREAD_SYSTEM_HOOKS: also interposes malloc/calloc/realloc/free
+//and pthread_mutex_lock (glibc only, meant for test executables, not plugins).
+//
+//With both options off, ScopedAudioThread only sets a thread-local flag.
+
+struct AudioThreadViolations
+{
+    juce::int64 allocations = 0;
+    juce::int64 deallocations = 0;
+    juce::int64 lockAcquisitions = 0;
+
+    juce::int64 total() const noexcept
+    {
+        return allocations + deallocations + lockAcquisitions;
+    }
+};
+
+//Marks the calling thread as the audio thread for the lifetime of the object
+struct ScopedAudioThread
+{
+    ScopedAudioThread() noexcept;
+    ~ScopedAudioThread() noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE(ScopedAudioThread)
+};
+
+//Temporarily allows allocations/locks on a marked thread, e.g. for debug logging
+struct ScopedAudioThreadAllowance
+{
+    ScopedAudioThreadAllowance() noexcept;
+    ~ScopedAudioThreadAllowance() noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE(ScopedAudioThreadAllowance)
+};
+
+//True if the calling thread is inside a ScopedAudioThread (and not inside an allowance)
+bool isCheckingAudioThread() noexcept;
+
+//True when this binary was built with any of the allocation/lock hooks
+bool areAudioThreadHooksInstalled() noexcept;
+
+//If enabled, every violation also fires a jassert (only has an effect in debug builds)
+void setTrapOnAudioThreadViolation(bool shouldTrap) noexcept;
+
+AudioThreadViolations getAudioThreadViolations() noexcept;
+void resetAudioThreadViolations() noexcept;
+
+//Violations counted on the calling thread since it started, never reset, so the
+//difference across a block is what that block did, whatever other threads do meanwhile
+juce::int64 getAudioThreadViolationsOnThisThread() noexcept;
+
+//Called by the hooks, but can also be used to annotate custom blocking code
+void recordAudioThreadAllocation() noexcept;
+void recordAudioThreadDeallocation() noexcept;
+void recordAudioThreadLock() noexcept;
+} // namespace PluginHelpers
@@ -1,2 +1,4 @@
 #include "ProcessorBase/ProcessorBase.cpp"
-#include "ProcessorBase/Helpers.cpp"
\ No newline at end of file
+#include "ProcessorBase/BlockProfiler.cpp"
+#include "ProcessorBase/Helpers.cpp"
+#include "RealtimeSafety/AudioThreadChecker.cpp"
\ No newline at end of file
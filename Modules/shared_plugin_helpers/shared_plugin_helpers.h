@@ -10,11 +10,29 @@ BEGIN_JUCE_MODULE_DECLARATION
       name:             shared_plugin_helpers
       description:      Shared plugin helpers
       license:          GPL/Commercial
-      dependencies:     juce_audio_utils
+      dependencies:     juce_audio_utils, shared_realtime
 
      END_JUCE_MODULE_DECLARATION
 
 #endif
 
+/** Config: PLUGIN_HELPERS_AUDIO_THREAD_HOOKS
+    Replaces the global operator new/delete so that allocations made while a thread is
+    marked with PluginHelpers::ScopedAudioThread are counted. Debug/test builds only.
+*/
+#ifndef PLUGIN_HELPERS_AUDIO_THREAD_HOOKS
+    #define PLUGIN_HELPERS_AUDIO_THREAD_HOOKS 0
+#endif
+
+/** Config: PLUGIN_HELPERS_AUDIO_THREAD_SYSTEM_HOOKS
+    Interposes malloc/free and pthread_mutex_lock as well (glibc only).
+    Only enable this in test executables, never in a plugin binary.
+*/
+#ifndef PLUGIN_HELPERS_AUDIO_THREAD_SYSTEM_HOOKS
+    #define PLUGIN_HELPERS_AUDIO_THREAD_SYSTEM_HOOKS 0
+#endif
+
+#include "RealtimeSafety/AudioThreadChecker.h"
+#include "ProcessorBase/BlockProfiler.h"
 #include "ProcessorBase/Helpers.h"
 #include "ProcessorBase/ProcessorBase.h"
\ No newline at end of file
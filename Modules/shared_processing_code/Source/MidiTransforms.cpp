@@ -0,0 +1,347 @@
+#include "MidiTransforms.h"
+
+namespace MidiTransforms
+{
+//Room for an event in a MidiBuffer: its position, its size and up to three bytes, rounded up
+constexpr int bytesPerEvent = 16;
+
+static bool isChannelMessage(juce::uint8 status) noexcept
+{
+    return status >= 0x80 && status < 0xf0;
+}
+
+//Note on, note off or polyphonic pressure: the messages with a note in their first data byte
+static bool hasNote(juce::uint8 status) noexcept
+{
+    return status >= 0x80 && status < 0xb0;
+}
+
+static bool isNoteOn(const juce::uint8* data, int size) noexcept
+{
+    return size == 3 && (data[0] & 0xf0) == 0x90 && data[2] != 0;
+}
+
+static bool isNoteOff(const juce::uint8* data, int size) noexcept
+{
+    return size == 3 && ((data[0] & 0xf0) == 0x80 || ((data[0] & 0xf0) == 0x90 && data[2] == 0));
+}
+
+static juce::uint32 getKind(juce::uint8 status) noexcept
+{
+    switch (status & 0xf0)
+    {
+        case 0x80:
+        case 0x90:
+            return notes;
+        case 0xa0:
+            return polyPressure;
+        case 0xb0:
+            return controllers;
+        case 0xc0:
+            return programChanges;
+        case 0xd0:
+            return channelPressure;
+        case 0xe0:
+            return pitchBend;
+        default:
+            return system;
+    }
+}
+
+static juce::uint8 toChannelByte(int channel) noexcept
+{
+    return (juce::uint8) (juce::jlimit(1, 16, channel) - 1);
+}
+
+//==============================================================================
+Op* Program::addOp(OpType type) noexcept
+{
+    //A program has a fixed number of ops, so that it never allocates
+    jassert(numOps < maxOps);
+
+    if (numOps >= maxOps)
+        return nullptr;
+
+    auto& op = ops[numOps++];
+    op = Op();
+    op.type = type;
+    return &op;
+}
+
+Program& Program::transpose(int semitones) noexcept
+{
+    if (auto* op = addOp(OpType::transpose))
+        op->amount = semitones;
+
+    return *this;
+}
+
+Program& Program::mapChannels(const std::array<int, 16>& destinations) noexcept
+{
+    if (auto* op = addOp(OpType::mapChannels))
+        for (size_t channel = 0; channel < destinations.size(); ++channel)
+            op->table[channel] = (juce::uint8) juce::jlimit(0, 16, destinations[channel]);
+
+    return *this;
+}
+
+Program& Program::toChannel(int channel) noexcept
+{
+    std::array<int, 16> destinations;
+    destinations.fill(juce::jlimit(1, 16, channel));
+    return mapChannels(destinations);
+}
+
+Program& Program::velocityCurve(float curve) noexcept
+{
+    if (auto* op = addOp(OpType::velocityCurve))
+    {
+        const auto exponent = std::pow(4.0f, -juce::jlimit(-1.0f, 1.0f, curve));
+
+        for (int velocity = 1; velocity < 128; ++velocity)
+        {
+            const auto curved = 127.0f * std::pow((float) velocity / 127.0f, exponent);
+            op->table[velocity] = (juce::uint8) juce::jlimit(1, 127, juce::roundToInt(curved));
+        }
+    }
+
+    return *this;
+}
+
+Program& Program::filter(juce::uint32 kindsToKeep, juce::uint16 channelsToKeep, int lowNote, int highNote) noexcept
+{
+    if (auto* op = addOp(OpType::filter))
+    {
+        op->kinds = kindsToKeep;
+        op->channels = channelsToKeep;
+        op->lowNote = (juce::uint8) juce::jlimit(0, 127, lowNote);
+        op->highNote = (juce::uint8) juce::jlimit(0, 127, highNote);
+    }
+
+    return *this;
+}
+
+Program& Program::split(int splitNote, int lowerChannel, int upperChannel) noexcept
+{
+    if (auto* op = addOp(OpType::split))
+    {
+        op->amount = splitNote;
+        op->lowerChannel = (juce::uint8) juce::jlimit(1, 16, lowerChannel);
+        op->upperChannel = (juce::uint8) juce::jlimit(1, 16, upperChannel);
+    }
+
+    return *this;
+}
+
+Program& Program::delay(int samples) noexcept
+{
+    if (auto* op = addOp(OpType::delay))
+        op->amount = juce::jmax(0, samples);
+
+    return *this;
+}
+
+//==============================================================================
+void Pipeline::prepare(int maxEvents)
+{
+    output.ensureSize((size_t) maxEvents * bytesPerEvent);
+    delayed.clear();
+    delayed.reserve((size_t) maxEvents);
+    reset();
+}
+
+void Pipeline::reset() noexcept
+{
+    delayed.clear();
+
+    for (auto& channelNotes: heldNotes)
+        for (auto& heldNote: channelNotes)
+            heldNote = HeldNote();
+
+    blockStart = 0;
+}
+
+void Pipeline::process(juce::MidiBuffer& midiMessages, int numSamples) noexcept
+{
+    output.clear();
+    process(midiMessages, output, numSamples);
+
+    midiMessages.clear();
+    midiMessages.addEvents(output, 0, -1, 0);
+}
+
+void Pipeline::process(const juce::MidiBuffer& source, juce::MidiBuffer& destination, int numSamples) noexcept
+{
+    jassert(&source != &destination);
+    const auto blockEnd = blockStart + numSamples;
+
+    //Events held back by a delay that fall in this block go first, as they came in first
+    size_t numStillDelayed = 0;
+
+    for (const auto& delayedEvent: delayed)
+    {
+        if (delayedEvent.time < blockEnd)
+            destination.addEvent(delayedEvent.event.data, delayedEvent.event.size, (int) (delayedEvent.time - blockStart));
+        else
+            delayed[numStillDelayed++] = delayedEvent;
+    }
+
+    delayed.resize(numStillDelayed);
+
+    for (const auto metadata: source)
+    {
+        //Longer messages such as sysex are only ever filtered
+        if (metadata.numBytes > 3 || metadata.numBytes < 1)
+        {
+            bool keep = true;
+
+            for (int index = 0; index < program.getNumOps(); ++index)
+                if (program.getOp(index).type == OpType::filter)
+                    keep = keep && (program.getOp(index).kinds & system) != 0;
+
+            if (keep)
+                destination.addEvent(metadata.data, metadata.numBytes, metadata.samplePosition);
+
+            continue;
+        }
+
+        Event event;
+        event.size = metadata.numBytes;
+        std::copy(metadata.data, metadata.data + metadata.numBytes, event.data);
+
+        const auto time = blockStart + metadata.samplePosition;
+
+        if (isNoteOff(event.data, event.size))
+        {
+            //A note off goes wherever its note on went
+            auto& heldNote = heldNotes[event.data[0] & 0x0f][event.data[1] & 0x7f];
+
+            if (heldNote.active)
+            {
+                heldNote.active = false;
+
+                if (!heldNote.dropped)
+                {
+                    event.data[0] = (juce::uint8) ((event.data[0] & 0xf0) | heldNote.channel);
+                    event.data[1] = heldNote.note;
+                    event.delay = heldNote.delay;
+                    emit(event, time, destination, blockEnd);
+                }
+
+                continue;
+            }
+        }
+        else if (isNoteOn(event.data, event.size))
+        {
+            auto& heldNote = heldNotes[event.data[0] & 0x0f][event.data[1] & 0x7f];
+            const bool keep = apply(event);
+
+            heldNote.active = true;
+            heldNote.dropped = !keep;
+            heldNote.channel = (juce::uint8) (event.data[0] & 0x0f);
+            heldNote.note = event.data[1];
+            heldNote.delay = event.delay;
+
+            if (keep)
+                emit(event, time, destination, blockEnd);
+
+            continue;
+        }
+
+        if (apply(event))
+            emit(event, time, destination, blockEnd);
+    }
+
+    blockStart = blockEnd;
+}
+
+//Runs every op of the program on an event, returning false if it's dropped
+bool Pipeline::apply(Event& event) const noexcept
+{
+    for (int index = 0; index < program.getNumOps(); ++index)
+    {
+        const auto& op = program.getOp(index);
+        const auto status = event.data[0];
+
+        switch (op.type)
+        {
+            case OpType::transpose:
+                if (hasNote(status) && event.size == 3)
+                {
+                    const auto note = event.data[1] + op.amount;
+
+                    if (note < 0 || note > 127)
+                        return false;
+
+                    event.data[1] = (juce::uint8) note;
+                }
+                break;
+
+            case OpType::mapChannels:
+                if (isChannelMessage(status))
+                {
+                    const auto destination = op.table[status & 0x0f];
+
+                    if (destination == 0)
+                        return false;
+
+                    event.data[0] = (juce::uint8) ((status & 0xf0) | (destination - 1));
+                }
+                break;
+
+            case OpType::velocityCurve:
+                if (isNoteOn(event.data, event.size))
+                    event.data[2] = op.table[event.data[2] & 0x7f];
+                break;
+
+            case OpType::filter:
+                if ((op.kinds & getKind(status)) == 0)
+                    return false;
+
+                if (isChannelMessage(status) && (op.channels & (1 << (status & 0x0f))) == 0)
+                    return false;
+
+                if (hasNote(status) && event.size == 3 && (event.data[1] < op.lowNote || event.data[1] > op.highNote))
+                    return false;
+                break;
+
+            case OpType::split:
+                if (hasNote(status) && event.size == 3)
+                {
+                    const auto channel = event.data[1] < op.amount ? op.lowerChannel : op.upperChannel;
+                    event.data[0] = (juce::uint8) ((status & 0xf0) | toChannelByte(channel));
+                }
+                break;
+
+            case OpType::delay:
+                if (isChannelMessage(status))
+                    event.delay += op.amount;
+                break;
+        }
+    }
+
+    return true;
+}
+
+//Adds an event to this block, or holds it back for a later one
+void Pipeline::emit(const Event& event, juce::int64 time, juce::MidiBuffer& destination, juce::int64 blockEnd) noexcept
+{
+    const auto delayedTime = time + event.delay;
+
+    if (delayedTime < blockEnd)
+    {
+        destination.addEvent(event.data, event.size, (int) (delayedTime - blockStart));
+        return;
+    }
+
+    //Out of room: better early than lost, which could leave a note hanging
+    if (delayed.size() == delayed.capacity())
+    {
+        jassertfalse;
+        destination.addEvent(event.data, event.size, (int) juce::jmax((juce::int64) 0, blockEnd - 1 - blockStart));
+        return;
+    }
+
+    delayed.push_back({ delayedTime, event });
+}
+} // namespace MidiTransforms
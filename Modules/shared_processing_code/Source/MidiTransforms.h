@@ -0,0 +1,144 @@
+#pragma once
+
+#include <juce_audio_utils/juce_audio_utils.h>
+
+//Composable MIDI transforms: a Program is a chain of them, and a Pipeline runs a
+//Program over a block of MIDI in one pass, with no allocation and no virtual calls
+//per event, so it's safe on the audio thread
+namespace MidiTransforms
+{
+constexpr int maxOps = 16;
+
+//Kinds of message, as bits for a filter
+enum Kind : juce::uint32
+{
+    notes = 1 << 0,
+    polyPressure = 1 << 1,
+    controllers = 1 << 2,
+    programChanges = 1 << 3,
+    channelPressure = 1 << 4,
+    pitchBend = 1 << 5,
+    system = 1 << 6,
+    allKinds = (1 << 7) - 1
+};
+
+enum class OpType : juce::uint8
+{
+    transpose,
+    mapChannels,
+    velocityCurve,
+    filter,
+    split,
+    delay
+};
+
+//One step of a program. Plain data, so a program copies without allocating
+struct Op
+{
+    OpType type = OpType::transpose;
+    int amount = 0;                      //Semitones to transpose, samples to delay, or the split note
+    juce::uint32 kinds = allKinds;       //Filter: the kinds of message kept
+    juce::uint16 channels = 0xffff;      //Filter: the channels kept, bit 0 for channel 1
+    juce::uint8 lowNote = 0;             //Filter: the range of notes kept
+    juce::uint8 highNote = 127;
+    juce::uint8 lowerChannel = 1;        //Split: channels for notes below and from the split note
+    juce::uint8 upperChannel = 1;
+    juce::uint8 table[128] {};           //Channel map (the first 16, 0 drops), or velocity curve
+};
+
+//A chain of transforms, applied in the order they're added. Building one doesn't
+//allocate either, so the audio thread can rebuild a program when a setting changes.
+//Notes that end up outside 0-127 are dropped.
+class Program
+{
+public:
+    Program& transpose(int semitones) noexcept;
+
+    //Sends channel messages from each channel to another, 1-16, or drops them for 0
+    Program& mapChannels(const std::array<int, 16>& destinations) noexcept;
+
+    //Sends every channel message to one channel
+    Program& toChannel(int channel) noexcept;
+
+    //Bends note on velocities: 0 leaves them, towards 1 makes them louder and towards
+    //-1 softer. A note on never becomes a note off
+    Program& velocityCurve(float curve) noexcept;
+
+    //Keeps only the kinds of message given, on the channels given, and notes in a range.
+    //Messages without a note aren't held to the range
+    Program& filter(juce::uint32 kindsToKeep, juce::uint16 channelsToKeep = 0xffff,
+                    int lowNote = 0, int highNote = 127) noexcept;
+
+    //Sends notes below the split note to one channel and the rest to another
+    Program& split(int splitNote, int lowerChannel, int upperChannel) noexcept;
+
+    //Delays channel messages. System messages, such as clock, are never delayed
+    Program& delay(int samples) noexcept;
+
+    int getNumOps() const noexcept { return numOps; }
+    const Op& getOp(int index) const noexcept { return ops[index]; }
+    bool isEmpty() const noexcept { return numOps == 0; }
+
+private:
+    Op* addOp(OpType type) noexcept;
+
+    Op ops[maxOps];
+    int numOps = 0;
+};
+
+//Runs a program over blocks of MIDI. Notes offs always follow their note on: a note
+//that started before the program changed ends on the channel and note it started on,
+//after the same delay, or is dropped if its note on was
+class Pipeline
+{
+public:
+    //Preallocates room for a number of events per block and held back by a delay.
+    //Call before processing, off the audio thread
+    void prepare(int maxEvents);
+
+    //Forgets held notes and delayed events
+    void reset() noexcept;
+
+    void setProgram(const Program& programToUse) noexcept { program = programToUse; }
+    const Program& getProgram() const noexcept { return program; }
+
+    //Transforms a block of MIDI in place
+    void process(juce::MidiBuffer& midiMessages, int numSamples) noexcept;
+
+    //Adds the transformed events of a block to another buffer, in time order with
+    //what's there. The two mustn't be the same buffer
+    void process(const juce::MidiBuffer& source, juce::MidiBuffer& destination, int numSamples) noexcept;
+
+private:
+    struct Event
+    {
+        juce::uint8 data[3] {};
+        int size = 0;
+        int delay = 0;
+    };
+
+    struct DelayedEvent
+    {
+        juce::int64 time = 0;
+        Event event;
+    };
+
+    struct HeldNote
+    {
+        bool active = false;
+        bool dropped = false;
+        juce::uint8 channel = 0;
+        juce::uint8 note = 0;
+        int delay = 0;
+    };
+
+    bool apply(Event& event) const noexcept;
+    void emit(const Event& event, juce::int64 time, juce::MidiBuffer& destination, juce::int64 blockEnd) noexcept;
+
+    Program program;
+    juce::MidiBuffer output;
+    std::vector<DelayedEvent> delayed;
+    HeldNote heldNotes[16][128];
+    juce::int64 blockStart = 0;
+};
+} // namespace MidiTransforms
@@ -3,35 +3,94 @@
 namespace WhiteNoise
 {
 constexpr float gain = 0.5f;
-constexpr size_t reservedNumSamples = 400000;
 
 Oscillator::Oscillator()
+    : Oscillator(juce::Random().nextInt64())
 {
-    //Precache the samples to a vector
-    samples.resize(reservedNumSamples);
+}
+
+Oscillator::Oscillator(juce::int64 seed)
+{
+    //splitmix64 spreads the seed over the lanes, so neighbouring seeds still give
+    //unrelated generators. xorshift never leaves a zero state, so none may start there
+    auto x = (juce::uint64) seed;
 
-    for (auto& sample: samples)
-        sample = getNextSample() * gain;
+    for (auto& laneState: state)
+    {
+        x += 0x9e3779b97f4a7c15ULL;
+        auto z = x;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        z ^= z >> 31;
+
+        laneState = (juce::uint32) z | 1u;
+    }
 }
 
 void Oscillator::process(juce::AudioBuffer<float>& buffer) noexcept
 {
-    for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+    if (buffer.getNumChannels() == 0)
+        return;
+
+    fill(buffer.getWritePointer(0), buffer.getNumSamples());
+
+    for (int channel = 1; channel < buffer.getNumChannels(); ++channel)
+        buffer.copyFrom(channel, 0, buffer, 0, 0, buffer.getNumSamples());
+}
+
+void Oscillator::fill(float* destination, int numSamples) noexcept
+{
+    while (numSamples > 0 && pendingPos < numLanes)
     {
-        auto nextSample = samples[(size_t)samplePos++];
+        *destination++ = pending[pendingPos++];
+        --numSamples;
+    }
 
-        if (samplePos >= (int) samples.size())
-            samplePos = 0;
+    //Whole groups go straight to the destination
+    for (; numSamples >= numLanes; numSamples -= numLanes, destination += numLanes)
+        fillGroup(destination);
 
-        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
-            buffer.setSample(channel, sample, nextSample);
+    if (numSamples > 0)
+    {
+        fillGroup(pending);
+        std::copy(pending, pending + numSamples, destination);
+        pendingPos = numSamples;
     }
 }
 
-float Oscillator::getNextSample()
+float Oscillator::getNextSample() noexcept
 {
-    auto f = rand.nextFloat();
-    return juce::jmap(f, -1.f, 1.f);
+    if (pendingPos == numLanes)
+    {
+        fillGroup(pending);
+        pendingPos = 0;
+    }
+
+    return pending[pendingPos++];
+}
+
+void Oscillator::fillGroup(float* destination) noexcept
+{
+    //Every lane steps its own xorshift32, with no branches, so this vectorises
+    juce::uint32 bits[numLanes];
+
+    for (int lane = 0; lane < numLanes; ++lane)
+    {
+        auto x = state[lane];
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        state[lane] = x;
+
+        //The top 23 bits as the mantissa of a float in [1, 2)
+        bits[lane] = (x >> 9) | 0x3f800000u;
+    }
+
+    float values[numLanes];
+    std::memcpy(values, bits, sizeof(values));
+
+    for (int lane = 0; lane < numLanes; ++lane)
+        destination[lane] = (values[lane] - 1.5f) * 2.0f * gain;
 }
 
 } // namespace WhiteNoise
@@ -4,17 +4,34 @@
 //A very simple white noise oscillator
 namespace WhiteNoise
 {
+//Noise is generated in groups of this many samples, one per independent xorshift
+//generator, so the compiler can run all of them side by side in SIMD registers
+constexpr int numLanes = 8;
+
 class Oscillator
 {
 public:
+    //Seeded differently for every instance
     Oscillator();
+
+    //Seeded for a repeatable sequence
+    explicit Oscillator(juce::int64 seed);
+
+    //Fills the first channel with noise, then copies it to the others
     void process(juce::AudioBuffer<float>& buffer) noexcept;
-    float getNextSample();
+
+    //Fills a block with the next numSamples of noise
+    void fill(float* destination, int numSamples) noexcept;
+
+    float getNextSample() noexcept;
 
 private:
-    int samplePos = 0;
+    void fillGroup(float* destination) noexcept;
+
+    juce::uint32 state[numLanes] {};
 
-    juce::Random rand;
-    std::vector<float> samples;
+    //The rest of a group started by the last block
+    float pending[numLanes] {};
+    int pendingPos = numLanes;
 };
 }
@@ -1,3 +1,4 @@
 #include "shared_processing_code.h"
 
-#include "Source/WhiteNoise.cpp"
\ No newline at end of file
+#include "Source/WhiteNoise.cpp"
+#include "Source/MidiTransforms.cpp"
\ No newline at end of file
@@ -0,0 +1,107 @@
+#pragma once
+
+namespace Realtime
+{
+//Hands whole objects, too big or too complex to copy, from one writer thread to one
+//real-time reader thread by swapping a pointer. The reader never waits, allocates or
+//frees: it reads through a ReadScope, and an object swapped out stays alive until the
+//writer sees the reader can't be using it any more.
+//The writer tells that from epochs: every swap bumps the epoch, and the reader notes
+//the epoch it started reading in, so an object retired at a later epoch than that is
+//one the reader never saw, or has finished with.
+template <typename T>
+class AtomicSwap
+{
+public:
+    AtomicSwap() = default;
+
+    explicit AtomicSwap(std::unique_ptr<T> initialObject)
+        : current(initialObject.release())
+    {
+    }
+
+    ~AtomicSwap()
+    {
+        //Nobody may be reading by now
+        jassert(readerEpoch.load() == notReading);
+        delete current.load();
+    }
+
+    //Writer: makes a new object the current one, and frees those the reader is done with.
+    //Only ever call this from one thread, which must not be the reader's
+    void publish(std::unique_ptr<T> newObject)
+    {
+        //Room for the retired object first, so nothing after the swap can throw
+        retired.reserve(retired.size() + 1);
+
+        auto* previous = current.exchange(newObject.release());
+        const auto retiredAt = epoch.fetch_add(1) + 1;
+
+        if (previous != nullptr)
+            retired.push_back({ std::unique_ptr<T>(previous), retiredAt });
+
+        collectGarbage();
+    }
+
+    //Writer: frees the objects swapped out that the reader is done with. Call it now and
+    //then if publish isn't called often, e.g. from a timer
+    void collectGarbage()
+    {
+        const auto reading = readerEpoch.load();
+
+        retired.erase(std::remove_if(retired.begin(), retired.end(),
+                                     [reading](const Retired& object) { return reading >= object.epoch; }),
+                      retired.end());
+    }
+
+    //Writer: the number of objects swapped out but not freed yet
+    int getNumRetired() const noexcept { return (int) retired.size(); }
+
+    //Reader: holds on to the current object while in scope. Don't nest them
+    class ReadScope
+    {
+    public:
+        explicit ReadScope(AtomicSwap& ownerToUse) noexcept
+            : owner(ownerToUse)
+        {
+            jassert(owner.readerEpoch.load(std::memory_order_relaxed) == notReading);
+
+            //The epoch goes before the pointer is loaded: see the class comment
+            owner.readerEpoch.store(owner.epoch.load());
+            object = owner.current.load();
+        }
+
+        ~ReadScope() noexcept { owner.readerEpoch.store(notReading); }
+
+        T* get() const noexcept { return object; }
+        T* operator->() const noexcept { return object; }
+        T& operator*() const noexcept { return *object; }
+        explicit operator bool() const noexcept { return object != nullptr; }
+
+    private:
+        AtomicSwap& owner;
+        T* object = nullptr;
+
+        JUCE_DECLARE_NON_COPYABLE(ReadScope)
+    };
+
+private:
+    //The epochs are compared across threads in one total order, so they all stay seq_cst
+    static constexpr juce::uint64 notReading = ~(juce::uint64) 0;
+
+    struct Retired
+    {
+        std::unique_ptr<T> object;
+        juce::uint64 epoch = 0;
+    };
+
+    alignas(cacheLineSize) std::atomic<T*> current {nullptr};
+    std::atomic<juce::uint64> epoch {0};
+    alignas(cacheLineSize) std::atomic<juce::uint64> readerEpoch {notReading};
+
+    //Only touched by the writer
+    std::vector<Retired> retired;
+
+    JUCE_DECLARE_NON_COPYABLE(AtomicSwap)
+};
+} // namespace Realtime
@@ -0,0 +1,81 @@
+#pragma once
+
+namespace Realtime
+{
+//Shares a small block of plain data, written by one thread and read by any number of
+//others. The writer never waits. A reader copies the data out and checks the sequence
+//number didn't move while it did, retrying if it did, so it's best for data that's
+//read far more often than it's written, and small enough to copy in a few cycles.
+//The data is kept as atomic words, so a reader racing the writer is well defined too.
+template <typename T>
+class SeqLock
+{
+public:
+    static_assert(std::is_trivially_copyable<T>::value, "A SeqLock copies its data word by word");
+
+    SeqLock() { write(T {}); }
+    explicit SeqLock(const T& initialValue) { write(initialValue); }
+
+    //Writer: publishes new data. Only ever call this from one thread at a time
+    void write(const T& value) noexcept
+    {
+        Words source {};
+        std::memcpy(source.data(), &value, sizeof(T));
+
+        const auto before = sequence.load(std::memory_order_relaxed);
+        sequence.store(before + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (size_t i = 0; i < numWords; ++i)
+            words[i].store(source[i], std::memory_order_relaxed);
+
+        sequence.store(before + 2, std::memory_order_release);
+    }
+
+    //Reader: copies the data out, unless the writer is in the middle of writing it
+    //@return False if it was, leaving value as it was: try again later
+    bool tryRead(T& value) const noexcept
+    {
+        const auto before = sequence.load(std::memory_order_acquire);
+
+        if ((before & 1) != 0)
+            return false;
+
+        Words destination;
+
+        for (size_t i = 0; i < numWords; ++i)
+            destination[i] = words[i].load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (sequence.load(std::memory_order_relaxed) != before)
+            return false;
+
+        std::memcpy(static_cast<void*>(&value), destination.data(), sizeof(T));
+        return true;
+    }
+
+    //Reader: copies the data out, retrying until the writer isn't in the way.
+    //On the audio thread, prefer tryRead and keep the last copy when it fails
+    T read() const noexcept
+    {
+        T value {};
+
+        while (!tryRead(value))
+            ;
+
+        return value;
+    }
+
+    //Either side: the number of writes so far, to tell whether the data changed
+    juce::uint32 getVersion() const noexcept { return sequence.load(std::memory_order_acquire) / 2; }
+
+private:
+    static constexpr size_t numWords = (sizeof(T) + sizeof(juce::uint32) - 1) / sizeof(juce::uint32);
+    using Words = std::array<juce::uint32, numWords>;
+
+    //Odd while a write is under way
+    alignas(cacheLineSize) std::atomic<juce::uint32> sequence {0};
+    std::atomic<juce::uint32> words[numWords] {};
+};
+} // namespace Realtime
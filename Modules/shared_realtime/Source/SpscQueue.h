@@ -0,0 +1,87 @@
+#pragma once
+
+namespace Realtime
+{
+//A wait-free queue from one producer thread to one consumer thread, holding up to
+//capacity items in a fixed array. Neither side ever allocates, locks or waits: a push
+//onto a full queue and a pop from an empty one just fail.
+//Each side keeps its own copy of the other's position, and only reloads it when the
+//queue looks full or empty, so most calls touch no shared cache line but their own.
+template <typename T, int capacity>
+class SpscQueue
+{
+public:
+    static_assert(capacity > 0 && (capacity & (capacity - 1)) == 0, "The capacity must be a power of two");
+    static_assert(std::is_nothrow_copy_assignable<T>::value, "Items are copied in and out on the audio thread");
+
+    //Producer: copies an item in, returning false if the queue is full
+    bool push(const T& item) noexcept
+    {
+        const auto write = writePosition.load(std::memory_order_relaxed);
+
+        if (write - cachedReadPosition >= (juce::uint32) capacity)
+        {
+            cachedReadPosition = readPosition.load(std::memory_order_acquire);
+
+            if (write - cachedReadPosition >= (juce::uint32) capacity)
+                return false;
+        }
+
+        items[write & mask] = item;
+        writePosition.store(write + 1, std::memory_order_release);
+        return true;
+    }
+
+    //Producer: the number of items that can be pushed before the queue is full
+    int getFreeSpace() const noexcept
+    {
+        return capacity - (int) (writePosition.load(std::memory_order_relaxed) - readPosition.load(std::memory_order_acquire));
+    }
+
+    //Consumer: copies the oldest item out, returning false if the queue is empty
+    bool pop(T& item) noexcept
+    {
+        const auto read = readPosition.load(std::memory_order_relaxed);
+
+        if (read == cachedWritePosition)
+        {
+            cachedWritePosition = writePosition.load(std::memory_order_acquire);
+
+            if (read == cachedWritePosition)
+                return false;
+        }
+
+        item = items[read & mask];
+        readPosition.store(read + 1, std::memory_order_release);
+        return true;
+    }
+
+    //Consumer: drops everything pushed so far
+    void discardAll() noexcept
+    {
+        cachedWritePosition = writePosition.load(std::memory_order_acquire);
+        readPosition.store(cachedWritePosition, std::memory_order_release);
+    }
+
+    //Either side: the number of items ready to pop. Only exact on the consumer side
+    int getNumReady() const noexcept
+    {
+        return (int) (writePosition.load(std::memory_order_acquire) - readPosition.load(std::memory_order_acquire));
+    }
+
+    static constexpr int getCapacity() noexcept { return capacity; }
+
+private:
+    static constexpr juce::uint32 mask = (juce::uint32) capacity - 1;
+
+    //The positions count up forever and wrap around together, so full and empty
+    //never look the same
+    alignas(cacheLineSize) std::atomic<juce::uint32> writePosition {0};
+    juce::uint32 cachedReadPosition = 0;
+
+    alignas(cacheLineSize) std::atomic<juce::uint32> readPosition {0};
+    juce::uint32 cachedWritePosition = 0;
+
+    alignas(cacheLineSize) std::array<T, (size_t) capacity> items {};
+};
+} // namespace Realtime
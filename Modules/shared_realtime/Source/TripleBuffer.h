@@ -0,0 +1,76 @@
+#pragma once
+
+namespace Realtime
+{
+//Hands snapshots too big for an atomic from one writer thread to one reader thread.
+//The writer fills its own buffer and publishes it by swapping it with the middle one,
+//and the reader takes the latest by swapping its own buffer with the middle one, so
+//neither ever waits for the other, copies the other's data or sees a half written
+//snapshot. Snapshots the reader doesn't get to in time are skipped.
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() = default;
+
+    explicit TripleBuffer(const T& initialValue)
+    {
+        for (auto& buffer: buffers)
+            buffer.value = initialValue;
+    }
+
+    //Writer: the buffer to fill before publishing it. It holds whatever was published
+    //two snapshots ago, so fill in all of it
+    T& getWriteBuffer() noexcept { return buffers[writeIndex].value; }
+
+    //Writer: makes the write buffer the latest snapshot
+    void publish() noexcept
+    {
+        writeIndex = middle.exchange(writeIndex | newFlag, std::memory_order_acq_rel) & indexMask;
+    }
+
+    //Writer: copies a snapshot in and publishes it
+    void write(const T& value) noexcept(std::is_nothrow_copy_assignable<T>::value)
+    {
+        getWriteBuffer() = value;
+        publish();
+    }
+
+    //Reader: takes the latest snapshot, if one was published since the last update
+    //@return Whether the read buffer changed
+    bool update() noexcept
+    {
+        if ((middle.load(std::memory_order_relaxed) & newFlag) == 0)
+            return false;
+
+        readIndex = middle.exchange(readIndex, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    //Reader: the snapshot taken by the last update. Stays put until the next one
+    const T& getReadBuffer() const noexcept { return buffers[readIndex].value; }
+
+    //Reader: updates and returns the latest snapshot
+    const T& read() noexcept
+    {
+        update();
+        return getReadBuffer();
+    }
+
+private:
+    //Index of the middle buffer, and whether it holds a snapshot the reader hasn't taken
+    static constexpr int indexMask = 3;
+    static constexpr int newFlag = 4;
+
+    struct alignas(cacheLineSize) Buffer
+    {
+        T value {};
+    };
+
+    Buffer buffers[3];
+
+    alignas(cacheLineSize) std::atomic<int> middle {1};
+    alignas(cacheLineSize) int writeIndex = 0;
+    alignas(cacheLineSize) int readIndex = 2;
+};
+} // namespace Realtime
@@ -0,0 +1,3 @@
+#include "shared_realtime.h"
+
+//Everything in this module is a template, so there's nothing else to compile here
@@ -0,0 +1,38 @@
+#pragma once
+
+#if 0
+
+BEGIN_JUCE_MODULE_DECLARATION
+
+      ID:               shared_realtime
+      vendor:           Eyal Amir
+      version:          0.0.1
+      name:             shared_realtime
+      description:      Wait-free primitives for sharing state with the audio thread
+      license:          GPL/Commercial
+      dependencies:     juce_core
+
+     END_JUCE_MODULE_DECLARATION
+
+#endif
+
+#include <juce_core/juce_core.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace Realtime
+{
+//State written by one thread and read by another goes on its own cache line, so the
+//two threads don't keep taking the line from each other
+constexpr size_t cacheLineSize = 64;
+} // namespace Realtime
+
+#include "Source/SpscQueue.h"
+#include "Source/TripleBuffer.h"
+#include "Source/SeqLock.h"
+#include "Source/AtomicSwap.h"
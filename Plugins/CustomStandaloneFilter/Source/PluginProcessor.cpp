@@ -1,8 +1,8 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
-void CustomStandaloneProcessor::processBlock(juce::AudioBuffer<float>& buffer,
-                                             juce::MidiBuffer& midiMessages)
+void CustomStandaloneProcessor::process(juce::AudioBuffer<float>& buffer,
+                                        juce::MidiBuffer& midiMessages)
 
 {
     midiMessages.clear();
@@ -5,7 +5,7 @@
 class CustomStandaloneProcessor : public PluginHelpers::ProcessorBase
 {
 private:
-    void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void process(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
     juce::AudioProcessorEditor* createEditor() override;
 
 };
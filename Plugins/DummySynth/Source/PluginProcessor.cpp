@@ -5,8 +5,8 @@ DummySynth::DummySynth()
 {
 }
 
-void DummySynth::processBlock(juce::AudioBuffer<float>& buffer,
-                              juce::MidiBuffer& midiMessages)
+void DummySynth::process(juce::AudioBuffer<float>& buffer,
+                         juce::MidiBuffer& midiMessages)
 {
     juce::ignoreUnused(midiMessages);
     buffer.clear();
@@ -3,7 +3,7 @@
 #include <shared_plugin_helpers/shared_plugin_helpers.h>
 
 //Inhereting from PluginHelpers::ProcessorBase, which is just inhereting from juce::AudioProcessor
-//And adding some default implementations
+//And adding some default implementations, and a processBlock that calls process()
 
 class DummySynth : public PluginHelpers::ProcessorBase
 {
@@ -11,8 +11,8 @@ public:
     DummySynth();
 
 private:
-    void processBlock(juce::AudioBuffer<float>& buffer,
-                      juce::MidiBuffer& midiMessages) override;
+    void process(juce::AudioBuffer<float>& buffer,
+                 juce::MidiBuffer& midiMessages) override;
 
     static BusesProperties getBuses();
 };
@@ -1,19 +1,20 @@
 #include "PluginProcessor.h"
 
-constexpr int numParams = 10000;
 constexpr bool useEditor = false;
 
-MaxParamsProcessor::MaxParamsProcessor()
+MaxParamsProcessor::MaxParamsProcessor(int numParams)
 {
     for (int index = 0; index < numParams; ++index)
     {
         auto name = juce::String(index);
         addParameter(new juce::AudioParameterBool({name, 1}, name, false));
     }
+
+    parameterIndex = std::make_unique<PluginHelpers::ParameterIndex>(*this);
 }
 
-void MaxParamsProcessor::processBlock(juce::AudioBuffer<float>& buffer,
-                                      juce::MidiBuffer& midiMessages)
+void MaxParamsProcessor::process(juce::AudioBuffer<float>& buffer,
+                                 juce::MidiBuffer& midiMessages)
 {
     juce::ignoreUnused(midiMessages);
     buffer.clear();
@@ -31,6 +32,21 @@ bool MaxParamsProcessor::hasEditor() const
     return useEditor;
 }
 
+void MaxParamsProcessor::getStateInformation(juce::MemoryBlock& destData)
+{
+    //Binary rather than XML: with this many parameters, the text costs more than the values
+    juce::MemoryOutputStream stream(destData, false);
+    parameterIndex->save().writeToStream(stream);
+}
+
+void MaxParamsProcessor::setStateInformation(const void* data, int sizeInBytes)
+{
+    auto params = juce::ValueTree::readFromData(data, (size_t) sizeInBytes);
+
+    if (params.isValid())
+        parameterIndex->load(params);
+}
+
 juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
 {
     return new MaxParamsProcessor();
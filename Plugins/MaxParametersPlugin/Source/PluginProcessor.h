@@ -3,16 +3,26 @@
 #include <shared_plugin_helpers/shared_plugin_helpers.h>
 
 //Inhereting from PluginHelpers::ProcessorBase, which is just inhereting from juce::AudioProcessor
-//And adding some default implementations
+//And adding some default implementations, and a processBlock that calls process()
 
 class MaxParamsProcessor : public PluginHelpers::ProcessorBase
 {
 public:
-    MaxParamsProcessor();
+    static constexpr int defaultNumParams = 10000;
 
-    void processBlock(juce::AudioBuffer<float>& buffer,
-                      juce::MidiBuffer& midiMessages) override;
+    //More or fewer parameters than the plugin has, for measuring how the parameter layer scales
+    explicit MaxParamsProcessor(int numParams = defaultNumParams);
+
+    void process(juce::AudioBuffer<float>& buffer,
+                 juce::MidiBuffer& midiMessages) override;
 
     bool hasEditor() const override;
     juce::AudioProcessorEditor* createEditor() override;
+
+    void getStateInformation(juce::MemoryBlock& destData) override;
+    void setStateInformation(const void* data, int sizeInBytes) override;
+
+private:
+    //Built once all the parameters are added, so a state saves and loads in linear time
+    std::unique_ptr<PluginHelpers::ParameterIndex> parameterIndex;
 };
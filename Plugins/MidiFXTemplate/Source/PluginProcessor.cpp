@@ -1,28 +1,31 @@
 #include "PluginProcessor.h"
 
-void MidiFXProcessor::processBlock(juce::AudioBuffer<float>& /*buffer*/,
-                                   juce::MidiBuffer& midiMessages)
-
+MidiFXProcessor::MidiFXProcessor()
 {
-    tempBuffer.clear();
+    transpose = new juce::AudioParameterInt({"transpose", 1}, "Transpose", -24, 24, 0);
+    addParameter(transpose);
+}
 
-    for (auto m: midiMessages)
-    {
-        auto message = m.getMessage();
-        auto samplePos = m.samplePosition;
+void MidiFXProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
+{
+    juce::ignoreUnused(sampleRate, samplesPerBlock);
 
-        //First, debug all incoming messages to console:
-        std::cout << "Incoming:" << message.getDescription()
-                  << " SamplePos:" << juce::String(samplePos) << std::endl;
+    //Room for the events of a block, so processing never allocates
+    pipeline.prepare(2048);
+}
 
-        //Then, transpose all notes to be note #60
-        if (message.isNoteOnOrOff())
-            message.setNoteNumber(60);
+void MidiFXProcessor::process(juce::AudioBuffer<float>& buffer,
+                              juce::MidiBuffer& midiMessages)
 
-        tempBuffer.addEvent(message, samplePos);
+{
+    //Chain more transforms here: channel maps, velocity curves, filters, splits, delays
+    if (transpose->get() != programTranspose)
+    {
+        programTranspose = transpose->get();
+        pipeline.setProgram(MidiTransforms::Program().transpose(programTranspose));
     }
 
-    midiMessages.swapWith(tempBuffer);
+    pipeline.process(midiMessages, buffer.getNumSamples());
 }
 
 juce::AudioProcessorEditor* MidiFXProcessor::createEditor()
@@ -1,15 +1,22 @@
 #pragma once
 
 #include <shared_plugin_helpers/shared_plugin_helpers.h>
+#include <shared_processing_code/shared_processing_code.h>
 
 class MidiFXProcessor : public PluginHelpers::ProcessorBase
 {
 public:
+    MidiFXProcessor();
 
-    void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void prepareToPlay(double sampleRate, int samplesPerBlock) override;
+    void process(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
 
     juce::AudioProcessorEditor* createEditor() override;
 private:
 
-    juce::MidiBuffer tempBuffer;
+    juce::AudioParameterInt* transpose = nullptr;
+
+    //Built into a program on the audio thread whenever the parameter changes
+    MidiTransforms::Pipeline pipeline;
+    int programTranspose = 0;
 };
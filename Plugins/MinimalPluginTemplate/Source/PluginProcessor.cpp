@@ -1,7 +1,7 @@
 #include "PluginProcessor.h"
 
-void MinimalAudioPlugin::processBlock(juce::AudioBuffer<float>& buffer,
-                                      juce::MidiBuffer& midiMessages)
+void MinimalAudioPlugin::process(juce::AudioBuffer<float>& buffer,
+                                 juce::MidiBuffer& midiMessages)
 {
     juce::ignoreUnused(midiMessages);
     buffer.clear();
@@ -3,11 +3,11 @@
 #include <shared_plugin_helpers/shared_plugin_helpers.h>
 
 //Inhereting from PluginHelpers::ProcessorBase, which is just inhereting from juce::AudioProcessor
-//And adding some default implementations
+//And adding some default implementations, and a processBlock that calls process()
 
 class MinimalAudioPlugin : public PluginHelpers::ProcessorBase
 {
 public:
-    void processBlock(juce::AudioBuffer<float>& buffer,
-                      juce::MidiBuffer& midiMessages) override;
+    void process(juce::AudioBuffer<float>& buffer,
+                 juce::MidiBuffer& midiMessages) override;
 };
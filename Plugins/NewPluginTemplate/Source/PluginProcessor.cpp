@@ -6,8 +6,8 @@ NewPluginTemplateAudioProcessor::NewPluginTemplateAudioProcessor()
     parameters.add(*this);
 }
 
-void NewPluginTemplateAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer,
-                                                   juce::MidiBuffer& midiMessages)
+void NewPluginTemplateAudioProcessor::process(juce::AudioBuffer<float>& buffer,
+                                              juce::MidiBuffer& midiMessages)
 
 {
     juce::ignoreUnused(midiMessages);
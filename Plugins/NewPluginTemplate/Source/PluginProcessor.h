@@ -7,7 +7,7 @@ class NewPluginTemplateAudioProcessor : public PluginHelpers::ProcessorBase
 public:
     NewPluginTemplateAudioProcessor();
 
-    void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void process(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
 
     juce::AudioProcessorEditor* createEditor() override;
 
@@ -1,7 +1,7 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
-void PluginWithCustomModule::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
+void PluginWithCustomModule::process(juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
 
 {
     whiteNoise.process(buffer);
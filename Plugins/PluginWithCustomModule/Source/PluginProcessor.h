@@ -7,7 +7,7 @@ class PluginWithCustomModule : public PluginHelpers::ProcessorBase
 {
 public:
 
-    void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void process(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
 
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override { return true; }
@@ -0,0 +1,34 @@
+#The sequencer's sources, shared by the plugin, the unit tests and the benchmarks, which all
+#link against RandomWalkSequencerCode instead of listing them.
+#It's an INTERFACE library rather than a STATIC one: every source includes the JuceHeader.h
+#generated for the target it's built into, PluginProcessor.cpp reads that target's JucePlugin_
+#settings, and the JUCE modules must only be compiled into the final target, once.
+include_guard(GLOBAL)
+
+add_library(RandomWalkSequencerCode INTERFACE)
+
+set(RandomWalkSequencerSource ${CMAKE_CURRENT_LIST_DIR}/Source)
+
+target_sources(RandomWalkSequencerCode INTERFACE
+        ${RandomWalkSequencerSource}/PluginProcessor.cpp
+        ${RandomWalkSequencerSource}/RandomWalkSequencer.cpp
+        ${RandomWalkSequencerSource}/RandomWalkSequencerEditor.cpp
+        ${RandomWalkSequencerSource}/MpeChannelAllocator.cpp
+        ${RandomWalkSequencerSource}/LinkGroup.cpp
+        ${RandomWalkSequencerSource}/SequencerEngine.cpp
+        ${RandomWalkSequencerSource}/StepClock.cpp
+        ${RandomWalkSequencerSource}/LookaheadRenderer.cpp
+        ${RandomWalkSequencerSource}/SearchedWalkGenerator.cpp
+        ${RandomWalkSequencerSource}/PerformancePanel.cpp
+        ${RandomWalkSequencerSource}/SequencerParameters.cpp
+        ${RandomWalkSequencerSource}/MidiFileWriter.cpp
+        ${RandomWalkSequencerSource}/MidiClock.cpp)
+
+target_include_directories(RandomWalkSequencerCode INTERFACE ${RandomWalkSequencerSource})
+
+target_link_libraries(RandomWalkSequencerCode INTERFACE
+        juce_audio_utils
+        juce_audio_processors
+        shared_plugin_helpers
+        shared_processing_code
+        shared_realtime)
@@ -0,0 +1,250 @@
+#include "LinkGroup.h"
+
+namespace
+{
+// Constant-initialised, so there's no static-init guard for the audio thread to hit
+LinkGroup linkGroups[LinkGroup::maxGroups];
+} // namespace
+
+/**
+ * Gets a group from the registry
+ */
+LinkGroup* LinkGroup::getGroup(int groupId) noexcept
+{
+    if (groupId < 1 || groupId > maxGroups)
+        return nullptr;
+
+    return &linkGroups[groupId - 1];
+}
+
+/**
+ * Computes the step grid for a block
+ * Step k starts at floor(k * stepLength) from host position 0, so every member computes
+ * the same grid for the same block, and it never drifts from the host timeline
+ */
+LinkGroup::Timebase LinkGroup::computeTimebase(juce::int64 blockStart, const StepClock::SampleLength& stepLength) noexcept
+{
+    Timebase timebase;
+    timebase.blockStart = blockStart;
+    timebase.stepLength = stepLength;
+
+    if (stepLength.isValid())
+    {
+        // Estimate the first step in floating point, then settle it exactly
+        auto step = (juce::int64) std::ceil((double) blockStart / stepLength.toDouble());
+
+        while (stepLength.getStepStart(step) < blockStart)
+            ++step;
+
+        while (stepLength.getStepStart(step - 1) >= blockStart)
+            --step;
+
+        timebase.firstStep = step;
+        timebase.samplesUntilFirstStep = stepLength.getStepStart(step) - blockStart;
+    }
+
+    return timebase;
+}
+
+//==============================================================================
+/**
+ * Registers a member with the group
+ */
+void LinkGroup::join() noexcept
+{
+    numMembers.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * Unregisters a member, giving up leadership if it holds it
+ */
+void LinkGroup::leave(const void* member) noexcept
+{
+    releaseLeadership(member);
+    numMembers.fetch_sub(1, std::memory_order_relaxed);
+}
+
+/**
+ * Makes a member the leader, if the group doesn't have one yet
+ */
+bool LinkGroup::claimLeadership(const void* member) noexcept
+{
+    const void* expected = nullptr;
+    return leader.compare_exchange_strong(expected, member, std::memory_order_acq_rel)
+           || expected == member;
+}
+
+/**
+ * Gives up leadership, if the member holds it
+ */
+void LinkGroup::releaseLeadership(const void* member) noexcept
+{
+    const void* expected = member;
+
+    if (leader.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel))
+        setLeaderStepLength({});
+}
+
+/**
+ * Returns whether the member is the group's leader
+ */
+bool LinkGroup::isLeader(const void* member) const noexcept
+{
+    return leader.load(std::memory_order_acquire) == member;
+}
+
+//==============================================================================
+/**
+ * Sets the step length the group's grid uses
+ * Only the leader writes it, and a leader that just took over can't race the old one
+ * for long, so a writer that finds the version odd just skips this block's update
+ */
+void LinkGroup::setLeaderStepLength(const StepClock::SampleLength& stepLength) noexcept
+{
+    auto version = leaderVersion.load(std::memory_order_relaxed);
+
+    if (leaderStepNumerator.load(std::memory_order_relaxed) == stepLength.numerator
+        && leaderStepDenominator.load(std::memory_order_relaxed) == stepLength.denominator)
+        return;
+
+    if ((version & 1) != 0
+        || !leaderVersion.compare_exchange_strong(version, version + 1, std::memory_order_relaxed))
+        return;
+
+    std::atomic_thread_fence(std::memory_order_release);
+
+    leaderStepNumerator.store(stepLength.numerator, std::memory_order_relaxed);
+    leaderStepDenominator.store(stepLength.denominator, std::memory_order_relaxed);
+
+    leaderVersion.store(version + 2, std::memory_order_release);
+}
+
+/**
+ * Reads the leader's step length
+ * @return False if there's no leader, or it was being written
+ */
+bool LinkGroup::readLeaderStepLength(StepClock::SampleLength& stepLength) const noexcept
+{
+    auto versionBefore = leaderVersion.load(std::memory_order_acquire);
+
+    if ((versionBefore & 1) != 0)
+        return false;
+
+    stepLength.numerator = leaderStepNumerator.load(std::memory_order_relaxed);
+    stepLength.denominator = leaderStepDenominator.load(std::memory_order_relaxed);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return leaderVersion.load(std::memory_order_relaxed) == versionBefore && stepLength.isValid();
+}
+
+/**
+ * Gets the step grid for a block
+ * The first member to process a block computes the grid, preferring the leader's
+ * step length, and the others reuse it
+ */
+LinkGroup::Timebase LinkGroup::getTimebase(juce::int64 blockStart, const StepClock::SampleLength& ownStepLength) noexcept
+{
+    Timebase timebase;
+
+    if (readTimebase(timebase) && timebase.blockStart == blockStart)
+        return timebase;
+
+    StepClock::SampleLength stepLength;
+
+    if (!readLeaderStepLength(stepLength))
+        stepLength = ownStepLength;
+
+    timebase = computeTimebase(blockStart, stepLength);
+    publishTimebase(timebase);
+
+    return timebase;
+}
+
+/**
+ * Reads the last published grid
+ * @return False if a member was publishing at the same time
+ */
+bool LinkGroup::readTimebase(Timebase& timebase) const noexcept
+{
+    auto versionBefore = timebaseVersion.load(std::memory_order_acquire);
+
+    if ((versionBefore & 1) != 0)
+        return false;
+
+    timebase.blockStart = timebaseBlockStart.load(std::memory_order_relaxed);
+    timebase.stepLength.numerator = timebaseStepNumerator.load(std::memory_order_relaxed);
+    timebase.stepLength.denominator = timebaseStepDenominator.load(std::memory_order_relaxed);
+    timebase.firstStep = timebaseFirstStep.load(std::memory_order_relaxed);
+    timebase.samplesUntilFirstStep = timebaseSamplesUntilFirstStep.load(std::memory_order_relaxed);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return timebaseVersion.load(std::memory_order_relaxed) == versionBefore;
+}
+
+/**
+ * Publishes a grid for the other members
+ * If another member is publishing at the same time, this one just doesn't: they're
+ * computing the same grid from the same host position
+ */
+void LinkGroup::publishTimebase(const Timebase& timebase) noexcept
+{
+    auto version = timebaseVersion.load(std::memory_order_relaxed);
+
+    if ((version & 1) != 0
+        || !timebaseVersion.compare_exchange_strong(version, version + 1, std::memory_order_relaxed))
+        return;
+
+    std::atomic_thread_fence(std::memory_order_release);
+
+    timebaseBlockStart.store(timebase.blockStart, std::memory_order_relaxed);
+    timebaseStepNumerator.store(timebase.stepLength.numerator, std::memory_order_relaxed);
+    timebaseStepDenominator.store(timebase.stepLength.denominator, std::memory_order_relaxed);
+    timebaseFirstStep.store(timebase.firstStep, std::memory_order_relaxed);
+    timebaseSamplesUntilFirstStep.store(timebase.samplesUntilFirstStep, std::memory_order_relaxed);
+
+    timebaseVersion.store(version + 2, std::memory_order_release);
+}
+
+//==============================================================================
+/**
+ * Publishes what the leader plays on a step
+ * The slot's step tag doubles as its seqlock: it's invalid while the record is written
+ */
+void LinkGroup::publishStep(juce::int64 step, const StepRecord& record) noexcept
+{
+    // Steps before host position 0 (pre-roll) aren't streamed, -1 marks an empty slot
+    if (step < 0)
+        return;
+
+    auto& slot = stream[(size_t) (step & (streamSize - 1))];
+
+    slot.step.store(-1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.plays.store(record.plays, std::memory_order_relaxed);
+    slot.note.store(record.note, std::memory_order_relaxed);
+    slot.velocity.store(record.velocity, std::memory_order_relaxed);
+
+    slot.step.store(step, std::memory_order_release);
+}
+
+/**
+ * Reads a step of the leader's stream
+ */
+bool LinkGroup::readStep(juce::int64 step, StepRecord& record) const noexcept
+{
+    if (step < 0)
+        return false;
+
+    const auto& slot = stream[(size_t) (step & (streamSize - 1))];
+
+    if (slot.step.load(std::memory_order_acquire) != step)
+        return false;
+
+    record.plays = slot.plays.load(std::memory_order_relaxed);
+    record.note = slot.note.load(std::memory_order_relaxed);
+    record.velocity = slot.velocity.load(std::memory_order_relaxed);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.step.load(std::memory_order_relaxed) == step;
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include "StepClock.h"
+
+/**
+ * A process-wide group of linked RandomWalkSequencer instances
+ *
+ * Groups live in a fixed, statically initialised registry, so joining, leaving and
+ * every per-block operation is lock-free and never allocates. Members of a group:
+ * - share one step grid per host block: the first member to process a block computes
+ *   it from the host position, the others reuse it
+ * - can follow the group's leader, whose step stream (the note it plays on every step
+ *   of the shared grid) is published into a ring of seqlock-protected slots
+ */
+class LinkGroup
+{
+public:
+    /**
+     * Number of groups in the registry, with IDs 1 to maxGroups (0 means not linked)
+     */
+    static constexpr int maxGroups = 8;
+
+    /**
+     * Number of steps the leader's stream keeps, must be a power of two
+     */
+    static constexpr int streamSize = 128;
+
+    /**
+     * Largest number of steps the leader publishes ahead of the current block
+     * Leaves room in the stream for followers that read behind the leader
+     */
+    static constexpr int maxStepsAhead = 64;
+
+    /**
+     * The step grid for one host block
+     */
+    struct Timebase
+    {
+        juce::int64 blockStart = 0;             // Host position of the block, in samples
+        StepClock::SampleLength stepLength;     // Exact length of a step in samples
+        juce::int64 firstStep = 0;              // Index of the first step starting at or after blockStart
+        juce::int64 samplesUntilFirstStep = 0;  // Position of that step relative to blockStart
+    };
+
+    /**
+     * One step of the leader's stream
+     */
+    struct StepRecord
+    {
+        bool plays = false;
+        int note = 0;
+        int velocity = 0;
+    };
+
+    /**
+     * Gets a group from the registry
+     * @param groupId Group ID from 1 to maxGroups
+     * @return The group, or nullptr if the ID is 0 or out of range
+     */
+    static LinkGroup* getGroup(int groupId) noexcept;
+
+    /**
+     * Computes the step grid for a block, measured from host position 0
+     */
+    static Timebase computeTimebase(juce::int64 blockStart, const StepClock::SampleLength& stepLength) noexcept;
+
+    constexpr LinkGroup() noexcept = default;
+
+    //==============================================================================
+    // Membership
+
+    /**
+     * Registers a member with the group
+     */
+    void join() noexcept;
+
+    /**
+     * Unregisters a member, giving up leadership if it holds it
+     * @param member The leaving member, compared against the current leader
+     */
+    void leave(const void* member) noexcept;
+
+    /**
+     * Gets the number of registered members
+     */
+    int getNumMembers() const noexcept { return numMembers.load(std::memory_order_relaxed); }
+
+    /**
+     * Makes a member the leader, if the group doesn't have one yet
+     * @return True if the member is now (or already was) the leader
+     */
+    bool claimLeadership(const void* member) noexcept;
+
+    /**
+     * Gives up leadership, if the member holds it
+     */
+    void releaseLeadership(const void* member) noexcept;
+
+    /**
+     * Returns whether the member is the group's leader
+     */
+    bool isLeader(const void* member) const noexcept;
+
+    //==============================================================================
+    // Shared step grid
+
+    /**
+     * Sets the step length the group's grid uses, called by the leader every block
+     */
+    void setLeaderStepLength(const StepClock::SampleLength& stepLength) noexcept;
+
+    /**
+     * Gets the step grid for a block, computing and publishing it if no member has yet
+     * @param blockStart Host position of the block, in samples
+     * @param ownStepLength The caller's step length, used if the group has no leader
+     */
+    Timebase getTimebase(juce::int64 blockStart, const StepClock::SampleLength& ownStepLength) noexcept;
+
+    //==============================================================================
+    // Leader's step stream
+
+    /**
+     * Publishes what the leader plays on a step (called by the leader only)
+     */
+    void publishStep(juce::int64 step, const StepRecord& record) noexcept;
+
+    /**
+     * Reads a step of the leader's stream
+     * @return False if the step hasn't been published, was overwritten, or is being written
+     */
+    bool readStep(juce::int64 step, StepRecord& record) const noexcept;
+
+private:
+    struct StreamSlot
+    {
+        std::atomic<juce::int64> step {-1};
+        std::atomic<bool> plays {false};
+        std::atomic<int> note {0};
+        std::atomic<int> velocity {0};
+    };
+
+    bool readTimebase(Timebase& timebase) const noexcept;
+    void publishTimebase(const Timebase& timebase) noexcept;
+    bool readLeaderStepLength(StepClock::SampleLength& stepLength) const noexcept;
+
+    std::atomic<int> numMembers {0};
+    std::atomic<const void*> leader {nullptr};
+
+    // The leader's step length, behind a seqlock (odd version while being written)
+    std::atomic<juce::uint32> leaderVersion {0};
+    std::atomic<juce::int64> leaderStepNumerator {0};
+    std::atomic<juce::int64> leaderStepDenominator {1};
+
+    // The last published step grid, behind a seqlock
+    std::atomic<juce::uint32> timebaseVersion {0};
+    std::atomic<juce::int64> timebaseBlockStart {0};
+    std::atomic<juce::int64> timebaseStepNumerator {0};
+    std::atomic<juce::int64> timebaseStepDenominator {1};
+    std::atomic<juce::int64> timebaseFirstStep {0};
+    std::atomic<juce::int64> timebaseSamplesUntilFirstStep {0};
+
+    std::array<StreamSlot, streamSize> stream {};
+
+    JUCE_DECLARE_NON_COPYABLE(LinkGroup)
+};
@@ -0,0 +1,154 @@
+#include "LookaheadRenderer.h"
+
+/**
+ * Constructor - the worker only starts once a generator is set
+ */
+LookaheadRenderer::LookaheadRenderer()
+    : juce::Thread("Lookahead renderer")
+{
+}
+
+/**
+ * Destructor - stops the worker before the generator goes
+ */
+LookaheadRenderer::~LookaheadRenderer()
+{
+    stopThread(2000);
+}
+
+//==============================================================================
+/**
+ * Sets the generator
+ * The worker is stopped while the generator is swapped, so the generator never needs
+ * to be shared between threads
+ */
+void LookaheadRenderer::setGenerator(std::unique_ptr<LookaheadGenerator> newGenerator)
+{
+    stopThread(2000);
+
+    generator = std::move(newGenerator);
+    generatorVersion.fetch_add(1, std::memory_order_release);
+    active.store(generator != nullptr, std::memory_order_relaxed);
+
+    if (generator != nullptr)
+        startThread();
+}
+
+/**
+ * Sets how many bars the worker renders ahead of the playhead
+ * A larger lookahead rides out longer stalls of the worker, but parameter edits flush
+ * more work
+ */
+void LookaheadRenderer::setLookaheadBars(int numBars) noexcept
+{
+    lookaheadBars.store(juce::jlimit(1, 8, numBars), std::memory_order_relaxed);
+}
+
+//==============================================================================
+/**
+ * Returns whether the generator changed since the queue was last primed
+ */
+bool LookaheadRenderer::needsPriming() const noexcept
+{
+    return generatorVersion.load(std::memory_order_acquire) != primedGeneratorVersion;
+}
+
+/**
+ * Flushes the queue and sends a new context to the worker
+ * Steps the worker is rendering for the old context can still arrive after this, but
+ * they carry the old generation, so popStep drops them
+ */
+bool LookaheadRenderer::prime(const LookaheadContext& context) noexcept
+{
+    if (!contexts.push({ generation + 1, context }))
+        return false;
+
+    ++generation;
+
+    // Only the audio thread reads the queue, so it can drop everything in it at once
+    steps.discardAll();
+
+    nextIndex = 0;
+    primedGeneratorVersion = generatorVersion.load(std::memory_order_acquire);
+    return true;
+}
+
+/**
+ * Takes the next step of the stream
+ * A step that wasn't ready in time is skipped: the worker renders it anyway, and it's
+ * dropped here when it arrives, so the stream stays in step with the playhead
+ */
+bool LookaheadRenderer::popStep(RenderedStep& step) noexcept
+{
+    Record record;
+
+    while (steps.pop(record))
+    {
+        if (record.generation != generation || record.index < nextIndex)
+            continue;
+
+        // The worker renders in order, and we never skip ahead of it
+        jassert(record.index == nextIndex);
+
+        step = record.step;
+        ++nextIndex;
+        return true;
+    }
+
+    ++nextIndex;
+    underruns.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+//==============================================================================
+/**
+ * Takes the most recent context the audio thread sent, dropping any older ones
+ * @return False if there was none
+ */
+bool LookaheadRenderer::readLatestContext(PendingContext& pending) noexcept
+{
+    bool found = false;
+
+    while (contexts.pop(pending))
+        found = true;
+
+    return found;
+}
+
+/**
+ * The worker: keeps the queue filled to the lookahead, restarting the stream whenever
+ * the audio thread re-primes
+ * It polls rather than being woken, since waking a thread isn't safe on the audio thread
+ */
+void LookaheadRenderer::run()
+{
+    PendingContext pending;
+    juce::int64 index = 0;
+    bool hasContext = false;
+
+    while (!threadShouldExit())
+    {
+        if (readLatestContext(pending))
+        {
+            generator->restart(pending.context);
+            index = 0;
+            hasContext = true;
+        }
+
+        const int lookaheadSteps = juce::jlimit(1, maxStepsAhead - 1,
+                                                getLookaheadBars() * pending.context.stepsPerBar);
+
+        if (!hasContext || steps.getNumReady() >= lookaheadSteps || steps.getFreeSpace() < 1)
+        {
+            wait(1);
+            continue;
+        }
+
+        Record record;
+        record.generation = pending.generation;
+        record.index = index++;
+        generator->renderStep(record.index, record.step);
+
+        steps.push(record);
+    }
+}
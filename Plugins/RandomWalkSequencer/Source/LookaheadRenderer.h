@@ -0,0 +1,190 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <memory>
+#include "SequencerEngine.h"
+
+/**
+ * What a step rendered ahead of the playhead plays
+ */
+struct RenderedStep
+{
+    bool plays = false;
+    int note = 0;
+    juce::uint8 velocity = 0;
+    int sequenceIndex = 0; // Offset-adjusted index into the sequence, for the expression lanes
+};
+
+/**
+ * What a lookahead generator renders from, latched by the audio thread when it
+ * (re-)primes the queue
+ */
+struct LookaheadContext
+{
+    static constexpr int maxSteps = 64;
+
+    LoopParameters parameters;      // Root, offset, density and step mode at the time
+    int numSteps = 16;              // Steps in the sequence
+    int firstLoopPosition = 0;      // Loop position of the first step to render
+    int stepsPerBar = 16;           // At the current rate, to size the lookahead
+    int sequence[maxSteps] {};      // Note offsets from the root
+    bool enabled[maxSteps] {};      // Manual step mode enabled flags
+
+    /**
+     * Gets the number of positions in the loop
+     */
+    int getLoopLength() const noexcept { return parameters.manualStepMode ? numSteps : parameters.density; }
+
+    /**
+     * Gets the loop position of a step of the stream
+     * @param index Index of the step since the queue was primed
+     */
+    int getLoopPosition(juce::int64 index) const noexcept
+    {
+        return (int) ((firstLoopPosition + index) % juce::jmax(1, getLoopLength()));
+    }
+};
+
+//==============================================================================
+/**
+ * A pattern generator that is too expensive for the audio thread, so it runs on the
+ * LookaheadRenderer's worker thread instead, rendering one step at a time ahead of the
+ * playhead. Both methods are only ever called from the worker thread
+ */
+class LookaheadGenerator
+{
+public:
+    virtual ~LookaheadGenerator() = default;
+
+    /**
+     * Starts a new stream, after the queue was flushed
+     * Called before the first step, and again whenever the audio thread re-primes
+     */
+    virtual void restart(const LookaheadContext& context) = 0;
+
+    /**
+     * Renders the next step of the stream
+     * @param index Index of the step since the stream was restarted
+     */
+    virtual void renderStep(juce::int64 index, RenderedStep& step) = 0;
+};
+
+//==============================================================================
+/**
+ * Renders step data ahead of the playhead on a worker thread
+ *
+ * The worker keeps a lock-free single producer, single consumer queue filled with the
+ * next few bars of steps, and the audio thread only ever dequeues one step per step it
+ * plays. Priming the queue (after a seek, a tempo change or a parameter edit) flushes it
+ * and sends the new context to the worker through a second queue, so the audio thread
+ * never waits for, locks or wakes the worker: steps rendered for an older context are
+ * recognised by their generation and dropped.
+ * When the worker falls behind, popStep fails and the caller falls back to something
+ * it can play without the generator
+ */
+class LookaheadRenderer : private juce::Thread
+{
+public:
+    /**
+     * Largest number of steps the queue holds
+     */
+    static constexpr int maxStepsAhead = 1024;
+
+    LookaheadRenderer();
+    ~LookaheadRenderer() override;
+
+    //==============================================================================
+    // Message thread
+
+    /**
+     * Sets the generator, starting the worker, or stops the worker with nullptr
+     * The audio thread re-primes the queue at the next step
+     */
+    void setGenerator(std::unique_ptr<LookaheadGenerator> newGenerator);
+
+    /**
+     * Returns whether a generator is set
+     */
+    bool isActive() const noexcept { return active.load(std::memory_order_relaxed); }
+
+    /**
+     * Sets how many bars the worker renders ahead of the playhead (1 to 8)
+     */
+    void setLookaheadBars(int numBars) noexcept;
+
+    /**
+     * Gets how many bars the worker renders ahead of the playhead
+     */
+    int getLookaheadBars() const noexcept { return lookaheadBars.load(std::memory_order_relaxed); }
+
+    /**
+     * Gets the number of steps the worker didn't deliver in time
+     */
+    juce::uint32 getNumUnderruns() const noexcept { return underruns.load(std::memory_order_relaxed); }
+
+    //==============================================================================
+    // Audio thread
+
+    /**
+     * Returns whether the generator changed since the queue was last primed
+     */
+    bool needsPriming() const noexcept;
+
+    /**
+     * Flushes the queue and has the worker start a new stream from a context
+     * @return False if the worker hasn't picked up the previous contexts yet; try again later
+     */
+    bool prime(const LookaheadContext& context) noexcept;
+
+    /**
+     * Takes the next step of the stream, dropping any steps that arrived too late
+     * @return False if the worker hasn't rendered it yet (counted as an underrun)
+     */
+    bool popStep(RenderedStep& step) noexcept;
+
+    /**
+     * Gets the number of steps that are ready, for any generation
+     */
+    int getNumStepsReady() const noexcept { return steps.getNumReady(); }
+
+private:
+    struct Record
+    {
+        juce::uint32 generation = 0;
+        juce::int64 index = 0;
+        RenderedStep step;
+    };
+
+    struct PendingContext
+    {
+        juce::uint32 generation = 0;
+        LookaheadContext context;
+    };
+
+    static constexpr int maxPendingContexts = 8;
+
+    void run() override;
+    bool readLatestContext(PendingContext& pending) noexcept;
+
+    // Owned by the worker thread while it runs, swapped by setGenerator while it's stopped
+    std::unique_ptr<LookaheadGenerator> generator;
+
+    std::atomic<bool> active {false};
+    std::atomic<int> lookaheadBars {2};
+    std::atomic<juce::uint32> generatorVersion {0};
+    std::atomic<juce::uint32> underruns {0};
+
+    // Worker to audio thread
+    Realtime::SpscQueue<Record, maxStepsAhead> steps;
+
+    // Audio thread to worker
+    Realtime::SpscQueue<PendingContext, maxPendingContexts> contexts;
+
+    // Audio thread state
+    juce::uint32 generation = 0;          // Generation of the last context sent
+    juce::uint32 primedGeneratorVersion = 0;
+    juce::int64 nextIndex = 0;            // Index of the next step the audio thread plays
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LookaheadRenderer)
+};
@@ -0,0 +1,243 @@
+#include "MidiClock.h"
+
+//==============================================================================
+// MidiClockGenerator
+//==============================================================================
+
+/**
+ * Starts the clock at the first step, and moves on to the step that starts
+ */
+void MidiClockGenerator::addStep(juce::MidiBuffer& midiMessages, int samplePosition, StepClock::Ticks stepLength,
+                                 juce::int64 stepLengthInSamples) noexcept
+{
+    if (!running)
+    {
+        running = true;
+        nextPulse = 0;
+        stepStartTick = 0.0;
+        stepTicks = 0.0;
+        midiMessages.addEvent(juce::MidiMessage::midiStart(), samplePosition);
+    }
+
+    // A tempo change can cut a step short: its last pulses go out now, so none is lost
+    stepStartTick += stepTicks;
+
+    while ((double) (nextPulse * MidiClock::ticksPerPulse) < stepStartTick)
+    {
+        midiMessages.addEvent(juce::MidiMessage::midiClock(), samplePosition);
+        ++nextPulse;
+    }
+
+    stepTicks = (double) stepLength.numerator / (double) juce::jmax((juce::int64) 1, stepLength.denominator);
+    stepSamples = stepLengthInSamples;
+    samplesIntoStep = 0;
+}
+
+/**
+ * Sends the pulses of the current step that fall inside a segment of the block
+ * A pulse's tick position within the step is scaled to the step's length in samples
+ */
+void MidiClockGenerator::addPulses(juce::MidiBuffer& midiMessages, int samplePosition, int numSamples) noexcept
+{
+    if (!running || stepTicks <= 0.0)
+        return;
+
+    for (;;)
+    {
+        const auto pulseTick = (double) (nextPulse * MidiClock::ticksPerPulse);
+
+        if (pulseTick >= stepStartTick + stepTicks)
+            break;
+
+        const auto offset = (juce::int64) ((pulseTick - stepStartTick) * (double) stepSamples / stepTicks);
+
+        if (offset >= samplesIntoStep + numSamples)
+            break;
+
+        midiMessages.addEvent(juce::MidiMessage::midiClock(),
+                              samplePosition + (int) juce::jmax((juce::int64) 0, offset - samplesIntoStep));
+        ++nextPulse;
+    }
+
+    samplesIntoStep += numSamples;
+}
+
+/**
+ * Sends a stop
+ */
+void MidiClockGenerator::stop(juce::MidiBuffer& midiMessages, int samplePosition) noexcept
+{
+    midiMessages.addEvent(juce::MidiMessage::midiStop(), samplePosition);
+    running = false;
+}
+
+//==============================================================================
+// MidiClockFollower
+//==============================================================================
+
+/**
+ * Forgets the clock, before playback starts at a new sample rate
+ */
+void MidiClockFollower::prepare(double sampleRateToUse) noexcept
+{
+    sampleRate = sampleRateToUse;
+    blockStart = 0;
+    nextBlockStart = 0;
+    locked = false;
+    numPulsesSeen = 0;
+    running = false;
+    songPulse = 0;
+    stopPosition = -1;
+    jumped = false;
+}
+
+/**
+ * Reads the clock and transport messages of a block, in time order
+ * Everything else in the buffer is ignored
+ */
+void MidiClockFollower::processBlock(const juce::MidiBuffer& midiMessages, int numSamples) noexcept
+{
+    blockStart = nextBlockStart;
+    nextBlockStart += numSamples;
+    stopPosition = -1;
+    jumped = false;
+
+    for (const auto metadata: midiMessages)
+    {
+        if (metadata.numBytes < 1)
+            continue;
+
+        switch (metadata.data[0])
+        {
+            case 0xf8: // Clock
+                addPulse((double) (blockStart + metadata.samplePosition));
+                break;
+
+            case 0xfa: // Start: the next pulse is the first of the song
+                running = true;
+                songPulse = 0;
+                jumped = true;
+                break;
+
+            case 0xfb: // Continue, from the song position
+                running = true;
+                jumped = true;
+                break;
+
+            case 0xfc: // Stop
+                if (running)
+                    stopPosition = metadata.samplePosition;
+
+                running = false;
+                break;
+
+            case 0xf2: // Song position pointer, in sixteenths
+                if (metadata.numBytes >= 3)
+                {
+                    songPulse = (juce::int64) ((metadata.data[2] << 7) | metadata.data[1]) * MidiClock::pulsesPerSongPositionUnit;
+                    jumped = true;
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    // A stop followed by a start or a continue in the same block plays on
+    if (running)
+        stopPosition = -1;
+
+    // A clock that went quiet has to lock again when it comes back
+    if (locked && (double) nextBlockStart - lastPulseTime > timeoutInSeconds * sampleRate)
+    {
+        locked = false;
+        numPulsesSeen = 0;
+    }
+}
+
+/**
+ * Feeds a pulse to the loop
+ * For the first beat after a reset, the pulse length is the average since the reset,
+ * which gives the loop a starting point that's already mostly free of jitter. From
+ * then on, the loop predicts the next pulse from the filtered pulse length, and corrects
+ * both by the prediction's error, weighted by the coefficients of a critically damped
+ * second-order loop of the chosen bandwidth
+ */
+void MidiClockFollower::addPulse(double time) noexcept
+{
+    if (locked && numPulsesSeen >= MidiClock::pulsesPerQuarterNote)
+    {
+        const double error = time - nextPulseTime;
+
+        if (std::abs(error) <= 0.5 * pulseLength)
+        {
+            const double omega = juce::MathConstants<double>::twoPi * loopBandwidth * pulseLength / sampleRate;
+            nextPulseTime += juce::MathConstants<double>::sqrt2 * omega * error + pulseLength;
+            pulseLength += omega * omega * error;
+            lastPulseTime = time;
+
+            if (running)
+                ++songPulse;
+
+            return;
+        }
+
+        // Too far off to be jitter: a jump in tempo or lost pulses, so start over from
+        // the last two pulses
+        numPulsesSeen = 1;
+        firstPulseTime = lastPulseTime;
+    }
+
+    if (numPulsesSeen == 0)
+    {
+        firstPulseTime = time;
+    }
+    else
+    {
+        pulseLength = (time - firstPulseTime) / (double) numPulsesSeen;
+        nextPulseTime = time + pulseLength;
+        locked = pulseLength > 0.0;
+    }
+
+    ++numPulsesSeen;
+    lastPulseTime = time;
+
+    if (running)
+        ++songPulse;
+}
+
+/**
+ * Gets the smoothed tempo, once locked
+ */
+double MidiClockFollower::getBpm() const noexcept
+{
+    if (!locked)
+        return 0.0;
+
+    return juce::jlimit(1.0, 999.0, 60.0 * sampleRate / (pulseLength * MidiClock::pulsesPerQuarterNote));
+}
+
+/**
+ * Gets the step grid for the last block
+ * The song position at the block's start is worked back from the pulse the loop
+ * expects next, so the grid moves as smoothly as the loop's estimate does
+ */
+MidiClockFollower::Timebase MidiClockFollower::getTimebase(StepClock::Ticks stepLength) const noexcept
+{
+    Timebase timebase;
+
+    if (!locked || stepLength.numerator <= 0 || stepLength.denominator <= 0)
+        return timebase;
+
+    timebase.stepLength = StepClock::getSampleLength(sampleRate, getBpm(), stepLength);
+
+    const double pulsesPerStep = (double) stepLength.numerator / ((double) stepLength.denominator * MidiClock::ticksPerPulse);
+    const double blockStartPulse = (double) songPulse - (nextPulseTime - (double) blockStart) / pulseLength;
+
+    timebase.firstStep = (juce::int64) std::ceil(blockStartPulse / pulsesPerStep);
+    timebase.samplesUntilFirstStep = juce::jmax((juce::int64) 0,
+                                                (juce::int64) std::llround(((double) timebase.firstStep * pulsesPerStep - blockStartPulse) * pulseLength));
+
+    return timebase;
+}
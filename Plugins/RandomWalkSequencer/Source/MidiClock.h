@@ -0,0 +1,182 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "StepClock.h"
+
+/**
+ * MIDI beat clock: 24 pulses per quarter note, plus the start, stop and continue
+ * transport messages and the song position pointer
+ */
+namespace MidiClock
+{
+    constexpr int pulsesPerQuarterNote = 24;
+
+    /**
+     * Length of a pulse on the step clock's 960 PPQN grid
+     */
+    constexpr int ticksPerPulse = StepClock::ticksPerQuarterNote / pulsesPerQuarterNote;
+
+    /**
+     * Pulses in a song position pointer unit (a sixteenth note)
+     */
+    constexpr int pulsesPerSongPositionUnit = 6;
+} // namespace MidiClock
+
+//==============================================================================
+/**
+ * Sends MIDI clock that follows the sequencer's steps
+ *
+ * The pulses are placed within each step as it plays, in proportion to the step's
+ * length in samples, so a step that starts on a pulse always has its pulse on the same
+ * sample as its note, however the step clock rounds or restarts. Everything happens on
+ * the audio thread, sample-accurately within the block
+ */
+class MidiClockGenerator
+{
+public:
+    /**
+     * Returns whether a start message has been sent and no stop since
+     */
+    bool isRunning() const noexcept { return running; }
+
+    /**
+     * Forgets that the clock was running, without sending a stop
+     */
+    void reset() noexcept { running = false; }
+
+    /**
+     * Called when a sequencer step starts: sends a start before the first step, and
+     * any pulse of the previous step that it was cut short before
+     * @param stepLength Length of the step that starts, in ticks
+     * @param stepLengthInSamples Length of the step that starts, in samples
+     */
+    void addStep(juce::MidiBuffer& midiMessages, int samplePosition, StepClock::Ticks stepLength,
+                 juce::int64 stepLengthInSamples) noexcept;
+
+    /**
+     * Sends the pulses of the current step that fall inside a segment of the block
+     */
+    void addPulses(juce::MidiBuffer& midiMessages, int samplePosition, int numSamples) noexcept;
+
+    /**
+     * Sends a stop
+     */
+    void stop(juce::MidiBuffer& midiMessages, int samplePosition) noexcept;
+
+private:
+    bool running = false;
+    juce::int64 nextPulse = 0;          // Index of the next pulse since the start
+    double stepStartTick = 0.0;         // Position of the current step since the start, in ticks
+    double stepTicks = 0.0;             // Length of the current step in ticks
+    juce::int64 stepSamples = 0;        // Length of the current step in samples
+    juce::int64 samplesIntoStep = 0;
+};
+
+//==============================================================================
+/**
+ * Follows an incoming MIDI clock
+ *
+ * After a beat's worth of pulses to find the tempo, the pulses drive a second-order
+ * phase-locked loop (a delay-locked loop in the time domain), which predicts when the
+ * next pulse is due and how long a pulse is. The prediction only moves a fraction of
+ * each pulse's timing error, so a clock that jitters by a millisecond or two still
+ * gives a steady tempo and steady steps, while a real change of tempo is picked up
+ * within a second or so.
+ *
+ * The song position counts the pulses since a start, or since the position set by a
+ * song position pointer, and only moves while the clock is running. Only touched by
+ * the audio thread
+ */
+class MidiClockFollower
+{
+public:
+    /**
+     * Bandwidth of the loop in hertz: lower smooths more and follows tempo changes slower
+     */
+    static constexpr double loopBandwidth = 0.5;
+
+    /**
+     * Time without a pulse after which the clock counts as gone
+     */
+    static constexpr double timeoutInSeconds = 0.5;
+
+    /**
+     * The step grid for one block
+     */
+    struct Timebase
+    {
+        StepClock::SampleLength stepLength;     // Step length at the followed tempo
+        juce::int64 firstStep = 0;              // Index of the first step starting at or after the block's start, since the song start
+        juce::int64 samplesUntilFirstStep = 0;  // Position of that step in the block
+    };
+
+    /**
+     * Forgets the clock, before playback starts at a new sample rate
+     */
+    void prepare(double sampleRateToUse) noexcept;
+
+    /**
+     * Reads the clock and transport messages of a block, in time order
+     */
+    void processBlock(const juce::MidiBuffer& midiMessages, int numSamples) noexcept;
+
+    /**
+     * Returns whether the loop has a tempo, which takes two pulses
+     * The tempo settles over the first beat, then follows the loop
+     */
+    bool isLocked() const noexcept { return locked; }
+
+    /**
+     * Returns whether the clock is running: started or continued, and not stopped
+     */
+    bool isRunning() const noexcept { return running; }
+
+    /**
+     * Returns whether the clock was running at the start of the last block and stopped in it
+     */
+    bool hasStoppedInBlock() const noexcept { return stopPosition >= 0; }
+
+    /**
+     * Gets where playing ends in the last block: the position of the stop message if
+     * the clock stopped in it, numSamples otherwise
+     */
+    int getPlayEnd(int numSamples) const noexcept { return stopPosition >= 0 ? stopPosition : numSamples; }
+
+    /**
+     * Returns whether the song position jumped in the last block, by a start, a
+     * continue or a song position pointer
+     */
+    bool hasJumped() const noexcept { return jumped; }
+
+    /**
+     * Gets the smoothed tempo, once locked
+     */
+    double getBpm() const noexcept;
+
+    /**
+     * Gets the step grid for the last block, once locked
+     * @param stepLength Length of a step in ticks
+     */
+    Timebase getTimebase(StepClock::Ticks stepLength) const noexcept;
+
+private:
+    void addPulse(double time) noexcept;
+
+    double sampleRate = 44100.0;
+    juce::int64 blockStart = 0;         // Samples read before the last block
+    juce::int64 nextBlockStart = 0;
+
+    // Loop state, in samples since prepare
+    bool locked = false;
+    int numPulsesSeen = 0;              // Pulses since the loop was last reset, up to a beat's worth
+    double firstPulseTime = 0.0;        // When the first pulse since the reset arrived
+    double lastPulseTime = 0.0;         // When the last pulse arrived
+    double nextPulseTime = 0.0;         // When the loop expects the next pulse
+    double pulseLength = 0.0;           // The loop's estimate of the pulse length
+
+    // Transport
+    bool running = false;
+    juce::int64 songPulse = 0;          // Song position of the next pulse
+    int stopPosition = -1;              // Position of a stop in the last block, if it stopped in it
+    bool jumped = false;
+};
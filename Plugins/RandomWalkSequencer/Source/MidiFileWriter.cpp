@@ -0,0 +1,211 @@
+#include "MidiFileWriter.h"
+
+namespace
+{
+/**
+ * Appends bytes to the output buffer
+ * The buffer was sized by getMaxFileSize, so nothing is bounds-checked
+ */
+struct ByteWriter
+{
+    juce::uint8* data;
+    size_t size = 0;
+
+    void byte(int value) noexcept { data[size++] = (juce::uint8) value; }
+
+    void bigEndian32(juce::uint32 value) noexcept
+    {
+        byte((int) (value >> 24));
+        byte((int) (value >> 16) & 0xff);
+        byte((int) (value >> 8) & 0xff);
+        byte((int) value & 0xff);
+    }
+
+    void bigEndian16(int value) noexcept
+    {
+        byte((value >> 8) & 0xff);
+        byte(value & 0xff);
+    }
+
+    /**
+     * Writes a delta time as a variable-length quantity, most significant group first
+     */
+    void variableLength(juce::uint32 value) noexcept
+    {
+        if (value >= (1u << 21))
+            byte((int) ((value >> 21) & 0x7f) | 0x80);
+
+        if (value >= (1u << 14))
+            byte((int) ((value >> 14) & 0x7f) | 0x80);
+
+        if (value >= (1u << 7))
+            byte((int) ((value >> 7) & 0x7f) | 0x80);
+
+        byte((int) (value & 0x7f));
+    }
+};
+
+// Worst cases: a 4-byte delta and a status byte for every note on and note off
+constexpr size_t maxBytesPerNote = 2 * (4 + 3);
+
+// Track header, the end of track event and the tempo event
+constexpr size_t trackOverhead = 8 + 4 + 3;
+constexpr size_t tempoEventSize = 1 + 6;
+constexpr size_t headerSize = 14;
+
+int countPlayingSteps(const ExportLane& lane) noexcept
+{
+    int count = 0;
+
+    for (int i = 0; i < lane.loopLength; ++i)
+        count += lane.plays[i] ? 1 : 0;
+
+    return count;
+}
+} // namespace
+
+/**
+ * Gets how many loops fit within maxLengthInTicks
+ * The longest lane decides, since the lanes play side by side
+ */
+int MidiFileWriter::getMaxNumLoops(const ExportLane* lanes, int numLanes, const ExportSettings& settings) noexcept
+{
+    int longestLoop = 1;
+
+    for (int i = 0; i < numLanes; ++i)
+        longestLoop = juce::jmax(longestLoop, lanes[i].loopLength);
+
+    const auto loopTicks = (juce::int64) longestLoop * juce::jmax((juce::int64) 1, settings.stepLengthInTicks);
+    return (int) juce::jlimit((juce::int64) 1, (juce::int64) std::numeric_limits<int>::max(), maxLengthInTicks / loopTicks);
+}
+
+/**
+ * Gets an upper bound on the size of the file
+ */
+size_t MidiFileWriter::getMaxFileSize(const ExportLane* lanes, int numLanes, const ExportSettings& settings) noexcept
+{
+    const auto numLoops = (size_t) juce::jlimit(1, getMaxNumLoops(lanes, numLanes, settings), settings.numLoops);
+    size_t size = headerSize + tempoEventSize;
+
+    for (int i = 0; i < numLanes; ++i)
+        size += trackOverhead + (size_t) countPlayingSteps(lanes[i]) * numLoops * maxBytesPerNote;
+
+    return size;
+}
+
+/**
+ * Writes the file into a buffer
+ */
+size_t MidiFileWriter::write(const ExportLane* lanes, int numLanes, const ExportSettings& settings,
+                             juce::uint8* destination) noexcept
+{
+    jassert(numLanes > 0);
+
+    const int numLoops = juce::jlimit(1, getMaxNumLoops(lanes, numLanes, settings), settings.numLoops);
+
+    ByteWriter header { destination };
+    header.byte('M');
+    header.byte('T');
+    header.byte('h');
+    header.byte('d');
+    header.bigEndian32(6);
+    header.bigEndian16(numLanes > 1 ? 1 : 0);
+    header.bigEndian16(numLanes);
+    header.bigEndian16(ticksPerQuarterNote);
+
+    size_t size = header.size;
+
+    // The first track carries the tempo, as format 1 requires
+    for (int i = 0; i < numLanes; ++i)
+        size += writeTrack(lanes + i, settings, numLoops, i == 0, destination + size);
+
+    return size;
+}
+
+/**
+ * Writes the file into a memory block
+ */
+void MidiFileWriter::write(const ExportLane* lanes, int numLanes, const ExportSettings& settings,
+                           juce::MemoryBlock& destination)
+{
+    destination.setSize(getMaxFileSize(lanes, numLanes, settings), false);
+    destination.setSize(write(lanes, numLanes, settings, static_cast<juce::uint8*>(destination.getData())));
+}
+
+/**
+ * Writes one lane as a track, loop after loop
+ * A step's note ends before the next step starts, so the events come out in time order
+ * as they're generated and the track length is patched into the header at the end
+ */
+size_t MidiFileWriter::writeTrack(const ExportLane* lane, const ExportSettings& settings, int numLoops,
+                                  bool withTempo, juce::uint8* destination) noexcept
+{
+    ByteWriter out { destination };
+    out.byte('M');
+    out.byte('T');
+    out.byte('r');
+    out.byte('k');
+    out.bigEndian32(0);
+
+    if (withTempo)
+    {
+        const auto microsecondsPerQuarterNote = (juce::uint32) juce::roundToInt(60000000.0 / juce::jlimit(1.0, 1000.0, settings.bpm));
+        out.variableLength(0);
+        out.byte(0xff);
+        out.byte(0x51);
+        out.byte(0x03);
+        out.byte((int) (microsecondsPerQuarterNote >> 16) & 0xff);
+        out.byte((int) (microsecondsPerQuarterNote >> 8) & 0xff);
+        out.byte((int) microsecondsPerQuarterNote & 0xff);
+    }
+
+    const auto stepTicks = juce::jmax((juce::int64) 1, settings.stepLengthInTicks);
+    const auto noteTicks = juce::jlimit((juce::int64) 1, stepTicks,
+                                        (juce::int64) std::llround((double) stepTicks * (double) settings.gate));
+    const int noteOn = 0x90 | ((juce::jlimit(1, 16, lane->channel) - 1) & 0x0f);
+
+    juce::int64 lastEventTime = 0;
+    juce::int64 stepTime = 0;
+
+    // A meta event cancels running status, so the first note always has its status byte
+    int runningStatus = 0;
+
+    for (int loop = 0; loop < numLoops; ++loop)
+    {
+        for (int position = 0; position < lane->loopLength; ++position, stepTime += stepTicks)
+        {
+            if (!lane->plays[position])
+                continue;
+
+            const int note = juce::jlimit(0, 127, lane->notes[position]);
+
+            out.variableLength((juce::uint32) (stepTime - lastEventTime));
+
+            if (runningStatus != noteOn)
+                out.byte(noteOn);
+
+            out.byte(note);
+            out.byte(juce::jlimit(1, 127, (int) lane->velocities[position]));
+
+            // The note off is a note on with zero velocity, so it needs no status byte
+            out.variableLength((juce::uint32) noteTicks);
+            out.byte(note);
+            out.byte(0);
+
+            runningStatus = noteOn;
+            lastEventTime = stepTime + noteTicks;
+        }
+    }
+
+    // End of track, at the end of the last loop
+    out.variableLength((juce::uint32) (stepTime - lastEventTime));
+    out.byte(0xff);
+    out.byte(0x2f);
+    out.byte(0x00);
+
+    // Patch in the track length
+    ByteWriter length { destination + 4 };
+    length.bigEndian32((juce::uint32) (out.size - 8));
+
+    return out.size;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "StepClock.h"
+
+/**
+ * A lane to export: what every position of its loop plays, as rendered into a LoopImage
+ */
+struct ExportLane
+{
+    const int* notes = nullptr;                // MIDI note of every loop position
+    const juce::uint8* velocities = nullptr;   // Velocity of every loop position
+    const bool* plays = nullptr;               // Whether every loop position plays
+    int loopLength = 16;
+    int channel = 1;                           // 1 to 16
+};
+
+/**
+ * How the lanes are laid out in time
+ */
+struct ExportSettings
+{
+    juce::int64 stepLengthInTicks = StepClock::ticksPerQuarterNote / 4;
+    float gate = 0.5f;       // Note length as a proportion of the step
+    int numLoops = 1;
+    double bpm = 120.0;      // Written as the file's tempo
+};
+
+/**
+ * Streaming Standard MIDI File writer
+ *
+ * Serialises loop images straight into a byte buffer sized up front, one event at a
+ * time: there's no MidiMessageSequence, no per-event allocation and no sorting, since
+ * a step's note always ends before the next step starts. Note offs are written as
+ * zero-velocity note ons under running status, so most notes take 7 bytes.
+ * One lane is written as a format 0 file, several as format 1 with a track per lane
+ */
+class MidiFileWriter
+{
+public:
+    /**
+     * Resolution of the file, the same as the step clock's, so step lengths are exact
+     */
+    static constexpr int ticksPerQuarterNote = StepClock::ticksPerQuarterNote;
+
+    /**
+     * Longest file the writer produces, in ticks
+     * Keeps every delta time within the 4 bytes the size estimate allows for
+     */
+    static constexpr juce::int64 maxLengthInTicks = (1 << 28) - 1;
+
+    /**
+     * Gets how many loops fit within maxLengthInTicks, at least 1
+     */
+    static int getMaxNumLoops(const ExportLane* lanes, int numLanes, const ExportSettings& settings) noexcept;
+
+    /**
+     * Gets an upper bound on the size of the file, in bytes
+     */
+    static size_t getMaxFileSize(const ExportLane* lanes, int numLanes, const ExportSettings& settings) noexcept;
+
+    /**
+     * Writes the file into a buffer
+     * @param destination At least getMaxFileSize bytes
+     * @return The number of bytes written
+     */
+    static size_t write(const ExportLane* lanes, int numLanes, const ExportSettings& settings,
+                        juce::uint8* destination) noexcept;
+
+    /**
+     * Writes the file into a memory block, replacing its contents
+     */
+    static void write(const ExportLane* lanes, int numLanes, const ExportSettings& settings,
+                      juce::MemoryBlock& destination);
+
+private:
+    static size_t writeTrack(const ExportLane* lane, const ExportSettings& settings, int numLoops,
+                             bool withTempo, juce::uint8* destination) noexcept;
+};
@@ -0,0 +1,126 @@
+#include "MpeChannelAllocator.h"
+
+/**
+ * Constructor - starts with every member channel of the lower zone free
+ */
+MpeChannelAllocator::MpeChannelAllocator() noexcept
+{
+    reset();
+}
+
+/**
+ * Changes the zone size and frees every channel
+ */
+void MpeChannelAllocator::setNumMemberChannels(int numMemberChannels) noexcept
+{
+    numMembers = juce::jlimit(1, maxMemberChannels, numMemberChannels);
+    reset();
+}
+
+/**
+ * Takes the channel at the front of the free list, or steals the oldest busy channel
+ */
+int MpeChannelAllocator::allocate() noexcept
+{
+    auto index = popFront(freeChannels);
+
+    // Every channel is in use, so steal the one whose note started first
+    if (index == none)
+        index = popFront(busyChannels);
+
+    slots[(size_t) index].busy = true;
+    pushBack(busyChannels, index);
+
+    return index + firstMemberChannel;
+}
+
+/**
+ * Moves a busy channel to the back of the free list
+ */
+void MpeChannelAllocator::release(int channel) noexcept
+{
+    auto index = channel - firstMemberChannel;
+
+    // Ignore channels outside the zone, or ones that were already released
+    if (!juce::isPositiveAndBelow(index, numMembers) || !slots[(size_t) index].busy)
+        return;
+
+    unlink(busyChannels, index);
+    slots[(size_t) index].busy = false;
+    pushBack(freeChannels, index);
+}
+
+/**
+ * Frees every channel, so that allocation starts again from channel 2
+ */
+void MpeChannelAllocator::reset() noexcept
+{
+    freeChannels = {};
+    busyChannels = {};
+
+    for (int i = 0; i < numMembers; ++i)
+    {
+        slots[(size_t) i] = {};
+        pushBack(freeChannels, i);
+    }
+}
+
+/**
+ * Returns whether a channel is currently allocated
+ */
+bool MpeChannelAllocator::isBusy(int channel) const noexcept
+{
+    auto index = channel - firstMemberChannel;
+    return juce::isPositiveAndBelow(index, numMembers) && slots[(size_t) index].busy;
+}
+
+/**
+ * Appends a slot to the end of a list
+ */
+void MpeChannelAllocator::pushBack(List& list, int index) noexcept
+{
+    auto& slot = slots[(size_t) index];
+    slot.previous = list.tail;
+    slot.next = none;
+
+    if (list.tail != none)
+        slots[(size_t) list.tail].next = index;
+    else
+        list.head = index;
+
+    list.tail = index;
+}
+
+/**
+ * Removes and returns the first slot of a list, or none if it's empty
+ */
+int MpeChannelAllocator::popFront(List& list) noexcept
+{
+    auto index = list.head;
+
+    if (index != none)
+        unlink(list, index);
+
+    return index;
+}
+
+/**
+ * Removes a slot from anywhere in a list
+ */
+void MpeChannelAllocator::unlink(List& list, int index) noexcept
+{
+    auto& slot = slots[(size_t) index];
+
+    if (slot.previous != none)
+        slots[(size_t) slot.previous].next = slot.next;
+    else
+        list.head = slot.next;
+
+    if (slot.next != none)
+        slots[(size_t) slot.next].previous = slot.previous;
+    else
+        list.tail = slot.previous;
+
+    slot.previous = none;
+    slot.next = none;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+
+/**
+ * Hands out MPE member channels to notes, least recently used first
+ * Free and busy channels are kept in two intrusive lists, so allocating and releasing
+ * are O(1) with no searching, which makes this safe to use on the audio thread.
+ * A released channel goes to the back of the free list, giving its release tail as much
+ * time as possible before the channel is reused
+ */
+class MpeChannelAllocator
+{
+public:
+    /**
+     * Constructor - sets up a lower zone with all 15 member channels (2 to 16)
+     */
+    MpeChannelAllocator() noexcept;
+
+    /**
+     * Sets the member channels to allocate from: 2 to (1 + numMemberChannels)
+     * Frees every channel
+     * @param numMemberChannels Number of member channels in the lower zone (1 to 15)
+     */
+    void setNumMemberChannels(int numMemberChannels) noexcept;
+
+    /**
+     * Returns the number of member channels in the zone
+     */
+    int getNumMemberChannels() const noexcept { return numMembers; }
+
+    /**
+     * Takes the least recently used free channel
+     * If every channel is busy, the one that has been busy longest is stolen
+     * @return The MIDI channel (1-16) for the new note
+     */
+    int allocate() noexcept;
+
+    /**
+     * Returns a channel to the back of the free list
+     * @param channel The MIDI channel previously returned by allocate
+     */
+    void release(int channel) noexcept;
+
+    /**
+     * Frees every channel, in channel order
+     */
+    void reset() noexcept;
+
+    /**
+     * Returns whether a channel is currently allocated
+     */
+    bool isBusy(int channel) const noexcept;
+
+private:
+    static constexpr int firstMemberChannel = 2;
+    static constexpr int maxMemberChannels = 15;
+    static constexpr int none = -1;
+
+    // A doubly linked list threaded through the per-channel slots
+    struct List
+    {
+        int head = none;
+        int tail = none;
+    };
+
+    struct Slot
+    {
+        int previous = none;
+        int next = none;
+        bool busy = false;
+    };
+
+    void pushBack(List& list, int index) noexcept;
+    int popFront(List& list) noexcept;
+    void unlink(List& list, int index) noexcept;
+
+    std::array<Slot, maxMemberChannels> slots;
+    List freeChannels;
+    List busyChannels;
+    int numMembers = maxMemberChannels;
+
+    JUCE_DECLARE_NON_COPYABLE(MpeChannelAllocator)
+};
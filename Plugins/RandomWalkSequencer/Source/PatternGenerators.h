@@ -0,0 +1,260 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * Pattern generator policies for SequencerEngine
+ * Each policy fills a sequence of note offsets from the root (-12 to +12 semitones).
+ * The step count is a template parameter, so every loop has a compile-time trip count
+ */
+
+/**
+ * Random walk: musically interesting variations in pitch
+ */
+struct RandomWalkPattern
+{
+    template <int Steps>
+    static void generate(int (&sequence)[Steps], juce::Random& random)
+    {
+        // Parameters for enhanced random walk with much more variability
+        const int maxJump = 7;              // Increased maximum basic step size
+        const int maxRange = 12;            // Maximum range (one octave)
+        const float stayProb = 0.05f;       // Reduced probability to stay on same note
+        const float bigJumpProb = 0.25f;    // Increased probability for larger jumps
+        const float patternBreakProb = 0.1f; // Probability to break a pattern completely
+        const float resetProb = 0.05f;      // Probability to reset to center
+
+        // Start from a random point rather than always the middle
+        int currentValue = random.nextInt(maxRange * 2 + 1) - maxRange;
+        sequence[0] = currentValue;
+
+        int prevDirection = 0;
+        int consecutiveSteps = 0;
+
+        // Generate pattern with more deliberate changes in direction
+        for (int i = 1; i < Steps; ++i)
+        {
+            // Occasionally reset to create phrases
+            if (random.nextFloat() < resetProb) {
+                currentValue = random.nextInt(maxRange * 2 + 1) - maxRange; // Random reset point
+                consecutiveSteps = 0;
+                prevDirection = 0;
+            }
+            // Decide if we should break the pattern
+            else if (random.nextFloat() < patternBreakProb || consecutiveSteps > 3) {
+                // Force a direction change to break monotony
+                prevDirection = prevDirection == 0 ? (random.nextBool() ? 1 : -1) : -prevDirection;
+
+                // Make a significant jump to break the pattern
+                int jumpSize = 3 + random.nextInt(9); // Jumps of 3 to 12 semitones
+                currentValue += prevDirection * jumpSize;
+                consecutiveSteps = 0;
+            }
+            // Stay on same note occasionally
+            else if (random.nextFloat() < stayProb) {
+                // Do nothing - stay on same note
+                consecutiveSteps = 0;
+            }
+            else {
+                // Choose a direction that might be different from previous
+                int direction;
+
+                if (consecutiveSteps >= 2 && random.nextFloat() < 0.7f) {
+                    // After 2+ steps in same direction, higher chance of change
+                    direction = -prevDirection;
+                } else {
+                    // Random direction with slight bias toward previous
+                    direction = (random.nextFloat() < 0.4f) ?
+                        -prevDirection : (prevDirection != 0 ? prevDirection : (random.nextBool() ? 1 : -1));
+                }
+
+                // Determine step size with more variety
+                int stepSize;
+                if (random.nextFloat() < bigJumpProb) {
+                    // Larger jumps for more variety
+                    stepSize = 4 + random.nextInt(maxJump);
+                } else {
+                    // Use different step size distribution
+                    // Higher probability of 1,2,3 steps, lower for larger steps
+                    float r = random.nextFloat();
+                    if (r < 0.5f)
+                        stepSize = 1;
+                    else if (r < 0.8f)
+                        stepSize = 2;
+                    else
+                        stepSize = 3 + random.nextInt(maxJump - 2);
+                }
+
+                // Apply the step
+                currentValue += direction * stepSize;
+
+                // Update tracking variables
+                if (direction == prevDirection)
+                    consecutiveSteps++;
+                else {
+                    prevDirection = direction;
+                    consecutiveSteps = 1;
+                }
+            }
+
+            // Keep within range but with soft boundaries
+            if (currentValue > maxRange) {
+                if (random.nextFloat() < 0.7f) {
+                    // Usually reflect back
+                    currentValue = maxRange - (currentValue - maxRange);
+                    prevDirection = -prevDirection;
+                } else {
+                    // Sometimes just clamp
+                    currentValue = maxRange;
+                }
+            } else if (currentValue < -maxRange) {
+                if (random.nextFloat() < 0.7f) {
+                    // Usually reflect back
+                    currentValue = -maxRange + (-maxRange - currentValue);
+                    prevDirection = -prevDirection;
+                } else {
+                    // Sometimes just clamp
+                    currentValue = -maxRange;
+                }
+            }
+
+            // Store the value
+            sequence[i] = currentValue;
+        }
+
+        // Add a final pass to ensure melodic interest
+        enhanceMelodically(sequence, random);
+    }
+
+    /**
+     * Breaks up repetitive patterns and adds accents/octave jumps
+     */
+    template <int Steps>
+    static void enhanceMelodically(int (&sequence)[Steps], juce::Random& random)
+    {
+        // Find any boring sections (3+ consecutive steps in same direction)
+        for (int i = 2; i < Steps-1; i++) {
+            int diff1 = sequence[i] - sequence[i-1];
+            int diff2 = sequence[i-1] - sequence[i-2];
+
+            // If we have 3 steps moving in the same direction with same interval
+            if (diff1 == diff2 && diff1 != 0) {
+                // Break the pattern by adding a jump or change
+                if (random.nextBool()) {
+                    // Reverse direction
+                    sequence[i+1] = sequence[i] - diff1;
+                } else {
+                    // Make a jump
+                    sequence[i+1] = sequence[i] + (random.nextBool() ? 3 : -3);
+                }
+                i++; // Skip the fixed note
+            }
+        }
+
+        // Create a few accents by adding octave jumps
+        int numAccents = 1 + random.nextInt(2); // 1-2 accents
+        for (int i = 0; i < numAccents; i++) {
+            int pos = 2 + random.nextInt(Steps - 3); // Not too close to start/end
+            // Jump up or down an octave if within range
+            int newValue = sequence[pos] + (random.nextBool() ? 12 : -12);
+            if (newValue >= -12 && newValue <= 12) {
+                sequence[pos] = newValue;
+            }
+        }
+    }
+
+    /**
+     * Continues the walk at one random step: the step moves to a note up to range
+     * semitones from one of its neighbours, so the melody evolves from where it is
+     * rather than being regenerated. Safe on the audio thread
+     * @return The index of the step that moved
+     */
+    template <int Steps>
+    static int mutateStep(int (&sequence)[Steps], int range, juce::Random& random) noexcept
+    {
+        const int index = random.nextInt(Steps);
+        const int neighbour = (index + (random.nextBool() ? 1 : Steps - 1)) % Steps;
+        const int move = (1 + random.nextInt(juce::jmax(1, range))) * (random.nextBool() ? 1 : -1);
+
+        sequence[index] = juce::jlimit(-12, 12, sequence[neighbour] + move);
+        return index;
+    }
+};
+
+/**
+ * Ascending: a mostly upward moving melody with occasional downward steps
+ */
+struct AscendingPattern
+{
+    template <int Steps>
+    static void generate(int (&sequence)[Steps], juce::Random& random)
+    {
+        // Start from a low value
+        int currentValue = -6;
+
+        for (int i = 0; i < Steps; ++i)
+        {
+            // Add some randomness but mostly ascending
+            if (random.nextFloat() < 0.2f)
+                currentValue--; // Occasionally go down for interest
+            else
+                currentValue++;
+
+            // Keep within reasonable range
+            currentValue = juce::jlimit(-12, 12, currentValue);
+            sequence[i] = currentValue;
+        }
+    }
+};
+
+/**
+ * Descending: a mostly downward moving melody with occasional upward steps
+ */
+struct DescendingPattern
+{
+    template <int Steps>
+    static void generate(int (&sequence)[Steps], juce::Random& random)
+    {
+        // Start from a high value
+        int currentValue = 6;
+
+        for (int i = 0; i < Steps; ++i)
+        {
+            // Add some randomness but mostly descending
+            if (random.nextFloat() < 0.2f)
+                currentValue++; // Occasionally go up for interest
+            else
+                currentValue--;
+
+            // Keep within reasonable range
+            currentValue = juce::jlimit(-12, 12, currentValue);
+            sequence[i] = currentValue;
+        }
+    }
+};
+
+/**
+ * Arpeggio: chord tones of a major chord, occasionally an octave down
+ */
+struct ArpeggioPattern
+{
+    template <int Steps>
+    static void generate(int (&sequence)[Steps], juce::Random& random)
+    {
+        // Major chord: root, major third, perfect fifth, octave
+        constexpr int intervals[] = { 0, 4, 7, 12 };
+        constexpr int numIntervals = 4;
+
+        for (int i = 0; i < Steps; ++i)
+        {
+            // Choose a random interval from our chord
+            int value = intervals[random.nextInt(numIntervals)];
+
+            // Occasionally invert down an octave for bass notes
+            if (random.nextFloat() < 0.3f && value > 0)
+                value -= 12;
+
+            sequence[i] = value;
+        }
+    }
+};
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+
+/**
+ * What a morphed step plays
+ */
+struct MorphedStep
+{
+    bool enabled = true;
+    int note = 0;              // Note offset from the root
+    juce::uint8 velocity = 0;
+    float gate = 0.5f;         // Proportion of the step the note lasts
+};
+
+/**
+ * Two stored sequences, A and B, and the morph between them
+ *
+ * The slots are written by the message thread and read by the audio thread, one step
+ * at a time: every value is its own relaxed atomic, and getStep only works out the step
+ * that's about to play, so a morph costs the same few operations per step however long
+ * the sequence is and however fast it's automated
+ */
+template <int Steps>
+class PatternMorph
+{
+public:
+    /**
+     * The stored sequences
+     */
+    enum Slot
+    {
+        slotA,
+        slotB,
+        numSlots
+    };
+
+    /**
+     * How the steps get from A to B
+     */
+    enum Mode
+    {
+        interpolateMode, // Pitch, velocity and gate of every step glide from A to B
+        crossfadeMode    // Steps switch from A to B one by one, spread over the loop
+    };
+
+    PatternMorph() noexcept = default;
+
+    /**
+     * Stores a step of a slot
+     */
+    void setStep(Slot slot, int step, const MorphedStep& value) noexcept
+    {
+        if (!juce::isPositiveAndBelow(slot, numSlots) || !juce::isPositiveAndBelow(step, Steps))
+            return;
+
+        auto& stored = slots[slot][step];
+        stored.note.store(value.note, std::memory_order_relaxed);
+        stored.velocity.store(value.velocity, std::memory_order_relaxed);
+        stored.gate.store(value.gate, std::memory_order_relaxed);
+        stored.enabled.store(value.enabled, std::memory_order_relaxed);
+    }
+
+    /**
+     * Gets a step of a slot as stored
+     */
+    MorphedStep getStoredStep(Slot slot, int step) const noexcept
+    {
+        MorphedStep value;
+
+        if (juce::isPositiveAndBelow(slot, numSlots) && juce::isPositiveAndBelow(step, Steps))
+        {
+            const auto& stored = slots[slot][step];
+            value.note = stored.note.load(std::memory_order_relaxed);
+            value.velocity = (juce::uint8) stored.velocity.load(std::memory_order_relaxed);
+            value.gate = stored.gate.load(std::memory_order_relaxed);
+            value.enabled = stored.enabled.load(std::memory_order_relaxed);
+        }
+
+        return value;
+    }
+
+    /**
+     * Works out what a step plays at a morph position
+     * @param step The step of the sequence
+     * @param position 0 plays A, 1 plays B
+     */
+    MorphedStep getStep(int step, float position, Mode mode) const noexcept
+    {
+        const auto a = getStoredStep(slotA, step);
+        const auto b = getStoredStep(slotB, step);
+
+        if (mode == crossfadeMode)
+            return position > getCrossfadeThreshold(step) ? b : a;
+
+        // Notes move in whole semitones, and a step is either on or off, so the enabled
+        // flag comes from the nearer slot
+        MorphedStep morphed;
+        morphed.note = juce::roundToInt((float) a.note + position * (float) (b.note - a.note));
+        morphed.velocity = (juce::uint8) juce::roundToInt((float) a.velocity + position * (float) (b.velocity - a.velocity));
+        morphed.gate = a.gate + position * (b.gate - a.gate);
+        morphed.enabled = position < 0.5f ? a.enabled : b.enabled;
+
+        return morphed;
+    }
+
+    /**
+     * Gets the morph position past which a step plays B in crossfade mode
+     * The thresholds follow the bit-reversed step order, so the steps that have switched
+     * are spread evenly over the loop rather than bunched at its start
+     */
+    static constexpr float getCrossfadeThreshold(int step) noexcept
+    {
+        int reversed = 0;
+
+        for (int bit = 1, mirror = Steps / 2; bit < Steps; bit <<= 1, mirror >>= 1)
+            if ((step & bit) != 0)
+                reversed |= mirror;
+
+        return ((float) reversed + 0.5f) / (float) Steps;
+    }
+
+private:
+    static_assert((Steps & (Steps - 1)) == 0, "Crossfade thresholds need a power of two step count");
+
+    struct StoredStep
+    {
+        std::atomic<int> note {0};
+        std::atomic<int> velocity {80};
+        std::atomic<float> gate {0.5f};
+        std::atomic<bool> enabled {true};
+    };
+
+    StoredStep slots[numSlots][Steps];
+
+    JUCE_DECLARE_NON_COPYABLE(PatternMorph)
+};
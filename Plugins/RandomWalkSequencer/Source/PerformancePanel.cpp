@@ -0,0 +1,156 @@
+#include "PerformancePanel.h"
+
+/**
+ * Constructor - sets up the panel controls
+ * @param profilerToUse The profiler to display and control
+ */
+PerformancePanel::PerformancePanel(PluginHelpers::BlockProfiler& profilerToUse)
+    : profiler(profilerToUse)
+{
+    // Measurement toggle - profiling costs nothing while this is off
+    enableButton.setButtonText("Measure processBlock");
+    enableButton.setToggleState(profiler.isEnabled(), juce::dontSendNotification);
+    enableButton.onClick = [this] { profiler.setEnabled(enableButton.getToggleState()); };
+    addAndMakeVisible(enableButton);
+
+    // Reset button - cleared by the audio thread on its next measured block
+    resetButton.setButtonText("Reset");
+    resetButton.onClick = [this] { profiler.requestReset(); };
+    addAndMakeVisible(resetButton);
+
+    // Dump button - writes a text report of the stats
+    dumpButton.setButtonText("Dump...");
+    dumpButton.onClick = [this] { dumpToFile(); };
+    addAndMakeVisible(dumpButton);
+}
+
+/**
+ * Positions the panel controls
+ */
+void PerformancePanel::resized()
+{
+    auto area = getLocalBounds().reduced(5);
+
+    auto buttonRow = area.removeFromTop(24);
+    enableButton.setBounds(buttonRow.removeFromLeft(180));
+    dumpButton.setBounds(buttonRow.removeFromRight(80));
+    buttonRow.removeFromRight(5);
+    resetButton.setBounds(buttonRow.removeFromRight(80));
+
+    area.removeFromTop(5);
+
+    statsArea = area.removeFromLeft(area.getWidth() / 2);
+    histogramArea = area.reduced(5, 0);
+}
+
+/**
+ * Takes a fresh copy of the profiler's stats and repaints
+ */
+void PerformancePanel::refresh()
+{
+    stats = profiler.getStats();
+    repaint();
+}
+
+/**
+ * Draws the statistics text and the load histogram
+ */
+void PerformancePanel::paint(juce::Graphics& g)
+{
+    g.fillAll(juce::Colours::darkgrey.darker(0.3f));
+
+    g.setColour(juce::Colours::grey);
+    g.drawRect(getLocalBounds(), 1);
+
+    // Statistics text
+    const juce::String lines[] {
+        "Blocks: " + juce::String((juce::int64) stats.blocksProcessed)
+            + "   Events: " + juce::String((juce::int64) stats.eventsEmitted),
+        "Block size: " + juce::String(stats.lastBlockSize) + " samples",
+        "Mean / worst: " + juce::String(stats.meanBlockMicros, 1) + " / "
+            + juce::String(stats.worstBlockMicros, 1) + " us",
+        "Load last / worst: " + juce::String(stats.lastLoadPercent, 2) + " / "
+            + juce::String(stats.worstLoadPercent, 2) + " %",
+        "Overruns: " + juce::String((juce::int64) stats.overruns)
+            + "   Violations: " + juce::String((juce::int64) stats.violations)
+    };
+
+    g.setColour(juce::Colours::white);
+    g.setFont(12.0f);
+
+    auto textArea = statsArea;
+    for (auto& line : lines)
+        g.drawText(line, textArea.removeFromTop(18), juce::Justification::centredLeft, true);
+
+    if (!profiler.isEnabled())
+    {
+        g.setColour(juce::Colours::lightgrey);
+        g.drawText("(measurement disabled)", textArea.removeFromTop(18), juce::Justification::centredLeft, true);
+    }
+
+    // Load histogram, bar heights relative to the fullest bucket; the last two buckets overran
+    if (histogramArea.isEmpty())
+        return;
+
+    juce::uint64 maxCount = 1;
+    for (auto count : stats.histogram)
+        maxCount = juce::jmax(maxCount, count);
+
+    const auto labelHeight = 14;
+    auto barsArea = histogramArea.withTrimmedBottom(labelHeight).toFloat();
+    const auto barWidth = barsArea.getWidth() / (float) PluginHelpers::BlockProfiler::numBuckets;
+
+    g.setFont(9.0f);
+
+    for (int i = 0; i < PluginHelpers::BlockProfiler::numBuckets; ++i)
+    {
+        auto proportion = (float) ((double) stats.histogram[(size_t) i] / (double) maxCount);
+        auto barHeight = barsArea.getHeight() * proportion;
+
+        juce::Rectangle<float> bar(barsArea.getX() + (float) i * barWidth,
+                                   barsArea.getBottom() - barHeight,
+                                   barWidth - 2.0f,
+                                   barHeight);
+
+        g.setColour(i < PluginHelpers::BlockProfiler::numBuckets - 2 ? juce::Colours::lightgreen : juce::Colours::orange);
+        g.fillRect(bar);
+
+        // Label every other bucket to keep the text readable
+        if (i % 2 == 0)
+        {
+            g.setColour(juce::Colours::white);
+            g.drawText(PluginHelpers::BlockProfiler::getBucketLabel(i),
+                       juce::Rectangle<float>(bar.getX(), barsArea.getBottom(), barWidth * 2.0f, (float) labelHeight),
+                       juce::Justification::centredLeft,
+                       true);
+        }
+    }
+}
+
+/**
+ * Opens a save dialog and writes the current stats to the chosen file
+ */
+void PerformancePanel::dumpToFile()
+{
+    auto defaultFile = juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
+                           .getChildFile("RandomWalkSequencer-performance.txt");
+
+    fileChooser = std::make_unique<juce::FileChooser>("Save performance stats", defaultFile, "*.txt");
+
+    auto flags = juce::FileBrowserComponent::saveMode
+                 | juce::FileBrowserComponent::canSelectFiles
+                 | juce::FileBrowserComponent::warnAboutOverwriting;
+
+    fileChooser->launchAsync(flags, [this](const juce::FileChooser& chooser)
+    {
+        auto file = chooser.getResult();
+
+        if (file != juce::File() && !profiler.dumpToFile(file))
+        {
+            juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon,
+                "Dump Failed",
+                "Could not write to " + file.getFullPathName(),
+                "OK");
+        }
+    });
+}
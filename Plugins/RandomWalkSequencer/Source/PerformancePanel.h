@@ -0,0 +1,79 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * Collapsible editor panel showing the sequencer's per-block profiler
+ * Displays timing statistics, overruns and a histogram of the load on each block's deadline
+ */
+class PerformancePanel : public juce::Component
+{
+public:
+    /**
+     * Preferred height of the panel when expanded
+     */
+    static constexpr int preferredHeight = 150;
+
+    /**
+     * Constructor - sets up the panel controls
+     * @param profilerToUse The profiler to display and control
+     */
+    explicit PerformancePanel(PluginHelpers::BlockProfiler& profilerToUse);
+
+    /**
+     * Draws the statistics text and the load histogram
+     */
+    void paint(juce::Graphics& g) override;
+
+    /**
+     * Positions the panel controls
+     */
+    void resized() override;
+
+    /**
+     * Takes a fresh copy of the profiler's stats and repaints
+     * Called periodically by the editor while the panel is visible
+     */
+    void refresh();
+
+private:
+    PluginHelpers::BlockProfiler& profiler;
+    PluginHelpers::BlockProfiler::Stats stats;
+
+    /**
+     * Toggle for enabling measurement
+     */
+    juce::ToggleButton enableButton;
+
+    /**
+     * Button for clearing the stats
+     */
+    juce::TextButton resetButton;
+
+    /**
+     * Button for writing the stats to a file
+     */
+    juce::TextButton dumpButton;
+
+    /**
+     * Save dialog used by the dump button
+     */
+    std::unique_ptr<juce::FileChooser> fileChooser;
+
+    /**
+     * Opens a save dialog and writes the current stats to the chosen file
+     */
+    void dumpToFile();
+
+    /**
+     * Area used for the statistics text
+     */
+    juce::Rectangle<int> statsArea;
+
+    /**
+     * Area used for the histogram
+     */
+    juce::Rectangle<int> histogramArea;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PerformancePanel)
+};
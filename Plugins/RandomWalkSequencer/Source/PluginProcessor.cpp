@@ -1,5 +1,5 @@
 #include "PluginProcessor.h"
-#include "RandomWalkSequencer.h"
+#include "RandomWalkSequencerEditor.h"
 
 //==============================================================================
 /**
@@ -117,14 +117,9 @@ void AudioPluginAudioProcessor::releaseResources()
 
 /**
  * Validates if the specified bus layout is supported by this plugin
- * Must match the RandomWalkSequencer's implementation for consistency
  */
 bool AudioPluginAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
 {
-    // This function must match the RandomWalkSequencer's implementation
-    bool isInputDisabled = layouts.getMainInputChannelSet().isDisabled();
-    bool isOutputDisabled = layouts.getMainOutputChannelSet().isDisabled();
-
     // Accept if both input and output are stereo (most common case)
     if (layouts.getMainInputChannelSet() == juce::AudioChannelSet::stereo() &&
         layouts.getMainOutputChannelSet() == juce::AudioChannelSet::stereo())
@@ -150,12 +145,15 @@ bool AudioPluginAudioProcessor::isBusesLayoutSupported(const BusesLayout& layout
 
 /**
  * Processes an audio/MIDI block
- * Delegates all processing to the RandomWalkSequencer
+ * Reads the host's playhead and passes it to the RandomWalkSequencer with the MIDI buffer
  */
 void AudioPluginAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
-    // Delegate to the RandomWalkSequencer
-    sequencer.processBlock(buffer, midiMessages);
+    // Clear audio buffer since this is a MIDI effect only
+    buffer.clear();
+
+    // Delegate to the RandomWalkSequencer with this block's host timing
+    sequencer.processBlock(midiMessages, buffer.getNumSamples(), TimingContext::fromPlayHead(getPlayHead()));
 }
 
 //==============================================================================
@@ -169,12 +167,11 @@ bool AudioPluginAudioProcessor::hasEditor() const
 
 /**
  * Creates the plugin's custom editor UI
- * Directly uses the sequencer's editor
  */
 juce::AudioProcessorEditor* AudioPluginAudioProcessor::createEditor()
 {
-    // Create the sequencer's editor directly
-    return sequencer.createEditor();
+    // Create the editor without triggering any sequence regeneration
+    return new RandomWalkSequencerEditor(*this);
 }
 
 //==============================================================================
@@ -184,8 +181,9 @@ juce::AudioProcessorEditor* AudioPluginAudioProcessor::createEditor()
  */
 void AudioPluginAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
 {
-    // Delegate to the RandomWalkSequencer
-    sequencer.getStateInformation(destData);
+    // Delegate to the RandomWalkSequencer and write its XML to binary
+    if (auto xml = sequencer.createStateXml())
+        copyXmlToBinary(*xml, destData);
 }
 
 /**
@@ -194,8 +192,14 @@ void AudioPluginAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
  */
 void AudioPluginAudioProcessor::setStateInformation(const void* data, int sizeInBytes)
 {
-    // Delegate to the RandomWalkSequencer
-    sequencer.setStateInformation(data, sizeInBytes);
+    // Parse XML from binary and delegate to the RandomWalkSequencer
+    if (auto xmlState = getXmlFromBinary(data, sizeInBytes))
+    {
+        sequencer.restoreStateFromXml(*xmlState);
+
+        // Let the host see the restored values
+        parameters.updateFromSequencer();
+    }
 }
 
 //==============================================================================
@@ -2,11 +2,12 @@
 
 #include <juce_audio_processors/juce_audio_processors.h>
 #include "RandomWalkSequencer.h" // Include the sequencer
+#include "SequencerParameters.h"
 
 //==============================================================================
 /**
  * Main audio processor class for the RandomWalkSequencer plugin
- * Acts as a wrapper that delegates all functionality to the RandomWalkSequencer class
+ * Owns the RandomWalkSequencer and feeds it the host's timing for every block
  */
 class AudioPluginAudioProcessor final : public juce::AudioProcessor
 {
@@ -118,10 +119,24 @@ public:
      */
     void setStateInformation (const void* data, int sizeInBytes) override;
 
+    //==============================================================================
+    /**
+     * Gets the sequencer that generates the MIDI, used by the editor
+     */
+    RandomWalkSequencer& getSequencer() { return sequencer; }
+
+    /**
+     * Gets the host-automatable parameters, used by the editor's attachments
+     */
+    SequencerParameters& getSequencerParameters() { return parameters; }
+
 private:
     // The RandomWalkSequencer that handles the actual MIDI generation
     RandomWalkSequencer sequencer;
 
+    // Host-automatable parameters that forward their changes to the sequencer
+    SequencerParameters parameters { *this, sequencer };
+
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioPluginAudioProcessor)
 };
\ No newline at end of file
@@ -1,44 +1,33 @@
 #include <memory>
-#include <iostream>
-#define DEBUG_LOG(x) std::cout << "[DEBUG] " << x << std::endl;
+#define DEBUG_LOG(x) DBG("[DEBUG] " << x)
 
 #include "RandomWalkSequencer.h"
-#include "RandomWalkSequencerEditor.h"
+#include "SearchedWalkGenerator.h"
 
 /**
  * Constructor - initializes the sequencer with default parameters
- * Sets up stereo MIDI buses and initializes the sequence pattern
+ * Only does what's trivially cheap: hosts construct plugins many times while scanning.
+ * The buffers are sized in prepareToPlay, and the first pattern is generated when
+ * something first needs it, unless a saved state brings one
  */
 RandomWalkSequencer::RandomWalkSequencer()
-    : AudioProcessor(BusesProperties()
-                     .withInput("MIDI In", juce::AudioChannelSet::stereo())
-                     .withOutput("MIDI Out", juce::AudioChannelSet::stereo()))
 {
-    // Set up parameter values manually
-    rateValue = 3;       // Default to quarter notes (1/4)
-    densityValue = 8;    // Default to 8 steps
-    offsetValue = 0;     // Default to no offset
-    gateValue = 0.5f;    // Default gate time 50%
-    rootValue = 72;      // Default to C5
+    // Parameter defaults are set where they're declared: quarter notes (1/4), 8 steps,
+    // no offset, 50% gate and C5 at 120 BPM
 
     // Initialize timing variables
     sampleRate = 44100.0;
     bpm = 120.0;
-    internalBpm = 120.0; // Initialize internal BPM
 
-    // Initialize all steps to enabled
+    // Initialize all steps to enabled, with centred timbre
     for (int i = 0; i < numSteps; ++i)
     {
         enabledSteps[i] = true;
+        stepExpression[timbreLane][i] = 0.5f;
     }
 
     // Calculate timing values
-    updateTimingInfo();
-
-    // Generate initial sequence
-    generateRandomWalk();
-
-    DEBUG_LOG("Processor created with random walk pattern");
+    updateStepDuration();
 }
 
 /**
@@ -46,7 +35,8 @@ RandomWalkSequencer::RandomWalkSequencer()
  */
 RandomWalkSequencer::~RandomWalkSequencer()
 {
-
+    // Don't keep a link group's leadership after we're gone
+    leaveLinkGroup();
 }
 
 /**
@@ -71,7 +61,9 @@ void RandomWalkSequencer::toggleStepEnabled(int step)
 {
     if (step >= 0 && step < numSteps)
     {
+        generatePatternIfPending();
         enabledSteps[step] = !enabledSteps[step];
+        markPatternChanged();
     }
 }
 
@@ -81,7 +73,7 @@ void RandomWalkSequencer::toggleStepEnabled(int step)
  */
 void RandomWalkSequencer::setManualStepMode(bool isManual)
 {
-    manualStepMode = isManual;
+    manualStepMode.store(isManual, std::memory_order_relaxed);
 
     // If we're disabling manual mode, reset all steps to enabled
     if (!isManual)
@@ -96,11 +88,15 @@ void RandomWalkSequencer::setManualStepMode(bool isManual)
  */
 void RandomWalkSequencer::resetEnabledSteps()
 {
+    generatePatternIfPending();
+
     // Reset all steps to enabled
     for (int i = 0; i < numSteps; ++i)
     {
         enabledSteps[i] = true;
     }
+
+    markPatternChanged();
 }
 
 /**
@@ -111,13 +107,30 @@ void RandomWalkSequencer::prepareToPlay(double sampleRateToUse, int /*samplesPer
 {
     this->sampleRate = sampleRateToUse;
 
+    // Deferred from the constructor, so scanning a plugin never pays for them
+    generatePatternIfPending();
+
+    if (mpeZoneMessages.isEmpty())
+        mpeZoneMessages = juce::MPEMessages::setLowerZone(15, mpePitchbendRange);
+
+    // Room for a block's events and for those a delay holds back, so post-processing never allocates
+    generatedMidi.ensureSize((size_t) maxEventsPerBlock * 16);
+
     // Reset playback state
-    currentStep = 0;
-    sampleCounter = 0.0;
+    currentStep.store(0, std::memory_order_relaxed);
+    stepClock.restart();
     noteIsOn = false;
+    mpeChannels.reset();
+    mpeZoneSent = false;
+    midiClockFollower.prepare(sampleRateToUse);
+    midiClockGenerator.reset();
+
+    // The output delay is in samples, so the post-processing is rebuilt for the new rate
+    postProcessing.prepare(maxEventsPerBlock);
+    compiledPostProcessingVersion = 0;
 
     // Initialize timing information
-    updateTimingInfo();
+    updateStepDuration();
 
     DEBUG_LOG("prepareToPlay called, sampleRate = " << sampleRateToUse);
 }
@@ -128,228 +141,971 @@ void RandomWalkSequencer::prepareToPlay(double sampleRateToUse, int /*samplesPer
  */
 void RandomWalkSequencer::releaseResources()
 {
-    // Turn off sequencer when the plugin is deactivated
-    isPlaying = false;
-
-    // Make sure no notes are left on
-    if (noteIsOn)
-    {
-        juce::MidiMessage noteOff = juce::MidiMessage::noteOff(1, lastNoteValue, (juce::uint8) 0);
-        juce::MidiBuffer tempBuffer;
-        tempBuffer.addEvent(noteOff, 0);
-        noteIsOn = false;
-    }
-}
+    // Turn off sequencer when the plugin is deactivated, along with any request to start
+    playRequest.store(noPlayRequest, std::memory_order_relaxed);
+    isPlaying.store(false, std::memory_order_relaxed);
 
-/**
- * Indicates if double precision processing is supported
- * This sequencer only uses single precision
- */
-bool RandomWalkSequencer::supportsDoublePrecisionProcessing() const
-{
-    return false;
-}
+    // No more blocks will arrive to send a note off in, so just forget the note
+    noteIsOn = false;
+    mpeChannels.reset();
+    midiClockGenerator.reset();
 
-/**
- * Gets the current processing precision
- * Always returns single precision for this sequencer
- */
-juce::AudioProcessor::ProcessingPrecision RandomWalkSequencer::getProcessingPrecision() const
-{
-    return juce::AudioProcessor::singlePrecision;
-}
-
-/**
- * Processes a block when the processor is bypassed
- * Simply clears the audio buffer since this is a MIDI effect
- */
-void RandomWalkSequencer::processBlockBypassed(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& /*midiMessages*/)
-{
-    buffer.clear();
+    // Let another instance lead our link group while we're inactive
+    leaveLinkGroup();
 }
 
 /**
  * Main processing method - generates MIDI notes based on the current sequence
  * Handles timing, note generation, and step advancement
  */
-void RandomWalkSequencer::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+void RandomWalkSequencer::processBlock(juce::MidiBuffer& midiMessages, int numSamples, const TimingContext& timing)
 {
-    // Update timing info at the start of each block to keep in sync with host transport
-    updateTimingInfo();
+    // Mark this as the audio thread so debug/test builds can catch allocations and locks
+    PluginHelpers::ScopedAudioThread audioThreadScope;
+
+    // Time this block if profiling is enabled
+    PluginHelpers::BlockProfiler::ScopedBlock profiledBlock(profiler, numSamples, sampleRate);
+    const int numIncomingEvents = profiledBlock.isActive() ? midiMessages.getNumEvents() : 0;
+
+    // An incoming MIDI clock is read before the timing is worked out, since it sets it
+    followingMidiClock = midiClockInput.load(std::memory_order_relaxed);
+
+    if (followingMidiClock)
+        midiClockFollower.processBlock(midiMessages, numSamples);
 
-    // Debug log to check if we're getting called with MIDI data
-    if (!midiMessages.isEmpty())
+    midiClockBpm.store(followingMidiClock ? midiClockFollower.getBpm() : 0.0, std::memory_order_relaxed);
+
+    // Start or stop as the UI asked, then update timing info at the start of each block
+    // to keep in sync with host transport
+    applyPlayRequest();
+    updateTimingInfo(timing);
+
+    // A jump of the host position is a seek, after which the lookahead is stale
+    if (timing.timeInSamples.hasValue())
     {
-        DEBUG_LOG("Received MIDI data: " << midiMessages.getNumEvents() << " events");
+        if (*timing.timeInSamples != nextHostPosition)
+            lookaheadNeedsPriming = true;
+
+        nextHostPosition = *timing.timeInSamples + numSamples;
     }
 
-    // Debug log to check transport sync
-    if (isPlaying && samplesPerBeat > 0)
+    // Pick up the message thread's edits of the pattern
+    updateAudioPattern();
+
+    // Incoming MIDI is passed through untouched: our own events go into a preallocated
+    // buffer of their own, so that post-processing only touches them, and are merged into
+    // the host's buffer in time order at the end of the block
+    generatedMidi.clear();
+
+    // Announce the MPE zone once, before the first MPE note
+    if (mpeMode.load(std::memory_order_relaxed))
     {
-        static int callCount = 0;
-        if (++callCount % 100 == 0)  // Don't log every buffer to avoid flooding
-            DEBUG_LOG("Plugin is playing, BPM: " << bpm << ", step: " << currentStep);
+        if (!mpeZoneSent)
+        {
+            for (const auto metadata: mpeZoneMessages)
+                generatedMidi.addEvent(metadata.data, metadata.numBytes, 0);
+
+            mpeZoneSent = true;
+        }
+    }
+    else
+    {
+        mpeZoneSent = false;
     }
 
-    // Clear audio buffer since this is a MIDI effect only
-    buffer.clear();
+    // Linked instances take their step grid for this block from the group
+    auto* linkGroup = updateLinkGroup(timing);
+    const bool isLeading = linkLeading.load(std::memory_order_relaxed);
+    const int role = linkRole.load(std::memory_order_relaxed);
 
-    // Get buffer size
-    auto numSamples = buffer.getNumSamples();
+    // Whether we're playing, as the transport left it for this block
+    bool playing = isPlaying.load(std::memory_order_relaxed);
 
-    // Create a MIDI buffer for our output
-    juce::MidiBuffer processedMidi;
+    if (linkGroup != nullptr && playing)
+    {
+        auto timebase = linkGroup->getTimebase(*timing.timeInSamples, stepClock.getStepLength());
 
-    // Pass through any incoming MIDI messages to our processed MIDI buffer
-    for (const auto& metadata : midiMessages)
+        // Line the clock up so the loop below fires the next step at the grid's position
+        stepClock.setStepLength(timebase.stepLength);
+        stepClock.alignToStep(timebase.firstStep, timebase.samplesUntilFirstStep);
+        nextLinkedStep = timebase.firstStep;
+    }
+    else if (followingMidiClock && playing)
     {
-        processedMidi.addEvent(metadata.getMessage(), metadata.samplePosition);
+        auto timebase = midiClockFollower.getTimebase(Engine::getStepLengthInTicks(getRate()));
+
+        // The estimate of the clock's phase moves a little with every pulse, which can put
+        // the step that just played back inside the block, or the next one before it.
+        // Neither is played twice or skipped: the next step plays, as close to where the
+        // grid has it as it can. A jump of the song position goes wherever it says
+        if (std::abs(timebase.firstStep - nextLinkedStep) == 1 && !midiClockFollower.hasJumped())
+        {
+            timebase.samplesUntilFirstStep = juce::jmax((juce::int64) 0, timebase.samplesUntilFirstStep
+                                                        + timebase.stepLength.getStepStart(nextLinkedStep)
+                                                        - timebase.stepLength.getStepStart(timebase.firstStep));
+            timebase.firstStep = nextLinkedStep;
+        }
+
+        stepClock.setStepLength(timebase.stepLength);
+        stepClock.alignToStep(timebase.firstStep, timebase.samplesUntilFirstStep);
+        nextLinkedStep = timebase.firstStep;
     }
 
+    // MIDI clock output follows our own steps, and never echoes a clock we follow
+    const bool sendingMidiClock = midiClockOutput.load(std::memory_order_relaxed) && !followingMidiClock;
+
+    // A followed clock can stop inside the block, where playing stops too
+    const int playEnd = followingMidiClock ? midiClockFollower.getPlayEnd(numSamples) : numSamples;
+
     // Process our sequencer if we're properly initialized
-    if (sampleRate > 0.0 && stepDuration > 0.0 && isPlaying)
+    if (sampleRate > 0.0 && stepClock.getStepLength().isValid() && playing)
     {
         // Track the time within this buffer
         int samplePosition = 0;
 
-        while (samplePosition < numSamples)
+        while (samplePosition < playEnd)
         {
             // Check if we need to advance to next step
-            if (sampleCounter >= stepDuration)
+            if (stepClock.isStepDue())
             {
-                // Reset the sample counter for the next step
-                sampleCounter -= stepDuration;
+                // Start the next step, carrying the fraction of a sample the step clock keeps
+                stepClock.startNextStep();
+
+                // Latch the parameters once per step, so that a change made by the host
+                // or the editor always takes effect at a step boundary
+                const int density = densityValue.load(std::memory_order_relaxed);
+                const int offset = offsetValue.load(std::memory_order_relaxed);
+                const int root = rootValue.load(std::memory_order_relaxed);
+                updateLoopImage(density, offset, root);
 
                 // Turn off previous note if it's still on
                 if (noteIsOn)
-                {
-                    auto noteOffMessage = juce::MidiMessage::noteOff(1, lastNoteValue, (juce::uint8) 0);
-                    processedMidi.addEvent(noteOffMessage, samplePosition);
-                    noteIsOn = false;
-                }
+                    addNoteOff(generatedMidi, samplePosition);
+
+                // Advance to the next step based on mode:
+                // In Manual Step mode all 16 steps are looped through, but only enabled steps produce sound.
+                // In Density mode only steps within density range are looped
+                const int loopLength = manualStepMode.load(std::memory_order_relaxed) ? numSteps : density;
+                juce::int64 absoluteStep = 0;
+                int loopPosition = 0;
 
-                // Advance to the next step based on mode
-                if (manualStepMode)
+                if (linkGroup != nullptr || followingMidiClock)
                 {
-                    // In Manual Step mode: All 16 steps are looped through,
-                    // but only enabled steps produce sound
-                    currentStep = (currentStep + 1) % numSteps;
+                    // Linked or following a clock: the loop position follows the grid, so
+                    // instances stay aligned and a song position pointer lands in the loop
+                    absoluteStep = nextLinkedStep++;
+                    loopPosition = (int) (((absoluteStep % loopLength) + loopLength) % loopLength);
                 }
                 else
                 {
-                    // In Density mode: Only steps within density range are looped
-                    currentStep = (currentStep + 1) % densityValue;
+                    loopPosition = (currentStep.load(std::memory_order_relaxed) + 1) % loopLength;
                 }
 
-                // Calculate the actual step index in the sequence, considering offset
-                int actualStepIndex = (currentStep + offsetValue) % numSteps;
+                currentStep.store(loopPosition, std::memory_order_relaxed);
 
-                // Determine if we should play a note for this step
-                bool shouldPlayNote;
-
-                if (manualStepMode)
+                // The walk evolves as the loop wraps, so every pass plays one version of it
+                if (loopPosition == 0 && evolveEnabled.load(std::memory_order_relaxed))
                 {
-                    // In Manual Step mode: Only play if step is enabled
-                    shouldPlayNote = enabledSteps[actualStepIndex];
+                    evolveLoop();
+                    updateLoopImage(density, offset, root);
                 }
+
+                // The gate is latched here, so a gate change only affects notes that start after it
+                float gate = gateValue.load(std::memory_order_relaxed);
+                PlannedStep step;
+
+                if (lookahead.isActive())
+                    step = planLookaheadStep(loopPosition, density, offset, root);
+                else if (morphEnabled.load(std::memory_order_relaxed))
+                    step = planMorphStep(loopPosition, offset, root, gate);
                 else
+                    step = planStep(loopPosition, offset);
+
+                if (linkGroup != nullptr)
                 {
-                    // In Density mode: Always play the steps in range
-                    shouldPlayNote = true;
+                    if (isLeading)
+                        linkGroup->publishStep(absoluteStep, { step.plays, step.note, step.velocity });
+                    else if (role != leadRole)
+                        step = followLeader(*linkGroup, absoluteStep, role, step.sequenceIndex);
                 }
 
-                if (shouldPlayNote)
+                if (step.plays)
                 {
-                    // Calculate the MIDI note for this step
-                    int noteValue = getNoteForStep(actualStepIndex);
-
-                    // Send note on message with velocity based on step
-                    juce::uint8 velocity = 80 + (juce::uint8)(30.0 * std::abs(sequence[actualStepIndex]) / 12.0);
-                    auto noteOnMessage = juce::MidiMessage::noteOn(1, noteValue, velocity);
-                    processedMidi.addEvent(noteOnMessage, samplePosition);
-
-                    // Log the note played
-                    DEBUG_LOG("Playing note " << noteValue << " at step " << actualStepIndex);
-
-                    // Remember this note and that we've turned it on
-                    lastNoteValue = noteValue;
-                    noteIsOn = true;
+                    noteLength = getNoteLength(gate);
+                    addNoteOn(generatedMidi, samplePosition, step.note, step.velocity, step.sequenceIndex);
                 }
+
+                if (sendingMidiClock)
+                    midiClockGenerator.addStep(generatedMidi, samplePosition, Engine::getStepLengthInTicks(getRate()),
+                                               stepClock.getCurrentStepLength());
             }
 
             // Determine how many samples to process next
-            auto samplesThisSegment = juce::jmin(numSamples - samplePosition,
-                                              (int) (stepDuration - sampleCounter));
+            auto samplesThisSegment = (int) juce::jmin((juce::int64) (playEnd - samplePosition),
+                                                       stepClock.getSamplesUntilNextStep());
+            const auto samplesIntoStep = stepClock.getSamplesIntoStep();
+
+            // Send the pitch glide of an MPE note up to the end of this segment
+            if (noteIsOn && glidePointsSent < numGlidePoints)
+                addGlidePoints(generatedMidi, samplesIntoStep, samplesThisSegment, samplePosition);
 
             // Check if we need to turn off the note based on gate time
-            if (noteIsOn && (sampleCounter + samplesThisSegment >= getNoteLength()))
+            // A note ending exactly where the segment ends is turned off at the start of the
+            // next one, so it lands on the same sample whatever the block size
+            if (noteIsOn && (samplesIntoStep + samplesThisSegment > noteLength))
             {
                 // Calculate exact sample position for note off
-                auto noteOffPosition = samplePosition + (int) (getNoteLength() - sampleCounter);
+                // (a tempo change may have moved the step past the note's end, so never go back in time)
+                auto noteOffPosition = samplePosition + (int) juce::jmax((juce::int64) 0, noteLength - samplesIntoStep);
 
                 // Ensure we don't go outside the buffer
-                noteOffPosition = juce::jmin(noteOffPosition, numSamples - 1);
+                noteOffPosition = juce::jmin(noteOffPosition, playEnd - 1);
 
                 // Send note off message
-                auto noteOffMessage = juce::MidiMessage::noteOff(1, lastNoteValue, (juce::uint8) 0);
-                processedMidi.addEvent(noteOffMessage, noteOffPosition);
-
-                noteIsOn = false;
+                addNoteOff(generatedMidi, noteOffPosition);
             }
 
             // Protect against impossible values to prevent crashes
-            if (samplesThisSegment <= 0) {
-                DEBUG_LOG("Warning: samplesThisSegment <= 0, resetting to 1");
+            if (samplesThisSegment <= 0)
                 samplesThisSegment = 1;
-            }
 
-            // Advance our counters
-            sampleCounter += samplesThisSegment;
-            samplePosition += samplesThisSegment;
-        }
+            if (sendingMidiClock)
+                midiClockGenerator.addPulses(generatedMidi, samplePosition, samplesThisSegment);
+
+            // Advance our counters
+            stepClock.advance(samplesThisSegment);
+            samplePosition += samplesThisSegment;
+        }
+
+        // The followed clock stopped inside the block
+        if (playEnd < numSamples)
+        {
+            if (noteIsOn)
+                addNoteOff(generatedMidi, playEnd);
+
+            isPlaying.store(false, std::memory_order_relaxed);
+            playing = false;
+        }
+    }
+    else {
+        // If we're not playing but have an active note, turn it off
+        if (noteIsOn) {
+            addNoteOff(generatedMidi, 0);
+        }
+    }
+
+    // Stop the clock we send when playback stops, or when it's turned off
+    if (midiClockGenerator.isRunning() && !(playing && sendingMidiClock))
+        midiClockGenerator.stop(generatedMidi, 0);
+
+    // Let followers that process the next block before us know what's coming
+    if (linkGroup != nullptr && isLeading && playing)
+        publishUpcomingSteps(*linkGroup, numSamples);
+
+    // Post-process our events, including any a delay held back from earlier blocks
+    updatePostProcessing();
+    postProcessing.process(generatedMidi, midiMessages, numSamples);
+
+    if (profiledBlock.isActive())
+        profiledBlock.setEventsEmitted(midiMessages.getNumEvents() - numIncomingEvents);
+}
+
+/**
+ * Publishes the sequence and the enabled steps for the audio thread
+ * The copy goes out before the version is bumped, so the audio thread never sees a new
+ * version with an older pattern
+ */
+void RandomWalkSequencer::markPatternChanged()
+{
+    patternPending.store(false, std::memory_order_release);
+
+    PatternSnapshot snapshot;
+    std::copy_n(sequence, numSteps, snapshot.sequence);
+    std::copy_n(enabledSteps, numSteps, snapshot.enabled);
+    publishedPattern.write(snapshot);
+
+    patternVersion.fetch_add(1, std::memory_order_release);
+}
+
+/**
+ * Takes the latest published pattern, if it changed since the audio thread's copy
+ * If the message thread is publishing at that very moment, the old copy plays on until
+ * the next block rather than the audio thread waiting for it
+ */
+void RandomWalkSequencer::updateAudioPattern()
+{
+    const auto version = patternVersion.load(std::memory_order_acquire);
+
+    if (version != audioPatternVersion && publishedPattern.tryRead(audioPattern))
+        audioPatternVersion = version;
+}
+
+/**
+ * Re-renders the loop image if the pattern or the latched parameters changed
+ * Most steps find it up to date, so a step is usually just a lookup
+ */
+void RandomWalkSequencer::updateLoopImage(int density, int offset, int root)
+{
+    LoopParameters parameters { root, offset, density, manualStepMode.load(std::memory_order_relaxed) };
+    const auto version = audioPatternVersion;
+    const bool evolving = evolveEnabled.load(std::memory_order_relaxed);
+
+    // An edit of the pattern, or turning evolve mode on, starts the walk over from the pattern
+    if (evolving && version != evolveBaseVersion.load(std::memory_order_relaxed))
+    {
+        for (int i = 0; i < numSteps; ++i)
+        {
+            evolvedSequence[i] = audioPattern.sequence[i];
+            evolvedValues[i].store(audioPattern.sequence[i], std::memory_order_relaxed);
+        }
+
+        // Published after the notes, so the UI never sees the walk before it starts
+        evolveBaseVersion.store(version, std::memory_order_release);
+        ++evolveGeneration;
+    }
+    else if (!evolving)
+    {
+        evolveBaseVersion.store(0, std::memory_order_relaxed);
+    }
+
+    if (version == loopImagePatternVersion && parameters == loopImageParameters
+        && evolving == loopImageEvolved && (!evolving || evolveGeneration == loopImageEvolveGeneration))
+        return;
+
+    StepPattern pattern { evolving ? evolvedSequence : audioPattern.sequence, audioPattern.enabled, nullptr };
+    LoopImage image { loopNotes, loopVelocities, loopPlays, nullptr };
+    Engine::renderLoop(pattern, parameters, image);
+
+    loopImageParameters = parameters;
+    loopImagePatternVersion = version;
+    loopImageEvolved = evolving;
+    loopImageEvolveGeneration = evolveGeneration;
+}
+
+/**
+ * Works out what a position in the loop plays, from the loop image
+ * @return Whether the step plays, and its note and velocity
+ */
+RandomWalkSequencer::PlannedStep RandomWalkSequencer::planStep(int loopPosition, int offset) const
+{
+    PlannedStep step;
+
+    // Calculate the actual step index in the sequence, considering offset
+    step.sequenceIndex = (loopPosition + offset) % numSteps;
+
+    step.plays = loopPlays[loopPosition];
+    step.note = loopNotes[loopPosition];
+    step.velocity = loopVelocities[loopPosition];
+
+    return step;
+}
+
+/**
+ * Continues the walk at the chosen number of steps
+ * Each mutation is a few operations on the preallocated walk and random generator
+ */
+void RandomWalkSequencer::evolveLoop()
+{
+    // The walk was copied from the pattern by the last loop image update
+    if (evolveBaseVersion.load(std::memory_order_relaxed) == 0)
+        return;
+
+    const int numMutations = evolveRate.load(std::memory_order_relaxed);
+    const int range = evolveRange.load(std::memory_order_relaxed);
+
+    for (int i = 0; i < numMutations; ++i)
+    {
+        const int index = RandomWalkPattern::mutateStep(evolvedSequence, range, evolveRandom);
+        evolvedValues[index].store(evolvedSequence[index], std::memory_order_relaxed);
+    }
+
+    ++evolveGeneration;
+}
+
+/**
+ * Gets the number of steps in a 4/4 bar at the current rate
+ */
+int RandomWalkSequencer::getStepsPerBar() const
+{
+    return juce::jmax(1, juce::roundToInt(4.0 / Engine::getStepLengthInBeats(getRate())));
+}
+
+/**
+ * Writes what the sequencer plays as a Standard MIDI File
+ * The loop is rendered into its own image here on the message thread, so the audio
+ * thread's image is never touched
+ */
+void RandomWalkSequencer::exportMidiFile(int numLoops, juce::MemoryBlock& destination) const
+{
+    int playingNotes[numSteps];
+
+    for (int i = 0; i < numSteps; ++i)
+        playingNotes[i] = getPlayingValue(i);
+
+    LoopParameters parameters { getRoot(), getOffset(), getDensity(), manualStepMode.load(std::memory_order_relaxed) };
+    int exportNotes[numSteps];
+    juce::uint8 exportVelocities[numSteps];
+    bool exportPlays[numSteps];
+
+    StepPattern pattern { playingNotes, enabledSteps, nullptr };
+    LoopImage image { exportNotes, exportVelocities, exportPlays, nullptr };
+    Engine::renderLoop(pattern, parameters, image);
+
+    ExportLane lane;
+    lane.notes = exportNotes;
+    lane.velocities = exportVelocities;
+    lane.plays = exportPlays;
+    lane.loopLength = parameters.manualStepMode ? numSteps : juce::jlimit(1, numSteps, parameters.density);
+    lane.channel = getOutputChannel();
+
+    ExportSettings settings;
+    settings.stepLengthInTicks = Engine::getStepLengthInTicks(getRate()).numerator;
+    settings.gate = getGate();
+    settings.numLoops = numLoops;
+    settings.bpm = getInternalBpm();
+
+    MidiFileWriter::write(&lane, 1, settings, destination);
+}
+
+//==============================================================================
+// Morphing
+//==============================================================================
+
+/**
+ * Works out what a loop position plays from the morph slots
+ * Only the step about to play is morphed, so moving the morph costs nothing until then
+ */
+RandomWalkSequencer::PlannedStep RandomWalkSequencer::planMorphStep(int loopPosition, int offset, int root, float& gate)
+{
+    // Glide towards the control a step at a time, reaching it after the chosen number of bars
+    const float target = morphAmount.load(std::memory_order_relaxed);
+    const int bars = morphBars.load(std::memory_order_relaxed);
+    float position = morphPosition.load(std::memory_order_relaxed);
+
+    if (bars == 0)
+    {
+        position = target;
+    }
+    else
+    {
+        const float increment = 1.0f / (float) (bars * getStepsPerBar());
+        position = target > position ? juce::jmin(target, position + increment)
+                                     : juce::jmax(target, position - increment);
+    }
+
+    morphPosition.store(position, std::memory_order_relaxed);
+
+    PlannedStep step;
+    step.sequenceIndex = (loopPosition + offset) % numSteps;
+
+    auto morphed = morph.getStep(step.sequenceIndex, position, static_cast<Morph::Mode>(morphMode.load(std::memory_order_relaxed)));
+
+    // In density mode every position in the loop plays, as it does without morphing
+    step.plays = manualStepMode.load(std::memory_order_relaxed) ? morphed.enabled : loopPlays[loopPosition];
+    step.note = juce::jlimit(0, 127, root + morphed.note);
+    step.velocity = morphed.velocity;
+    gate = morphed.gate;
+
+    return step;
+}
+
+/**
+ * Stores the current pattern in a slot
+ * Each step keeps the velocity the pattern plays it at, and the current gate
+ */
+void RandomWalkSequencer::storeMorphSlot(Morph::Slot slot)
+{
+    generatePatternIfPending();
+
+    const float gate = getGate();
+
+    for (int i = 0; i < numSteps; ++i)
+    {
+        MorphedStep value;
+        value.enabled = enabledSteps[i];
+        value.note = sequence[i];
+        value.velocity = (juce::uint8) (80 + (5 * std::abs(sequence[i])) / 2);
+        value.gate = gate;
+
+        morph.setStep(slot, i, value);
+    }
+}
+
+/**
+ * Copies a slot's notes and enabled steps back into the pattern
+ */
+void RandomWalkSequencer::recallMorphSlot(Morph::Slot slot)
+{
+    for (int i = 0; i < numSteps; ++i)
+    {
+        auto value = morph.getStoredStep(slot, i);
+        sequence[i] = juce::jlimit(-12, 12, value.note);
+        enabledSteps[i] = value.enabled;
+    }
+
+    markPatternChanged();
+}
+
+/**
+ * Enables or disables morphing
+ */
+void RandomWalkSequencer::setMorphEnabled(bool shouldMorph) { morphEnabled.store(shouldMorph, std::memory_order_relaxed); }
+
+/**
+ * Returns whether morphing is on
+ */
+bool RandomWalkSequencer::isMorphEnabled() const { return morphEnabled.load(std::memory_order_relaxed); }
+
+/**
+ * Sets the morph control, picked up at the next step
+ */
+void RandomWalkSequencer::setMorphAmount(float amount) { morphAmount.store(juce::jlimit(0.0f, 1.0f, amount), std::memory_order_relaxed); }
+
+/**
+ * Gets the morph control
+ */
+float RandomWalkSequencer::getMorphAmount() const { return morphAmount.load(std::memory_order_relaxed); }
+
+/**
+ * Sets how many bars the morph takes to reach the control
+ * Snapped down to the longest choice that fits, so a restored or automated value is
+ * always one the editor can show
+ */
+void RandomWalkSequencer::setMorphBars(int numBars)
+{
+    int snapped = morphBarChoices[0];
+
+    for (int choice: morphBarChoices)
+        if (numBars >= choice)
+            snapped = choice;
+
+    morphBars.store(snapped, std::memory_order_relaxed);
+}
+
+/**
+ * Gets how many bars the morph takes to reach the control
+ */
+int RandomWalkSequencer::getMorphBars() const { return morphBars.load(std::memory_order_relaxed); }
+
+/**
+ * Sets how the steps get from A to B
+ */
+void RandomWalkSequencer::setMorphMode(Morph::Mode mode) { morphMode.store(juce::jlimit((int) Morph::interpolateMode, (int) Morph::crossfadeMode, (int) mode), std::memory_order_relaxed); }
+
+/**
+ * Gets how the steps get from A to B
+ */
+RandomWalkSequencer::Morph::Mode RandomWalkSequencer::getMorphMode() const { return static_cast<Morph::Mode>(morphMode.load(std::memory_order_relaxed)); }
+
+//==============================================================================
+// Evolving
+//==============================================================================
+
+/**
+ * Enables or disables evolve mode
+ */
+void RandomWalkSequencer::setEvolveEnabled(bool shouldEvolve) { evolveEnabled.store(shouldEvolve, std::memory_order_relaxed); }
+
+/**
+ * Returns whether evolve mode is on
+ */
+bool RandomWalkSequencer::isEvolveEnabled() const { return evolveEnabled.load(std::memory_order_relaxed); }
+
+/**
+ * Sets how many steps are mutated at every wrap of the loop
+ */
+void RandomWalkSequencer::setEvolveRate(int stepsPerLoop) { evolveRate.store(juce::jlimit(1, numSteps, stepsPerLoop), std::memory_order_relaxed); }
+
+/**
+ * Gets how many steps are mutated at every wrap of the loop
+ */
+int RandomWalkSequencer::getEvolveRate() const { return evolveRate.load(std::memory_order_relaxed); }
+
+/**
+ * Sets how many semitones a mutated step can move from its neighbour
+ */
+void RandomWalkSequencer::setEvolveRange(int semitones) { evolveRange.store(juce::jlimit(1, 12, semitones), std::memory_order_relaxed); }
+
+/**
+ * Gets how many semitones a mutated step can move from its neighbour
+ */
+int RandomWalkSequencer::getEvolveRange() const { return evolveRange.load(std::memory_order_relaxed); }
+
+/**
+ * Returns whether the audio thread has started evolving the walk from the pattern
+ */
+bool RandomWalkSequencer::hasEvolvedWalk() const
+{
+    return isEvolveEnabled() && evolveBaseVersion.load(std::memory_order_acquire) != 0;
+}
+
+/**
+ * Gets the note value a step is playing
+ * Until the audio thread has started the walk, that's still the pattern's
+ */
+int RandomWalkSequencer::getPlayingValue(int index) const
+{
+    if (!juce::isPositiveAndBelow(index, numSteps))
+        return 0;
+
+    return hasEvolvedWalk() ? evolvedValues[index].load(std::memory_order_relaxed) : sequence[index];
+}
+
+/**
+ * Copies the evolved notes into the pattern
+ */
+void RandomWalkSequencer::keepEvolvedPattern()
+{
+    if (!hasEvolvedWalk())
+        return;
+
+    for (int i = 0; i < numSteps; ++i)
+        sequence[i] = evolvedValues[i].load(std::memory_order_relaxed);
+
+    markPatternChanged();
+}
+
+//==============================================================================
+// Lookahead generation
+//==============================================================================
+
+/**
+ * Works out what a loop position plays from the lookahead generator's stream
+ * The queue is re-primed when it was rendered for other parameters, another pattern or
+ * another rate, or after a seek, a tempo change or a restart of playback
+ */
+RandomWalkSequencer::PlannedStep RandomWalkSequencer::planLookaheadStep(int loopPosition, int density, int offset, int root)
+{
+    const LoopParameters parameters { root, offset, density, manualStepMode.load(std::memory_order_relaxed) };
+    const int stepsPerBar = getStepsPerBar();
+    const bool parametersChanged = parameters != lookaheadParameters
+                                   || audioPatternVersion != lookaheadPatternVersion;
+
+    if (lookaheadNeedsPriming || parametersChanged || stepsPerBar != lookaheadStepsPerBar || lookahead.needsPriming())
+        primeLookahead(loopPosition, parameters, stepsPerBar, parametersChanged);
+
+    RenderedStep rendered;
+
+    if (lookahead.popStep(rendered))
+    {
+        auto& step = lookaheadLoop[loopPosition];
+        step.plays = rendered.plays;
+        step.note = juce::jlimit(0, 127, rendered.note);
+        step.velocity = rendered.velocity;
+        step.sequenceIndex = juce::jlimit(0, numSteps - 1, rendered.sequenceIndex);
+    }
+
+    // Without a rendered step, repeat what this position played on the last pass
+    return lookaheadLoop[loopPosition];
+}
+
+/**
+ * Flushes the lookahead queue and sends the worker a new context
+ * If the worker hasn't taken the previous contexts yet, this is tried again at the next step
+ */
+void RandomWalkSequencer::primeLookahead(int loopPosition, const LoopParameters& parameters, int stepsPerBar, bool parametersChanged)
+{
+    LookaheadContext context;
+    context.parameters = parameters;
+    context.numSteps = numSteps;
+    context.firstLoopPosition = loopPosition;
+    context.stepsPerBar = stepsPerBar;
+    std::copy_n(audioPattern.sequence, numSteps, context.sequence);
+    std::copy_n(audioPattern.enabled, numSteps, context.enabled);
+
+    if (!lookahead.prime(context))
+        return;
+
+    // The last pass is the best fallback after a seek or a tempo change, but not once
+    // it was rendered from other parameters or another pattern
+    if (parametersChanged || lookaheadPatternVersion == 0)
+    {
+        for (int i = 0; i < numSteps; ++i)
+            lookaheadLoop[i] = planStep(i, parameters.offset);
+    }
+
+    lookaheadNeedsPriming = false;
+    lookaheadParameters = parameters;
+    lookaheadPatternVersion = audioPatternVersion;
+    lookaheadStepsPerBar = stepsPerBar;
+}
+
+/**
+ * Sets where the notes come from
+ */
+void RandomWalkSequencer::setGenerationMode(GenerationMode mode)
+{
+    if (mode == searchedWalkGeneration)
+        setLookaheadGenerator(std::make_unique<SearchedWalkGenerator>());
+    else
+        setLookaheadGenerator(nullptr);
+
+    generationMode.store(mode, std::memory_order_relaxed);
+}
+
+/**
+ * Gets where the notes come from
+ */
+RandomWalkSequencer::GenerationMode RandomWalkSequencer::getGenerationMode() const
+{
+    return static_cast<GenerationMode>(generationMode.load(std::memory_order_relaxed));
+}
+
+/**
+ * Renders the notes with a custom generator ahead of the playhead
+ * The audio thread primes the new generator's queue at the next step, and plays the
+ * pattern until the first rendered steps arrive
+ */
+void RandomWalkSequencer::setLookaheadGenerator(std::unique_ptr<LookaheadGenerator> generator)
+{
+    lookahead.setGenerator(std::move(generator));
+}
+
+//==============================================================================
+// Link groups
+//==============================================================================
+
+/**
+ * Registers with the selected link group (or leaves it), and claims or gives up leadership
+ * The shared grid is measured from host position 0, so it's only used while the host
+ * transport is running; otherwise this instance keeps its own clock for the block
+ * @return The group to take this block's step grid from, or nullptr to run unlinked
+ */
+LinkGroup* RandomWalkSequencer::updateLinkGroup(const TimingContext& timing)
+{
+    auto* wantedGroup = LinkGroup::getGroup(linkGroupId.load(std::memory_order_relaxed));
+
+    if (wantedGroup != joinedGroup)
+    {
+        leaveLinkGroup();
+
+        if (wantedGroup != nullptr)
+            wantedGroup->join();
+
+        joinedGroup = wantedGroup;
+    }
+
+    if (joinedGroup == nullptr)
+        return nullptr;
+
+    bool isLeading = false;
+
+    if (linkRole.load(std::memory_order_relaxed) == leadRole)
+        isLeading = joinedGroup->claimLeadership(this);
+    else
+        joinedGroup->releaseLeadership(this);
+
+    linkLeading.store(isLeading, std::memory_order_relaxed);
+
+    // The leader's rate decides the group's grid
+    if (isLeading)
+        joinedGroup->setLeaderStepLength(stepClock.getStepLength());
+
+    if (!timing.hostIsPlaying || !timing.timeInSamples.hasValue())
+        return nullptr;
+
+    return joinedGroup;
+}
+
+/**
+ * Works out what a follower plays on a step, from the leader's stream
+ * A step the leader hasn't published (yet) is a rest
+ */
+RandomWalkSequencer::PlannedStep RandomWalkSequencer::followLeader(const LinkGroup& group, juce::int64 absoluteStep, int role, int sequenceIndex) const
+{
+    PlannedStep step;
+    step.sequenceIndex = sequenceIndex;
+
+    auto leaderStep = absoluteStep - (role == canonRole ? canonDelay.load(std::memory_order_relaxed) : 0);
+    LinkGroup::StepRecord record;
+
+    if (group.readStep(leaderStep, record) && record.plays)
+    {
+        step.plays = true;
+        step.note = juce::jlimit(0, 127, record.note + linkInterval.load(std::memory_order_relaxed));
+        step.velocity = (juce::uint8) record.velocity;
+    }
+
+    return step;
+}
+
+/**
+ * Publishes the leader's upcoming steps with the current pattern
+ * Covers the next two blocks' worth of steps (up to LinkGroup::maxStepsAhead),
+ * and each one is published again with its final values when it's played
+ */
+void RandomWalkSequencer::publishUpcomingSteps(LinkGroup& group, int numSamples)
+{
+    const int density = densityValue.load(std::memory_order_relaxed);
+    const int offset = offsetValue.load(std::memory_order_relaxed);
+    const int root = rootValue.load(std::memory_order_relaxed);
+    const int loopLength = manualStepMode.load(std::memory_order_relaxed) ? numSteps : density;
+    updateLoopImage(density, offset, root);
+
+    const int numStepsAhead = juce::jmin(LinkGroup::maxStepsAhead,
+                                         1 + (int) std::ceil(2.0 * numSamples / stepClock.getStepLength().toDouble()));
+
+    for (int i = 0; i < numStepsAhead; ++i)
+    {
+        auto absoluteStep = nextLinkedStep + i;
+        auto loopPosition = (int) (((absoluteStep % loopLength) + loopLength) % loopLength);
+        auto step = planStep(loopPosition, offset);
+
+        group.publishStep(absoluteStep, { step.plays, step.note, step.velocity });
+    }
+}
+
+/**
+ * Leaves the link group, giving up leadership
+ */
+void RandomWalkSequencer::leaveLinkGroup()
+{
+    if (joinedGroup != nullptr)
+    {
+        joinedGroup->leave(this);
+        joinedGroup = nullptr;
+    }
+
+    linkLeading.store(false, std::memory_order_relaxed);
+}
+
+/**
+ * Sets the link group, picked up by the audio thread at the next block
+ */
+void RandomWalkSequencer::setLinkGroup(int groupId) { linkGroupId.store(juce::jlimit(0, LinkGroup::maxGroups, groupId), std::memory_order_relaxed); }
+
+/**
+ * Gets the link group ID, 0 if not linked
+ */
+int RandomWalkSequencer::getLinkGroup() const { return linkGroupId.load(std::memory_order_relaxed); }
+
+/**
+ * Sets the role in the link group
+ */
+void RandomWalkSequencer::setLinkRole(LinkRole role) { linkRole.store(juce::jlimit((int) leadRole, (int) canonRole, (int) role), std::memory_order_relaxed); }
+
+/**
+ * Gets the role in the link group
+ */
+RandomWalkSequencer::LinkRole RandomWalkSequencer::getLinkRole() const { return static_cast<LinkRole>(linkRole.load(std::memory_order_relaxed)); }
+
+/**
+ * Sets the interval that followers add to the leader's notes
+ */
+void RandomWalkSequencer::setLinkInterval(int semitones) { linkInterval.store(juce::jlimit(-24, 24, semitones), std::memory_order_relaxed); }
+
+/**
+ * Gets the interval that followers add to the leader's notes
+ */
+int RandomWalkSequencer::getLinkInterval() const { return linkInterval.load(std::memory_order_relaxed); }
+
+/**
+ * Sets how many steps a canon follower plays behind the leader
+ * Limited so that the delayed steps are still in the leader's stream
+ */
+void RandomWalkSequencer::setCanonDelay(int steps) { canonDelay.store(juce::jlimit(1, numSteps, steps), std::memory_order_relaxed); }
+
+/**
+ * Gets how many steps a canon follower plays behind the leader
+ */
+int RandomWalkSequencer::getCanonDelay() const { return canonDelay.load(std::memory_order_relaxed); }
+
+//==============================================================================
+// Note output
+//==============================================================================
+
+/**
+ * Starts a note, allocating an MPE member channel for it in MPE mode
+ * @param midiMessages The buffer to add the events to
+ * @param samplePosition Position of the note on within the block
+ * @param noteValue MIDI note number
+ * @param velocity Note on velocity
+ * @param step The (offset-adjusted) step whose expression lanes are sent
+ */
+void RandomWalkSequencer::addNoteOn(juce::MidiBuffer& midiMessages, int samplePosition, int noteValue, juce::uint8 velocity, int step)
+{
+    lastNoteIsMpe = mpeMode.load(std::memory_order_relaxed);
+
+    if (lastNoteIsMpe)
+    {
+        lastNoteChannel = mpeChannels.allocate();
+
+        // Initial per-note expression goes out before the note on, so the synth
+        // starts the note with the right values: no bend yet, then pressure and timbre
+        auto pressure = stepExpression[pressureLane][step].load(std::memory_order_relaxed);
+        auto timbre = stepExpression[timbreLane][step].load(std::memory_order_relaxed);
+
+        midiMessages.addEvent(juce::MidiMessage::pitchWheel(lastNoteChannel, glideToPitchWheel(0.0f)), samplePosition);
+        midiMessages.addEvent(juce::MidiMessage::channelPressureChange(lastNoteChannel, juce::roundToInt(pressure * 127.0f)), samplePosition);
+        midiMessages.addEvent(juce::MidiMessage::controllerEvent(lastNoteChannel, 74, juce::roundToInt(timbre * 127.0f)), samplePosition);
+
+        // The glide ramp follows during the note
+        glideTarget = stepExpression[glideLane][step].load(std::memory_order_relaxed);
+        glidePointsSent = glideTarget != 0.0f ? 0 : numGlidePoints;
     }
-    else {
-        // If we're not playing but have an active note, turn it off
-        if (noteIsOn) {
-            auto noteOffMessage = juce::MidiMessage::noteOff(1, lastNoteValue, (juce::uint8) 0);
-            processedMidi.addEvent(noteOffMessage, 0);
-            noteIsOn = false;
-        }
+    else
+    {
+        lastNoteChannel = outputChannel.load(std::memory_order_relaxed);
+        glidePointsSent = numGlidePoints;
     }
 
-    // Replace original MIDI with our processed MIDI
-    midiMessages.swapWith(processedMidi);
+    midiMessages.addEvent(juce::MidiMessage::noteOn(lastNoteChannel, noteValue, velocity), samplePosition);
+
+    // Remember this note and that we've turned it on
+    lastNoteValue = noteValue;
+    noteIsOn = true;
+}
+
+/**
+ * Ends the playing note on the channel it was started on
+ * @param midiMessages The buffer to add the note off to
+ * @param samplePosition Position of the note off within the block
+ */
+void RandomWalkSequencer::addNoteOff(juce::MidiBuffer& midiMessages, int samplePosition)
+{
+    midiMessages.addEvent(juce::MidiMessage::noteOff(lastNoteChannel, lastNoteValue, (juce::uint8) 0), samplePosition);
+
+    // The member channel goes to the back of the queue, so its release tail isn't cut short
+    if (lastNoteIsMpe)
+        mpeChannels.release(lastNoteChannel);
+
+    noteIsOn = false;
+    glidePointsSent = numGlidePoints;
 }
 
 /**
- * Checks if the provided bus layout is compatible with this sequencer
- * Supports various bus configurations for maximum compatibility
+ * Sends the glide ramp points that fall inside a segment of the playing note
+ * Point k of the ramp is at k / (numGlidePoints + 1) of the note, so the last
+ * one is sent while the note is still sounding
  */
-bool RandomWalkSequencer::isBusesLayoutSupported(const BusesLayout& layouts) const
+void RandomWalkSequencer::addGlidePoints(juce::MidiBuffer& midiMessages, juce::int64 segmentStart, int segmentLength, int samplePosition)
 {
-    // For REAPER compatibility, we'll be more permissive with bus layouts
+    const auto segmentEnd = segmentStart + segmentLength;
 
-    // Accept if both input and output are stereo (most common case)
-    if (layouts.getMainInputChannelSet() == juce::AudioChannelSet::stereo() &&
-        layouts.getMainOutputChannelSet() == juce::AudioChannelSet::stereo())
-        return true;
+    while (glidePointsSent < numGlidePoints)
+    {
+        auto pointTime = noteLength * (glidePointsSent + 1) / (numGlidePoints + 1);
 
-    // Accept if both are mono
-    if (layouts.getMainInputChannelSet() == juce::AudioChannelSet::mono() &&
-        layouts.getMainOutputChannelSet() == juce::AudioChannelSet::mono())
-        return true;
+        if (pointTime >= segmentEnd)
+            break;
 
-    // Accept if both are disabled
-    if (layouts.getMainInputChannelSet().isDisabled() &&
-        layouts.getMainOutputChannelSet().isDisabled())
-        return true;
+        auto position = samplePosition + (int) juce::jmax((juce::int64) 0, pointTime - segmentStart);
+        auto glide = glideTarget * (float) (glidePointsSent + 1) / (float) numGlidePoints;
 
-    // Also accept asymmetric layouts as long as they're valid channel sets
-    if (!layouts.getMainInputChannelSet().isDisabled() &&
-        !layouts.getMainOutputChannelSet().isDisabled())
-        return true;
+        midiMessages.addEvent(juce::MidiMessage::pitchWheel(lastNoteChannel, glideToPitchWheel(glide)), position);
+        ++glidePointsSent;
+    }
+}
 
-    return false;
+/**
+ * Converts a glide amount to a pitch wheel value
+ * @param glide Glide amount from -1 to 1, where 1 is maxGlideSemitones up
+ * @return 14-bit pitch wheel value, centred at 8192
+ */
+int RandomWalkSequencer::glideToPitchWheel(float glide)
+{
+    auto bend = glide * (float) maxGlideSemitones / (float) mpePitchbendRange;
+    return juce::jlimit(0, 16383, 8192 + juce::roundToInt(bend * 8191.0f));
 }
 
 //==============================================================================
@@ -363,26 +1119,8 @@ bool RandomWalkSequencer::isBusesLayoutSupported(const BusesLayout& layouts) con
 void RandomWalkSequencer::generateAscendingPattern()
 {
     juce::Random random;
-
-    // Start from a low value
-    int currentValue = -6;
-
-    // Generate an ascending pattern
-    for (int i = 0; i < numSteps; ++i)
-    {
-        // Add some randomness but mostly ascending
-        if (random.nextFloat() < 0.2f)
-            currentValue--; // Occasionally go down for interest
-        else
-            currentValue++;
-
-        // Keep within reasonable range
-        if (currentValue < -12) currentValue = -12;
-        if (currentValue > 12) currentValue = 12;
-
-        // Store the value
-        sequence[i] = currentValue;
-    }
+    AscendingPattern::generate(sequence, random);
+    markPatternChanged();
 }
 
 /**
@@ -392,26 +1130,8 @@ void RandomWalkSequencer::generateAscendingPattern()
 void RandomWalkSequencer::generateDescendingPattern()
 {
     juce::Random random;
-
-    // Start from a high value
-    int currentValue = 6;
-
-    // Generate a descending pattern
-    for (int i = 0; i < numSteps; ++i)
-    {
-        // Add some randomness but mostly descending
-        if (random.nextFloat() < 0.2f)
-            currentValue++; // Occasionally go up for interest
-        else
-            currentValue--;
-
-        // Keep within reasonable range
-        if (currentValue < -12) currentValue = -12;
-        if (currentValue > 12) currentValue = 12;
-
-        // Store the value
-        sequence[i] = currentValue;
-    }
+    DescendingPattern::generate(sequence, random);
+    markPatternChanged();
 }
 
 /**
@@ -420,78 +1140,121 @@ void RandomWalkSequencer::generateDescendingPattern()
  */
 void RandomWalkSequencer::generateArpeggioPattern()
 {
-    // Define some musical intervals (semitones)
-    const int intervals[] = { 0, 4, 7, 12 }; // Major chord: root, major third, perfect fifth, octave
-    const int numIntervals = 4;
-
     juce::Random random;
-
-    for (int i = 0; i < numSteps; ++i)
-    {
-        // Choose a random interval from our chord
-        int intervalIndex = random.nextInt(numIntervals);
-        int value = intervals[intervalIndex];
-
-        // Occasionally invert down an octave for bass notes
-        if (random.nextFloat() < 0.3f && value > 0)
-            value -= 12;
-
-        sequence[i] = value;
-    }
+    ArpeggioPattern::generate(sequence, random);
+    markPatternChanged();
 }
 
 /**
- * Saves the current state of the sequencer to the provided memory block
- * Stores all parameters and sequence data as XML
+ * Saves the current state of the sequencer as XML
+ * Stores all parameters and sequence data
  */
-void RandomWalkSequencer::getStateInformation(juce::MemoryBlock& destData)
+std::unique_ptr<juce::XmlElement> RandomWalkSequencer::createStateXml() const
 {
     // Create XML to store parameter values
-    juce::XmlElement xml("RandomWalkSequencerState");
+    auto xml = std::make_unique<juce::XmlElement>("RandomWalkSequencerState");
 
     // Add parameters
-    xml.setAttribute("rate", rateValue);
-    xml.setAttribute("density", densityValue);
-    xml.setAttribute("offset", offsetValue);
-    xml.setAttribute("gate", gateValue);
-    xml.setAttribute("root", rootValue);
-    xml.setAttribute("manualStepMode", manualStepMode);
-
-    // Add sequence data
-    juce::XmlElement* sequenceXml = xml.createNewChildElement("Sequence");
+    xml->setAttribute("rate", getRate());
+    xml->setAttribute("density", getDensity());
+    xml->setAttribute("offset", getOffset());
+    xml->setAttribute("gate", getGate());
+    xml->setAttribute("root", getRoot());
+    xml->setAttribute("manualStepMode", isManualStepMode());
+    xml->setAttribute("internalBpm", getInternalBpm());
+    xml->setAttribute("outputChannel", getOutputChannel());
+    xml->setAttribute("mpeMode", isMpeMode());
+    xml->setAttribute("linkGroup", getLinkGroup());
+    xml->setAttribute("linkRole", (int) getLinkRole());
+    xml->setAttribute("linkInterval", getLinkInterval());
+    xml->setAttribute("canonDelay", getCanonDelay());
+    xml->setAttribute("generationMode", (int) getGenerationMode());
+    xml->setAttribute("morphEnabled", isMorphEnabled());
+    xml->setAttribute("morphAmount", getMorphAmount());
+    xml->setAttribute("morphBars", getMorphBars());
+    xml->setAttribute("morphMode", (int) getMorphMode());
+    xml->setAttribute("evolveEnabled", isEvolveEnabled());
+    xml->setAttribute("evolveRate", getEvolveRate());
+    xml->setAttribute("evolveRange", getEvolveRange());
+    xml->setAttribute("lookaheadBars", getLookaheadBars());
+    xml->setAttribute("midiClockInput", isMidiClockInput());
+    xml->setAttribute("midiClockOutput", isMidiClockOutput());
+    xml->setAttribute("postTranspose", getPostTranspose());
+    xml->setAttribute("velocityCurve", getVelocityCurve());
+    xml->setAttribute("outputDelay", getOutputDelay());
+
+    // Add sequence data. Hosts save from any thread, so a pattern that hasn't been
+    // generated yet is left out rather than generated here: restoring generates one
+    const bool hasPattern = !patternPending.load(std::memory_order_acquire);
+
+    juce::XmlElement* sequenceXml = xml->createNewChildElement("Sequence");
     for (int i = 0; i < numSteps; ++i)
     {
-        sequenceXml->setAttribute("Step" + juce::String(i), sequence[i]);
+        if (hasPattern)
+            sequenceXml->setAttribute("Step" + juce::String(i), sequence[i]);
+
         sequenceXml->setAttribute("Enabled" + juce::String(i), enabledSteps[i]);
+        sequenceXml->setAttribute("Glide" + juce::String(i), getStepExpression(glideLane, i));
+        sequenceXml->setAttribute("Pressure" + juce::String(i), getStepExpression(pressureLane, i));
+        sequenceXml->setAttribute("Timbre" + juce::String(i), getStepExpression(timbreLane, i));
+    }
+
+    // Add the morph slots
+    for (int slot = 0; slot < Morph::numSlots; ++slot)
+    {
+        juce::XmlElement* slotXml = xml->createNewChildElement(slot == Morph::slotA ? "MorphSlotA" : "MorphSlotB");
+
+        for (int i = 0; i < numSteps; ++i)
+        {
+            auto value = morph.getStoredStep(static_cast<Morph::Slot>(slot), i);
+            slotXml->setAttribute("Step" + juce::String(i), value.note);
+            slotXml->setAttribute("Velocity" + juce::String(i), (int) value.velocity);
+            slotXml->setAttribute("Gate" + juce::String(i), value.gate);
+            slotXml->setAttribute("Enabled" + juce::String(i), value.enabled);
+        }
     }
 
-    // Write to binary
-    copyXmlToBinary(xml, destData);
     DEBUG_LOG("State saved");
+    return xml;
 }
 
 /**
- * Restores the sequencer state from the provided data
- * Loads all parameters and sequence data from XML
+ * Restores the sequencer state from XML
+ * Loads all parameters and sequence data
  */
-void RandomWalkSequencer::setStateInformation(const void* data, int sizeInBytes)
+void RandomWalkSequencer::restoreStateFromXml(const juce::XmlElement& xmlState)
 {
-    // Parse XML from binary
-    std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
-
-    if (xmlState != nullptr && xmlState->hasTagName("RandomWalkSequencerState"))
+    if (xmlState.hasTagName("RandomWalkSequencerState"))
     {
         // Restore parameters
-        rateValue = xmlState->getIntAttribute("rate", 1);
-        densityValue = xmlState->getIntAttribute("density", 16);
-        offsetValue = xmlState->getIntAttribute("offset", 0);
-        gateValue = static_cast<float>(xmlState->getDoubleAttribute("gate", 0.5));
-        rootValue = xmlState->getIntAttribute("root", 72);  // Changed from 60 to 72
-        manualStepMode = xmlState->getBoolAttribute("manualStepMode", false);
-        internalBpm = xmlState->getDoubleAttribute("internalBpm", 120.0); // Restore internal BPM
+        setRate(xmlState.getIntAttribute("rate", 1));
+        setDensity(xmlState.getIntAttribute("density", 16));
+        setOffset(xmlState.getIntAttribute("offset", 0));
+        setGate(static_cast<float>(xmlState.getDoubleAttribute("gate", 0.5)));
+        setRoot(xmlState.getIntAttribute("root", 72));  // Changed from 60 to 72
+        manualStepMode.store(xmlState.getBoolAttribute("manualStepMode", false), std::memory_order_relaxed);
+        setInternalBpm(xmlState.getDoubleAttribute("internalBpm", 120.0)); // Restore internal BPM
+        setOutputChannel(xmlState.getIntAttribute("outputChannel", 1));
+        setMpeMode(xmlState.getBoolAttribute("mpeMode", false));
+        setLinkGroup(xmlState.getIntAttribute("linkGroup", 0));
+        setLinkRole(static_cast<LinkRole>(xmlState.getIntAttribute("linkRole", leadRole)));
+        setLinkInterval(xmlState.getIntAttribute("linkInterval", 7));
+        setCanonDelay(xmlState.getIntAttribute("canonDelay", 4));
+        setLookaheadBars(xmlState.getIntAttribute("lookaheadBars", 2));
+
+        auto mode = static_cast<GenerationMode>(juce::jlimit((int) patternGeneration, (int) searchedWalkGeneration,
+                                                             xmlState.getIntAttribute("generationMode", patternGeneration)));
+
+        if (mode != getGenerationMode())
+            setGenerationMode(mode);
 
         // Restore sequence data
-        juce::XmlElement* sequenceXml = xmlState->getChildByName("Sequence");
+        juce::XmlElement* sequenceXml = xmlState.getChildByName("Sequence");
+
+        // A state saved without a pattern still gets one
+        if (sequenceXml == nullptr || !sequenceXml->hasAttribute("Step0"))
+            generatePatternIfPending();
+
         if (sequenceXml != nullptr)
         {
             for (int i = 0; i < numSteps; ++i)
@@ -505,38 +1268,54 @@ void RandomWalkSequencer::setStateInformation(const void* data, int sizeInBytes)
                 {
                     enabledSteps[i] = sequenceXml->getBoolAttribute("Enabled" + juce::String(i), true);
                 }
+
+                // Expression lanes, missing from states saved before MPE support
+                setStepExpression(glideLane, i, (float) sequenceXml->getDoubleAttribute("Glide" + juce::String(i), 0.0));
+                setStepExpression(pressureLane, i, (float) sequenceXml->getDoubleAttribute("Pressure" + juce::String(i), 0.0));
+                setStepExpression(timbreLane, i, (float) sequenceXml->getDoubleAttribute("Timbre" + juce::String(i), 0.5));
             }
         }
 
-        DEBUG_LOG("State restored");
-    }
-}
+        // Restore the morph, missing from states saved before morphing
+        setMorphEnabled(xmlState.getBoolAttribute("morphEnabled", false));
+        setMorphAmount((float) xmlState.getDoubleAttribute("morphAmount", 0.0));
+        setMorphBars(xmlState.getIntAttribute("morphBars", 0));
+        setMorphMode(static_cast<Morph::Mode>(xmlState.getIntAttribute("morphMode", Morph::interpolateMode)));
 
-/**
- * Creates the editor component for the sequencer UI
- * @return A new editor instance
- */
-juce::AudioProcessorEditor* RandomWalkSequencer::createEditor()
-{
-    // Create the editor without triggering any sequence regeneration
-    return new RandomWalkSequencerEditor(*this);
-}
+        for (int slot = 0; slot < Morph::numSlots; ++slot)
+        {
+            if (auto* slotXml = xmlState.getChildByName(slot == Morph::slotA ? "MorphSlotA" : "MorphSlotB"))
+            {
+                for (int i = 0; i < numSteps; ++i)
+                {
+                    MorphedStep value;
+                    value.note = juce::jlimit(-12, 12, slotXml->getIntAttribute("Step" + juce::String(i), 0));
+                    value.velocity = (juce::uint8) juce::jlimit(1, 127, slotXml->getIntAttribute("Velocity" + juce::String(i), 80));
+                    value.gate = juce::jlimit(0.1f, 1.0f, (float) slotXml->getDoubleAttribute("Gate" + juce::String(i), 0.5));
+                    value.enabled = slotXml->getBoolAttribute("Enabled" + juce::String(i), true);
+                    morph.setStep(static_cast<Morph::Slot>(slot), i, value);
+                }
+            }
+        }
 
-/**
- * Indicates whether this sequencer has a custom editor
- * @return Always returns true
- */
-bool RandomWalkSequencer::hasEditor() const
-{
-    return true;
-}
+        // Restore evolve mode, missing from states saved before it
+        setEvolveEnabled(xmlState.getBoolAttribute("evolveEnabled", false));
+        setEvolveRate(xmlState.getIntAttribute("evolveRate", 2));
+        setEvolveRange(xmlState.getIntAttribute("evolveRange", 3));
 
-/**
- * Called when a parameter value changes (unused in this implementation)
- */
-void RandomWalkSequencer::parameterChanged(const juce::String&, float)
-{
-    // Not used without AudioProcessorValueTreeState
+        // Restore the MIDI clock settings, missing from states saved before them
+        setMidiClockInput(xmlState.getBoolAttribute("midiClockInput", false));
+        setMidiClockOutput(xmlState.getBoolAttribute("midiClockOutput", false));
+
+        // Restore the post-processing, missing from states saved before it
+        setPostTranspose(xmlState.getIntAttribute("postTranspose", 0));
+        setVelocityCurve((float) xmlState.getDoubleAttribute("velocityCurve", 0.0));
+        setOutputDelay((float) xmlState.getDoubleAttribute("outputDelay", 0.0));
+
+        markPatternChanged();
+
+        DEBUG_LOG("State restored");
+    }
 }
 
 //==============================================================================
@@ -546,65 +1325,196 @@ void RandomWalkSequencer::parameterChanged(const juce::String&, float)
 /**
  * Gets the rate parameter value (step timing)
  */
-int RandomWalkSequencer::getRate() const { return rateValue; }
+int RandomWalkSequencer::getRate() const { return rateValue.load(std::memory_order_relaxed); }
 
 /**
  * Gets the density parameter value (number of active steps)
  */
-int RandomWalkSequencer::getDensity() const { return densityValue; }
+int RandomWalkSequencer::getDensity() const { return densityValue.load(std::memory_order_relaxed); }
 
 /**
  * Gets the offset parameter value (sequence start position)
  */
-int RandomWalkSequencer::getOffset() const { return offsetValue; }
+int RandomWalkSequencer::getOffset() const { return offsetValue.load(std::memory_order_relaxed); }
 
 /**
  * Gets the gate parameter value (note duration)
  */
-float RandomWalkSequencer::getGate() const { return gateValue; }
+float RandomWalkSequencer::getGate() const { return gateValue.load(std::memory_order_relaxed); }
 
 /**
  * Gets the root note parameter value (base MIDI note)
  */
-int RandomWalkSequencer::getRoot() const { return rootValue; }
+int RandomWalkSequencer::getRoot() const { return rootValue.load(std::memory_order_relaxed); }
 
 /**
  * Sets the rate parameter (step timing)
- * Updates timing information when changed
+ * The step duration is recalculated at the start of the next block
  */
-void RandomWalkSequencer::setRate(int value) { rateValue = value; updateTimingInfo(); }
+void RandomWalkSequencer::setRate(int value) { rateValue.store(juce::jlimit(0, 9, value), std::memory_order_relaxed); }
 
 /**
  * Sets the density parameter (number of active steps)
- * Resets current step if it's now outside the loop range
+ * The loop wraps at the new density on the next step
  */
-void RandomWalkSequencer::setDensity(int value)
-{
-    // Only update if value changed
-    if (densityValue != value) {
-        densityValue = value;
-
-        // Reset currentStep if it's now outside the loop range
-        if (currentStep >= densityValue) {
-            currentStep = 0;
-        }
-    }
-}
+void RandomWalkSequencer::setDensity(int value) { densityValue.store(juce::jlimit(1, numSteps, value), std::memory_order_relaxed); }
 
 /**
  * Sets the offset parameter (sequence start position)
  */
-void RandomWalkSequencer::setOffset(int value) { offsetValue = value; }
+void RandomWalkSequencer::setOffset(int value) { offsetValue.store(juce::jlimit(0, numSteps - 1, value), std::memory_order_relaxed); }
 
 /**
  * Sets the gate parameter (note duration)
+ * Only notes that start after the change use the new gate
  */
-void RandomWalkSequencer::setGate(float value) { gateValue = value; }
+void RandomWalkSequencer::setGate(float value) { gateValue.store(value, std::memory_order_relaxed); }
 
 /**
  * Sets the root note parameter (base MIDI note)
  */
-void RandomWalkSequencer::setRoot(int value) { rootValue = value; }
+void RandomWalkSequencer::setRoot(int value) { rootValue.store(value, std::memory_order_relaxed); }
+
+//==============================================================================
+// MIDI output routing and MPE
+//==============================================================================
+
+/**
+ * Sets the MIDI channel for notes outside MPE mode
+ * Takes effect from the next note
+ */
+void RandomWalkSequencer::setOutputChannel(int channel) { outputChannel.store(juce::jlimit(1, 16, channel), std::memory_order_relaxed); }
+
+/**
+ * Gets the MIDI channel for notes outside MPE mode
+ */
+int RandomWalkSequencer::getOutputChannel() const { return outputChannel.load(std::memory_order_relaxed); }
+
+/**
+ * Enables or disables MPE output
+ * Takes effect from the next note; the zone configuration is sent before it
+ */
+void RandomWalkSequencer::setMpeMode(bool shouldUseMpe) { mpeMode.store(shouldUseMpe, std::memory_order_relaxed); }
+
+/**
+ * Returns whether MPE output is enabled
+ */
+bool RandomWalkSequencer::isMpeMode() const { return mpeMode.load(std::memory_order_relaxed); }
+
+/**
+ * Enables or disables following an incoming MIDI clock
+ * The audio thread picks it up at the start of the next block
+ */
+void RandomWalkSequencer::setMidiClockInput(bool shouldFollow) { midiClockInput.store(shouldFollow, std::memory_order_relaxed); }
+
+/**
+ * Returns whether an incoming MIDI clock is followed
+ */
+bool RandomWalkSequencer::isMidiClockInput() const { return midiClockInput.load(std::memory_order_relaxed); }
+
+/**
+ * Enables or disables sending MIDI clock
+ */
+void RandomWalkSequencer::setMidiClockOutput(bool shouldSend) { midiClockOutput.store(shouldSend, std::memory_order_relaxed); }
+
+/**
+ * Returns whether MIDI clock is sent
+ */
+bool RandomWalkSequencer::isMidiClockOutput() const { return midiClockOutput.load(std::memory_order_relaxed); }
+
+/**
+ * Sets the transposition applied to the notes played
+ * The audio thread rebuilds its post-processing at the start of the next block
+ */
+void RandomWalkSequencer::setPostTranspose(int semitones)
+{
+    postTranspose.store(juce::jlimit(-24, 24, semitones), std::memory_order_relaxed);
+    postProcessingVersion.fetch_add(1, std::memory_order_release);
+}
+
+/**
+ * Gets the transposition applied to the notes played
+ */
+int RandomWalkSequencer::getPostTranspose() const { return postTranspose.load(std::memory_order_relaxed); }
+
+/**
+ * Sets the velocity curve applied to the notes played
+ */
+void RandomWalkSequencer::setVelocityCurve(float curve)
+{
+    velocityCurve.store(juce::jlimit(-1.0f, 1.0f, curve), std::memory_order_relaxed);
+    postProcessingVersion.fetch_add(1, std::memory_order_release);
+}
+
+/**
+ * Gets the velocity curve applied to the notes played
+ */
+float RandomWalkSequencer::getVelocityCurve() const { return velocityCurve.load(std::memory_order_relaxed); }
+
+/**
+ * Sets the delay applied to the notes played, in milliseconds
+ */
+void RandomWalkSequencer::setOutputDelay(float milliseconds)
+{
+    outputDelay.store(juce::jlimit(0.0f, maxOutputDelay, milliseconds), std::memory_order_relaxed);
+    postProcessingVersion.fetch_add(1, std::memory_order_release);
+}
+
+/**
+ * Gets the delay applied to the notes played, in milliseconds
+ */
+float RandomWalkSequencer::getOutputDelay() const { return outputDelay.load(std::memory_order_relaxed); }
+
+/**
+ * Rebuilds the post-processing program if a setting changed since it was last built
+ * Building a program doesn't allocate, so this runs on the audio thread. Notes that are
+ * still playing end the way they started, whatever the new settings
+ */
+void RandomWalkSequencer::updatePostProcessing()
+{
+    const auto version = postProcessingVersion.load(std::memory_order_acquire);
+
+    if (version == compiledPostProcessingVersion)
+        return;
+
+    MidiTransforms::Program program;
+    const auto semitones = postTranspose.load(std::memory_order_relaxed);
+    const auto curve = velocityCurve.load(std::memory_order_relaxed);
+    const auto delayInSamples = juce::roundToInt(outputDelay.load(std::memory_order_relaxed) * 0.001 * sampleRate);
+
+    if (semitones != 0)
+        program.transpose(semitones);
+
+    if (curve != 0.0f)
+        program.velocityCurve(curve);
+
+    if (delayInSamples > 0)
+        program.delay(delayInSamples);
+
+    postProcessing.setProgram(program);
+    compiledPostProcessingVersion = version;
+}
+
+/**
+ * Sets the value of an expression lane for a step
+ */
+void RandomWalkSequencer::setStepExpression(ExpressionLane lane, int step, float value)
+{
+    if (juce::isPositiveAndBelow(lane, numExpressionLanes) && juce::isPositiveAndBelow(step, numSteps))
+        stepExpression[lane][step].store(juce::jlimit(getExpressionLaneMinimum(lane), 1.0f, value),
+                                         std::memory_order_relaxed);
+}
+
+/**
+ * Gets the value of an expression lane for a step
+ */
+float RandomWalkSequencer::getStepExpression(ExpressionLane lane, int step) const
+{
+    if (juce::isPositiveAndBelow(lane, numExpressionLanes) && juce::isPositiveAndBelow(step, numSteps))
+        return stepExpression[lane][step].load(std::memory_order_relaxed);
+
+    return 0.0f;
+}
 
 //==============================================================================
 // Core Sequencer Functionality
@@ -617,8 +1527,9 @@ void RandomWalkSequencer::setRoot(int value) { rootValue = value; }
 void RandomWalkSequencer::randomizeSequence(int patternType)
 {
     // Save the current enabled states if in manual mode
+    const bool isManual = isManualStepMode();
     bool savedEnabledStates[numSteps];
-    if (manualStepMode)
+    if (isManual)
     {
         for (int i = 0; i < numSteps; ++i)
         {
@@ -626,30 +1537,12 @@ void RandomWalkSequencer::randomizeSequence(int patternType)
         }
     }
 
-    switch (patternType)
-    {
-        case 0: // Random walk
-            generateRandomWalk();
-        break;
-
-        case 1: // Ascending
-            generateAscendingPattern();
-        break;
-
-        case 2: // Descending
-            generateDescendingPattern();
-        break;
-
-        case 3: // Arpeggio
-            generateArpeggioPattern();
-        break;
-
-        default:
-            generateRandomWalk();
-    }
+    // The pattern types' generators are picked from the engine's table
+    juce::Random random;
+    Engine::generatePattern(patternType, sequence, random);
 
     // Restore the enabled states if in manual mode
-    if (manualStepMode)
+    if (isManual)
     {
         for (int i = 0; i < numSteps; ++i)
         {
@@ -657,9 +1550,9 @@ void RandomWalkSequencer::randomizeSequence(int patternType)
         }
     }
 
-    // Notify that sequence has changed (useful for GUI updates)
-    if (auto* editor = dynamic_cast<RandomWalkSequencerEditor*>(getActiveEditor()))
-        editor->repaint();
+    markPatternChanged();
+
+    // The editor's timer picks up the new sequence on its next refresh
 }
 
 /**
@@ -668,35 +1561,41 @@ void RandomWalkSequencer::randomizeSequence(int patternType)
  */
 void RandomWalkSequencer::setPlaying(bool shouldPlay)
 {
+    // The step clock and the step counter belong to the audio thread, so they're reset
+    // there, by applyPlayRequest. A later request replaces one it hasn't applied yet
+    playRequest.store(shouldPlay ? startRequest : stopRequest, std::memory_order_release);
+
+    // Any note still sounding is turned off by the next processBlock: at the first
+    // step when starting, or immediately at sample 0 when stopped
+}
+
+/**
+ * Starts or stops playback as the UI last asked
+ * Called at the start of every block, before the host transport is read, so a host that's
+ * synced to still has the last word
+ */
+void RandomWalkSequencer::applyPlayRequest()
+{
+    const int request = playRequest.exchange(noPlayRequest, std::memory_order_acquire);
+
+    if (request == noPlayRequest)
+        return;
+
+    const bool shouldPlay = request == startRequest;
+
     // Only update if the state is actually changing
-    if (isPlaying != shouldPlay)
+    if (isPlaying.load(std::memory_order_relaxed) != shouldPlay)
     {
-        isPlaying = shouldPlay;
+        isPlaying.store(shouldPlay, std::memory_order_relaxed);
 
-        // If starting playback, reset counters and stop any hanging notes
-        if (isPlaying)
+        // If starting playback, reset counters
+        if (shouldPlay)
         {
-            sampleCounter = 0.0;
-            currentStep = numSteps - 1; // Will increment to 0 on first step
-
-            // Make sure no notes are left on
-            if (noteIsOn)
-            {
-                juce::MidiMessage noteOff = juce::MidiMessage::noteOff(1, lastNoteValue, (juce::uint8) 0);
-                juce::MidiBuffer tempBuffer;
-                tempBuffer.addEvent(noteOff, 0);
-                noteIsOn = false;
-            }
+            stepClock.restart();
+            currentStep.store(numSteps - 1, std::memory_order_relaxed); // Will increment to 0 on first step
+            lookaheadNeedsPriming = true;
         }
     }
-    if (!shouldPlay && noteIsOn)
-    {
-        // Send a note off message immediately when stopping
-        juce::MidiMessage noteOff = juce::MidiMessage::noteOff(1, lastNoteValue, (juce::uint8) 0);
-        juce::MidiBuffer tempBuffer;
-        tempBuffer.addEvent(noteOff, 0);
-        noteIsOn = false;
-    }
 }
 
 /**
@@ -712,8 +1611,10 @@ void RandomWalkSequencer::setSequenceValue(int step, int value)
         // Limit value to reasonable range (-12 to +12 semitones)
         value = juce::jlimit(-12, 12, value);
 
-        // Update the sequence
+        // Update the sequence, on top of the first pattern if it's still to come
+        generatePatternIfPending();
         sequence[step] = value;
+        markPatternChanged();
     }
 }
 
@@ -723,105 +1624,105 @@ void RandomWalkSequencer::setSequenceValue(int step, int value)
  */
 bool RandomWalkSequencer::getIsPlaying() const
 {
-    return isPlaying;
-}
+    // A request the audio thread hasn't applied yet is what it's about to do
+    const int request = playRequest.load(std::memory_order_acquire);
 
-/**
- * Returns the name of the sequencer
- */
-const juce::String RandomWalkSequencer::getName() const
-{
-    return "RandomWalkSequencer";
+    if (request != noPlayRequest)
+        return request == startRequest;
+
+    return isPlaying.load(std::memory_order_relaxed);
 }
 
 /**
  * Updates timing information based on BPM and rate settings
  * Handles host transport sync if enabled
  */
-void RandomWalkSequencer::updateTimingInfo()
+void RandomWalkSequencer::updateTimingInfo(const TimingContext& timing)
 {
-    auto* playHead = getPlayHead();
-
     // Reset sample counter at appropriate moments to ensure tight sync
     double oldBpm = bpm;
 
-    if (playHead != nullptr && syncToHostTransport)
+    if (followingMidiClock)
     {
-        juce::Optional<juce::AudioPlayHead::PositionInfo> posInfo = playHead->getPosition();
+        // An external clock drives both the transport and the tempo. The steps follow
+        // it while it's locked and running (or until it stopped inside this block), and
+        // processBlock lines them up with the clock's grid, so a tempo change needs no restart
+        const bool clockIsPlaying = midiClockFollower.isLocked()
+                                    && (midiClockFollower.isRunning() || midiClockFollower.hasStoppedInBlock());
+
+        if (midiClockFollower.isLocked())
+            bpm = midiClockFollower.getBpm();
+
+        const bool playing = isPlaying.load(std::memory_order_relaxed);
+
+        if (clockIsPlaying && !playing)
+        {
+            isPlaying.store(true, std::memory_order_relaxed);
+            currentStep.store(numSteps - 1, std::memory_order_relaxed);
+            lookaheadNeedsPriming = true;
+        }
+        else if (!clockIsPlaying && playing)
+        {
+            isPlaying.store(false, std::memory_order_relaxed);
+        }
+
+        updateStepDuration();
+        return;
+    }
 
-        if (posInfo.hasValue())
+    if (syncToHostTransport.load(std::memory_order_relaxed))
+    {
+        if (timing.hasHostPosition)
         {
             // Update BPM from host if available and synced
-            if (posInfo->getBpm().hasValue())
-                bpm = *posInfo->getBpm();
+            if (timing.hostBpm > 0.0)
+                bpm = timing.hostBpm;
 
             // Only control playback if we're synced to host
-            bool hostIsPlaying = posInfo->getIsPlaying();
+            bool hostIsPlaying = timing.hostIsPlaying;
+            const bool playing = isPlaying.load(std::memory_order_relaxed);
 
-            // This section is crucial - make sure to get the correct playing state
-            if (hostIsPlaying && !isPlaying)
+            // This section is crucial - make sure to get the correct playing state.
+            // A note left sounding is turned off by processBlock, never from here,
+            // since this runs on the audio thread and must not allocate
+            if (hostIsPlaying && !playing)
             {
-                // Debug info - helps track down sync issues
-                DEBUG_LOG("Host started playing - starting sequencer");
-
                 // Start the sequencer
-                isPlaying = true;
-                currentStep = numSteps - 1; // Will increment to 0 on first step
-                sampleCounter = 0.0;
-
-                // Make sure no notes are left on
-                if (noteIsOn)
-                {
-                    juce::MidiMessage noteOff = juce::MidiMessage::noteOff(1, lastNoteValue, (juce::uint8) 0);
-                    juce::MidiBuffer tempBuffer;
-                    tempBuffer.addEvent(noteOff, 0);
-                    noteIsOn = false;
-                }
+                isPlaying.store(true, std::memory_order_relaxed);
+                currentStep.store(numSteps - 1, std::memory_order_relaxed); // Will increment to 0 on first step
+                stepClock.restart();
+                lookaheadNeedsPriming = true;
             }
-            else if (!hostIsPlaying && isPlaying)
+            else if (!hostIsPlaying && playing)
             {
-                // Debug info
-                DEBUG_LOG("Host stopped playing - stopping sequencer");
-
                 // Stop the sequencer
-                isPlaying = false;
-
-                // Make sure no notes are left on
-                if (noteIsOn)
-                {
-                    juce::MidiMessage noteOff = juce::MidiMessage::noteOff(1, lastNoteValue, (juce::uint8) 0);
-                    juce::MidiBuffer tempBuffer;
-                    tempBuffer.addEvent(noteOff, 0);
-                    noteIsOn = false;
-                }
+                isPlaying.store(false, std::memory_order_relaxed);
             }
         }
     }
-    else if (!syncToHostTransport)
+    else
     {
         // When not synced to host, use internal BPM
-        bpm = internalBpm;
+        bpm = getInternalBpm();
     }
 
-    // Check for BPM changes and reset sample counter if needed
+    // Check for BPM changes and restart the step if needed
     if (std::abs(oldBpm - bpm) > 0.01)
     {
-        DEBUG_LOG("BPM changed from " << oldBpm << " to " << bpm);
-        sampleCounter = 0.0;
+        stepClock.restart();
+        lookaheadNeedsPriming = true;
     }
 
-    // Calculate timing values
-    samplesPerBeat = (60.0 / bpm) * sampleRate;
-    stepDuration = samplesPerBeat * getRateInSeconds();
-
-    // Debug timing values
-    if (isPlaying) {
-        static int debugCounter = 0;
-        if (++debugCounter % 100 == 0) { // Limit debug output
-            DEBUG_LOG("Timing: BPM=" << bpm << ", samplesPerBeat=" << samplesPerBeat
-                      << ", stepDuration=" << stepDuration);
-        }
-    }
+    updateStepDuration();
+}
+
+/**
+ * Recalculates the step duration from the current tempo, rate and sample rate
+ * The step clock keeps the exact length, so no fraction of a sample is ever lost
+ */
+void RandomWalkSequencer::updateStepDuration()
+{
+    stepClock.setStepLength(StepClock::getSampleLength(sampleRate, bpm, Engine::getStepLengthInTicks(getRate())));
 }
 
 /**
@@ -831,8 +1732,7 @@ void RandomWalkSequencer::updateTimingInfo()
 float RandomWalkSequencer::getRateInSeconds() const
 {
     // Convert rate parameter to actual timing value
-    const float rateValues[] = { 1.0f/32.0f, 1.0f/16.0f, 1.0f/8.0f, 1.0f/4.0f, 1.0f/3.0f, 1.0f/2.0f, 1.0f, 2.0f, 3.0f, 4.0f };
-    return rateValues[rateValue];
+    return (float) Engine::getStepLengthInBeats(getRate());
 }
 
 /**
@@ -842,176 +1742,29 @@ float RandomWalkSequencer::getRateInSeconds() const
 void RandomWalkSequencer::generateRandomWalk()
 {
     juce::Random random;
-
-    // Parameters for enhanced random walk with much more variability
-    const int maxJump = 7;              // Increased maximum basic step size
-    const int maxRange = 12;            // Maximum range (one octave)
-    const float stayProb = 0.05f;       // Reduced probability to stay on same note
-    const float bigJumpProb = 0.25f;    // Increased probability for larger jumps
-    const float patternBreakProb = 0.1f; // Probability to break a pattern completely
-    const float resetProb = 0.05f;      // Probability to reset to center
-
-    // Start from a random point rather than always the middle
-    int currentValue = random.nextInt(maxRange * 2 + 1) - maxRange;
-    sequence[0] = currentValue;
-
-    int prevDirection = 0;
-    int consecutiveSteps = 0;
-
-    // Generate pattern with more deliberate changes in direction
-    for (int i = 1; i < numSteps; ++i)
-    {
-        // Occasionally reset to create phrases
-        if (random.nextFloat() < resetProb) {
-            currentValue = random.nextInt(maxRange * 2 + 1) - maxRange; // Random reset point
-            consecutiveSteps = 0;
-            prevDirection = 0;
-        }
-        // Decide if we should break the pattern
-        else if (random.nextFloat() < patternBreakProb || consecutiveSteps > 3) {
-            // Force a direction change to break monotony
-            prevDirection = prevDirection == 0 ? (random.nextBool() ? 1 : -1) : -prevDirection;
-
-            // Make a significant jump to break the pattern
-            int jumpSize = 3 + random.nextInt(9); // Jumps of 3 to 12 semitones
-            currentValue += prevDirection * jumpSize;
-            consecutiveSteps = 0;
-        }
-        // Stay on same note occasionally
-        else if (random.nextFloat() < stayProb) {
-            // Do nothing - stay on same note
-            consecutiveSteps = 0;
-        }
-        else {
-            // Choose a direction that might be different from previous
-            int direction;
-
-            if (consecutiveSteps >= 2 && random.nextFloat() < 0.7f) {
-                // After 2+ steps in same direction, higher chance of change
-                direction = -prevDirection;
-            } else {
-                // Random direction with slight bias toward previous
-                direction = (random.nextFloat() < 0.4f) ?
-                    -prevDirection : (prevDirection != 0 ? prevDirection : (random.nextBool() ? 1 : -1));
-            }
-
-            // Determine step size with more variety
-            int stepSize;
-            if (random.nextFloat() < bigJumpProb) {
-                // Larger jumps for more variety
-                stepSize = 4 + random.nextInt(maxJump);
-            } else {
-                // Use different step size distribution
-                // Higher probability of 1,2,3 steps, lower for larger steps
-                float r = random.nextFloat();
-                if (r < 0.5f)
-                    stepSize = 1;
-                else if (r < 0.8f)
-                    stepSize = 2;
-                else
-                    stepSize = 3 + random.nextInt(maxJump - 2);
-            }
-
-            // Apply the step
-            currentValue += direction * stepSize;
-
-            // Update tracking variables
-            if (direction == prevDirection)
-                consecutiveSteps++;
-            else {
-                prevDirection = direction;
-                consecutiveSteps = 1;
-            }
-        }
-
-        // Keep within range but with soft boundaries
-        if (currentValue > maxRange) {
-            if (random.nextFloat() < 0.7f) {
-                // Usually reflect back
-                currentValue = maxRange - (currentValue - maxRange);
-                prevDirection = -prevDirection;
-            } else {
-                // Sometimes just clamp
-                currentValue = maxRange;
-            }
-        } else if (currentValue < -maxRange) {
-            if (random.nextFloat() < 0.7f) {
-                // Usually reflect back
-                currentValue = -maxRange + (-maxRange - currentValue);
-                prevDirection = -prevDirection;
-            } else {
-                // Sometimes just clamp
-                currentValue = -maxRange;
-            }
-        }
-
-        // Store the value
-        sequence[i] = currentValue;
-    }
-
-    // Add a final pass to ensure melodic interest
-    enhanceSequenceMelodically();
+    RandomWalkPattern::generate(sequence, random);
+    markPatternChanged();
 
     DEBUG_LOG("Random walk sequence generated");
 }
 
 /**
- * Helper method to enhance the musical quality of the sequence
- * Breaks up repetitive patterns and adds accents/octave jumps
- */
-void RandomWalkSequencer::enhanceSequenceMelodically()
-{
-    juce::Random random;
-
-    // Find any boring sections (3+ consecutive steps in same direction)
-    for (int i = 2; i < numSteps-1; i++) {
-        int diff1 = sequence[i] - sequence[i-1];
-        int diff2 = sequence[i-1] - sequence[i-2];
-
-        // If we have 3 steps moving in the same direction with same interval
-        if (diff1 == diff2 && diff1 != 0) {
-            // Break the pattern by adding a jump or change
-            if (random.nextBool()) {
-                // Reverse direction
-                sequence[i+1] = sequence[i] - diff1;
-            } else {
-                // Make a jump
-                sequence[i+1] = sequence[i] + (random.nextBool() ? 3 : -3);
-            }
-            i++; // Skip the fixed note
-        }
-    }
-
-    // Create a few accents by adding octave jumps
-    int numAccents = 1 + random.nextInt(2); // 1-2 accents
-    for (int i = 0; i < numAccents; i++) {
-        int pos = 2 + random.nextInt(numSteps - 3); // Not too close to start/end
-        // Jump up or down an octave if within range
-        int newValue = sequence[pos] + (random.nextBool() ? 12 : -12);
-        if (newValue >= -12 && newValue <= 12) {
-            sequence[pos] = newValue;
-        }
-    }
-}
-
-/**
- * Calculates the MIDI note value for a specific step
- * @param step The step index
- * @return MIDI note value (root + offset)
+ * Generates the first random walk, if no pattern has been set or restored yet
  */
-int RandomWalkSequencer::getNoteForStep(int step)
+void RandomWalkSequencer::generatePatternIfPending()
 {
-    // step is already offset-adjusted, so use it directly to access the sequence array
-    return rootValue + sequence[step];
+    if (patternPending.load(std::memory_order_acquire))
+        generateRandomWalk();
 }
 
 /**
  * Calculates the duration of a note based on gate time
+ * @param gate The gate as a proportion of the step duration
  * @return Note duration in samples
  */
-double RandomWalkSequencer::getNoteLength()
+juce::int64 RandomWalkSequencer::getNoteLength(float gate) const
 {
-    return stepDuration * gateValue;
+    return (juce::int64) ((double) stepClock.getCurrentStepLength() * gate);
 }
 
 /**
@@ -1020,15 +1773,9 @@ double RandomWalkSequencer::getNoteLength()
  */
 void RandomWalkSequencer::setInternalBpm(double newBpm)
 {
-    // Limit BPM to a reasonable range
-    internalBpm = juce::jlimit(30.0, 300.0, newBpm);
-
-    // Only update timing if we're not synced to host
-    if (!syncToHostTransport)
-    {
-        bpm = internalBpm;
-        updateTimingInfo();
-    }
+    // Limit BPM to a reasonable range. When we're not synced to host,
+    // the audio thread picks it up at the start of the next block
+    internalBpm.store(juce::jlimit(30.0, 300.0, newBpm), std::memory_order_relaxed);
 }
 
 /**
@@ -1038,10 +1785,12 @@ void RandomWalkSequencer::setInternalBpm(double newBpm)
 void RandomWalkSequencer::transposeOctaveUp()
 {
     // Don't transpose above C9 (MIDI note 120)
-    if (rootValue <= 108) // C9 - 12 = 108 to ensure we can go up one octave
+    auto root = getRoot();
+
+    if (root <= 108) // C9 - 12 = 108 to ensure we can go up one octave
     {
-        rootValue += 12;
-        DEBUG_LOG("Transposed up one octave: Root = " << rootValue);
+        setRoot(root + 12);
+        DEBUG_LOG("Transposed up one octave: Root = " << root + 12);
     }
     else
     {
@@ -1057,10 +1806,12 @@ void RandomWalkSequencer::transposeOctaveUp()
 void RandomWalkSequencer::transposeOctaveDown()
 {
     // Don't transpose below C0 (MIDI note 12)
-    if (rootValue >= 24) // C0 + 12 = 24 to ensure we can go down one octave
+    auto root = getRoot();
+
+    if (root >= 24) // C0 + 12 = 24 to ensure we can go down one octave
     {
-        rootValue -= 12;
-        DEBUG_LOG("Transposed down one octave: Root = " << rootValue);
+        setRoot(root - 12);
+        DEBUG_LOG("Transposed down one octave: Root = " << root - 12);
     }
     else
     {
@@ -1081,9 +1832,7 @@ void RandomWalkSequencer::setMonoMode()
         sequence[i] = 0; // 0 means no offset, so it will play the root note
     }
 
-    // If we have an editor, update the display
-    if (auto* editor = dynamic_cast<RandomWalkSequencerEditor*>(getActiveEditor()))
-        editor->repaint();
+    markPatternChanged();
 
     DEBUG_LOG("Set all steps to mono (root note)");
 }
\ No newline at end of file
@@ -1,15 +1,25 @@
 #pragma once
 
 #include <JuceHeader.h>
-
-// Forward declaration
-class RandomWalkSequencerEditor;
+#include <atomic>
+#include "LinkGroup.h"
+#include "LookaheadRenderer.h"
+#include "MidiClock.h"
+#include "MpeChannelAllocator.h"
+#include "PatternMorph.h"
+#include "MidiFileWriter.h"
+#include "SequencerEngine.h"
+#include "StepClock.h"
+#include "TimingContext.h"
 
 /**
  * Main sequencer class that implements a MIDI step sequencer with random walk capabilities
  * Generates MIDI notes based on various step patterns and settings
+ *
+ * This is the plain sequencing core: the plugin's AudioPluginAudioProcessor owns one,
+ * and passes it the host timing for every block through a TimingContext
  */
-class RandomWalkSequencer : public juce::AudioProcessor
+class RandomWalkSequencer
 {
 public:
     /**
@@ -20,117 +30,56 @@ public:
     /**
      * Destructor - cleans up any allocated resources
      */
-    ~RandomWalkSequencer() override;
+    ~RandomWalkSequencer();
 
     //==============================================================================
-    // AudioProcessor methods
+    // Processing methods
 
     /**
      * Prepares the sequencer for playback
      * Initializes timing parameters based on sample rate
      */
-    void prepareToPlay(double sampleRate, int samplesPerBlock) override;
+    void prepareToPlay(double sampleRate, int samplesPerBlock);
 
     /**
      * Releases resources when the sequencer is no longer needed
      * Ensures no hanging MIDI notes remain
      */
-    void releaseResources() override;
+    void releaseResources();
 
     /**
      * Main processing method - generates MIDI notes based on the current sequence
+     * Generated events are added to the incoming MIDI, which is passed through
+     * @param midiMessages The block's MIDI buffer, used for both input and output
+     * @param numSamples Number of samples in this block
+     * @param timing Host timing information for this block
      */
-    void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
-
-    /**
-     * Checks if the provided bus layout is compatible with this sequencer
-     */
-    bool isBusesLayoutSupported(const BusesLayout& layouts) const override;
-
-    //==============================================================================
-    // Editor methods
-
-    /**
-     * Creates the editor component for the sequencer UI
-     */
-    juce::AudioProcessorEditor* createEditor() override;
-
-    /**
-     * Indicates whether this sequencer has a custom editor
-     */
-    bool hasEditor() const override;
-
-    //==============================================================================
-    // Plugin properties
-
-    /**
-     * Returns the name of the sequencer
-     */
-    const juce::String getName() const override;
-
-    /**
-     * Indicates if the sequencer can receive MIDI input
-     */
-    bool acceptsMidi() const override { return true; } // Match NEEDS_MIDI_INPUT=TRUE
-
-    /**
-     * Indicates if the sequencer outputs MIDI messages
-     */
-    bool producesMidi() const override { return true; } // Match NEEDS_MIDI_OUTPUT=TRUE
-
-    /**
-     * Indicates if this is a MIDI effect (rather than an audio processor)
-     */
-    bool isMidiEffect() const override { return true; } // Since it's a MIDI processor
-
-    /**
-     * Returns the tail time of the sequencer in seconds
-     */
-    double getTailLengthSeconds() const override { return 0.0; }
+    void processBlock(juce::MidiBuffer& midiMessages, int numSamples, const TimingContext& timing);
 
     //==============================================================================
-    // Program handling
-
-    /**
-     * Returns the number of programs (presets) available
-     */
-    int getNumPrograms() override { return 1; }
-
-    /**
-     * Returns the current program (preset) index
-     */
-    int getCurrentProgram() override { return 0; }
-
-    /**
-     * Sets the current program (preset) to the specified index
-     */
-    void setCurrentProgram(int) override {}
-
-    /**
-     * Gets the name of the specified program (preset)
-     */
-    const juce::String getProgramName(int) override { return {}; }
+    // State handling
 
     /**
-     * Changes the name of the specified program (preset)
+     * Saves the current state of the sequencer as XML
      */
-    void changeProgramName(int, const juce::String&) override {}
-
-    //==============================================================================
-    // State handling
+    std::unique_ptr<juce::XmlElement> createStateXml() const;
 
     /**
-     * Saves the current state of the sequencer to the provided memory block
+     * Restores the sequencer state from XML previously created by createStateXml
      */
-    void getStateInformation(juce::MemoryBlock& destData) override;
+    void restoreStateFromXml(const juce::XmlElement& xml);
 
     /**
-     * Restores the sequencer state from the provided data
+     * Writes what the sequencer plays as a Standard MIDI File, at the internal tempo
+     * Covers a number of passes of the loop, as the current parameters lay it out
+     * @param numLoops Number of passes of the loop, limited to what fits in the file
      */
-    void setStateInformation(const void* data, int sizeInBytes) override;
+    void exportMidiFile(int numLoops, juce::MemoryBlock& destination) const;
 
     //==============================================================================
     // Parameter access methods
+    // These are safe to call from any thread: each one is a single relaxed atomic load or
+    // store, and the audio thread picks up new values at the next step boundary
 
     /**
      * Gets the rate parameter value (step timing)
@@ -202,6 +151,15 @@ public:
      */
     void generateRandomWalk();
 
+    /**
+     * Generates the first pattern, unless one has been set or restored already
+     * The constructor leaves it for later, so constructing the sequencer stays cheap.
+     * prepareToPlay, the editor, restoring a state and editing a step all call this
+     * first; until then the pattern reads as all root notes, and is left out of saved states.
+     * Message thread only: saving a state, which hosts do from any thread, never calls it
+     */
+    void generatePatternIfPending();
+
     /**
      * Generates an ascending pattern sequence
      */
@@ -227,11 +185,12 @@ public:
 
     /**
      * Starts or stops the sequencer playback
+     * Only asks for it: the audio thread starts or stops at the start of its next block
      */
     void setPlaying(bool shouldPlay);
 
     /**
-     * Returns whether the sequencer is currently playing
+     * Returns whether the sequencer is currently playing, or has been asked to
      */
     bool getIsPlaying() const;
 
@@ -241,7 +200,76 @@ public:
     /**
      * Sets whether the sequencer should sync to the host's transport
      */
-    void setSyncToHostTransport(bool shouldSync) { syncToHostTransport = shouldSync; }
+    void setSyncToHostTransport(bool shouldSync) { syncToHostTransport.store(shouldSync, std::memory_order_relaxed); }
+
+    /**
+     * Enables or disables following an incoming MIDI clock
+     * While it's on, the clock's start, stop, continue and song position messages drive
+     * the transport and its tempo drives the steps, in place of the host or the internal
+     * BPM. Clock messages are passed through, so no clock is sent while following
+     */
+    void setMidiClockInput(bool shouldFollow);
+
+    /**
+     * Returns whether an incoming MIDI clock is followed
+     */
+    bool isMidiClockInput() const;
+
+    /**
+     * Enables or disables sending MIDI clock, with a start at the first step and a stop
+     * when playback stops
+     */
+    void setMidiClockOutput(bool shouldSend);
+
+    /**
+     * Returns whether MIDI clock is sent
+     */
+    bool isMidiClockOutput() const;
+
+    /**
+     * Gets the tempo of the followed MIDI clock, or 0 while there's no clock to follow
+     */
+    double getMidiClockBpm() const { return midiClockBpm.load(std::memory_order_relaxed); }
+
+    /**
+     * Longest output delay, in milliseconds
+     */
+    static constexpr float maxOutputDelay = 500.0f;
+
+    /**
+     * Sets the transposition applied to every note played, after the walk and any link
+     * interval, in the post-processing stage
+     * @param semitones -24 to 24
+     */
+    void setPostTranspose(int semitones);
+
+    /**
+     * Gets the transposition applied to every note played
+     */
+    int getPostTranspose() const;
+
+    /**
+     * Sets the velocity curve applied to every note played
+     * @param curve 0 leaves velocities as they are, towards 1 louder, towards -1 softer
+     */
+    void setVelocityCurve(float curve);
+
+    /**
+     * Gets the velocity curve applied to every note played
+     */
+    float getVelocityCurve() const;
+
+    /**
+     * Sets a delay applied to everything the sequencer plays, for lining its output up
+     * with other tracks. MIDI clock that's sent isn't delayed
+     * @param milliseconds 0 to maxOutputDelay
+     */
+    void setOutputDelay(float milliseconds);
+
+    /**
+     * Gets the delay applied to everything the sequencer plays, in milliseconds
+     */
+    float getOutputDelay() const;
 
     //==============================================================================
     // Public accessor methods for StepDisplay
@@ -249,7 +277,7 @@ public:
     /**
      * Gets the current step being played
      */
-    int getCurrentStep() const { return currentStep; }
+    int getCurrentStep() const { return currentStep.load(std::memory_order_relaxed); }
 
     /**
      * Gets the note value for a specific step in the sequence
@@ -278,7 +306,7 @@ public:
     /**
      * Returns whether manual step mode is active
      */
-    bool isManualStepMode() const { return manualStepMode; }
+    bool isManualStepMode() const { return manualStepMode.load(std::memory_order_relaxed); }
 
     /**
      * Resets all steps to enabled state
@@ -286,127 +314,628 @@ public:
     void resetEnabledSteps();
 
     /**
-     * Determines if buses can be added to this processor
+     * Gets whether the sequencer is synced to host transport
+     */
+    bool getSyncToHostTransport() const { return syncToHostTransport.load(std::memory_order_relaxed); }
+
+    /**
+     * Gets the internal BPM setting
+     */
+    double getInternalBpm() const { return internalBpm.load(std::memory_order_relaxed); }
+
+    /**
+     * Sets the internal BPM value (used when not synced to host)
+     */
+    void setInternalBpm(double newBpm);
+
+    /**
+     * Transposes the root note up by one octave
+     */
+    void transposeOctaveUp();
+
+    /**
+     * Transposes the root note down by one octave
+     */
+    void transposeOctaveDown();
+
+    /**
+     * Sets all sequence steps to play the root note (mono mode)
+     */
+    void setMonoMode();
+
+    //==============================================================================
+    // MIDI output routing and MPE
+
+    /**
+     * Per-step expression lanes, sent as per-note expression in MPE mode
      */
-    bool canAddBus(bool /*isInput*/) const override
+    enum ExpressionLane
     {
-        return false;  // Don't allow adding buses
-    }
+        glideLane,    // Pitch glide over the note, -1 to 1 (scaled by maxGlideSemitones)
+        pressureLane, // Channel pressure, 0 to 1
+        timbreLane,   // CC74 (MPE timbre), 0 to 1
+        numExpressionLanes
+    };
+
+    /**
+     * Largest pitch glide, reached when a step's glide lane is at -1 or 1
+     */
+    static constexpr int maxGlideSemitones = 12;
+
+    /**
+     * Per-note pitch bend range announced in the MPE zone configuration
+     */
+    static constexpr int mpePitchbendRange = 48;
 
     /**
-     * Determines if buses can be removed from this processor
+     * Sets the MIDI channel (1-16) for notes when MPE mode is off
      */
-    bool canRemoveBus(bool /*isInput*/) const override
+    void setOutputChannel(int channel);
+
+    /**
+     * Gets the MIDI channel used for notes when MPE mode is off
+     */
+    int getOutputChannel() const;
+
+    /**
+     * Enables or disables MPE output
+     * In MPE mode every note gets its own member channel of the lower zone (2-16),
+     * and the expression lanes are sent on that channel
+     */
+    void setMpeMode(bool shouldUseMpe);
+
+    /**
+     * Returns whether MPE output is enabled
+     */
+    bool isMpeMode() const;
+
+    /**
+     * Sets the value of an expression lane for a step
+     * @param lane The expression lane
+     * @param step The step index
+     * @param value The new value, clamped to the lane's range
+     */
+    void setStepExpression(ExpressionLane lane, int step, float value);
+
+    /**
+     * Gets the value of an expression lane for a step
+     */
+    float getStepExpression(ExpressionLane lane, int step) const;
+
+    /**
+     * Gets the lowest value an expression lane can take (-1 for glide, 0 otherwise)
+     */
+    static float getExpressionLaneMinimum(ExpressionLane lane) { return lane == glideLane ? -1.0f : 0.0f; }
+
+    //==============================================================================
+    // Link groups
+
+    /**
+     * What an instance does in its link group
+     */
+    enum LinkRole
     {
-        return false;  // Don't allow removing buses
-    }
+        leadRole,      // Plays its own walk, and publishes it if it's the group's leader
+        harmonizeRole, // Plays the leader's notes on the same steps, shifted by the interval
+        canonRole      // Plays the leader's notes a number of steps later, shifted by the interval
+    };
 
     /**
-     * Indicates if double precision processing is supported
+     * Joins a link group (1 to LinkGroup::maxGroups), or leaves it with 0
+     * Linked instances share their step grid, which needs the host transport to be running
      */
-    bool supportsDoublePrecisionProcessing() const override;
+    void setLinkGroup(int groupId);
 
     /**
-     * Gets the current processing precision
+     * Gets the link group ID, 0 if not linked
      */
-    juce::AudioProcessor::ProcessingPrecision getProcessingPrecision() const;
+    int getLinkGroup() const;
 
     /**
-     * Processes a block when the processor is bypassed
+     * Sets the role in the link group
      */
-    void processBlockBypassed(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages) override;
+    void setLinkRole(LinkRole role);
 
     /**
-     * Gets whether the sequencer is synced to host transport
+     * Gets the role in the link group
      */
-    bool getSyncToHostTransport() const { return syncToHostTransport; }
+    LinkRole getLinkRole() const;
 
     /**
-     * Gets the internal BPM setting
+     * Sets the interval (in semitones) that followers add to the leader's notes
      */
-    double getInternalBpm() const { return internalBpm; }
+    void setLinkInterval(int semitones);
 
     /**
-     * Sets the internal BPM value (used when not synced to host)
+     * Gets the interval that followers add to the leader's notes
      */
-    void setInternalBpm(double newBpm);
+    int getLinkInterval() const;
 
     /**
-     * Transposes the root note up by one octave
+     * Sets how many steps a canon follower plays behind the leader
      */
-    void transposeOctaveUp();
+    void setCanonDelay(int steps);
 
     /**
-     * Transposes the root note down by one octave
+     * Gets how many steps a canon follower plays behind the leader
      */
-    void transposeOctaveDown();
+    int getCanonDelay() const;
 
     /**
-     * Sets all sequence steps to play the root note (mono mode)
+     * Returns whether this instance is currently leading its link group
      */
-    void setMonoMode();
+    bool isLinkLeader() const { return linkLeading.load(std::memory_order_relaxed); }
+
+    //==============================================================================
+    // Morphing
+
+    /**
+     * The A/B slots, one stored step per sequence step
+     */
+    using Morph = PatternMorph<16>;
+
+    /**
+     * Stores the current pattern, with the velocities it plays at and the current gate, in a slot
+     */
+    void storeMorphSlot(Morph::Slot slot);
+
+    /**
+     * Copies a slot's notes and enabled steps back into the pattern
+     */
+    void recallMorphSlot(Morph::Slot slot);
+
+    /**
+     * Enables or disables morphing: while it's on, the notes come from the slots
+     */
+    void setMorphEnabled(bool shouldMorph);
+
+    /**
+     * Returns whether morphing is on
+     */
+    bool isMorphEnabled() const;
+
+    /**
+     * Sets the morph control, from 0 (A) to 1 (B)
+     */
+    void setMorphAmount(float amount);
+
+    /**
+     * Gets the morph control
+     */
+    float getMorphAmount() const;
+
+    /**
+     * Bar counts the morph can take, as the editor offers them; 0 follows the control at once
+     */
+    static constexpr int morphBarChoices[] = { 0, 1, 2, 4, 8, 16 };
+
+    /**
+     * Sets how many bars the morph takes to reach the control, 0 to follow it at once
+     * Snapped down to one of morphBarChoices
+     */
+    void setMorphBars(int numBars);
+
+    /**
+     * Gets how many bars the morph takes to reach the control
+     */
+    int getMorphBars() const;
+
+    /**
+     * Sets how the steps get from A to B
+     */
+    void setMorphMode(Morph::Mode mode);
+
+    /**
+     * Gets how the steps get from A to B
+     */
+    Morph::Mode getMorphMode() const;
+
+    /**
+     * Gets where the morph is now, which trails the control when it takes a number of bars
+     */
+    float getMorphPosition() const { return morphPosition.load(std::memory_order_relaxed); }
+
+    /**
+     * Gets the slots, to edit their steps one by one
+     */
+    Morph& getMorph() { return morph; }
+
+    //==============================================================================
+    // Evolving
+
+    /**
+     * Enables or disables evolve mode: at every wrap of the loop, the audio thread
+     * continues the walk at a few steps, leaving the stored pattern as it is
+     */
+    void setEvolveEnabled(bool shouldEvolve);
+
+    /**
+     * Returns whether evolve mode is on
+     */
+    bool isEvolveEnabled() const;
+
+    /**
+     * Sets how many steps are mutated at every wrap of the loop (1 to 16)
+     */
+    void setEvolveRate(int stepsPerLoop);
+
+    /**
+     * Gets how many steps are mutated at every wrap of the loop
+     */
+    int getEvolveRate() const;
+
+    /**
+     * Sets how many semitones a mutated step can move from its neighbour (1 to 12)
+     */
+    void setEvolveRange(int semitones);
+
+    /**
+     * Gets how many semitones a mutated step can move from its neighbour
+     */
+    int getEvolveRange() const;
+
+    /**
+     * Returns whether the audio thread has started evolving the walk from the pattern
+     */
+    bool hasEvolvedWalk() const;
+
+    /**
+     * Gets the note value a step is playing, which has evolved away from the stored
+     * pattern while evolve mode is on
+     */
+    int getPlayingValue(int index) const;
+
+    /**
+     * Copies the evolved notes into the pattern, so they're kept when evolve mode is
+     * turned off
+     */
+    void keepEvolvedPattern();
+
+    //==============================================================================
+    // Lookahead generation
+
+    /**
+     * Where the notes come from
+     */
+    enum GenerationMode
+    {
+        patternGeneration,     // The pattern, as rendered by the engine on the audio thread
+        searchedWalkGeneration // A SearchedWalkGenerator, rendered ahead on a worker thread
+    };
+
+    /**
+     * Sets where the notes come from, starting or stopping the lookahead worker
+     * Must be called from the message thread
+     */
+    void setGenerationMode(GenerationMode mode);
+
+    /**
+     * Gets where the notes come from
+     */
+    GenerationMode getGenerationMode() const;
+
+    /**
+     * Renders the notes with a custom generator ahead of the playhead, or goes back to
+     * the pattern with nullptr
+     * Must be called from the message thread
+     */
+    void setLookaheadGenerator(std::unique_ptr<LookaheadGenerator> generator);
+
+    /**
+     * Sets how many bars the lookahead generator renders ahead of the playhead
+     */
+    void setLookaheadBars(int numBars) { lookahead.setLookaheadBars(numBars); }
+
+    /**
+     * Gets how many bars the lookahead generator renders ahead of the playhead
+     */
+    int getLookaheadBars() const { return lookahead.getLookaheadBars(); }
+
+    /**
+     * Gets the number of steps the lookahead generator didn't deliver in time, which
+     * repeated what their loop position played on the previous pass instead
+     */
+    juce::uint32 getLookaheadUnderruns() const { return lookahead.getNumUnderruns(); }
+
+    //==============================================================================
+    // Performance instrumentation
+
+    /**
+     * Gets the per-block profiler shown in the editor's performance panel
+     */
+    PluginHelpers::BlockProfiler& getProfiler() { return profiler; }
 
 private:
+    // Per-block profiling (disabled by default)
+    PluginHelpers::BlockProfiler profiler;
 
     // Internal BPM setting (used when not synced to host)
-    double internalBpm = 120.0;
+    std::atomic<double> internalBpm {120.0};
 
-    // Parameter values
-    int rateValue;      // Step timing (note rate)
-    int densityValue;   // Number of active steps in the sequence
-    int offsetValue;    // Starting position offset in the sequence
-    float gateValue;    // Note duration as a proportion of step duration
-    int rootValue;      // Base MIDI note number
+    // Parameter values, written by the host or the editor and read by the audio thread
+    std::atomic<int> rateValue {3};      // Step timing (note rate)
+    std::atomic<int> densityValue {8};   // Number of active steps in the sequence
+    std::atomic<int> offsetValue {0};    // Starting position offset in the sequence
+    std::atomic<float> gateValue {0.5f}; // Note duration as a proportion of step duration
+    std::atomic<int> rootValue {72};     // Base MIDI note number
+
+    // Link group settings, written by the UI and read by the audio thread
+    std::atomic<int> linkGroupId {0};        // 0 when not linked
+    std::atomic<int> linkRole {leadRole};    // A LinkRole
+    std::atomic<int> linkInterval {7};       // Semitones added to the leader's notes
+    std::atomic<int> canonDelay {4};         // Steps a canon follower plays behind
+
+    // Output routing
+    std::atomic<int> outputChannel {1};  // Channel for notes outside MPE mode
+    std::atomic<bool> mpeMode {false};   // Whether each note gets its own member channel
 
     // Sequencer properties
     static const int numSteps = 16;       // Total number of steps in the sequence
-    int currentStep = 0;                  // Current step being played
-    bool isPlaying = false;               // Playback state
+    using Engine = SequencerEngine<numSteps, 1>; // Step-level work, specialised for our step count
+    std::atomic<int> currentStep {0};     // Current step being played, written by the audio thread
+    std::atomic<bool> isPlaying {false};  // Playback state, written by the audio thread
     int sequence[numSteps] = {0};         // MIDI note offsets from root note
+    std::atomic<bool> patternPending {true}; // No pattern generated, set or restored yet
 
     // Manual step mode properties
     bool enabledSteps[numSteps] = {true}; // Tracks which steps are enabled
-    bool manualStepMode = false;          // Whether manual step mode is active
+
+    // Per-step expression, edited by the UI and read by the audio thread
+    std::atomic<float> stepExpression[numExpressionLanes][numSteps] {};
+    std::atomic<bool> manualStepMode {false}; // Whether manual step mode is active
+
+    // What every loop position plays, rendered by the engine when the pattern or the
+    // latched parameters change, so a step only has to look itself up
+    int loopNotes[numSteps] {};
+    juce::uint8 loopVelocities[numSteps] {};
+    bool loopPlays[numSteps] {};
+    LoopParameters loopImageParameters;
+    std::atomic<juce::uint32> patternVersion {1}; // Bumped whenever the sequence or enabled steps change
+    juce::uint32 loopImagePatternVersion = 0;     // The pattern version the loop image was rendered from
+
+    // The pattern as the audio thread sees it: the message thread edits sequence and
+    // enabledSteps, and every edit publishes a copy of both, so the audio thread never
+    // reads them while they're being written
+    struct PatternSnapshot
+    {
+        int sequence[numSteps] {};
+        bool enabled[numSteps] {};
+    };
+    Realtime::SeqLock<PatternSnapshot> publishedPattern;
+    PatternSnapshot audioPattern;                 // The audio thread's copy
+    juce::uint32 audioPatternVersion = 0;         // The pattern version of that copy
 
     // Timing variables
     double sampleRate = 44100.0;          // Current sample rate
     double bpm = 120.0;                   // Current tempo
-    double samplesPerBeat = 0.0;          // Number of samples in one beat
-    double sampleCounter = 0.0;           // Counter for tracking position within a step
-    double stepDuration = 0.0;            // Duration of one step in samples
+    StepClock stepClock;                  // Exact step timing, in whole samples
     int stepOffset = 0;                   // Offset for the current step
 
     // Note tracking variables
     bool noteIsOn = false;                // Whether a note is currently playing
     int lastNoteValue = 0;                // MIDI note value of the currently playing note
+    juce::int64 noteLength = 0;           // Length of the playing note, latched at its note on
+    int lastNoteChannel = 1;              // MIDI channel of the currently playing note
+    bool lastNoteIsMpe = false;           // Whether that channel came from the MPE allocator
+
+    // MPE state, only touched by the audio thread
+    MpeChannelAllocator mpeChannels;      // Member channel allocator for the lower zone
+    juce::MidiBuffer mpeZoneMessages;     // Zone configuration, built once in prepareToPlay
+    bool mpeZoneSent = false;             // Whether the zone configuration has been sent
+
+    // Link group state, only touched by the audio thread (and the destructor)
+    LinkGroup* joinedGroup = nullptr;     // The group this instance is registered with
+    juce::int64 nextLinkedStep = 0;       // Index of the next step on the group's grid
+    std::atomic<bool> linkLeading {false}; // Whether this instance leads its group
+
+    // Pitch glide of the playing MPE note, sent as a short ramp of pitch bends
+    static constexpr int numGlidePoints = 8;
+    int glidePointsSent = numGlidePoints; // Ramp points already sent for this note
+    float glideTarget = 0.0f;             // Glide at the end of the ramp, -1 to 1
+
+    // Transport settings, written by the UI and read by the audio thread
+    std::atomic<bool> syncToHostTransport {false}; // Whether to sync to host transport
+
+    // Play and stop from the UI. Starting restarts the step clock, which the audio thread
+    // owns, so the UI only leaves a request that the audio thread applies at its next block
+    enum PlayRequest
+    {
+        noPlayRequest,
+        startRequest,
+        stopRequest
+    };
+
+    std::atomic<int> playRequest {noPlayRequest};
+
+    // MIDI clock: the settings are written by the UI, the clocks are owned by the audio thread
+    std::atomic<bool> midiClockInput {false};
+    std::atomic<bool> midiClockOutput {false};
+    std::atomic<double> midiClockBpm {0.0};    // Only written by the audio thread
+    MidiClockFollower midiClockFollower;
+    bool followingMidiClock = false;           // Latched at the start of every block
+    MidiClockGenerator midiClockGenerator;
+
+    // Post-processing of our own events: the settings are written by the UI, and the audio
+    // thread rebuilds its program from them when the version changes
+    static constexpr int maxEventsPerBlock = 2048;
+    std::atomic<int> postTranspose {0};
+    std::atomic<float> velocityCurve {0.0f};
+    std::atomic<float> outputDelay {0.0f};                // Milliseconds
+    std::atomic<juce::uint32> postProcessingVersion {1};  // Bumped whenever a setting changes
+    juce::uint32 compiledPostProcessingVersion = 0;       // The version the program was built from
+    MidiTransforms::Pipeline postProcessing;
+    juce::MidiBuffer generatedMidi;                       // Our events for the block, before post-processing
 
     /**
-     * Enhances a sequence to make it more melodically interesting
+     * Rebuilds the post-processing program if a setting changed since it was last built
      */
-    void enhanceSequenceMelodically();
+    void updatePostProcessing();
 
-    // Transport settings
-    bool syncToHostTransport = false; // Whether to sync to host transport
+    /**
+     * Starts or stops playback as the UI last asked, if it asked since the previous block
+     */
+    void applyPlayRequest();
 
     /**
-     * Updates timing based on host information or internal BPM
+     * Updates tempo and transport state from a followed MIDI clock, the host or the internal BPM
+     * @param timing Host timing information for the current block
      */
-    void updateTimingInfo();
+    void updateTimingInfo(const TimingContext& timing);
 
     /**
-     * Gets the MIDI note for the specified step
+     * Recalculates the step duration from the current tempo, rate and sample rate
      */
-    int getNoteForStep(int step);
+    void updateStepDuration();
 
     /**
      * Calculates note length based on gate parameter
      */
-    double getNoteLength();
+    juce::int64 getNoteLength(float gate) const;
+
+    /**
+     * What a step plays: whether it plays, and which note at which velocity
+     */
+    struct PlannedStep
+    {
+        bool plays = false;
+        int note = 0;
+        juce::uint8 velocity = 0;
+        int sequenceIndex = 0; // Offset-adjusted index into the sequence
+    };
+
+    // Morphing: the slots and the morph control, written by the UI or the host
+    Morph morph;
+    std::atomic<bool> morphEnabled {false};
+    std::atomic<float> morphAmount {0.0f};
+    std::atomic<int> morphBars {0};
+    std::atomic<int> morphMode {Morph::interpolateMode};
+    std::atomic<float> morphPosition {0.0f};  // Only written by the audio thread
+    static_assert(numSteps == 16, "The morph slots have one step per sequence step");
+
+    // Evolving: the settings are written by the UI, the walk is owned by the audio thread
+    // and its notes are published one by one for the UI as they move
+    std::atomic<bool> evolveEnabled {false};
+    std::atomic<int> evolveRate {2};
+    std::atomic<int> evolveRange {3};
+    std::atomic<int> evolvedValues[numSteps] {};
+    int evolvedSequence[numSteps] {};
+    juce::Random evolveRandom;              // Seeded when constructed, so the audio thread never has to
+    std::atomic<juce::uint32> evolveBaseVersion {0}; // The pattern version the walk evolved from, 0 before it started
+    juce::uint32 evolveGeneration = 0;      // Bumped whenever the walk moves
+    juce::uint32 loopImageEvolveGeneration = 0;
+    bool loopImageEvolved = false;          // Whether the loop image was rendered from the evolved walk
+
+    // Lookahead generation: the worker and its queue, and the audio thread's side of it
+    LookaheadRenderer lookahead;
+    std::atomic<int> generationMode {patternGeneration};
+    bool lookaheadNeedsPriming = true;        // Set on a seek, a tempo change or a restart
+    LoopParameters lookaheadParameters;       // The parameters the queue was primed with
+    juce::uint32 lookaheadPatternVersion = 0; // The pattern version the queue was primed with
+    int lookaheadStepsPerBar = 0;             // The rate the queue was primed at
+    PlannedStep lookaheadLoop[numSteps];      // What every loop position played on the last pass
+    juce::int64 nextHostPosition = -1;        // Where the host should be at the next block
+
+    /**
+     * Re-renders the loop image if the pattern or the latched parameters changed
+     */
+    void updateLoopImage(int density, int offset, int root);
+
+    /**
+     * Publishes the sequence and the enabled steps for the audio thread after an edit,
+     * marking the loop image and the lookahead as stale
+     */
+    void markPatternChanged();
+
+    /**
+     * Takes the latest published pattern, if it changed since the audio thread's copy
+     */
+    void updateAudioPattern();
+
+    /**
+     * Works out what a position in the loop plays, from the loop image
+     * @param loopPosition Position in the loop (before the offset is applied)
+     * @param offset The latched offset parameter
+     */
+    PlannedStep planStep(int loopPosition, int offset) const;
+
+    /**
+     * Continues the walk at the chosen number of steps, at a wrap of the loop
+     * The work is bounded by the evolve rate: nothing is allocated or regenerated
+     */
+    void evolveLoop();
+
+    /**
+     * Gets the number of steps in a 4/4 bar at the current rate, at least 1
+     */
+    int getStepsPerBar() const;
+
+    /**
+     * Works out what a loop position plays from the morph slots, moving the morph a
+     * step's worth towards the control first
+     * @param gate Set to the step's morphed gate
+     */
+    PlannedStep planMorphStep(int loopPosition, int offset, int root, float& gate);
+
+    /**
+     * Works out what a loop position plays from the lookahead generator's stream,
+     * re-priming the queue first if it's stale
+     * If the generator hasn't rendered the step in time, the position plays what it
+     * played on the previous pass of the loop
+     */
+    PlannedStep planLookaheadStep(int loopPosition, int density, int offset, int root);
+
+    /**
+     * Flushes the lookahead queue and has the worker start over from this loop position
+     * @param parametersChanged Whether the previous pass no longer fits the parameters or
+     *                          the pattern, so the fallback goes back to the loop image
+     */
+    void primeLookahead(int loopPosition, const LoopParameters& parameters, int stepsPerBar, bool parametersChanged);
+
+    /**
+     * Registers with the selected link group, or leaves it, and claims leadership
+     * @return The group to take this block's step grid from, or nullptr to run unlinked
+     */
+    LinkGroup* updateLinkGroup(const TimingContext& timing);
+
+    /**
+     * Works out what a follower plays on a step of the group's grid, from the leader's stream
+     */
+    PlannedStep followLeader(const LinkGroup& group, juce::int64 absoluteStep, int role, int sequenceIndex) const;
+
+    /**
+     * Publishes the leader's upcoming steps, so followers that process a block before
+     * the leader already know what it will play
+     */
+    void publishUpcomingSteps(LinkGroup& group, int numSamples);
+
+    /**
+     * Leaves the link group, if registered with one
+     */
+    void leaveLinkGroup();
+
+    /**
+     * Starts a note at the given position, on the output channel or a new MPE member channel
+     * In MPE mode the step's expression is sent on the member channel before the note on
+     */
+    void addNoteOn(juce::MidiBuffer& midiMessages, int samplePosition, int noteValue, juce::uint8 velocity, int step);
+
+    /**
+     * Ends the playing note at the given position and frees its MPE channel
+     */
+    void addNoteOff(juce::MidiBuffer& midiMessages, int samplePosition);
+
+    /**
+     * Sends the glide ramp points of the playing MPE note that fall inside a segment
+     * @param segmentStart Position of the segment within the step, in samples
+     * @param segmentLength Length of the segment in samples
+     * @param samplePosition Position of the segment within the block
+     */
+    void addGlidePoints(juce::MidiBuffer& midiMessages, juce::int64 segmentStart, int segmentLength, int samplePosition);
 
     /**
-     * Called when a parameter value changes
+     * Converts a glide amount (-1 to 1) to a 14-bit pitch wheel value for the MPE bend range
      */
-    void parameterChanged(const juce::String& parameterID, float newValue);
+    static int glideToPitchWheel(float glide);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RandomWalkSequencer)
 };
\ No newline at end of file
@@ -1,21 +1,26 @@
 #include <memory>
-#include <iostream>
-#define DEBUG_LOG(x) std::cout << "[DEBUG] " << x << std::endl;
+#define DEBUG_LOG(x) DBG("[DEBUG] " << x)
 
 #include "RandomWalkSequencer.h"
 #include "RandomWalkSequencerEditor.h"
+#include "PluginProcessor.h"
 
 /**
  * Constructor - initializes all UI components and connects them to the processor
- * @param p Reference to the RandomWalkSequencer processor
+ * @param p Reference to the plugin processor that owns the sequencer
  */
-RandomWalkSequencerEditor::RandomWalkSequencerEditor(RandomWalkSequencer& p)
+RandomWalkSequencerEditor::RandomWalkSequencerEditor(AudioPluginAudioProcessor& p)
     : AudioProcessorEditor(&p)
-    , randomWalkProcessor(p)
-    , stepDisplay(p, *this)
+    , randomWalkProcessor(p.getSequencer())
+    , parameters(p.getSequencerParameters())
+    , stepDisplay(p.getSequencer(), *this)
+    , midiDragSource(p.getSequencer())
 {
     DEBUG_LOG("Editor constructor start");
 
+    // The sequencer leaves its first pattern until something needs it, and we're about to show it
+    randomWalkProcessor.generatePatternIfPending();
+
     // Rate label and combo box setup
     rateLabel.setText("Rate", juce::dontSendNotification);
     rateLabel.setJustificationType(juce::Justification::centred);
@@ -23,9 +28,8 @@ RandomWalkSequencerEditor::RandomWalkSequencerEditor(RandomWalkSequencer& p)
 
     // Rate combo box setup - musical note values
     rateComboBox.addItemList(juce::StringArray("1/32", "1/16", "1/8", "1/4", "1/3", "1/2", "1", "2", "3", "4"), 1);
-    rateComboBox.setSelectedItemIndex(randomWalkProcessor.getRate()); // Using renamed processor
     rateComboBox.setJustificationType(juce::Justification::centred);
-    rateComboBox.onChange = [this] { randomWalkProcessor.setRate(rateComboBox.getSelectedItemIndex()); }; // Using renamed processor
+    rateAttachment = std::make_unique<juce::ComboBoxParameterAttachment>(*parameters.rate, rateComboBox);
     addAndMakeVisible(rateComboBox);
 
     // Density slider - controls number of active steps
@@ -34,10 +38,8 @@ RandomWalkSequencerEditor::RandomWalkSequencerEditor(RandomWalkSequencer& p)
     addAndMakeVisible(densityLabel);
 
     densitySlider.setSliderStyle(juce::Slider::SliderStyle::LinearHorizontal);
-    densitySlider.setRange(1, 16, 1);
-    densitySlider.setValue(randomWalkProcessor.getDensity()); // Using renamed processor
     densitySlider.setTextBoxStyle(juce::Slider::TextBoxRight, false, 50, 20);
-    densitySlider.onValueChange = [this] { randomWalkProcessor.setDensity(static_cast<int>(densitySlider.getValue())); }; // Using renamed processor
+    densityAttachment = std::make_unique<juce::SliderParameterAttachment>(*parameters.density, densitySlider);
     addAndMakeVisible(densitySlider);
 
     // Offset slider - controls sequence start position
@@ -46,10 +48,8 @@ RandomWalkSequencerEditor::RandomWalkSequencerEditor(RandomWalkSequencer& p)
     addAndMakeVisible(offsetLabel);
 
     offsetSlider.setSliderStyle(juce::Slider::SliderStyle::LinearHorizontal);
-    offsetSlider.setRange(0, 15, 1);
-    offsetSlider.setValue(randomWalkProcessor.getOffset()); // Using renamed processor
     offsetSlider.setTextBoxStyle(juce::Slider::TextBoxRight, false, 50, 20);
-    offsetSlider.onValueChange = [this] { randomWalkProcessor.setOffset(static_cast<int>(offsetSlider.getValue())); }; // Using renamed processor
+    offsetAttachment = std::make_unique<juce::SliderParameterAttachment>(*parameters.offset, offsetSlider);
     addAndMakeVisible(offsetSlider);
 
     // Gate slider - controls note duration
@@ -58,10 +58,8 @@ RandomWalkSequencerEditor::RandomWalkSequencerEditor(RandomWalkSequencer& p)
     addAndMakeVisible(gateLabel);
 
     gateSlider.setSliderStyle(juce::Slider::SliderStyle::LinearHorizontal);
-    gateSlider.setRange(0.1, 1.0, 0.01);
-    gateSlider.setValue(randomWalkProcessor.getGate()); // Using renamed processor
     gateSlider.setTextBoxStyle(juce::Slider::TextBoxRight, false, 50, 20);
-    gateSlider.onValueChange = [this] { randomWalkProcessor.setGate(static_cast<float>(gateSlider.getValue())); }; // Using renamed processor
+    gateAttachment = std::make_unique<juce::SliderParameterAttachment>(*parameters.gate, gateSlider);
     addAndMakeVisible(gateSlider);
 
     // Root slider - controls base MIDI note
@@ -70,18 +68,14 @@ RandomWalkSequencerEditor::RandomWalkSequencerEditor(RandomWalkSequencer& p)
     addAndMakeVisible(rootLabel);
 
     rootSlider.setSliderStyle(juce::Slider::SliderStyle::LinearHorizontal);
-    rootSlider.setRange(12, 120, 1); // From C0 to C9
     rootSlider.setTextBoxStyle(juce::Slider::TextBoxRight, false, 80, 20); // Wider for note name display
-    // Update the note name display function that's called when the slider value changes
-    rootSlider.onValueChange = [this] {
-        int value = static_cast<int>(rootSlider.getValue());
-        randomWalkProcessor.setRoot(value);
-        updateRootNoteDisplay();
-    };
+    // The attachment sets the range (C0 to C9) and value, and updates the processor
+    rootAttachment = std::make_unique<juce::SliderParameterAttachment>(*parameters.root, rootSlider);
+    // Update the note name display when the slider value changes
+    rootSlider.onValueChange = [this] { updateRootNoteDisplay(); };
     addAndMakeVisible(rootSlider);
 
-    // Initialize slider with processor's value and update display
-    rootSlider.setValue(randomWalkProcessor.getRoot(), juce::dontSendNotification);
+    // Initialize the display with processor's value
     updateRootNoteDisplay();
 
     // Transpose Octave controls
@@ -93,8 +87,8 @@ RandomWalkSequencerEditor::RandomWalkSequencerEditor(RandomWalkSequencer& p)
     transposeDownButton.setButtonText("v");
     transposeDownButton.onClick = [this] {
         randomWalkProcessor.transposeOctaveDown();
-        rootSlider.setValue(randomWalkProcessor.getRoot(), juce::dontSendNotification);
-        updateRootNoteDisplay();
+        // Moving the slider tells the host about the new root
+        rootSlider.setValue(randomWalkProcessor.getRoot(), juce::sendNotificationSync);
     };
     addAndMakeVisible(transposeDownButton);
 
@@ -102,8 +96,8 @@ RandomWalkSequencerEditor::RandomWalkSequencerEditor(RandomWalkSequencer& p)
     transposeUpButton.setButtonText("^");
     transposeUpButton.onClick = [this] {
         randomWalkProcessor.transposeOctaveUp();
-        rootSlider.setValue(randomWalkProcessor.getRoot(), juce::dontSendNotification);
-        updateRootNoteDisplay();
+        // Moving the slider tells the host about the new root
+        rootSlider.setValue(randomWalkProcessor.getRoot(), juce::sendNotificationSync);
     };
     addAndMakeVisible(transposeUpButton);
 
@@ -177,18 +171,35 @@ RandomWalkSequencerEditor::RandomWalkSequencerEditor(RandomWalkSequencer& p)
     };
     addAndMakeVisible(syncButton);
 
+    // MIDI clock - follow an external clock's transport and tempo, or send our own
+    clockInButton.setButtonText("Clock In");
+    clockInButton.setToggleState(randomWalkProcessor.isMidiClockInput(), juce::dontSendNotification);
+    clockInButton.onClick = [this] { randomWalkProcessor.setMidiClockInput(clockInButton.getToggleState()); };
+    addAndMakeVisible(clockInButton);
+
+    clockOutButton.setButtonText("Clock Out");
+    clockOutButton.setToggleState(randomWalkProcessor.isMidiClockOutput(), juce::dontSendNotification);
+    clockOutButton.onClick = [this] { randomWalkProcessor.setMidiClockOutput(clockOutButton.getToggleState()); };
+    addAndMakeVisible(clockOutButton);
+
+    // Generation mode - the pattern itself, or a walk searched ahead on a worker thread
+    generationComboBox.addItemList(juce::StringArray("Pattern", "Searched Walk"), 1);
+    generationComboBox.setSelectedItemIndex((int) randomWalkProcessor.getGenerationMode(), juce::dontSendNotification);
+    generationComboBox.onChange = [this]
+    {
+        randomWalkProcessor.setGenerationMode(static_cast<RandomWalkSequencer::GenerationMode>(generationComboBox.getSelectedItemIndex()));
+    };
+    addAndMakeVisible(generationComboBox);
+
     // BPM slider - controls internal tempo when not synced
     bpmLabel.setText("BPM", juce::dontSendNotification);
     bpmLabel.setJustificationType(juce::Justification::centred);
     addAndMakeVisible(bpmLabel);
 
     bpmSlider.setSliderStyle(juce::Slider::SliderStyle::LinearVertical);
-    bpmSlider.setRange(30.0, 300.0, 1.0);
-    bpmSlider.setValue(randomWalkProcessor.getInternalBpm());
     bpmSlider.setTextBoxStyle(juce::Slider::TextBoxBelow, false, 50, 20);
-    bpmSlider.onValueChange = [this] {
-        randomWalkProcessor.setInternalBpm(bpmSlider.getValue());
-    };
+    bpmAttachment = std::make_unique<juce::SliderParameterAttachment>(*parameters.bpm, bpmSlider);
+    bpmSlider.setNumDecimalPlacesToDisplay(0);
     bpmSlider.setEnabled(true);
     addAndMakeVisible(bpmSlider);
 
@@ -208,10 +219,143 @@ RandomWalkSequencerEditor::RandomWalkSequencerEditor(RandomWalkSequencer& p)
     // Initial state update for density slider
     updateDensitySliderState();
 
+    // Lane selector - what the step display edits
+    laneComboBox.addItemList(juce::StringArray("Notes", "Glide", "Pressure", "Timbre"), 1);
+    laneComboBox.setSelectedItemIndex(0, juce::dontSendNotification);
+    laneComboBox.onChange = [this] { stepDisplay.setEditedLane(laneComboBox.getSelectedItemIndex()); };
+    addAndMakeVisible(laneComboBox);
+
+    // Output channel - used for every note when MPE is off
+    channelLabel.setText("Channel", juce::dontSendNotification);
+    channelLabel.setJustificationType(juce::Justification::centred);
+    addAndMakeVisible(channelLabel);
+
+    for (int channel = 1; channel <= 16; ++channel)
+        channelComboBox.addItem(juce::String(channel), channel);
+
+    channelAttachment = std::make_unique<juce::ComboBoxParameterAttachment>(*parameters.channel, channelComboBox);
+    addAndMakeVisible(channelComboBox);
+
+    // MPE toggle - one member channel per note, with the expression lanes as per-note expression
+    mpeToggle.setButtonText("MPE");
+    mpeAttachment = std::make_unique<juce::ButtonParameterAttachment>(*parameters.mpe, mpeToggle);
+    addAndMakeVisible(mpeToggle);
+
+    // Link controls - share the step grid and follow another instance's notes
+    linkLabel.setText("Link", juce::dontSendNotification);
+    addAndMakeVisible(linkLabel);
+
+    linkGroupComboBox.addItem("Off", 1);
+    for (int group = 1; group <= LinkGroup::maxGroups; ++group)
+        linkGroupComboBox.addItem("Group " + juce::String(group), group + 1);
+    linkGroupComboBox.onChange = [this] { randomWalkProcessor.setLinkGroup(linkGroupComboBox.getSelectedId() - 1); };
+    addAndMakeVisible(linkGroupComboBox);
+
+    linkRoleComboBox.addItemList(juce::StringArray("Lead", "Harmonize", "Canon"), 1);
+    linkRoleComboBox.onChange = [this]
+    {
+        randomWalkProcessor.setLinkRole(static_cast<RandomWalkSequencer::LinkRole>(linkRoleComboBox.getSelectedItemIndex()));
+    };
+    addAndMakeVisible(linkRoleComboBox);
+
+    // Item IDs are offset by 25, as they can't be 0 or negative
+    for (int interval = -24; interval <= 24; ++interval)
+        linkIntervalComboBox.addItem((interval > 0 ? "+" : "") + juce::String(interval) + " st", interval + 25);
+    linkIntervalComboBox.onChange = [this] { randomWalkProcessor.setLinkInterval(linkIntervalComboBox.getSelectedId() - 25); };
+    addAndMakeVisible(linkIntervalComboBox);
+
+    for (int delay = 1; delay <= 16; ++delay)
+        canonDelayComboBox.addItem(juce::String(delay) + (delay == 1 ? " step" : " steps"), delay);
+    canonDelayComboBox.onChange = [this] { randomWalkProcessor.setCanonDelay(canonDelayComboBox.getSelectedId()); };
+    addAndMakeVisible(canonDelayComboBox);
+
+    linkStatusLabel.setJustificationType(juce::Justification::centredRight);
+    addAndMakeVisible(linkStatusLabel);
+
+    updateLinkControls();
+
+    // Morph controls - store the pattern in two slots and move between them
+    morphLabel.setText("Morph", juce::dontSendNotification);
+    addAndMakeVisible(morphLabel);
+
+    morphToggle.setButtonText("On");
+    morphToggle.onClick = [this] { randomWalkProcessor.setMorphEnabled(morphToggle.getToggleState()); };
+    addAndMakeVisible(morphToggle);
+
+    storeAButton.setButtonText("Store A");
+    storeAButton.onClick = [this] { randomWalkProcessor.storeMorphSlot(RandomWalkSequencer::Morph::slotA); };
+    addAndMakeVisible(storeAButton);
+
+    storeBButton.setButtonText("Store B");
+    storeBButton.onClick = [this] { randomWalkProcessor.storeMorphSlot(RandomWalkSequencer::Morph::slotB); };
+    addAndMakeVisible(storeBButton);
+
+    morphModeComboBox.addItemList(juce::StringArray("Interpolate", "Crossfade"), 1);
+    morphModeComboBox.onChange = [this]
+    {
+        randomWalkProcessor.setMorphMode(static_cast<RandomWalkSequencer::Morph::Mode>(morphModeComboBox.getSelectedItemIndex()));
+    };
+    addAndMakeVisible(morphModeComboBox);
+
+    // Item IDs are the number of bars plus 1, as they can't be 0
+    for (int bars: RandomWalkSequencer::morphBarChoices)
+    {
+        auto name = bars == 0 ? juce::String("Instant") : juce::String(bars) + (bars == 1 ? " bar" : " bars");
+        morphBarsComboBox.addItem(name, bars + 1);
+    }
+    morphBarsComboBox.onChange = [this] { randomWalkProcessor.setMorphBars(morphBarsComboBox.getSelectedId() - 1); };
+    addAndMakeVisible(morphBarsComboBox);
+
+    morphSlider.setSliderStyle(juce::Slider::LinearHorizontal);
+    morphSlider.setTextBoxStyle(juce::Slider::TextBoxRight, false, 50, 20);
+    morphAttachment = std::make_unique<juce::SliderParameterAttachment>(*parameters.morph, morphSlider);
+    addAndMakeVisible(morphSlider);
+
+    updateMorphControls();
+
+    // Evolve controls - keep the walk moving a few steps at every loop
+    evolveLabel.setText("Evolve", juce::dontSendNotification);
+    addAndMakeVisible(evolveLabel);
+
+    evolveToggle.setButtonText("On");
+    evolveToggle.onClick = [this] { randomWalkProcessor.setEvolveEnabled(evolveToggle.getToggleState()); };
+    addAndMakeVisible(evolveToggle);
+
+    for (int steps = 1; steps <= 16; ++steps)
+        evolveRateComboBox.addItem(juce::String(steps) + (steps == 1 ? " step/loop" : " steps/loop"), steps);
+    evolveRateComboBox.onChange = [this] { randomWalkProcessor.setEvolveRate(evolveRateComboBox.getSelectedId()); };
+    addAndMakeVisible(evolveRateComboBox);
+
+    for (int semitones = 1; semitones <= 12; ++semitones)
+        evolveRangeComboBox.addItem("+/-" + juce::String(semitones) + " st", semitones);
+    evolveRangeComboBox.onChange = [this] { randomWalkProcessor.setEvolveRange(evolveRangeComboBox.getSelectedId()); };
+    addAndMakeVisible(evolveRangeComboBox);
+
+    keepEvolvedButton.setButtonText("Keep");
+    keepEvolvedButton.onClick = [this] { randomWalkProcessor.keepEvolvedPattern(); };
+    addAndMakeVisible(keepEvolvedButton);
+
+    updateEvolveControls();
+
+    // MIDI export - drag the pattern onto a DAW track, covering a number of loops
+    for (int loops: { 1, 2, 4, 8, 16, 32, 64 })
+        exportLoopsComboBox.addItem(juce::String(loops) + (loops == 1 ? " loop" : " loops"), loops);
+    exportLoopsComboBox.setSelectedId(4, juce::dontSendNotification);
+    exportLoopsComboBox.onChange = [this] { midiDragSource.setNumLoops(exportLoopsComboBox.getSelectedId()); };
+    addAndMakeVisible(exportLoopsComboBox);
+
+    addAndMakeVisible(midiDragSource);
+
     // Step display - visual representation of sequence
     addAndMakeVisible(stepDisplay);
     stepDisplay.setMouseCursor(juce::MouseCursor::UpDownResizeCursor);
 
+    // Performance panel - collapsed by default, and only built the first time it's expanded
+    performanceToggle.setButtonText("Performance >");
+    performanceToggle.setClickingTogglesState(true);
+    performanceToggle.onClick = [this] { setPerformancePanelVisible(performanceToggle.getToggleState()); };
+    addAndMakeVisible(performanceToggle);
+
     // Set up timer to refresh UI
     startTimerHz(10);
 
@@ -261,7 +405,11 @@ void RandomWalkSequencerEditor::resized()
     auto area = getLocalBounds().reduced(10);
 
     // Calculate the total height needed for all controls
-    int totalHeight = 40 + 150 + 30 + 10 + (40 + 10) * 7; // Added +1 to account for manual step toggle
+    int totalHeight = 40 + 150 + 30 + 10 + 30 + 10 + 30 + 10 + 30 + 10 + (40 + 10) * 7; // Added +1 to account for manual step toggle
+
+    // Make room for the performance panel when it's expanded
+    if (isPerformancePanelVisible())
+        totalHeight += PerformancePanel::preferredHeight + 10;
 
     // Set a minimum size for the editor
     setSize(juce::jmax(600, getWidth()), juce::jmax(totalHeight, getHeight()));
@@ -269,6 +417,13 @@ void RandomWalkSequencerEditor::resized()
     // Reset area after possibly resizing
     area = getLocalBounds().reduced(10);
 
+    // Performance panel sits along the bottom edge
+    if (isPerformancePanelVisible())
+    {
+        performancePanel->setBounds(area.removeFromBottom(PerformancePanel::preferredHeight));
+        area.removeFromBottom(10);
+    }
+
     // Header section
     auto headerArea = area.removeFromTop(40);
 
@@ -293,10 +448,68 @@ void RandomWalkSequencerEditor::resized()
     manualStepLabel.setBounds(manualStepArea.removeFromLeft(80));
     manualStepToggle.setBounds(manualStepArea.removeFromLeft(30));
 
+    // Output routing and the lane selector share the row, on the right
+    mpeToggle.setBounds(manualStepArea.removeFromRight(60));
+    channelComboBox.setBounds(manualStepArea.removeFromRight(60));
+    channelLabel.setBounds(manualStepArea.removeFromRight(60));
+    manualStepArea.removeFromRight(10);
+    laneComboBox.setBounds(manualStepArea.removeFromRight(100));
+
+    area.removeFromTop(10); // Add spacing
+
+    // Transport sync toggle, with the performance panel toggle on the right
+    auto syncArea = area.removeFromTop(30);
+    performanceToggle.setBounds(syncArea.removeFromRight(120));
+    generationComboBox.setBounds(syncArea.removeFromRight(130));
+    clockOutButton.setBounds(syncArea.removeFromRight(90));
+    clockInButton.setBounds(syncArea.removeFromRight(80));
+    syncButton.setBounds(syncArea);
+
+    area.removeFromTop(10); // Add spacing
+
+    // Link controls
+    auto linkArea = area.removeFromTop(30);
+    linkLabel.setBounds(linkArea.removeFromLeft(80));
+    linkGroupComboBox.setBounds(linkArea.removeFromLeft(90));
+    linkArea.removeFromLeft(5);
+    linkRoleComboBox.setBounds(linkArea.removeFromLeft(100));
+    linkArea.removeFromLeft(5);
+    linkIntervalComboBox.setBounds(linkArea.removeFromLeft(70));
+    linkArea.removeFromLeft(5);
+    canonDelayComboBox.setBounds(linkArea.removeFromLeft(80));
+    linkStatusLabel.setBounds(linkArea);
+
     area.removeFromTop(10); // Add spacing
 
-    // Transport sync toggle
-    syncButton.setBounds(area.removeFromTop(30));
+    // Morph controls
+    auto morphArea = area.removeFromTop(30);
+    morphLabel.setBounds(morphArea.removeFromLeft(80));
+    morphToggle.setBounds(morphArea.removeFromLeft(50));
+    storeAButton.setBounds(morphArea.removeFromLeft(65));
+    morphArea.removeFromLeft(5);
+    storeBButton.setBounds(morphArea.removeFromLeft(65));
+    morphArea.removeFromLeft(5);
+    morphModeComboBox.setBounds(morphArea.removeFromLeft(100));
+    morphArea.removeFromLeft(5);
+    morphBarsComboBox.setBounds(morphArea.removeFromLeft(80));
+    morphSlider.setBounds(morphArea);
+
+    area.removeFromTop(10); // Add spacing
+
+    // Evolve controls
+    auto evolveArea = area.removeFromTop(30);
+    evolveLabel.setBounds(evolveArea.removeFromLeft(80));
+    evolveToggle.setBounds(evolveArea.removeFromLeft(50));
+    evolveRateComboBox.setBounds(evolveArea.removeFromLeft(120));
+    evolveArea.removeFromLeft(5);
+    evolveRangeComboBox.setBounds(evolveArea.removeFromLeft(80));
+    evolveArea.removeFromLeft(5);
+    keepEvolvedButton.setBounds(evolveArea.removeFromLeft(60));
+
+    // MIDI export shares the row, on the right
+    midiDragSource.setBounds(evolveArea.removeFromRight(90));
+    evolveArea.removeFromRight(5);
+    exportLoopsComboBox.setBounds(evolveArea.removeFromRight(80));
 
     area.removeFromTop(10); // Add spacing
 
@@ -370,29 +583,6 @@ void RandomWalkSequencerEditor::resized()
  */
 void RandomWalkSequencerEditor::timerCallback()
 {
-    // Update controls from processor values, if needed
-    if (rateComboBox.getSelectedItemIndex() != randomWalkProcessor.getRate()) // Using renamed processor
-        rateComboBox.setSelectedItemIndex(randomWalkProcessor.getRate()); // Using renamed processor
-
-    if (static_cast<int>(densitySlider.getValue()) != randomWalkProcessor.getDensity()) // Using renamed processor
-        densitySlider.setValue(randomWalkProcessor.getDensity()); // Using renamed processor
-
-    if (static_cast<int>(offsetSlider.getValue()) != randomWalkProcessor.getOffset()) // Using renamed processor
-        offsetSlider.setValue(randomWalkProcessor.getOffset()); // Using renamed processor
-
-    if (std::abs(gateSlider.getValue() - randomWalkProcessor.getGate()) > 0.01) // Using renamed processor
-        gateSlider.setValue(randomWalkProcessor.getGate()); // Using renamed processor
-
-    if (static_cast<int>(rootSlider.getValue()) != randomWalkProcessor.getRoot())
-    {
-        int newValue = randomWalkProcessor.getRoot();
-        // Ensure the value is within the slider's range
-        newValue = juce::jlimit((int)rootSlider.getMinimum(),
-                               (int)rootSlider.getMaximum(),
-                               newValue);
-        rootSlider.setValue(newValue);
-    }
-
     // Update play button state
     bool isProcessorPlaying = randomWalkProcessor.getIsPlaying();
     if (playButton.getToggleState() != isProcessorPlaying)
@@ -401,8 +591,92 @@ void RandomWalkSequencerEditor::timerCallback()
         playButton.setButtonText(isProcessorPlaying ? "Stop" : "Play");
     }
 
+    // Link, morph, evolve and MIDI clock settings and the generation mode may have been changed by loading state
+    updateLinkControls();
+    updateMorphControls();
+    updateEvolveControls();
+    generationComboBox.setSelectedItemIndex((int) randomWalkProcessor.getGenerationMode(), juce::dontSendNotification);
+    clockInButton.setToggleState(randomWalkProcessor.isMidiClockInput(), juce::dontSendNotification);
+    clockOutButton.setToggleState(randomWalkProcessor.isMidiClockOutput(), juce::dontSendNotification);
+
     // Repaint the step display
     stepDisplay.repaint();
+
+    // Refresh the profiler stats only while they're on screen
+    if (isPerformancePanelVisible())
+        performancePanel->refresh();
+}
+
+/**
+ * Copies the sequencer's link settings into the link controls
+ * The interval and canon delay only apply to followers, so they're disabled otherwise
+ */
+void RandomWalkSequencerEditor::updateLinkControls()
+{
+    const int group = randomWalkProcessor.getLinkGroup();
+    const auto role = randomWalkProcessor.getLinkRole();
+
+    linkGroupComboBox.setSelectedId(group + 1, juce::dontSendNotification);
+    linkRoleComboBox.setSelectedItemIndex((int) role, juce::dontSendNotification);
+    linkIntervalComboBox.setSelectedId(randomWalkProcessor.getLinkInterval() + 25, juce::dontSendNotification);
+    canonDelayComboBox.setSelectedId(randomWalkProcessor.getCanonDelay(), juce::dontSendNotification);
+
+    linkIntervalComboBox.setEnabled(role != RandomWalkSequencer::leadRole);
+    canonDelayComboBox.setEnabled(role == RandomWalkSequencer::canonRole);
+
+    juce::String status;
+
+    if (group > 0)
+        status = randomWalkProcessor.isLinkLeader() ? "Leading" : "Following";
+
+    linkStatusLabel.setText(status, juce::dontSendNotification);
+}
+
+/**
+ * Copies the sequencer's morph settings into the morph controls
+ */
+void RandomWalkSequencerEditor::updateMorphControls()
+{
+    morphToggle.setToggleState(randomWalkProcessor.isMorphEnabled(), juce::dontSendNotification);
+    morphModeComboBox.setSelectedItemIndex((int) randomWalkProcessor.getMorphMode(), juce::dontSendNotification);
+    morphBarsComboBox.setSelectedId(randomWalkProcessor.getMorphBars() + 1, juce::dontSendNotification);
+}
+
+/**
+ * Copies the sequencer's evolve settings into the evolve controls
+ * Keeping the walk only makes sense once it's evolving
+ */
+void RandomWalkSequencerEditor::updateEvolveControls()
+{
+    evolveToggle.setToggleState(randomWalkProcessor.isEvolveEnabled(), juce::dontSendNotification);
+    evolveRateComboBox.setSelectedId(randomWalkProcessor.getEvolveRate(), juce::dontSendNotification);
+    evolveRangeComboBox.setSelectedId(randomWalkProcessor.getEvolveRange(), juce::dontSendNotification);
+    keepEvolvedButton.setEnabled(randomWalkProcessor.hasEvolvedWalk());
+}
+
+/**
+ * Shows or hides the performance panel and resizes the editor to fit
+ * @param shouldBeVisible Whether the panel should be expanded
+ */
+void RandomWalkSequencerEditor::setPerformancePanelVisible(bool shouldBeVisible)
+{
+    if (isPerformancePanelVisible() == shouldBeVisible)
+        return;
+
+    if (performancePanel == nullptr)
+    {
+        performancePanel = std::make_unique<PerformancePanel>(randomWalkProcessor.getProfiler());
+        addChildComponent(*performancePanel);
+    }
+
+    performancePanel->setVisible(shouldBeVisible);
+    performanceToggle.setButtonText(shouldBeVisible ? "Performance v" : "Performance >");
+
+    auto heightChange = PerformancePanel::preferredHeight + 10;
+    setSize(getWidth(), getHeight() + (shouldBeVisible ? heightChange : -heightChange));
+
+    if (shouldBeVisible)
+        performancePanel->refresh();
 }
 
 /**
@@ -485,11 +759,19 @@ void RandomWalkSequencerEditor::StepDisplay::mouseDrag(const juce::MouseEvent& e
 {
     if (draggedStep >= 0)
     {
-        // Convert mouse y position to note value
-        int noteValue = yPositionToNoteValue(e.position.y);
+        if (editedLane == 0)
+        {
+            // Convert mouse y position to note value
+            int noteValue = yPositionToNoteValue(e.position.y);
 
-        // Update the sequence step value
-        processor.setSequenceValue(draggedStep, noteValue);
+            // Update the sequence step value
+            processor.setSequenceValue(draggedStep, noteValue);
+        }
+        else
+        {
+            // Update the step's value in the edited expression lane
+            processor.setStepExpression(getExpressionLane(), draggedStep, yPositionToExpressionValue(e.position.y));
+        }
 
         // Redraw the component
         repaint();
@@ -602,7 +884,8 @@ void RandomWalkSequencerEditor::StepDisplay::paint(juce::Graphics& g)
             g.fillRect(stepRect);
 
             // Draw note value as a line
-            int noteOffset = processor.getSequenceValue(i);
+            // While evolving, this is the evolved walk rather than the stored pattern
+            int noteOffset = processor.getPlayingValue(i);
             float lineY = midPoint - (noteOffset * (h / 24.0f)); // Scale to fit in view
 
             // Draw the note line with a different color when inactive
@@ -643,6 +926,10 @@ void RandomWalkSequencerEditor::StepDisplay::paint(juce::Graphics& g)
         g.setColour(juce::Colours::darkgrey.brighter(0.3f));
         g.drawLine(0, midPoint, getWidth(), midPoint, 1.0f);
 
+        // Overlay the expression lane being edited
+        if (editedLane != 0)
+            paintExpressionLane(g, w);
+
         // Add a label to indicate manual mode
         if (isManualMode) {
             g.setColour(juce::Colours::white);
@@ -661,6 +948,127 @@ void RandomWalkSequencerEditor::StepDisplay::paint(juce::Graphics& g)
     }
 }
 
+/**
+ * Chooses what dragging a step edits
+ * @param lane 0 for note values, or 1 + a RandomWalkSequencer::ExpressionLane
+ */
+void RandomWalkSequencerEditor::StepDisplay::setEditedLane(int lane)
+{
+    editedLane = juce::jlimit(0, (int) RandomWalkSequencer::numExpressionLanes, lane);
+    repaint();
+}
+
+/**
+ * Returns the expression lane being edited
+ */
+RandomWalkSequencer::ExpressionLane RandomWalkSequencerEditor::StepDisplay::getExpressionLane() const
+{
+    return static_cast<RandomWalkSequencer::ExpressionLane>(editedLane - 1);
+}
+
+/**
+ * Converts vertical position to a value of the edited expression lane
+ * Glide is centred like the note values, the other lanes start at the bottom
+ */
+float RandomWalkSequencerEditor::StepDisplay::yPositionToExpressionValue(float y)
+{
+    float h = (float)getHeight();
+
+    if (getExpressionLane() == RandomWalkSequencer::glideLane)
+        return juce::jlimit(-1.0f, 1.0f, (h * 0.5f - y) / (h * 0.5f));
+
+    return juce::jlimit(0.0f, 1.0f, 1.0f - y / h);
+}
+
+/**
+ * Draws the edited expression lane as translucent bars over the steps
+ * @param stepWidth Width of one step in pixels
+ */
+void RandomWalkSequencerEditor::StepDisplay::paintExpressionLane(juce::Graphics& g, float stepWidth)
+{
+    const int numSteps = 16;
+    const float h = (float)getHeight();
+    const auto lane = getExpressionLane();
+    const bool isBipolar = (lane == RandomWalkSequencer::glideLane);
+    const float baseline = isBipolar ? h * 0.5f : h;
+
+    for (int i = 0; i < numSteps; ++i)
+    {
+        float value = processor.getStepExpression(lane, i);
+        float top = isBipolar ? baseline - value * h * 0.5f : baseline - value * h;
+
+        juce::Rectangle<float> bar(i * stepWidth + 4, juce::jmin(top, baseline),
+                                   stepWidth - 10, std::abs(baseline - top));
+
+        g.setColour(juce::Colours::cyan.withAlpha(i == draggedStep ? 0.8f : 0.5f));
+        g.fillRect(bar);
+    }
+
+    g.setColour(juce::Colours::white);
+    g.setFont(14.0f);
+    g.drawText(editor.laneComboBox.getText() + " lane",
+               juce::Rectangle<float>(0, h - 25, 150, 25),
+               juce::Justification::centredLeft,
+               true);
+}
+
+//==============================================================================
+/**
+ * Constructor for the MIDI drag handle
+ */
+RandomWalkSequencerEditor::MidiDragSource::MidiDragSource(RandomWalkSequencer& proc)
+    : processor(proc)
+{
+    setMouseCursor(juce::MouseCursor::DraggingHandCursor);
+}
+
+/**
+ * Draws the handle as a labelled box
+ */
+void RandomWalkSequencerEditor::MidiDragSource::paint(juce::Graphics& g)
+{
+    auto bounds = getLocalBounds().toFloat().reduced(1.0f);
+
+    g.setColour(isDragging ? juce::Colours::orange : juce::Colours::lightgreen);
+    g.drawRoundedRectangle(bounds, 4.0f, 1.0f);
+
+    g.setColour(juce::Colours::white);
+    g.setFont(13.0f);
+    g.drawText("Drag MIDI", bounds, juce::Justification::centred, true);
+}
+
+/**
+ * Writes the MIDI file to the temporary folder and hands it to the OS as a file drag
+ * The file takes a few milliseconds to write even for long exports, so there's no need
+ * to do it off the message thread
+ */
+void RandomWalkSequencerEditor::MidiDragSource::mouseDrag(const juce::MouseEvent& e)
+{
+    if (isDragging || e.getDistanceFromDragStart() < 5)
+        return;
+
+    juce::MemoryBlock midiFile;
+    processor.exportMidiFile(numLoops, midiFile);
+
+    auto file = juce::File::getSpecialLocation(juce::File::tempDirectory).getChildFile("RandomWalkSequencer.mid");
+
+    if (!file.replaceWithData(midiFile.getData(), midiFile.getSize()))
+        return;
+
+    isDragging = true;
+    repaint();
+
+    juce::Component::SafePointer<MidiDragSource> safeThis(this);
+    juce::DragAndDropContainer::performExternalDragDropOfFiles({ file.getFullPathName() }, false, this, [safeThis]
+    {
+        if (safeThis != nullptr)
+        {
+            safeThis->isDragging = false;
+            safeThis->repaint();
+        }
+    });
+}
+
 /**
  * Updates the root note display text to show note name
  * Converts MIDI note number to note name with octave
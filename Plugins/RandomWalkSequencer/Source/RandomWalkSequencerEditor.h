@@ -2,6 +2,10 @@
 
 #include <JuceHeader.h>
 #include "RandomWalkSequencer.h"
+#include "PerformancePanel.h"
+#include "SequencerParameters.h"
+
+class AudioPluginAudioProcessor;
 
 /**
  * Editor component for the RandomWalkSequencer plugin
@@ -13,9 +17,9 @@ class RandomWalkSequencerEditor : public juce::AudioProcessorEditor,
 public:
     /**
      * Constructor - initializes the UI components
-     * @param p Reference to the RandomWalkSequencer processor
+     * @param p Reference to the plugin processor that owns the sequencer
      */
-    RandomWalkSequencerEditor(RandomWalkSequencer& p);
+    RandomWalkSequencerEditor(AudioPluginAudioProcessor& p);
 
     /**
      * Destructor - cleans up resources and stops timer
@@ -51,10 +55,19 @@ public:
      */
     void updateManualStepToggle(bool state);
 
+    /**
+     * Returns the step display, so it can be rendered on its own
+     * Used by the render benchmarks
+     */
+    juce::Component& getStepDisplay() { return stepDisplay; }
+
 private:
     // Reference to the processor
     RandomWalkSequencer& randomWalkProcessor; // Renamed from 'processor' to avoid shadowing
 
+    // Host-automatable parameters that the controls are attached to
+    SequencerParameters& parameters;
+
     //==============================================================================
     // UI Components
 
@@ -108,6 +121,17 @@ private:
      */
     juce::ToggleButton syncButton;
 
+    /**
+     * Toggle buttons for following an incoming MIDI clock and sending one
+     */
+    juce::ToggleButton clockInButton;
+    juce::ToggleButton clockOutButton;
+
+    /**
+     * Dropdown menu for where the notes come from
+     */
+    juce::ComboBox generationComboBox;
+
     /**
      * Toggle button for manual step mode
      * Enables individual steps to be toggled on/off
@@ -139,6 +163,128 @@ private:
      */
     juce::TextButton monoButton;
 
+    /**
+     * Dropdown menu for choosing which lane the step display edits
+     * Notes, or one of the MPE expression lanes
+     */
+    juce::ComboBox laneComboBox;
+
+    /**
+     * Dropdown menu for the MIDI output channel (used when MPE is off)
+     */
+    juce::ComboBox channelComboBox;
+
+    /**
+     * Label for the channel dropdown
+     */
+    juce::Label channelLabel;
+
+    /**
+     * Toggle button for MPE output
+     */
+    juce::ToggleButton mpeToggle;
+
+    /**
+     * Label for the link controls
+     */
+    juce::Label linkLabel;
+
+    /**
+     * Dropdown menu for the link group (Off, or a group shared with other instances)
+     */
+    juce::ComboBox linkGroupComboBox;
+
+    /**
+     * Dropdown menu for the role in the link group
+     */
+    juce::ComboBox linkRoleComboBox;
+
+    /**
+     * Dropdown menu for the interval followers add to the leader's notes
+     */
+    juce::ComboBox linkIntervalComboBox;
+
+    /**
+     * Dropdown menu for how many steps a canon follower plays behind the leader
+     */
+    juce::ComboBox canonDelayComboBox;
+
+    /**
+     * Shows whether this instance is leading or following its link group
+     */
+    juce::Label linkStatusLabel;
+
+    /**
+     * Copies the sequencer's link settings into the link controls
+     */
+    void updateLinkControls();
+
+    /**
+     * Label for the morph controls
+     */
+    juce::Label morphLabel;
+
+    /**
+     * Toggle button for playing the morph between the pattern slots
+     */
+    juce::ToggleButton morphToggle;
+
+    /**
+     * Buttons that store the current pattern in slot A or B
+     */
+    juce::TextButton storeAButton;
+    juce::TextButton storeBButton;
+
+    /**
+     * Dropdown menu for how the steps get from A to B
+     */
+    juce::ComboBox morphModeComboBox;
+
+    /**
+     * Dropdown menu for how many bars the morph takes to reach the slider
+     */
+    juce::ComboBox morphBarsComboBox;
+
+    /**
+     * Slider for the morph, from slot A to slot B
+     */
+    juce::Slider morphSlider;
+
+    /**
+     * Copies the sequencer's morph settings into the morph controls
+     */
+    void updateMorphControls();
+
+    /**
+     * Label for the evolve controls
+     */
+    juce::Label evolveLabel;
+
+    /**
+     * Toggle button for evolve mode
+     */
+    juce::ToggleButton evolveToggle;
+
+    /**
+     * Dropdown menu for how many steps evolve at every loop
+     */
+    juce::ComboBox evolveRateComboBox;
+
+    /**
+     * Dropdown menu for how far an evolving step can move from its neighbour
+     */
+    juce::ComboBox evolveRangeComboBox;
+
+    /**
+     * Button that keeps the evolved walk as the pattern
+     */
+    juce::TextButton keepEvolvedButton;
+
+    /**
+     * Copies the sequencer's evolve settings into the evolve controls
+     */
+    void updateEvolveControls();
+
     //==============================================================================
     /**
      * Step display component that visualizes the sequence pattern
@@ -185,10 +331,35 @@ private:
          */
         void mouseDoubleClick(const juce::MouseEvent& e) override;
 
+        /**
+         * Chooses what dragging a step edits
+         * @param lane 0 for note values, or 1 + a RandomWalkSequencer::ExpressionLane
+         */
+        void setEditedLane(int lane);
+
     private:
         RandomWalkSequencer& processor;
         RandomWalkSequencerEditor& editor;
         int draggedStep = -1;  // Currently dragged step
+        int editedLane = 0;    // 0 for notes, otherwise 1 + expression lane
+
+        /**
+         * Returns the expression lane being edited
+         * Only valid when editedLane isn't 0
+         */
+        RandomWalkSequencer::ExpressionLane getExpressionLane() const;
+
+        /**
+         * Converts vertical position to a value of the edited expression lane
+         * @param y Vertical position in pixels
+         * @return Lane value, -1 to 1 for glide and 0 to 1 otherwise
+         */
+        float yPositionToExpressionValue(float y);
+
+        /**
+         * Draws the edited expression lane as bars over the steps
+         */
+        void paintExpressionLane(juce::Graphics& g, float stepWidth);
 
         /**
          * Converts vertical position to note value
@@ -210,6 +381,50 @@ private:
      */
     StepDisplay stepDisplay;
 
+    /**
+     * A handle that drags the pattern out of the editor as a MIDI file
+     * The file is written when the drag starts, so it's always the current pattern
+     */
+    class MidiDragSource : public juce::Component
+    {
+    public:
+        /**
+         * Constructor for the drag handle
+         * @param proc Reference to the RandomWalkSequencer processor
+         */
+        explicit MidiDragSource(RandomWalkSequencer& proc);
+
+        /**
+         * Draws the handle
+         */
+        void paint(juce::Graphics& g) override;
+
+        /**
+         * Writes the MIDI file and starts dragging it, once the mouse moved far enough
+         */
+        void mouseDrag(const juce::MouseEvent& e) override;
+
+        /**
+         * Sets how many passes of the loop the file covers
+         */
+        void setNumLoops(int newNumLoops) { numLoops = newNumLoops; }
+
+    private:
+        RandomWalkSequencer& processor;
+        int numLoops = 4;
+        bool isDragging = false;
+    };
+
+    /**
+     * Drag handle for exporting the pattern
+     */
+    MidiDragSource midiDragSource;
+
+    /**
+     * Dropdown menu for how many loops the exported file covers
+     */
+    juce::ComboBox exportLoopsComboBox;
+
     //==============================================================================
     // UI Labels
 
@@ -229,11 +444,50 @@ private:
      */
     juce::Label bpmLabel;
 
+    //==============================================================================
+    // Parameter attachments
+    // These keep the controls and the host parameters in sync, and wrap every
+    // user edit in a change gesture so hosts can record it as automation
+
+    std::unique_ptr<juce::ComboBoxParameterAttachment> rateAttachment;
+    std::unique_ptr<juce::SliderParameterAttachment> densityAttachment;
+    std::unique_ptr<juce::SliderParameterAttachment> offsetAttachment;
+    std::unique_ptr<juce::SliderParameterAttachment> gateAttachment;
+    std::unique_ptr<juce::SliderParameterAttachment> rootAttachment;
+    std::unique_ptr<juce::SliderParameterAttachment> bpmAttachment;
+    std::unique_ptr<juce::ComboBoxParameterAttachment> channelAttachment;
+    std::unique_ptr<juce::ButtonParameterAttachment> mpeAttachment;
+    std::unique_ptr<juce::SliderParameterAttachment> morphAttachment;
+
     /**
      * Updates the root note display text to show note name
      * Converts MIDI note number to note name with octave
      */
     void updateRootNoteDisplay();
 
+    //==============================================================================
+    // Performance panel
+
+    /**
+     * Button for expanding/collapsing the performance panel
+     */
+    juce::TextButton performanceToggle;
+
+    /**
+     * Collapsible panel showing the processBlock profiler
+     * Built the first time it's expanded, so opening the editor doesn't pay for it
+     */
+    std::unique_ptr<PerformancePanel> performancePanel;
+
+    /**
+     * Shows or hides the performance panel and resizes the editor to fit
+     */
+    void setPerformancePanelVisible(bool shouldBeVisible);
+
+    /**
+     * Returns whether the performance panel has been built and is expanded
+     */
+    bool isPerformancePanelVisible() const { return performancePanel != nullptr && performancePanel->isVisible(); }
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RandomWalkSequencerEditor)
 };
\ No newline at end of file
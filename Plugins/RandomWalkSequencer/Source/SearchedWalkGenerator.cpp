@@ -0,0 +1,147 @@
+#include "SearchedWalkGenerator.h"
+#include <algorithm>
+
+/**
+ * Constructor - seeds the search randomly
+ */
+SearchedWalkGenerator::SearchedWalkGenerator() = default;
+
+/**
+ * Constructor - seeds the search
+ */
+SearchedWalkGenerator::SearchedWalkGenerator(juce::int64 seed)
+    : random(seed)
+{
+}
+
+/**
+ * Starts a new stream from the user's pattern
+ * The first (partial) pass plays the pattern as it is, the search starts at the next one
+ */
+void SearchedWalkGenerator::restart(const LookaheadContext& newContext)
+{
+    context = newContext;
+    std::copy_n(context.sequence, maxSteps, walk);
+    renderPass();
+}
+
+/**
+ * Renders the next step, searching for the next pass whenever the loop wraps
+ */
+void SearchedWalkGenerator::renderStep(juce::int64 index, RenderedStep& step)
+{
+    const int position = context.getLoopPosition(index);
+
+    if (position == 0 && index > 0)
+        searchNextPass();
+
+    step.plays = loopPlays[position];
+    step.note = loopNotes[position];
+    step.velocity = loopVelocities[position];
+    step.sequenceIndex = (position + context.parameters.offset) % context.numSteps;
+}
+
+/**
+ * Scores a walk as it plays through the loop
+ */
+float SearchedWalkGenerator::scoreWalk(const int* walkToScore, const int* original, const LookaheadContext& scoredContext) noexcept
+{
+    const int loopLength = juce::jmax(1, scoredContext.getLoopLength());
+    const int numSteps = scoredContext.numSteps;
+    const int offset = scoredContext.parameters.offset;
+
+    float score = 0.0f;
+    int previous = 0;
+    int first = 0;
+    bool hasPrevious = false;
+
+    for (int position = 0; position < loopLength; ++position)
+    {
+        const int index = (position + offset) % numSteps;
+
+        // Steps that don't play don't shape the melody
+        if (scoredContext.parameters.manualStepMode && !scoredContext.enabled[index])
+            continue;
+
+        const int value = walkToScore[index];
+        score -= 0.25f * (float) std::abs(value - original[index]);
+
+        if (!hasPrevious)
+        {
+            first = value;
+            hasPrevious = true;
+        }
+        else
+        {
+            const int interval = std::abs(value - previous);
+
+            if (interval == 0)
+                score -= 0.5f;
+            else if (interval <= 2)
+                score += 1.0f;
+            else if (interval > 7)
+                score -= (float) (interval - 7);
+        }
+
+        previous = value;
+    }
+
+    if (hasPrevious && std::abs(previous - first) <= 2)
+        score += 2.0f;
+
+    return score;
+}
+
+/**
+ * Tries a batch of mutations of the current walk and keeps the best one
+ * Each mutation moves one to three steps to a note a few semitones from a neighbour,
+ * so the walk continues from where it is rather than jumping anywhere
+ */
+void SearchedWalkGenerator::searchNextPass()
+{
+    const int numSteps = context.numSteps;
+    const int loopLength = juce::jmax(1, context.getLoopLength());
+
+    int best[maxSteps];
+    std::copy_n(walk, maxSteps, best);
+    float bestScore = scoreWalk(walk, context.sequence, context);
+
+    for (int i = 0; i < numCandidates; ++i)
+    {
+        std::copy_n(walk, maxSteps, candidate);
+
+        const int numMutations = 1 + random.nextInt(3);
+
+        for (int m = 0; m < numMutations; ++m)
+        {
+            const int position = random.nextInt(loopLength);
+            const int index = (position + context.parameters.offset) % numSteps;
+            const int neighbour = (index + (random.nextBool() ? 1 : numSteps - 1)) % numSteps;
+            const int move = (1 + random.nextInt(3)) * (random.nextBool() ? 1 : -1);
+
+            candidate[index] = juce::jlimit(-12, 12, candidate[neighbour] + move);
+        }
+
+        const float score = scoreWalk(candidate, context.sequence, context);
+
+        if (score > bestScore)
+        {
+            bestScore = score;
+            std::copy_n(candidate, maxSteps, best);
+        }
+    }
+
+    std::copy_n(best, maxSteps, walk);
+    renderPass();
+}
+
+/**
+ * Renders what every loop position plays on this pass, the same way the sequencer
+ * renders its own loop image
+ */
+void SearchedWalkGenerator::renderPass()
+{
+    StepPattern pattern { walk, context.enabled, nullptr };
+    LoopImage image { loopNotes, loopVelocities, loopPlays, nullptr };
+    SequencerEngines::renderLoop(context.numSteps, 1, pattern, context.parameters, image);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "LookaheadRenderer.h"
+
+/**
+ * Lookahead generator that keeps the walk going: on every pass of the loop it tries a
+ * batch of mutations of the last pass, each one continuing the walk from a step's
+ * neighbours, and plays the one that scores best as a melody while staying close to
+ * the user's pattern.
+ * The search is far too much work for the audio thread, so it runs on the
+ * LookaheadRenderer's worker, a pass ahead of the playhead
+ */
+class SearchedWalkGenerator : public LookaheadGenerator
+{
+public:
+    /**
+     * Number of mutations tried on every pass
+     */
+    static constexpr int numCandidates = 256;
+
+    /**
+     * Constructor - seeds the search randomly
+     */
+    SearchedWalkGenerator();
+
+    /**
+     * Constructor - seeds the search, so the same context always renders the same stream
+     */
+    explicit SearchedWalkGenerator(juce::int64 seed);
+
+    void restart(const LookaheadContext& newContext) override;
+    void renderStep(juce::int64 index, RenderedStep& step) override;
+
+    /**
+     * Scores a walk as it plays through the loop, higher is better
+     * Stepwise motion scores, leaps beyond a fifth and repeated notes cost, as does
+     * every semitone away from the original pattern; a loop that ends near where it
+     * starts scores a bonus, so it wraps smoothly
+     * @param walk Note offsets of the walk, one per sequence step
+     * @param original The user's pattern, one per sequence step
+     */
+    static float scoreWalk(const int* walk, const int* original, const LookaheadContext& context) noexcept;
+
+private:
+    static constexpr int maxSteps = LookaheadContext::maxSteps;
+
+    void searchNextPass();
+    void renderPass();
+
+    LookaheadContext context;
+    juce::Random random;
+
+    int walk[maxSteps] {};          // The walk playing on the current pass
+    int candidate[maxSteps] {};     // The mutation being scored
+
+    // What every loop position plays on the current pass
+    int loopNotes[maxSteps] {};
+    juce::uint8 loopVelocities[maxSteps] {};
+    bool loopPlays[maxSteps] {};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SearchedWalkGenerator)
+};
@@ -0,0 +1,75 @@
+#include "SequencerEngine.h"
+
+namespace
+{
+// The pre-instantiated configurations, indexed by step count and lane count
+constexpr int specialisedSteps[] = { 16, 32, 64 };
+constexpr int specialisedLanes[] = { 1, 4, 8 };
+
+constexpr RenderLoopFunction specialisedRenderLoops[3][3] = {
+    { &SequencerEngine<16, 1>::renderLoop, &SequencerEngine<16, 4>::renderLoop, &SequencerEngine<16, 8>::renderLoop },
+    { &SequencerEngine<32, 1>::renderLoop, &SequencerEngine<32, 4>::renderLoop, &SequencerEngine<32, 8>::renderLoop },
+    { &SequencerEngine<64, 1>::renderLoop, &SequencerEngine<64, 4>::renderLoop, &SequencerEngine<64, 8>::renderLoop }
+};
+
+int findIndex(const int (&values)[3], int value) noexcept
+{
+    for (int i = 0; i < 3; ++i)
+        if (values[i] == value)
+            return i;
+
+    return -1;
+}
+} // namespace
+
+/**
+ * Gets the loop renderer for a configuration, or nullptr if it isn't pre-instantiated
+ */
+RenderLoopFunction SequencerEngines::getRenderLoop(int numSteps, int numLanes) noexcept
+{
+    auto stepsIndex = findIndex(specialisedSteps, numSteps);
+    auto lanesIndex = findIndex(specialisedLanes, numLanes);
+
+    if (stepsIndex < 0 || lanesIndex < 0)
+        return nullptr;
+
+    return specialisedRenderLoops[stepsIndex][lanesIndex];
+}
+
+/**
+ * Renders a loop image through the pre-instantiated renderer, or the generic path
+ */
+void SequencerEngines::renderLoop(int numSteps, int numLanes, const StepPattern& pattern,
+                                  const LoopParameters& parameters, LoopImage& image) noexcept
+{
+    if (auto render = getRenderLoop(numSteps, numLanes))
+        render(pattern, parameters, image);
+    else
+        renderLoopGeneric(numSteps, numLanes, pattern, parameters, image);
+}
+
+/**
+ * Renders a loop image one position at a time, with runtime step and lane counts
+ */
+void SequencerEngines::renderLoopGeneric(int numSteps, int numLanes, const StepPattern& pattern,
+                                         const LoopParameters& parameters, LoopImage& image) noexcept
+{
+    const int loopLength = parameters.manualStepMode ? numSteps : parameters.density;
+
+    for (int i = 0; i < numSteps; ++i)
+    {
+        // Calculate the actual step index in the sequence, considering offset
+        const int index = (i + parameters.offset) % numSteps;
+        const int value = pattern.notes[index];
+
+        image.notes[i] = parameters.root + value;
+        image.velocities[i] = 80 + (juce::uint8) (30.0 * std::abs(value) / 12.0);
+
+        // In Manual Step mode: Only play if step is enabled.
+        // In Density mode: Only the steps in range play
+        image.plays[i] = parameters.manualStepMode ? pattern.enabled[index] : i < loopLength;
+
+        for (int lane = 1; lane < numLanes; ++lane)
+            image.values[(lane - 1) * numSteps + i] = pattern.values[(lane - 1) * numSteps + index];
+    }
+}
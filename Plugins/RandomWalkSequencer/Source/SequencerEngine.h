@@ -0,0 +1,212 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include "PatternGenerators.h"
+#include "StepClock.h"
+
+/**
+ * Pattern data of a sequencer, as read by the loop renderer
+ * Lane 0 is the note lane (notes and enabled flags), every further lane holds one
+ * float per step, stored lane after lane in values
+ */
+struct StepPattern
+{
+    const int* notes = nullptr;      // Note offsets from the root, one per step
+    const bool* enabled = nullptr;   // Manual step mode enabled flags, one per step
+    const float* values = nullptr;   // (numLanes - 1) * numSteps lane values
+};
+
+/**
+ * The parameters a loop image is rendered with, latched at a step boundary
+ */
+struct LoopParameters
+{
+    int root = 72;
+    int offset = 0;
+    int density = 8;
+    bool manualStepMode = false;
+
+    bool operator== (const LoopParameters& other) const noexcept
+    {
+        return root == other.root && offset == other.offset && density == other.density
+               && manualStepMode == other.manualStepMode;
+    }
+
+    bool operator!= (const LoopParameters& other) const noexcept { return !operator== (other); }
+};
+
+/**
+ * What every position of the loop plays: the pattern rotated by the offset, with the
+ * root and velocity applied, laid out like StepPattern
+ */
+struct LoopImage
+{
+    int* notes = nullptr;
+    juce::uint8* velocities = nullptr;
+    bool* plays = nullptr;
+    float* values = nullptr;
+};
+
+/**
+ * Renders a loop image
+ */
+using RenderLoopFunction = void (*)(const StepPattern&, const LoopParameters&, LoopImage&) noexcept;
+
+/**
+ * Step lengths for each rate setting, matching the editor's rate menu
+ */
+struct RateTable
+{
+    static constexpr int numRates = 10;
+    static constexpr double stepLengthsInBeats[numRates] = { 1.0 / 32.0, 1.0 / 16.0, 1.0 / 8.0, 1.0 / 4.0, 1.0 / 3.0,
+                                                             1.0 / 2.0, 1.0, 2.0, 3.0, 4.0 };
+
+    // The same lengths in StepClock ticks, all whole at 960 per beat
+    static constexpr juce::int64 stepLengthsInTicks[numRates] = { 30, 60, 120, 240, 320, 480, 960, 1920, 2880, 3840 };
+
+    /**
+     * Gets the length of a step in beats (e.g. 0.25 = a sixteenth note)
+     * @param rate Rate setting, clamped to the table
+     */
+    static constexpr double getStepLengthInBeats(int rate) noexcept
+    {
+        return stepLengthsInBeats[rate < 0 ? 0 : (rate >= numRates ? numRates - 1 : rate)];
+    }
+
+    /**
+     * Gets the exact length of a step in ticks
+     * @param rate Rate setting, clamped to the table
+     */
+    static constexpr StepClock::Ticks getStepLengthInTicks(int rate) noexcept
+    {
+        return { stepLengthsInTicks[rate < 0 ? 0 : (rate >= numRates ? numRates - 1 : rate)], 1 };
+    }
+};
+
+//==============================================================================
+/**
+ * The sequencer's step-level work, specialised for a step count and a lane count
+ *
+ * With both known at compile time, the loop renderer has constant trip counts and
+ * power-of-two wrapping, so the compiler unrolls and vectorises it; the pattern
+ * generators are picked from a constexpr table instead of a switch.
+ * Common configurations are pre-instantiated in SequencerEngine.cpp and reachable at
+ * runtime through SequencerEngines::getRenderLoop
+ */
+template <int Steps, int Lanes>
+class SequencerEngine
+{
+public:
+    static_assert(Steps >= 4 && (Steps & (Steps - 1)) == 0, "Step count must be a power of two");
+    static_assert(Lanes >= 1, "The note lane is always there");
+
+    static constexpr int numSteps = Steps;
+    static constexpr int numLanes = Lanes;
+
+    /**
+     * Pattern types, in the order of the editor's pattern menu
+     */
+    enum PatternType
+    {
+        randomWalkPattern,
+        ascendingPattern,
+        descendingPattern,
+        arpeggioPattern,
+        numPatternTypes
+    };
+
+    /**
+     * Gets the length of a step in beats for a rate setting
+     */
+    static constexpr double getStepLengthInBeats(int rate) noexcept { return RateTable::getStepLengthInBeats(rate); }
+
+    /**
+     * Gets the exact length of a step in ticks for a rate setting
+     */
+    static constexpr StepClock::Ticks getStepLengthInTicks(int rate) noexcept { return RateTable::getStepLengthInTicks(rate); }
+
+    /**
+     * Fills a sequence with a generated pattern
+     * @param patternType A PatternType, unknown types generate a random walk
+     */
+    static void generatePattern(int patternType, int (&sequence)[Steps], juce::Random& random)
+    {
+        generators[juce::isPositiveAndBelow(patternType, (int) numPatternTypes) ? patternType : 0](sequence, random);
+    }
+
+    /**
+     * Renders what every loop position plays
+     * Loop position i plays step (i + offset) % Steps; in density mode only positions
+     * below the density play, in manual step mode only enabled steps do
+     */
+    static void renderLoop(const StepPattern& pattern, const LoopParameters& parameters, LoopImage& image) noexcept
+    {
+        // The rotation is split into two contiguous runs, so neither needs a gather
+        const int offset = parameters.offset & (Steps - 1);
+        renderRun(pattern, parameters, image, 0, offset, Steps - offset);
+        renderRun(pattern, parameters, image, Steps - offset, 0, offset);
+
+        if (!parameters.manualStepMode)
+        {
+            for (int i = 0; i < Steps; ++i)
+                image.plays[i] = i < parameters.density;
+        }
+    }
+
+private:
+    using Generator = void (*)(int (&)[Steps], juce::Random&);
+
+    static constexpr Generator generators[numPatternTypes] = { &RandomWalkPattern::generate<Steps>,
+                                                               &AscendingPattern::generate<Steps>,
+                                                               &DescendingPattern::generate<Steps>,
+                                                               &ArpeggioPattern::generate<Steps> };
+
+    /**
+     * Renders loop positions [first, first + count) from steps [source, source + count)
+     */
+    static void renderRun(const StepPattern& pattern, const LoopParameters& parameters, LoopImage& image,
+                          int first, int source, int count) noexcept
+    {
+        const int* notes = pattern.notes + source;
+
+        for (int i = 0; i < count; ++i)
+        {
+            // 80 + 30 * |value| / 12, in integers
+            const int value = notes[i];
+            image.notes[first + i] = parameters.root + value;
+            image.velocities[first + i] = (juce::uint8) (80 + (5 * std::abs(value)) / 2);
+        }
+
+        if (parameters.manualStepMode)
+            std::copy_n(pattern.enabled + source, count, image.plays + first);
+
+        for (int lane = 0; lane < Lanes - 1; ++lane)
+            std::copy_n(pattern.values + lane * Steps + source, count, image.values + lane * Steps + first);
+    }
+};
+
+//==============================================================================
+namespace SequencerEngines
+{
+/**
+ * Gets the loop renderer for a configuration
+ * @return The pre-instantiated renderer for 16, 32 or 64 steps with 1, 4 or 8 lanes,
+ *         or nullptr for any other configuration
+ */
+RenderLoopFunction getRenderLoop(int numSteps, int numLanes) noexcept;
+
+/**
+ * Renders a loop image for any configuration, through the pre-instantiated renderer
+ * if there is one, or the generic path otherwise
+ */
+void renderLoop(int numSteps, int numLanes, const StepPattern& pattern,
+                const LoopParameters& parameters, LoopImage& image) noexcept;
+
+/**
+ * Renders a loop image with the step and lane counts only known at runtime
+ * This is the path every configuration took before SequencerEngine
+ */
+void renderLoopGeneric(int numSteps, int numLanes, const StepPattern& pattern,
+                       const LoopParameters& parameters, LoopImage& image) noexcept;
+} // namespace SequencerEngines
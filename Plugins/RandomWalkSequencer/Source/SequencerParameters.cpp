@@ -0,0 +1,178 @@
+#include "SequencerParameters.h"
+
+namespace
+{
+/**
+ * A JUCE parameter that calls back whenever its value changes
+ * The callback runs on whichever thread changed the value (possibly the audio thread),
+ * so it must only do what the sequencer's setters do: store into an atomic
+ */
+template <typename ParameterType, typename ValueType>
+class ForwardingParameter final : public ParameterType
+{
+public:
+    template <typename... Args>
+    explicit ForwardingParameter(std::function<void(ValueType)> callback, Args&&... args)
+        : ParameterType(std::forward<Args>(args)...), onValueChanged(std::move(callback))
+    {
+    }
+
+private:
+    void valueChanged(ValueType newValue) override
+    {
+        onValueChanged(newValue);
+    }
+
+    std::function<void(ValueType)> onValueChanged;
+};
+
+using ForwardingChoiceParameter = ForwardingParameter<juce::AudioParameterChoice, int>;
+using ForwardingIntParameter = ForwardingParameter<juce::AudioParameterInt, int>;
+using ForwardingFloatParameter = ForwardingParameter<juce::AudioParameterFloat, float>;
+using ForwardingBoolParameter = ForwardingParameter<juce::AudioParameterBool, bool>;
+} // namespace
+
+/**
+ * Constructor - creates the parameters with the sequencer's current values as defaults
+ * and adds them to the processor
+ */
+SequencerParameters::SequencerParameters(juce::AudioProcessor& processor, RandomWalkSequencer& sequencerToUse)
+    : sequencer(sequencerToUse)
+{
+    // Rate - musical note values, matching the editor's rate menu
+    auto rateParameter = std::make_unique<ForwardingChoiceParameter>(
+        [this](int value) { sequencer.setRate(value); },
+        juce::ParameterID("rate", 1), "Rate",
+        juce::StringArray("1/32", "1/16", "1/8", "1/4", "1/3", "1/2", "1", "2", "3", "4"),
+        sequencer.getRate());
+
+    // Density - number of active steps
+    auto densityParameter = std::make_unique<ForwardingIntParameter>(
+        [this](int value) { sequencer.setDensity(value); },
+        juce::ParameterID("density", 1), "Density", 1, 16, sequencer.getDensity());
+
+    // Offset - sequence start position
+    auto offsetParameter = std::make_unique<ForwardingIntParameter>(
+        [this](int value) { sequencer.setOffset(value); },
+        juce::ParameterID("offset", 1), "Offset", 0, 15, sequencer.getOffset());
+
+    // Gate - note duration as a proportion of the step
+    auto gateParameter = std::make_unique<ForwardingFloatParameter>(
+        [this](float value) { sequencer.setGate(value); },
+        juce::ParameterID("gate", 1), "Gate",
+        juce::NormalisableRange<float>(0.1f, 1.0f, 0.01f), sequencer.getGate());
+
+    // Root - base MIDI note, from C0 to C9
+    auto rootParameter = std::make_unique<ForwardingIntParameter>(
+        [this](int value) { sequencer.setRoot(value); },
+        juce::ParameterID("root", 1), "Root", 12, 120, sequencer.getRoot());
+
+    // BPM - internal tempo, used when not synced to host
+    auto bpmParameter = std::make_unique<ForwardingFloatParameter>(
+        [this](float value) { sequencer.setInternalBpm(value); },
+        juce::ParameterID("bpm", 1), "BPM",
+        juce::NormalisableRange<float>(30.0f, 300.0f, 0.01f), (float) sequencer.getInternalBpm());
+
+    // Channel - MIDI channel for notes when MPE is off
+    auto channelParameter = std::make_unique<ForwardingIntParameter>(
+        [this](int value) { sequencer.setOutputChannel(value); },
+        juce::ParameterID("channel", 1), "Channel", 1, 16, sequencer.getOutputChannel());
+
+    // MPE - one member channel per note, with per-note expression
+    auto mpeParameter = std::make_unique<ForwardingBoolParameter>(
+        [this](bool value) { sequencer.setMpeMode(value); },
+        juce::ParameterID("mpe", 1), "MPE", sequencer.isMpeMode());
+
+    // Morph - from pattern slot A to slot B
+    auto morphParameter = std::make_unique<ForwardingFloatParameter>(
+        [this](float value) { sequencer.setMorphAmount(value); },
+        juce::ParameterID("morph", 1), "Morph",
+        juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f), sequencer.getMorphAmount());
+
+    // Transpose - semitones added to every note played, after the walk
+    auto transposeParameter = std::make_unique<ForwardingIntParameter>(
+        [this](int value) { sequencer.setPostTranspose(value); },
+        juce::ParameterID("transpose", 1), "Transpose", -24, 24, sequencer.getPostTranspose());
+
+    // Velocity curve - softer below 0, louder above
+    auto velocityCurveParameter = std::make_unique<ForwardingFloatParameter>(
+        [this](float value) { sequencer.setVelocityCurve(value); },
+        juce::ParameterID("velocityCurve", 1), "Velocity Curve",
+        juce::NormalisableRange<float>(-1.0f, 1.0f, 0.01f), sequencer.getVelocityCurve());
+
+    // Delay - of everything played, in milliseconds
+    auto delayParameter = std::make_unique<ForwardingFloatParameter>(
+        [this](float value) { sequencer.setOutputDelay(value); },
+        juce::ParameterID("delay", 1), "Delay",
+        juce::NormalisableRange<float>(0.0f, RandomWalkSequencer::maxOutputDelay, 0.1f), sequencer.getOutputDelay());
+
+    rate = rateParameter.get();
+    density = densityParameter.get();
+    offset = offsetParameter.get();
+    gate = gateParameter.get();
+    root = rootParameter.get();
+    bpm = bpmParameter.get();
+    channel = channelParameter.get();
+    mpe = mpeParameter.get();
+    morph = morphParameter.get();
+    transpose = transposeParameter.get();
+    velocityCurve = velocityCurveParameter.get();
+    delay = delayParameter.get();
+
+    // The processor takes ownership
+    processor.addParameter(rateParameter.release());
+    processor.addParameter(densityParameter.release());
+    processor.addParameter(offsetParameter.release());
+    processor.addParameter(gateParameter.release());
+    processor.addParameter(rootParameter.release());
+    processor.addParameter(bpmParameter.release());
+    processor.addParameter(channelParameter.release());
+    processor.addParameter(mpeParameter.release());
+    processor.addParameter(morphParameter.release());
+    processor.addParameter(transposeParameter.release());
+    processor.addParameter(velocityCurveParameter.release());
+    processor.addParameter(delayParameter.release());
+}
+
+/**
+ * Copies the sequencer's current values into the parameters
+ * Only parameters whose value differs are touched, so the host isn't sent redundant changes
+ */
+void SequencerParameters::updateFromSequencer()
+{
+    if (rate->getIndex() != sequencer.getRate())
+        *rate = sequencer.getRate();
+
+    if (density->get() != sequencer.getDensity())
+        *density = sequencer.getDensity();
+
+    if (offset->get() != sequencer.getOffset())
+        *offset = sequencer.getOffset();
+
+    if (std::abs(gate->get() - sequencer.getGate()) > 0.001f)
+        *gate = sequencer.getGate();
+
+    if (root->get() != sequencer.getRoot())
+        *root = sequencer.getRoot();
+
+    if (std::abs(bpm->get() - (float) sequencer.getInternalBpm()) > 0.001f)
+        *bpm = (float) sequencer.getInternalBpm();
+
+    if (channel->get() != sequencer.getOutputChannel())
+        *channel = sequencer.getOutputChannel();
+
+    if (mpe->get() != sequencer.isMpeMode())
+        *mpe = sequencer.isMpeMode();
+
+    if (std::abs(morph->get() - sequencer.getMorphAmount()) > 0.001f)
+        *morph = sequencer.getMorphAmount();
+
+    if (transpose->get() != sequencer.getPostTranspose())
+        *transpose = sequencer.getPostTranspose();
+
+    if (std::abs(velocityCurve->get() - sequencer.getVelocityCurve()) > 0.001f)
+        *velocityCurve = sequencer.getVelocityCurve();
+
+    if (std::abs(delay->get() - sequencer.getOutputDelay()) > 0.001f)
+        *delay = sequencer.getOutputDelay();
+}
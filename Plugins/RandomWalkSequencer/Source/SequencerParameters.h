@@ -0,0 +1,46 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "RandomWalkSequencer.h"
+
+/**
+ * Host-automatable parameters of the RandomWalkSequencer
+ * Every parameter forwards its new value to the sequencer's setter as soon as it changes,
+ * so the audio thread only ever reads the sequencer's atomics and never calls into the
+ * parameters or any listeners
+ */
+class SequencerParameters
+{
+public:
+    /**
+     * Creates the parameters and adds them to the processor
+     * @param processor The processor that owns the parameters
+     * @param sequencer The sequencer that receives the parameter changes
+     */
+    SequencerParameters(juce::AudioProcessor& processor, RandomWalkSequencer& sequencer);
+
+    /**
+     * Copies the sequencer's current values into the parameters, notifying the host
+     * Call this after the sequencer's values were changed directly, e.g. by loading state
+     */
+    void updateFromSequencer();
+
+    // The parameters, owned by the processor
+    juce::AudioParameterChoice* rate = nullptr;
+    juce::AudioParameterInt* density = nullptr;
+    juce::AudioParameterInt* offset = nullptr;
+    juce::AudioParameterFloat* gate = nullptr;
+    juce::AudioParameterInt* root = nullptr;
+    juce::AudioParameterFloat* bpm = nullptr;
+    juce::AudioParameterInt* channel = nullptr;
+    juce::AudioParameterBool* mpe = nullptr;
+    juce::AudioParameterFloat* morph = nullptr;
+    juce::AudioParameterInt* transpose = nullptr;
+    juce::AudioParameterFloat* velocityCurve = nullptr;
+    juce::AudioParameterFloat* delay = nullptr;
+
+private:
+    RandomWalkSequencer& sequencer;
+
+    JUCE_DECLARE_NON_COPYABLE(SequencerParameters)
+};
@@ -0,0 +1,135 @@
+#include "StepClock.h"
+
+namespace
+{
+juce::int64 greatestCommonDivisor(juce::int64 a, juce::int64 b) noexcept
+{
+    while (b != 0)
+    {
+        auto r = a % b;
+        a = b;
+        b = r;
+    }
+
+    return a;
+}
+
+// (a * b) mod m for 0 <= b < m, without overflowing as long as m * m fits in 64 bits
+juce::int64 multiplyModulo(juce::int64 a, juce::int64 b, juce::int64 m) noexcept
+{
+    auto reduced = a % m;
+
+    if (reduced < 0)
+        reduced += m;
+
+    return (reduced * b) % m;
+}
+
+// floor(a / b) for b > 0
+juce::int64 floorDivide(juce::int64 a, juce::int64 b) noexcept
+{
+    auto quotient = a / b;
+    return (a % b < 0) ? quotient - 1 : quotient;
+}
+} // namespace
+
+/**
+ * Gets the first sample of a step: floor(step * numerator / denominator), split so
+ * the product can't overflow
+ */
+juce::int64 StepClock::SampleLength::getStepStart(juce::int64 step) const noexcept
+{
+    const auto whole = numerator / denominator;
+    const auto remainder = numerator % denominator;
+
+    const auto stepBlocks = floorDivide(step, denominator);
+    const auto stepRest = step - stepBlocks * denominator;
+
+    return step * whole + stepBlocks * remainder + (stepRest * remainder) / denominator;
+}
+
+/**
+ * Converts a step length in ticks to samples
+ * samples = ticks / 960 beats * 60 / bpm seconds * sampleRate
+ */
+StepClock::SampleLength StepClock::getSampleLength(double sampleRate, double bpm, Ticks stepLength) noexcept
+{
+    const auto wholeSampleRate = (juce::int64) std::llround(sampleRate);
+    const auto milliBpm = (juce::int64) std::llround(bpm * 1000.0);
+
+    if (wholeSampleRate <= 0 || milliBpm <= 0 || stepLength.numerator <= 0 || stepLength.denominator <= 0)
+        return {};
+
+    SampleLength result;
+    result.numerator = stepLength.numerator * 60000 * wholeSampleRate;
+    result.denominator = stepLength.denominator * ticksPerQuarterNote * milliBpm;
+
+    const auto divisor = greatestCommonDivisor(result.numerator, result.denominator);
+    result.numerator /= divisor;
+    result.denominator /= divisor;
+
+    // The carried remainder is multiplied by step indices, so keep it well inside 64 bits
+    jassert(result.denominator < (juce::int64) 3000000000);
+
+    return result;
+}
+
+//==============================================================================
+/**
+ * Changes the step length, keeping the samples the current step has already played
+ */
+void StepClock::setStepLength(const SampleLength& newLength) noexcept
+{
+    if (newLength == length)
+        return;
+
+    length = newLength;
+    wholeSamples = length.isValid() ? length.numerator / length.denominator : 0;
+    remainder = length.isValid() ? length.numerator % length.denominator : 0;
+    carry = remainder;
+
+    // If the step just got shorter than the time already spent in it, end it now
+    // instead of firing a burst of catch-up steps at the same sample position
+    currentStepLength = wholeSamples;
+    samplesIntoStep = juce::jmin(samplesIntoStep, currentStepLength);
+}
+
+/**
+ * Starts the current step over, as the first step of a new grid
+ */
+void StepClock::restart() noexcept
+{
+    carry = remainder;
+    currentStepLength = wholeSamples;
+    samplesIntoStep = 0;
+}
+
+/**
+ * Lines the clock up with a grid, so the step in progress is the one before the given step
+ */
+void StepClock::alignToStep(juce::int64 step, juce::int64 samplesUntilStep) noexcept
+{
+    if (!length.isValid())
+        return;
+
+    currentStepLength = length.getStepStart(step) - length.getStepStart(step - 1);
+    samplesIntoStep = currentStepLength - samplesUntilStep;
+    carry = multiplyModulo(step, remainder, length.denominator);
+}
+
+/**
+ * Ends the current step and starts the next, carrying the fraction of a sample
+ */
+void StepClock::startNextStep() noexcept
+{
+    samplesIntoStep -= currentStepLength;
+
+    carry += remainder;
+    currentStepLength = wholeSamples;
+
+    if (carry >= length.denominator)
+    {
+        carry -= length.denominator;
+        ++currentStepLength;
+    }
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * Drift-free step clock
+ *
+ * Step lengths are rational numbers of ticks (960 per quarter note), and the resulting
+ * length in samples is kept as an exact fraction. Step k starts at sample floor(k * length)
+ * from the clock's origin: each step gets the whole samples of the length, plus one more
+ * whenever the carried remainder wraps, so rounding never accumulates however long the
+ * clock runs. Everything the audio thread touches is 64-bit integer arithmetic
+ */
+class StepClock
+{
+public:
+    /**
+     * Resolution of step lengths
+     */
+    static constexpr int ticksPerQuarterNote = 960;
+
+    /**
+     * A step length in ticks, as a fraction
+     * Tuplets and dotted values that don't divide 960 can use the denominator, e.g. a
+     * seventh of a beat is { 960, 7 }
+     */
+    struct Ticks
+    {
+        juce::int64 numerator = ticksPerQuarterNote / 4;
+        juce::int64 denominator = 1;
+    };
+
+    /**
+     * A step length in samples, as a reduced fraction
+     */
+    struct SampleLength
+    {
+        juce::int64 numerator = 0;
+        juce::int64 denominator = 1;
+
+        bool isValid() const noexcept { return numerator > 0 && denominator > 0; }
+        double toDouble() const noexcept { return (double) numerator / (double) denominator; }
+
+        /**
+         * Gets the first sample of a step, measured from the start of step 0
+         */
+        juce::int64 getStepStart(juce::int64 step) const noexcept;
+
+        bool operator== (const SampleLength& other) const noexcept
+        {
+            return numerator == other.numerator && denominator == other.denominator;
+        }
+
+        bool operator!= (const SampleLength& other) const noexcept { return !operator== (other); }
+    };
+
+    /**
+     * Converts a step length in ticks to samples
+     * The sample rate is taken in whole hertz and the tempo in thousandths of a BPM, so
+     * the result is exact for those
+     */
+    static SampleLength getSampleLength(double sampleRate, double bpm, Ticks stepLength) noexcept;
+
+    //==============================================================================
+    /**
+     * Changes the step length
+     * The step in progress takes the new length, ending at once if it has already
+     * played longer than that
+     */
+    void setStepLength(const SampleLength& newLength) noexcept;
+
+    /**
+     * Gets the exact step length
+     */
+    const SampleLength& getStepLength() const noexcept { return length; }
+
+    /**
+     * Starts the current step over, so the next one starts a full step length from now
+     */
+    void restart() noexcept;
+
+    /**
+     * Lines the clock up with a grid that started at step 0
+     * @param step The grid step that starts next
+     * @param samplesUntilStep How many samples from now it starts
+     */
+    void alignToStep(juce::int64 step, juce::int64 samplesUntilStep) noexcept;
+
+    //==============================================================================
+    /**
+     * Returns whether the next step should start now
+     */
+    bool isStepDue() const noexcept { return samplesIntoStep >= currentStepLength; }
+
+    /**
+     * Ends the current step and starts the next one
+     */
+    void startNextStep() noexcept;
+
+    /**
+     * Moves the clock forward
+     */
+    void advance(juce::int64 numSamples) noexcept { samplesIntoStep += numSamples; }
+
+    /**
+     * Gets the number of samples played since the current step started
+     */
+    juce::int64 getSamplesIntoStep() const noexcept { return samplesIntoStep; }
+
+    /**
+     * Gets the number of samples until the next step starts
+     */
+    juce::int64 getSamplesUntilNextStep() const noexcept { return currentStepLength - samplesIntoStep; }
+
+    /**
+     * Gets the length of the current step in whole samples
+     */
+    juce::int64 getCurrentStepLength() const noexcept { return currentStepLength; }
+
+private:
+    SampleLength length;
+    juce::int64 wholeSamples = 0;       // Whole samples in a step
+    juce::int64 remainder = 0;          // Fraction of a sample in a step, in 1/denominator
+    juce::int64 carry = 0;              // Fraction carried to the end of the current step
+
+    juce::int64 samplesIntoStep = 0;
+    juce::int64 currentStepLength = 0;
+};
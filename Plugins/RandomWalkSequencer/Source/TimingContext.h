@@ -0,0 +1,60 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * Host timing information for one processing block
+ * Built by the plugin processor from the host's playhead and passed to the sequencer,
+ * so the sequencer itself never needs to know about AudioProcessor or AudioPlayHead
+ */
+struct TimingContext
+{
+    /**
+     * True if the host supplied position information for this block
+     */
+    bool hasHostPosition = false;
+
+    /**
+     * Whether the host transport is playing
+     */
+    bool hostIsPlaying = false;
+
+    /**
+     * Host tempo in beats per minute, or 0 if the host didn't supply one
+     */
+    double hostBpm = 0.0;
+
+    /**
+     * Host position in quarter notes, if supplied
+     */
+    juce::Optional<double> ppqPosition;
+
+    /**
+     * Host position in samples, if supplied
+     */
+    juce::Optional<juce::int64> timeInSamples;
+
+    /**
+     * Reads the current position from a playhead
+     * @param playHead The host's playhead, may be null (e.g. in the Standalone app or tests)
+     * @return The timing context for this block
+     */
+    static TimingContext fromPlayHead(juce::AudioPlayHead* playHead)
+    {
+        TimingContext context;
+
+        if (playHead == nullptr)
+            return context;
+
+        if (auto position = playHead->getPosition())
+        {
+            context.hasHostPosition = true;
+            context.hostIsPlaying = position->getIsPlaying();
+            context.hostBpm = position->getBpm().orFallback(0.0);
+            context.ppqPosition = position->getPpqPosition();
+            context.timeInSamples = position->getTimeInSamples();
+        }
+
+        return context;
+    }
+};
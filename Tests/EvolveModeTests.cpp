@@ -0,0 +1,157 @@
+#include <catch2/catch_test_macros.hpp>
+#include "SequencerTestHelpers.h"
+
+using namespace SequencerTestHelpers;
+
+namespace
+{
+//Manual step mode with every step of the loop playing the root
+void prepareFlat(RandomWalkSequencer& sequencer)
+{
+    prepare(sequencer);
+    sequencer.setManualStepMode(true);
+
+    for (int step = 0; step < 16; ++step)
+        sequencer.setSequenceValue(step, 0);
+}
+} // namespace
+
+TEST_CASE("Mutating a step continues the walk from a neighbour")
+{
+    juce::Random random(42);
+    int sequence[16];
+
+    for (int step = 0; step < 16; ++step)
+        sequence[step] = (step * 7) % 25 - 12;
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        int before[16];
+        std::copy_n(sequence, 16, before);
+
+        const int range = 1 + i % 12;
+        const int index = RandomWalkPattern::mutateStep(sequence, range, random);
+        REQUIRE(index >= 0);
+        REQUIRE(index < 16);
+
+        //Only the returned step moved, and it's within range of a neighbour
+        for (int step = 0; step < 16; ++step)
+            if (step != index)
+                CHECK(sequence[step] == before[step]);
+
+        const int previous = before[(index + 15) % 16];
+        const int next = before[(index + 1) % 16];
+        const bool nearPrevious = std::abs(sequence[index] - previous) <= range;
+        const bool nearNext = std::abs(sequence[index] - next) <= range;
+
+        CHECK((nearPrevious || nearNext));
+        CHECK(sequence[index] >= -12);
+        CHECK(sequence[index] <= 12);
+    }
+}
+
+TEST_CASE("Evolve mode changes at most the evolve rate's steps per loop, leaving the pattern alone")
+{
+    RandomWalkSequencer sequencer;
+    prepareFlat(sequencer);
+    sequencer.setEvolveEnabled(true);
+    sequencer.setEvolveRate(3);
+    sequencer.setEvolveRange(5);
+
+    juce::int64 position = 0;
+    auto notes = playNotes(sequencer, position, 16 * 20);
+    REQUIRE(notes.size() == 16 * 20);
+
+    //A position of the loop is a wrap apart from the same position on the next pass
+    int numChanged = 0;
+
+    for (size_t pass = 1; pass < 20; ++pass)
+    {
+        int changedThisPass = 0;
+
+        for (size_t step = 0; step < 16; ++step)
+            if (notes[pass * 16 + step] != notes[(pass - 1) * 16 + step])
+                ++changedThisPass;
+
+        CHECK(changedThisPass <= 3);
+        numChanged += changedThisPass;
+    }
+
+    CHECK(numChanged > 0);
+
+    //The stored pattern didn't move, the playing walk did
+    bool walkMoved = false;
+
+    for (int step = 0; step < 16; ++step)
+    {
+        CHECK(sequencer.getSequenceValue(step) == 0);
+        walkMoved = walkMoved || sequencer.getPlayingValue(step) != 0;
+    }
+
+    CHECK(walkMoved);
+
+    //Keeping the walk makes it the pattern
+    REQUIRE(sequencer.hasEvolvedWalk());
+    sequencer.keepEvolvedPattern();
+
+    for (int step = 0; step < 16; ++step)
+        CHECK(sequencer.getSequenceValue(step) == sequencer.getPlayingValue(step));
+}
+
+TEST_CASE("Editing the pattern restarts the evolution from it")
+{
+    RandomWalkSequencer sequencer;
+    prepareFlat(sequencer);
+    sequencer.setEvolveEnabled(true);
+    sequencer.setEvolveRate(16);
+
+    juce::int64 position = 0;
+    playNotes(sequencer, position, 40);
+
+    for (int step = 0; step < 16; ++step)
+        sequencer.setSequenceValue(step, 7);
+
+    //The next step picks up the edit, and the walk carries on from there
+    CHECK(playNotes(sequencer, position, 1) == std::vector<int> { 67 });
+
+    //Turning evolve mode off plays the pattern again
+    sequencer.setEvolveEnabled(false);
+    playNotes(sequencer, position, 40);
+    auto notes = playNotes(sequencer, position, 16);
+    CHECK(notes == std::vector<int>(16, 67));
+    CHECK(!sequencer.hasEvolvedWalk());
+    CHECK(sequencer.getPlayingValue(3) == 7);
+}
+
+TEST_CASE("Evolving allocates nothing and takes no locks on the audio thread")
+{
+    REQUIRE(PluginHelpers::areAudioThreadHooksInstalled());
+
+    RandomWalkSequencer sequencer;
+    prepareFlat(sequencer);
+    sequencer.setEvolveEnabled(true);
+    sequencer.setEvolveRate(16);
+    sequencer.setEvolveRange(12);
+
+    CHECK(countAudioThreadViolations(sequencer, 2000) == 0);
+}
+
+TEST_CASE("The evolve settings are saved with the state")
+{
+    RandomWalkSequencer sequencer;
+    sequencer.setEvolveEnabled(true);
+    sequencer.setEvolveRate(5);
+    sequencer.setEvolveRange(9);
+
+    RandomWalkSequencer restored;
+    restored.restoreStateFromXml(*sequencer.createStateXml());
+    CHECK(restored.isEvolveEnabled());
+    CHECK(restored.getEvolveRate() == 5);
+    CHECK(restored.getEvolveRange() == 9);
+
+    //Out of range values are clamped
+    sequencer.setEvolveRate(100);
+    sequencer.setEvolveRange(0);
+    CHECK(sequencer.getEvolveRate() == 16);
+    CHECK(sequencer.getEvolveRange() == 1);
+}
@@ -0,0 +1,305 @@
+#include <catch2/catch_test_macros.hpp>
+#include "PluginProcessor.h"
+
+//The golden logs are checked in next to this file, so any change to what the plugin plays
+//shows up as a diff against them, and a missing one fails. A run with RECORD_GOLDEN_OUTPUT
+//set in the environment records them instead, for a change that's meant, to be checked in
+#ifndef GOLDEN_OUTPUT_DIR
+ #error "GOLDEN_OUTPUT_DIR must point at the checked-in golden logs"
+#endif
+
+namespace
+{
+//Something the host does at a point of the timeline
+struct TransportEvent
+{
+    enum Type
+    {
+        setTempo,
+        seek,   //Jump the host position, as a loop or a click in the timeline does
+        stop,
+        start
+    };
+
+    juce::int64 sample;  //Samples rendered when it happens
+    Type type;
+    double value = 0.0;  //BPM for setTempo, seconds for seek
+};
+
+//A host playhead that plays back a script of transport events
+class ScriptedPlayHead : public juce::AudioPlayHead
+{
+public:
+    explicit ScriptedPlayHead(double sampleRateToUse) : sampleRate(sampleRateToUse) {}
+
+    juce::Optional<PositionInfo> getPosition() const override
+    {
+        PositionInfo info;
+        info.setIsPlaying(isPlaying);
+        info.setBpm(bpm);
+        info.setTimeInSamples(timeInSamples);
+        info.setPpqPosition(ppqPosition);
+        return info;
+    }
+
+    void apply(const TransportEvent& event)
+    {
+        switch (event.type)
+        {
+            case TransportEvent::setTempo: bpm = event.value; break;
+            case TransportEvent::seek:
+                timeInSamples = (juce::int64) (event.value * sampleRate);
+                ppqPosition = event.value * bpm / 60.0;
+                break;
+            case TransportEvent::stop: isPlaying = false; break;
+            case TransportEvent::start: isPlaying = true; break;
+        }
+    }
+
+    void advance(int numSamples)
+    {
+        if (!isPlaying)
+            return;
+
+        timeInSamples += numSamples;
+        ppqPosition += (double) numSamples * bpm / (60.0 * sampleRate);
+    }
+
+private:
+    double sampleRate;
+    bool isPlaying = true;
+    double bpm = 120.0;
+    juce::int64 timeInSamples = 0;
+    double ppqPosition = 0.0;
+};
+
+struct Scenario
+{
+    juce::String name;
+    double sampleRate;
+    double lengthInSeconds;
+    std::function<void(RandomWalkSequencer&)> setUp;
+    std::vector<TransportEvent> events;
+};
+
+//Fills the pattern from a fixed seed, so it's the same on every run
+void setSeededPattern(RandomWalkSequencer& sequencer, juce::int64 seed)
+{
+    juce::Random random(seed);
+    int pattern[16];
+    RandomWalkPattern::generate(pattern, random);
+
+    for (int step = 0; step < 16; ++step)
+        sequencer.setSequenceValue(step, pattern[step]);
+}
+
+//Tempo changes every couple of seconds, including to tempos whose steps aren't a whole
+//number of samples
+Scenario makeTempoScenario()
+{
+    Scenario scenario { "tempo_changes", 48000.0, 40.0, {}, {} };
+
+    scenario.setUp = [](RandomWalkSequencer& sequencer)
+    {
+        setSeededPattern(sequencer, 1);
+        sequencer.setRate(3);
+        sequencer.setDensity(11);
+        sequencer.setOffset(3);
+        sequencer.setGate(0.7f);
+        sequencer.setRoot(60);
+    };
+
+    const double tempos[] = { 97.5, 174.0, 133.0, 60.0, 141.25, 88.0, 120.0 };
+
+    for (int i = 0; i < 16; ++i)
+        scenario.events.push_back({ (juce::int64) (2.3 * 48000.0) * (i + 1), TransportEvent::setTempo, tempos[i % 7] });
+
+    return scenario;
+}
+
+//A host looping four bars, a jump in the timeline and a stop, with legato triplets in
+//manual step mode
+Scenario makeLoopScenario()
+{
+    Scenario scenario { "loops_and_seeks", 44100.0, 40.0, {}, {} };
+
+    scenario.setUp = [](RandomWalkSequencer& sequencer)
+    {
+        setSeededPattern(sequencer, 2);
+        sequencer.setManualStepMode(true);
+        sequencer.toggleStepEnabled(2);
+        sequencer.toggleStepEnabled(5);
+        sequencer.toggleStepEnabled(11);
+        sequencer.setRate(4);
+        sequencer.setGate(1.0f);
+        sequencer.setRoot(48);
+    };
+
+    //Four bars at 128 BPM
+    const double loopLength = 16.0 * 60.0 / 128.0;
+    const auto loopSamples = (juce::int64) (loopLength * 44100.0);
+
+    scenario.events.push_back({ 0, TransportEvent::setTempo, 128.0 });
+
+    for (int i = 1; i * loopSamples < (juce::int64) (18.0 * 44100.0); ++i)
+        scenario.events.push_back({ i * loopSamples, TransportEvent::seek, 0.0 });
+
+    scenario.events.push_back({ (juce::int64) (18.7 * 44100.0), TransportEvent::seek, 95.25 });
+    scenario.events.push_back({ (juce::int64) (20.0 * 44100.0), TransportEvent::stop });
+    scenario.events.push_back({ (juce::int64) (21.3 * 44100.0), TransportEvent::start });
+    scenario.events.push_back({ (juce::int64) (30.01 * 44100.0), TransportEvent::seek, 3.5 });
+
+    return scenario;
+}
+
+//MPE output with every expression lane set, where glide points and pressure land inside notes
+Scenario makeExpressionScenario()
+{
+    Scenario scenario { "mpe_expression", 96000.0, 20.0, {}, {} };
+
+    scenario.setUp = [](RandomWalkSequencer& sequencer)
+    {
+        setSeededPattern(sequencer, 3);
+        sequencer.setMpeMode(true);
+        sequencer.setRate(2);
+        sequencer.setDensity(16);
+        sequencer.setGate(0.35f);
+        sequencer.setRoot(67);
+
+        for (int step = 0; step < 16; ++step)
+        {
+            sequencer.setStepExpression(RandomWalkSequencer::glideLane, step, (float) (step % 5 - 2) / 2.0f);
+            sequencer.setStepExpression(RandomWalkSequencer::pressureLane, step, (float) step / 15.0f);
+            sequencer.setStepExpression(RandomWalkSequencer::timbreLane, step, (float) ((step * 7) % 16) / 15.0f);
+        }
+    };
+
+    scenario.events.push_back({ 0, TransportEvent::setTempo, 100.0 });
+    scenario.events.push_back({ 10 * 96000, TransportEvent::setTempo, 150.0 });
+
+    return scenario;
+}
+
+//Renders a scenario through the plugin processor, one line per MIDI event with the sample
+//it lands on, counted from the first block
+//@param blockSize The host's block size, or 0 for ragged blocks of random sizes
+juce::StringArray renderScenario(const Scenario& scenario, int blockSize)
+{
+    constexpr int maxBlockSize = 4096;
+
+    AudioPluginAudioProcessor processor;
+    ScriptedPlayHead playHead(scenario.sampleRate);
+    processor.setPlayHead(&playHead);
+    processor.prepareToPlay(scenario.sampleRate, maxBlockSize);
+
+    auto& sequencer = processor.getSequencer();
+    sequencer.setSyncToHostTransport(true);
+    scenario.setUp(sequencer);
+
+    juce::AudioBuffer<float> buffer(2, maxBlockSize);
+    juce::MidiBuffer midi;
+    juce::Random blockSizes(1234);
+    juce::StringArray log;
+
+    const auto length = (juce::int64) (scenario.lengthInSeconds * scenario.sampleRate);
+    juce::int64 rendered = 0;
+    size_t nextEvent = 0;
+
+    while (rendered < length)
+    {
+        while (nextEvent < scenario.events.size() && scenario.events[nextEvent].sample <= rendered)
+            playHead.apply(scenario.events[nextEvent++]);
+
+        //Like hosts do, blocks are split where the transport changes
+        auto numSamples = (juce::int64) (blockSize > 0 ? blockSize : 1 + blockSizes.nextInt(maxBlockSize));
+        numSamples = juce::jmin(numSamples, length - rendered);
+
+        if (nextEvent < scenario.events.size())
+            numSamples = juce::jmin(numSamples, scenario.events[nextEvent].sample - rendered);
+
+        buffer.setSize(2, (int) numSamples, false, false, true);
+        midi.clear();
+        processor.processBlock(buffer, midi);
+
+        for (const auto metadata: midi)
+            log.add(juce::String(rendered + metadata.samplePosition) + " "
+                    + juce::String::toHexString(metadata.data, metadata.numBytes));
+
+        playHead.advance((int) numSamples);
+        rendered += numSamples;
+    }
+
+    processor.setPlayHead(nullptr);
+    processor.releaseResources();
+    return log;
+}
+
+//Checks two logs match, reporting the first line where they don't
+void checkLogsMatch(const juce::StringArray& log, const juce::StringArray& expected)
+{
+    const int numLines = juce::jmin(log.size(), expected.size());
+    int firstMismatch = 0;
+
+    while (firstMismatch < numLines && log[firstMismatch] == expected[firstMismatch])
+        ++firstMismatch;
+
+    INFO("First mismatch at line " << firstMismatch + 1 << ": got \"" << log[firstMismatch]
+         << "\", expected \"" << expected[firstMismatch] << "\"");
+    CHECK(log.size() == expected.size());
+    CHECK(firstMismatch == numLines);
+}
+
+//Compares a log with its golden log, or records the golden log with RECORD_GOLDEN_OUTPUT set
+void checkAgainstGolden(const juce::String& name, const juce::StringArray& log)
+{
+    auto golden = juce::File(GOLDEN_OUTPUT_DIR).getChildFile(name + ".txt");
+
+    if (juce::SystemStats::getEnvironmentVariable("RECORD_GOLDEN_OUTPUT", {}).isNotEmpty())
+    {
+        golden.getParentDirectory().createDirectory();
+        REQUIRE(golden.replaceWithText(log.joinIntoString("\n") + "\n"));
+        WARN("Recorded golden log " << golden.getFullPathName() << ", check it in");
+        return;
+    }
+
+    //Without its golden log, a scenario would only be compared with itself
+    if (!golden.existsAsFile())
+        FAIL("Missing golden log " << golden.getFullPathName() << ", record it with RECORD_GOLDEN_OUTPUT set");
+
+    juce::StringArray expected;
+    expected.addLines(golden.loadFileAsString());
+    expected.removeEmptyStrings();
+    checkLogsMatch(log, expected);
+}
+
+void checkScenario(const Scenario& scenario)
+{
+    const auto reference = renderScenario(scenario, 512);
+
+    //Hundreds of notes, so a scenario that stopped playing can't pass
+    REQUIRE(reference.size() > 200);
+
+    checkAgainstGolden(scenario.name, reference);
+
+    for (int blockSize: { 7, 64, 100, 441, 1024, 4096, 0 })
+    {
+        INFO("Block size " << (blockSize > 0 ? juce::String(blockSize) : juce::String("ragged")));
+        checkLogsMatch(renderScenario(scenario, blockSize), reference);
+    }
+}
+} // namespace
+
+TEST_CASE("Golden output: tempo changes")
+{
+    checkScenario(makeTempoScenario());
+}
+
+TEST_CASE("Golden output: host loops, seeks and stops")
+{
+    checkScenario(makeLoopScenario());
+}
+
+TEST_CASE("Golden output: MPE expression")
+{
+    checkScenario(makeExpressionScenario());
+}
@@ -0,0 +1,194 @@
+#include <catch2/catch_test_macros.hpp>
+#include "SequencerTestHelpers.h"
+
+using namespace SequencerTestHelpers;
+
+namespace
+{
+constexpr int blockSize = 512;
+
+//Every step playing, in a link group
+void prepare(RandomWalkSequencer& sequencer, int groupId, RandomWalkSequencer::LinkRole role)
+{
+    SequencerTestHelpers::prepare(sequencer, blockSize);
+    sequencer.setDensity(16);
+    sequencer.setLinkGroup(groupId);
+    sequencer.setLinkRole(role);
+}
+
+//Runs two linked instances over the same host blocks, taking turns at processing first,
+//and collects their note ons with timeline timestamps
+void runLinked(RandomWalkSequencer& leader,
+               RandomWalkSequencer& follower,
+               int numBlocks,
+               std::vector<juce::MidiMessage>& leaderNotes,
+               std::vector<juce::MidiMessage>& followerNotes)
+{
+    juce::MidiBuffer leaderMidi, followerMidi;
+
+    auto collect = [](const juce::MidiBuffer& midi, juce::int64 blockStart, std::vector<juce::MidiMessage>& notes)
+    {
+        for (const auto metadata: midi)
+            if (metadata.getMessage().isNoteOn())
+                notes.push_back(metadata.getMessage().withTimeStamp((double) (blockStart + metadata.samplePosition)));
+    };
+
+    for (int block = 0; block < numBlocks; ++block)
+    {
+        const juce::int64 blockStart = (juce::int64) block * blockSize;
+        auto timing = hostBlock(blockStart);
+
+        leaderMidi.clear();
+        followerMidi.clear();
+
+        if (block % 2 == 0)
+        {
+            leader.processBlock(leaderMidi, blockSize, timing);
+            follower.processBlock(followerMidi, blockSize, timing);
+        }
+        else
+        {
+            follower.processBlock(followerMidi, blockSize, timing);
+            leader.processBlock(leaderMidi, blockSize, timing);
+        }
+
+        collect(leaderMidi, blockStart, leaderNotes);
+        collect(followerMidi, blockStart, followerNotes);
+    }
+}
+} // namespace
+
+TEST_CASE("Link group members share the step grid of the leader")
+{
+    auto* group = LinkGroup::getGroup(3);
+    REQUIRE(group != nullptr);
+    CHECK(LinkGroup::getGroup(0) == nullptr);
+    CHECK(LinkGroup::getGroup(LinkGroup::maxGroups + 1) == nullptr);
+
+    int leader = 0;
+    int other = 0;
+
+    //Quarter-beat steps at 120 BPM and 48 kHz, and 1/3 beat steps at 133 BPM and 44.1 kHz
+    auto quarterBeats = StepClock::getSampleLength(48000.0, 120.0, { 240, 1 });
+    auto tripletBeats = StepClock::getSampleLength(44100.0, 133.0, { 320, 1 });
+    REQUIRE(quarterBeats.numerator == 6000);
+    REQUIRE(quarterBeats.denominator == 1);
+
+    //Without a leader, the first member's step length is used and reused by the others
+    auto first = group->getTimebase(1000, quarterBeats);
+    CHECK(first.firstStep == 1);
+    CHECK(first.samplesUntilFirstStep == 5000);
+
+    auto second = group->getTimebase(1000, tripletBeats);
+    CHECK(second.stepLength == quarterBeats);
+    CHECK(second.firstStep == first.firstStep);
+
+    //The leader's step length wins from the next block on
+    CHECK(group->claimLeadership(&leader));
+    CHECK(!group->claimLeadership(&other));
+    group->setLeaderStepLength(tripletBeats);
+
+    //Steps start at floor(k * 126000 / 19) samples, so step 3 starts at 19894
+    auto led = group->getTimebase(19000, quarterBeats);
+    CHECK(led.stepLength == tripletBeats);
+    CHECK(led.firstStep == 3);
+    CHECK(led.samplesUntilFirstStep == 894);
+
+    group->releaseLeadership(&leader);
+    CHECK(!group->isLeader(&leader));
+    CHECK(group->claimLeadership(&other));
+    group->releaseLeadership(&other);
+}
+
+TEST_CASE("A harmonizing follower plays the leader's notes shifted by the interval")
+{
+    RandomWalkSequencer leader, follower;
+    prepare(leader, 4, RandomWalkSequencer::leadRole);
+    prepare(follower, 4, RandomWalkSequencer::harmonizeRole);
+    follower.setLinkInterval(7);
+
+    //The follower's own pattern is ignored
+    for (int step = 0; step < 16; ++step)
+    {
+        leader.setSequenceValue(step, step - 8);
+        follower.setSequenceValue(step, 0);
+    }
+
+    std::vector<juce::MidiMessage> leaderNotes, followerNotes;
+    runLinked(leader, follower, 300, leaderNotes, followerNotes);
+
+    CHECK(leader.isLinkLeader());
+    CHECK(!follower.isLinkLeader());
+
+    REQUIRE(leaderNotes.size() >= 20);
+    REQUIRE(followerNotes.size() == leaderNotes.size());
+
+    for (size_t i = 0; i < leaderNotes.size(); ++i)
+    {
+        CHECK(followerNotes[i].getTimeStamp() == leaderNotes[i].getTimeStamp());
+        CHECK(followerNotes[i].getNoteNumber() == leaderNotes[i].getNoteNumber() + 7);
+        CHECK(followerNotes[i].getVelocity() == leaderNotes[i].getVelocity());
+    }
+}
+
+TEST_CASE("A canon follower plays the leader's notes a number of steps later")
+{
+    RandomWalkSequencer leader, follower;
+    prepare(leader, 5, RandomWalkSequencer::leadRole);
+    prepare(follower, 5, RandomWalkSequencer::canonRole);
+    follower.setLinkInterval(0);
+    follower.setCanonDelay(2);
+
+    for (int step = 0; step < 16; ++step)
+        leader.setSequenceValue(step, (step * 5) % 12 - 6);
+
+    std::vector<juce::MidiMessage> leaderNotes, followerNotes;
+    runLinked(leader, follower, 300, leaderNotes, followerNotes);
+
+    //The follower rests for the first two steps, as there's nothing to imitate yet
+    REQUIRE(leaderNotes.size() >= 20);
+    REQUIRE(followerNotes.size() == leaderNotes.size() - 2);
+
+    for (size_t i = 0; i < followerNotes.size(); ++i)
+    {
+        CHECK(followerNotes[i].getTimeStamp() == leaderNotes[i + 2].getTimeStamp());
+        CHECK(followerNotes[i].getNoteNumber() == leaderNotes[i].getNoteNumber());
+    }
+}
+
+TEST_CASE("Linked instances don't allocate or lock on the audio thread")
+{
+    REQUIRE(PluginHelpers::areAudioThreadHooksInstalled());
+
+    RandomWalkSequencer leader, follower;
+    prepare(leader, 6, RandomWalkSequencer::leadRole);
+    prepare(follower, 6, RandomWalkSequencer::harmonizeRole);
+
+    juce::MidiBuffer midi;
+    midi.ensureSize(8192);
+
+    PluginHelpers::resetAudioThreadViolations();
+
+    for (int block = 0; block < 2000; ++block)
+    {
+        auto timing = hostBlock((juce::int64) block * 128);
+
+        midi.clear();
+        leader.processBlock(midi, 128, timing);
+        follower.processBlock(midi, 128, timing);
+
+        //Switching groups and roles happens on the audio thread too
+        if (block % 400 == 200)
+            follower.setLinkGroup(block % 800 == 200 ? 0 : 6);
+        else if (block % 400 == 300)
+            follower.setLinkRole(block % 800 == 300 ? RandomWalkSequencer::canonRole
+                                                    : RandomWalkSequencer::harmonizeRole);
+    }
+
+    CHECK(PluginHelpers::getAudioThreadViolations().total() == 0);
+
+    //Leaving frees the group for a new leader
+    leader.releaseResources();
+    CHECK(LinkGroup::getGroup(6)->claimLeadership(&midi));
+    LinkGroup::getGroup(6)->releaseLeadership(&midi);
+}
@@ -0,0 +1,272 @@
+#include <catch2/catch_test_macros.hpp>
+#include "SequencerTestHelpers.h"
+#include "SearchedWalkGenerator.h"
+
+using namespace SequencerTestHelpers;
+
+namespace
+{
+//What the test generators report back to the test, which outlives them
+struct GeneratorLog
+{
+    std::atomic<int> numRestarts {0};
+    std::atomic<int> lastRoot {0};
+    std::atomic<int> lastFirstLoopPosition {-1};
+    std::atomic<bool> stalled {false};
+};
+
+//Plays root + 24 + (index % 12) on every step, so its notes can't be mistaken for the pattern's
+class CountingGenerator : public LookaheadGenerator
+{
+public:
+    explicit CountingGenerator(GeneratorLog& logToUse) : log(logToUse) {}
+
+    void restart(const LookaheadContext& newContext) override
+    {
+        context = newContext;
+        log.lastRoot = context.parameters.root;
+        log.lastFirstLoopPosition = context.firstLoopPosition;
+        ++log.numRestarts;
+    }
+
+    void renderStep(juce::int64 index, RenderedStep& step) override
+    {
+        //A stalled generator never delivers, as if it were stuck in an expensive search
+        while (log.stalled)
+            juce::Thread::sleep(1);
+
+        step.plays = true;
+        step.note = context.parameters.root + 24 + (int) (index % 12);
+        step.velocity = 100;
+        step.sequenceIndex = context.getLoopPosition(index);
+    }
+
+private:
+    GeneratorLog& log;
+    LookaheadContext context;
+};
+
+LookaheadContext makeContext(int root, int firstLoopPosition)
+{
+    LookaheadContext context;
+    context.parameters.root = root;
+    context.parameters.density = 8;
+    context.firstLoopPosition = firstLoopPosition;
+    return context;
+}
+
+//Waits for the worker to render a number of steps, for at most a few seconds
+bool waitForSteps(const LookaheadRenderer& renderer, int numSteps)
+{
+    for (int i = 0; i < 5000 && renderer.getNumStepsReady() < numSteps; ++i)
+        juce::Thread::sleep(1);
+
+    return renderer.getNumStepsReady() >= numSteps;
+}
+
+//Half the steps playing a short walk, without a lookahead generator unless a test sets one
+void prepareWalk(RandomWalkSequencer& sequencer)
+{
+    prepare(sequencer);
+    sequencer.setDensity(8);
+
+    for (int step = 0; step < 16; ++step)
+        sequencer.setSequenceValue(step, step % 5);
+}
+} // namespace
+
+TEST_CASE("The lookahead queue delivers the stream in order and flushes when primed")
+{
+    GeneratorLog log;
+    LookaheadRenderer renderer;
+    renderer.setGenerator(std::make_unique<CountingGenerator>(log));
+
+    REQUIRE(renderer.isActive());
+    REQUIRE(renderer.needsPriming());
+    REQUIRE(renderer.prime(makeContext(60, 0)));
+    CHECK(!renderer.needsPriming());
+
+    //Two bars of sixteenths are rendered ahead, and no more
+    REQUIRE(waitForSteps(renderer, 32));
+    juce::Thread::sleep(20);
+    CHECK(renderer.getNumStepsReady() == 32);
+
+    RenderedStep step;
+
+    for (int i = 0; i < 20; ++i)
+    {
+        REQUIRE(renderer.popStep(step));
+        CHECK(step.note == 84 + i % 12);
+        CHECK(step.sequenceIndex == i % 8);
+    }
+
+    //After priming, nothing rendered for the old context comes out
+    REQUIRE(renderer.prime(makeContext(48, 5)));
+    REQUIRE(waitForSteps(renderer, 32));
+
+    for (int i = 0; i < 10; ++i)
+    {
+        REQUIRE(renderer.popStep(step));
+        CHECK(step.note == 72 + i % 12);
+        CHECK(step.sequenceIndex == (5 + i) % 8);
+    }
+
+    CHECK(log.numRestarts == 2);
+    CHECK(renderer.getNumUnderruns() == 0);
+
+    //A step that isn't ready is an underrun, and is skipped when it arrives late
+    log.stalled = true;
+    juce::Thread::sleep(20);
+
+    while (renderer.getNumStepsReady() > 0)
+        renderer.popStep(step);
+
+    CHECK(!renderer.popStep(step));
+    CHECK(renderer.getNumUnderruns() == 1);
+
+    log.stalled = false;
+    renderer.setGenerator(nullptr);
+    CHECK(!renderer.isActive());
+}
+
+TEST_CASE("A sequencer with a lookahead generator plays its stream")
+{
+    GeneratorLog log;
+    RandomWalkSequencer sequencer;
+    prepareWalk(sequencer);
+    sequencer.setLookaheadGenerator(std::make_unique<CountingGenerator>(log));
+
+    juce::int64 position = 0;
+    auto notes = playNotes(sequencer, position, 40, 1);
+    REQUIRE(notes.size() == 40);
+
+    //Once the worker caught up, the stream plays without gaps
+    CHECK(notes.back() >= 84);
+    CHECK(notes[notes.size() - 1] - 84 == (notes[notes.size() - 2] - 84 + 1) % 12);
+
+    //A parameter edit re-primes the queue with the new parameters
+    const int restarts = log.numRestarts;
+    sequencer.setRoot(48);
+    notes = playNotes(sequencer, position, 20, 1);
+    CHECK(log.numRestarts > restarts);
+    CHECK(log.lastRoot == 48);
+    CHECK(notes.back() >= 72);
+    CHECK(notes.back() < 84);
+
+    //So does a seek
+    const int restartsBeforeSeek = log.numRestarts;
+    position += 48000 * 10 + 123;
+    playNotes(sequencer, position, 2, 1);
+    CHECK(log.numRestarts > restartsBeforeSeek);
+}
+
+TEST_CASE("A stalled lookahead generator falls back to repeating the loop, without blocking the audio thread")
+{
+    REQUIRE(PluginHelpers::areAudioThreadHooksInstalled());
+
+    GeneratorLog log;
+    log.stalled = true;
+
+    RandomWalkSequencer sequencer, reference;
+    prepareWalk(sequencer);
+    prepareWalk(reference);
+    sequencer.setLookaheadGenerator(std::make_unique<CountingGenerator>(log));
+
+    juce::MidiBuffer midi, referenceMidi;
+    midi.ensureSize(8192);
+    referenceMidi.ensureSize(8192);
+
+    PluginHelpers::resetAudioThreadViolations();
+
+    std::vector<int> notes, referenceNotes;
+    notes.reserve(1000);
+    referenceNotes.reserve(1000);
+
+    auto collect = [](const juce::MidiBuffer& buffer, juce::int64 blockStart, std::vector<int>& collected)
+    {
+        for (const auto metadata: buffer)
+            if (metadata.getMessage().isNoteOn())
+                collected.push_back((int) (blockStart + metadata.samplePosition) * 128 + metadata.getMessage().getNoteNumber());
+    };
+
+    for (int block = 0; block < 500; ++block)
+    {
+        const juce::int64 blockStart = (juce::int64) block * 512;
+        auto timing = hostBlock(blockStart);
+
+        midi.clear();
+        referenceMidi.clear();
+        sequencer.processBlock(midi, 512, timing);
+        reference.processBlock(referenceMidi, 512, timing);
+
+        collect(midi, blockStart, notes);
+        collect(referenceMidi, blockStart, referenceNotes);
+    }
+
+    CHECK(PluginHelpers::getAudioThreadViolations().total() == 0);
+
+    //Without a single rendered step, every pass repeats the pattern's loop
+    CHECK(notes.size() > 30);
+    CHECK(notes == referenceNotes);
+    CHECK(sequencer.getLookaheadUnderruns() == (juce::uint32) notes.size());
+
+    //Let the worker finish its step, so it can stop
+    log.stalled = false;
+    sequencer.setLookaheadGenerator(nullptr);
+}
+
+TEST_CASE("The searched walk keeps the loop moving and close to the pattern")
+{
+    LookaheadContext context;
+    context.parameters.root = 60;
+    context.parameters.density = 16;
+
+    for (int step = 0; step < 16; ++step)
+        context.sequence[step] = (step * 5) % 13 - 6;
+
+    SearchedWalkGenerator generator(1234), sameSeed(1234);
+    generator.restart(context);
+    sameSeed.restart(context);
+
+    RenderedStep step, sameSeedStep;
+    int numChangedSteps = 0;
+
+    for (int index = 0; index < 16 * 8; ++index)
+    {
+        generator.renderStep(index, step);
+        sameSeed.renderStep(index, sameSeedStep);
+
+        //The same seed searches the same way
+        CHECK(step.note == sameSeedStep.note);
+
+        //The first pass is the pattern itself, then each pass is searched from the last
+        if (index < 16)
+            CHECK(step.note == 60 + context.sequence[index]);
+        else if (step.note != 60 + context.sequence[index % 16])
+            ++numChangedSteps;
+
+        CHECK(step.plays);
+        CHECK(step.note >= 48);
+        CHECK(step.note <= 72);
+    }
+
+    CHECK(numChangedSteps > 0);
+}
+
+TEST_CASE("The generation mode is saved with the state")
+{
+    RandomWalkSequencer sequencer;
+    sequencer.setGenerationMode(RandomWalkSequencer::searchedWalkGeneration);
+    sequencer.setLookaheadBars(4);
+
+    auto xml = sequencer.createStateXml();
+
+    RandomWalkSequencer restored;
+    restored.restoreStateFromXml(*xml);
+    CHECK(restored.getGenerationMode() == RandomWalkSequencer::searchedWalkGeneration);
+    CHECK(restored.getLookaheadBars() == 4);
+
+    sequencer.setGenerationMode(RandomWalkSequencer::patternGeneration);
+    restored.restoreStateFromXml(*sequencer.createStateXml());
+    CHECK(restored.getGenerationMode() == RandomWalkSequencer::patternGeneration);
+}
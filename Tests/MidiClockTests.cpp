@@ -0,0 +1,327 @@
+#include <catch2/catch_test_macros.hpp>
+#include "RandomWalkSequencer.h"
+
+namespace
+{
+constexpr int blockSize = 512;
+constexpr double sampleRate = 48000.0;
+
+//A MIDI event with the sample it lands on, counted from the first block
+struct TimedEvent
+{
+    juce::int64 time;
+    juce::MidiMessage message;
+};
+
+//Sixteenth notes, every step playing the root plus its index, so a note tells the step
+void prepare(RandomWalkSequencer& sequencer)
+{
+    sequencer.prepareToPlay(sampleRate, blockSize);
+    sequencer.setRate(3);
+    sequencer.setRoot(60);
+    sequencer.setManualStepMode(true);
+
+    for (int step = 0; step < 16; ++step)
+        sequencer.setSequenceValue(step, step - 8);
+}
+
+//An external clock at a fixed tempo, whose pulses arrive up to a number of
+//milliseconds early or late
+class ClockSource
+{
+public:
+    ClockSource(double bpmToUse, double jitterInMs) : bpm(bpmToUse), jitter(jitterInMs * sampleRate / 1000.0) {}
+
+    double getPulseLength() const { return sampleRate * 60.0 / (bpm * 24.0); }
+
+    //Adds the pulses that fall inside a block
+    void addPulses(juce::MidiBuffer& midi, juce::int64 blockStart)
+    {
+        while (nextPulseTime < (double) (blockStart + blockSize))
+        {
+            const auto time = (juce::int64) (nextPulseTime + (random.nextDouble() * 2.0 - 1.0) * jitter);
+            midi.addEvent(juce::MidiMessage::midiClock(), (int) juce::jlimit(blockStart, blockStart + blockSize - 1, time) - (int) blockStart);
+            nextPulseTime += getPulseLength();
+        }
+    }
+
+    //Gets when the next pulse is due, without jitter
+    double getNextPulseTime() const { return nextPulseTime; }
+
+private:
+    double bpm;
+    double jitter;
+    double nextPulseTime = 100.0;
+    juce::Random random { 7 };
+};
+
+//Processes blocks with the clock's pulses in them, plus the transport messages of each
+//block, collecting what comes out
+std::vector<TimedEvent> followClock(RandomWalkSequencer& sequencer, ClockSource& clock, juce::int64& blockStart, int numBlocks,
+                                    const std::function<void(juce::MidiBuffer&, int)>& addTransport = {})
+{
+    std::vector<TimedEvent> events;
+    juce::MidiBuffer midi;
+
+    for (int block = 0; block < numBlocks; ++block)
+    {
+        midi.clear();
+
+        if (addTransport)
+            addTransport(midi, block);
+
+        clock.addPulses(midi, blockStart);
+        sequencer.processBlock(midi, blockSize, TimingContext());
+
+        for (const auto metadata: midi)
+            events.push_back({ blockStart + metadata.samplePosition, metadata.getMessage() });
+
+        blockStart += blockSize;
+    }
+
+    return events;
+}
+
+std::vector<TimedEvent> noteOns(const std::vector<TimedEvent>& events)
+{
+    std::vector<TimedEvent> notes;
+
+    for (const auto& event: events)
+        if (event.message.isNoteOn())
+            notes.push_back(event);
+
+    return notes;
+}
+} // namespace
+
+TEST_CASE("MIDI clock output starts with the first step and has a pulse on every step")
+{
+    RandomWalkSequencer sequencer;
+    prepare(sequencer);
+    sequencer.setInternalBpm(120.0);
+    sequencer.setMidiClockOutput(true);
+    sequencer.setPlaying(true);
+
+    std::vector<TimedEvent> events;
+    juce::MidiBuffer midi;
+
+    //Odd block sizes, so pulses and steps land anywhere in a block
+    juce::int64 blockStart = 0;
+
+    for (int block = 0; block < 400; ++block)
+    {
+        const int numSamples = 1 + (block * 97) % 700;
+        midi.clear();
+        sequencer.processBlock(midi, numSamples, TimingContext());
+
+        for (const auto metadata: midi)
+            events.push_back({ blockStart + metadata.samplePosition, metadata.getMessage() });
+
+        blockStart += numSamples;
+    }
+
+    sequencer.setPlaying(false);
+    midi.clear();
+    sequencer.processBlock(midi, blockSize, TimingContext());
+
+    int numStops = 0;
+
+    for (const auto metadata: midi)
+        numStops += metadata.getMessage().isMidiStop() ? 1 : 0;
+
+    CHECK(numStops == 1);
+
+    std::vector<juce::int64> pulses;
+    auto notes = noteOns(events);
+    REQUIRE(notes.size() > 16);
+
+    for (const auto& event: events)
+        if (event.message.isMidiClock())
+            pulses.push_back(event.time);
+
+    //The start goes out with the first step and its pulse
+    auto firstEvent = std::find_if(events.begin(), events.end(), [](const TimedEvent& e) { return !e.message.isNoteOn(); });
+    REQUIRE(firstEvent != events.end());
+    CHECK(firstEvent->message.isMidiStart());
+    CHECK(firstEvent->time == notes.front().time);
+    REQUIRE(!pulses.empty());
+    CHECK(pulses.front() == notes.front().time);
+
+    //24 pulses to the beat, 1000 samples apart at 120 BPM
+    for (size_t i = 1; i < pulses.size(); ++i)
+        CHECK(pulses[i] - pulses[i - 1] == 1000);
+
+    //A sixteenth is six pulses, the first of them on the same sample as the note
+    for (const auto& note: notes)
+        CHECK(std::find(pulses.begin(), pulses.end(), note.time) != pulses.end());
+}
+
+TEST_CASE("A jittery external clock gives steady steps at its tempo")
+{
+    RandomWalkSequencer sequencer;
+    prepare(sequencer);
+    sequencer.setMidiClockInput(true);
+
+    //A clock jittering by up to 1.5 ms either way, 72 samples at 48 kHz
+    ClockSource clock(133.0, 1.5);
+    juce::int64 blockStart = 0;
+
+    //Nothing plays until the clock starts
+    CHECK(noteOns(followClock(sequencer, clock, blockStart, 200)).empty());
+    CHECK(std::abs(sequencer.getMidiClockBpm() - 133.0) < 1.0);
+
+    const double firstPulse = clock.getNextPulseTime();
+    auto notes = noteOns(followClock(sequencer, clock, blockStart, 3000, [](juce::MidiBuffer& midi, int block)
+    {
+        if (block == 0)
+            midi.addEvent(juce::MidiMessage::midiStart(), 0);
+    }));
+
+    //Every step plays once, in order from the first step
+    REQUIRE(notes.size() > 200);
+
+    for (size_t i = 0; i < notes.size(); ++i)
+        CHECK(notes[i].message.getNoteNumber() == 60 + (int) (i % 16) - 8);
+
+    //The first step lands on the first pulse after the start, give or take its jitter
+    CHECK(std::abs((double) notes.front().time - firstPulse) <= 72.0);
+
+    //After a few seconds of settling, steps are six pulses apart, with far less jitter
+    //than the pulses, and the tempo is steady
+    const double stepLength = 6.0 * clock.getPulseLength();
+    double sumOfSquares = 0.0;
+    int numIntervals = 0;
+
+    for (size_t i = 40; i < notes.size(); ++i)
+    {
+        const double error = (double) (notes[i].time - notes[i - 1].time) - stepLength;
+        sumOfSquares += error * error;
+        ++numIntervals;
+
+        //Nor do they drift from the clock
+        CHECK(std::abs((double) notes[i].time - (firstPulse + (double) i * stepLength)) < 72.0);
+    }
+
+    CHECK(std::sqrt(sumOfSquares / numIntervals) < 15.0);
+    CHECK(std::abs(sequencer.getMidiClockBpm() - 133.0) < 0.3);
+
+    //Incoming clock is passed through, and none is sent while following
+    sequencer.setMidiClockOutput(true);
+    juce::MidiBuffer midi;
+    clock.addPulses(midi, blockStart);
+    const int numIncoming = midi.getNumEvents();
+    sequencer.processBlock(midi, blockSize, TimingContext());
+
+    int numClocks = 0;
+
+    for (const auto metadata: midi)
+        numClocks += metadata.getMessage().isMidiClock() ? 1 : 0;
+
+    CHECK(numClocks == numIncoming);
+}
+
+TEST_CASE("Following a clock honours stop, song position and continue")
+{
+    RandomWalkSequencer sequencer;
+    prepare(sequencer);
+    sequencer.setMidiClockInput(true);
+
+    //Legato, so a note is always playing
+    sequencer.setGate(1.0f);
+
+    ClockSource clock(120.0, 0.0);
+    juce::int64 blockStart = 0;
+    followClock(sequencer, clock, blockStart, 20);
+
+    auto events = followClock(sequencer, clock, blockStart, 200, [](juce::MidiBuffer& midi, int block)
+    {
+        if (block == 0)
+            midi.addEvent(juce::MidiMessage::midiStart(), 0);
+
+        //Stop in the middle of a block, while a note is playing
+        if (block == 150)
+            midi.addEvent(juce::MidiMessage::midiStop(), 200);
+    });
+
+    const auto stopTime = blockStart - 50 * blockSize + 200;
+    auto notes = noteOns(events);
+    REQUIRE(!notes.empty());
+    CHECK(notes.back().time < stopTime);
+
+    //The playing note ends where the clock stopped
+    auto lastNoteOff = std::find_if(events.rbegin(), events.rend(), [](const TimedEvent& e) { return e.message.isNoteOff(); });
+    REQUIRE(lastNoteOff != events.rend());
+    CHECK(lastNoteOff->time == stopTime);
+
+    //The clock keeps running while stopped, which plays nothing
+    CHECK(noteOns(followClock(sequencer, clock, blockStart, 100)).empty());
+
+    //Continue from the ninth sixteenth of the song: its step comes with the next pulse
+    notes = noteOns(followClock(sequencer, clock, blockStart, 100, [](juce::MidiBuffer& midi, int block)
+    {
+        if (block == 0)
+        {
+            midi.addEvent(juce::MidiMessage::songPositionPointer(8), 0);
+            midi.addEvent(juce::MidiMessage::midiContinue(), 0);
+        }
+    }));
+
+    REQUIRE(notes.size() > 4);
+    CHECK(notes[0].message.getNoteNumber() == 60);
+    CHECK(notes[1].message.getNoteNumber() == 61);
+
+    //The clock going quiet stops the steps until it comes back
+    juce::MidiBuffer midi;
+
+    for (int block = 0; block < 100; ++block)
+    {
+        midi.clear();
+        sequencer.processBlock(midi, blockSize, TimingContext());
+    }
+
+    CHECK(!sequencer.getIsPlaying());
+    CHECK(sequencer.getMidiClockBpm() == 0.0);
+}
+
+TEST_CASE("MIDI clock input and output allocate nothing and take no locks on the audio thread")
+{
+    REQUIRE(PluginHelpers::areAudioThreadHooksInstalled());
+
+    RandomWalkSequencer sender;
+    prepare(sender);
+    sender.setMidiClockOutput(true);
+    sender.setPlaying(true);
+
+    RandomWalkSequencer follower;
+    prepare(follower);
+    follower.setMidiClockInput(true);
+
+    //The follower plays along with the sender's clock
+    juce::MidiBuffer midi;
+    midi.ensureSize(8192);
+
+    PluginHelpers::resetAudioThreadViolations();
+
+    for (int block = 0; block < 2000; ++block)
+    {
+        midi.clear();
+        sender.processBlock(midi, blockSize, TimingContext());
+        follower.processBlock(midi, blockSize, TimingContext());
+    }
+
+    CHECK(follower.getIsPlaying());
+    CHECK(std::abs(follower.getMidiClockBpm() - 120.0) < 0.1);
+    CHECK(PluginHelpers::getAudioThreadViolations().total() == 0);
+}
+
+TEST_CASE("The MIDI clock settings are saved with the state")
+{
+    RandomWalkSequencer sequencer;
+    sequencer.setMidiClockInput(true);
+    sequencer.setMidiClockOutput(true);
+
+    RandomWalkSequencer restored;
+    restored.restoreStateFromXml(*sequencer.createStateXml());
+    CHECK(restored.isMidiClockInput());
+    CHECK(restored.isMidiClockOutput());
+}
@@ -0,0 +1,216 @@
+#include <catch2/catch_test_macros.hpp>
+#include "RandomWalkSequencer.h"
+
+namespace
+{
+//A loop image and the lane that exports it
+struct TestLane
+{
+    TestLane(int loopLength, int channel, juce::int64 seed)
+    {
+        juce::Random random(seed);
+
+        for (int i = 0; i < 64; ++i)
+        {
+            notes[i] = 36 + random.nextInt(60);
+            velocities[i] = (juce::uint8) (1 + random.nextInt(127));
+            plays[i] = random.nextInt(4) != 0;
+        }
+
+        lane.notes = notes;
+        lane.velocities = velocities;
+        lane.plays = plays;
+        lane.loopLength = loopLength;
+        lane.channel = channel;
+    }
+
+    int notes[64] {};
+    juce::uint8 velocities[64] {};
+    bool plays[64] {};
+    ExportLane lane;
+};
+
+juce::MidiFile readMidiFile(const juce::MemoryBlock& data)
+{
+    juce::MidiFile file;
+    juce::MemoryInputStream stream(data, false);
+    REQUIRE(file.readFrom(stream));
+    return file;
+}
+
+//Checks a track plays the lane's loop numLoops times, note by note
+void checkTrack(const juce::MidiMessageSequence& track, const ExportLane& lane, const ExportSettings& settings)
+{
+    const auto noteLength = (double) std::llround((double) settings.stepLengthInTicks * settings.gate);
+    int eventIndex = 0;
+
+    for (int loop = 0; loop < settings.numLoops; ++loop)
+    {
+        for (int position = 0; position < lane.loopLength; ++position)
+        {
+            if (!lane.plays[position])
+                continue;
+
+            //Skip anything that isn't a note, such as the tempo
+            while (eventIndex < track.getNumEvents() && !track.getEventPointer(eventIndex)->message.isNoteOnOrOff())
+                ++eventIndex;
+
+            REQUIRE(eventIndex + 1 < track.getNumEvents());
+            const auto& noteOn = track.getEventPointer(eventIndex)->message;
+            const auto& noteOff = track.getEventPointer(eventIndex + 1)->message;
+            const double start = (double) ((loop * lane.loopLength + position) * settings.stepLengthInTicks);
+
+            CHECK(noteOn.isNoteOn());
+            CHECK(noteOn.getNoteNumber() == lane.notes[position]);
+            CHECK(noteOn.getVelocity() == lane.velocities[position]);
+            CHECK(noteOn.getChannel() == lane.channel);
+            CHECK(noteOn.getTimeStamp() == start);
+
+            CHECK(noteOff.isNoteOff());
+            CHECK(noteOff.getNoteNumber() == lane.notes[position]);
+            CHECK(noteOff.getTimeStamp() == start + noteLength);
+
+            eventIndex += 2;
+        }
+    }
+
+    CHECK(track.getEndTime() <= (double) (settings.numLoops * lane.loopLength * settings.stepLengthInTicks));
+}
+} // namespace
+
+TEST_CASE("A single lane exports as a format 0 file that plays the loop")
+{
+    TestLane testLane(13, 3, 1);
+
+    ExportSettings settings;
+    settings.stepLengthInTicks = 320;
+    settings.gate = 0.6f;
+    settings.numLoops = 7;
+    settings.bpm = 133.0;
+
+    juce::MemoryBlock data;
+    MidiFileWriter::write(&testLane.lane, 1, settings, data);
+    CHECK(data.getSize() <= MidiFileWriter::getMaxFileSize(&testLane.lane, 1, settings));
+
+    auto file = readMidiFile(data);
+    CHECK(file.getTimeFormat() == MidiFileWriter::ticksPerQuarterNote);
+    REQUIRE(file.getNumTracks() == 1);
+
+    juce::MidiMessageSequence tempos;
+    file.findAllTempoEvents(tempos);
+    REQUIRE(tempos.getNumEvents() == 1);
+    CHECK(std::abs(60.0 / tempos.getEventPointer(0)->message.getTempoSecondsPerQuarterNote() - 133.0) < 0.001);
+
+    checkTrack(*file.getTrack(0), testLane.lane, settings);
+}
+
+TEST_CASE("Several lanes export as a format 1 file with a track per lane")
+{
+    std::vector<std::unique_ptr<TestLane>> testLanes;
+    std::vector<ExportLane> lanes;
+
+    for (int i = 0; i < 5; ++i)
+    {
+        testLanes.push_back(std::make_unique<TestLane>(4 + i * 15, 1 + i, 100 + i));
+        lanes.push_back(testLanes.back()->lane);
+    }
+
+    ExportSettings settings;
+    settings.stepLengthInTicks = 120;
+    settings.gate = 1.0f;
+    settings.numLoops = 3;
+
+    juce::MemoryBlock data;
+    MidiFileWriter::write(lanes.data(), (int) lanes.size(), settings, data);
+
+    auto file = readMidiFile(data);
+    REQUIRE(file.getNumTracks() == (int) lanes.size());
+
+    for (size_t i = 0; i < lanes.size(); ++i)
+        checkTrack(*file.getTrack((int) i), lanes[i], settings);
+}
+
+TEST_CASE("Long exports are limited to what the file format can time")
+{
+    TestLane testLane(64, 1, 7);
+
+    ExportSettings settings;
+    settings.stepLengthInTicks = 3840;
+    settings.numLoops = std::numeric_limits<int>::max();
+
+    const int maxLoops = MidiFileWriter::getMaxNumLoops(&testLane.lane, 1, settings);
+    CHECK((juce::int64) maxLoops * 64 * 3840 <= MidiFileWriter::maxLengthInTicks);
+    CHECK((juce::int64) (maxLoops + 1) * 64 * 3840 > MidiFileWriter::maxLengthInTicks);
+
+    juce::MemoryBlock data;
+    MidiFileWriter::write(&testLane.lane, 1, settings, data);
+    auto file = readMidiFile(data);
+    CHECK(file.getLastTimestamp() <= (double) MidiFileWriter::maxLengthInTicks);
+}
+
+TEST_CASE("1000 bars of 32 lanes export in one pass")
+{
+    std::vector<std::unique_ptr<TestLane>> testLanes;
+    std::vector<ExportLane> lanes;
+
+    for (int i = 0; i < 32; ++i)
+    {
+        testLanes.push_back(std::make_unique<TestLane>(16, 1 + i % 16, i));
+        lanes.push_back(testLanes.back()->lane);
+    }
+
+    //Sixteenths, 16 steps to the bar
+    ExportSettings settings;
+    settings.stepLengthInTicks = 240;
+    settings.numLoops = 1000;
+
+    juce::MemoryBlock data;
+    const auto start = juce::Time::getMillisecondCounterHiRes();
+    MidiFileWriter::write(lanes.data(), (int) lanes.size(), settings, data);
+    const auto elapsed = juce::Time::getMillisecondCounterHiRes() - start;
+
+    //Generous, so it holds in debug builds: the benchmark has the real figure
+    CHECK(elapsed < 500.0);
+
+    auto file = readMidiFile(data);
+    REQUIRE(file.getNumTracks() == 32);
+    checkTrack(*file.getTrack(31), lanes[31], settings);
+}
+
+TEST_CASE("The sequencer exports what it plays")
+{
+    RandomWalkSequencer sequencer;
+    sequencer.setRate(3);
+    sequencer.setDensity(6);
+    sequencer.setOffset(2);
+    sequencer.setRoot(60);
+    sequencer.setGate(0.25f);
+    sequencer.setOutputChannel(5);
+    sequencer.setInternalBpm(90.0);
+
+    for (int step = 0; step < 16; ++step)
+        sequencer.setSequenceValue(step, step - 6);
+
+    juce::MemoryBlock data;
+    sequencer.exportMidiFile(4, data);
+
+    auto file = readMidiFile(data);
+    REQUIRE(file.getNumTracks() == 1);
+
+    juce::MidiMessageSequence notes;
+
+    for (auto* event: *file.getTrack(0))
+        if (event->message.isNoteOn())
+            notes.addEvent(event->message);
+
+    //Four passes of a six step loop, starting at the offset
+    REQUIRE(notes.getNumEvents() == 24);
+
+    for (int i = 0; i < notes.getNumEvents(); ++i)
+    {
+        const auto& message = notes.getEventPointer(i)->message;
+        CHECK(message.getNoteNumber() == 60 + (i % 6 + 2) - 6);
+        CHECK(message.getChannel() == 5);
+        CHECK(message.getTimeStamp() == (double) (i * 240));
+    }
+}
@@ -0,0 +1,276 @@
+#include <catch2/catch_test_macros.hpp>
+#include "RandomWalkSequencer.h"
+
+namespace
+{
+//A MIDI event with the sample it lands on, counted from the first block
+struct TimedEvent
+{
+    juce::int64 time;
+    juce::MidiMessage message;
+};
+
+//Runs blocks through a pipeline, each with the events given for it, collecting what comes out
+std::vector<TimedEvent> runPipeline(MidiTransforms::Pipeline& pipeline, int numBlocks, int blockSize,
+                                    const std::function<void(juce::MidiBuffer&, int)>& addEvents)
+{
+    std::vector<TimedEvent> events;
+    juce::MidiBuffer midi;
+    midi.ensureSize(4096);
+
+    for (int block = 0; block < numBlocks; ++block)
+    {
+        midi.clear();
+        addEvents(midi, block);
+        pipeline.process(midi, blockSize);
+
+        for (const auto metadata: midi)
+            events.push_back({ (juce::int64) block * blockSize + metadata.samplePosition, metadata.getMessage() });
+    }
+
+    return events;
+}
+
+juce::MidiMessage processOne(const MidiTransforms::Program& program, const juce::MidiMessage& message, bool& kept)
+{
+    MidiTransforms::Pipeline pipeline;
+    pipeline.prepare(16);
+    pipeline.setProgram(program);
+
+    juce::MidiBuffer midi;
+    midi.addEvent(message, 0);
+    pipeline.process(midi, 64);
+
+    kept = midi.getNumEvents() == 1;
+    return kept ? (*midi.begin()).getMessage() : juce::MidiMessage();
+}
+} // namespace
+
+TEST_CASE("MIDI transforms change the messages they apply to")
+{
+    bool kept = false;
+
+    //Transposed, and dropped when out of range
+    auto message = processOne(MidiTransforms::Program().transpose(7), juce::MidiMessage::noteOn(1, 60, (juce::uint8) 100), kept);
+    CHECK((kept && message.getNoteNumber() == 67));
+    processOne(MidiTransforms::Program().transpose(12), juce::MidiMessage::noteOn(1, 120, (juce::uint8) 100), kept);
+    CHECK(!kept);
+
+    //Channels mapped, and dropped for 0
+    std::array<int, 16> map {};
+    map[2] = 9;
+    message = processOne(MidiTransforms::Program().mapChannels(map), juce::MidiMessage::controllerEvent(3, 1, 64), kept);
+    CHECK((kept && message.getChannel() == 9));
+    processOne(MidiTransforms::Program().mapChannels(map), juce::MidiMessage::controllerEvent(4, 1, 64), kept);
+    CHECK(!kept);
+
+    //Velocities curved, never to 0
+    message = processOne(MidiTransforms::Program().velocityCurve(1.0f), juce::MidiMessage::noteOn(1, 60, (juce::uint8) 64), kept);
+    CHECK(message.getVelocity() > 64);
+    message = processOne(MidiTransforms::Program().velocityCurve(-1.0f), juce::MidiMessage::noteOn(1, 60, (juce::uint8) 2), kept);
+    CHECK((kept && message.isNoteOn() && message.getVelocity() == 1));
+
+    //Split at middle C
+    const auto split = MidiTransforms::Program().split(60, 2, 3);
+    CHECK(processOne(split, juce::MidiMessage::noteOn(1, 59, (juce::uint8) 100), kept).getChannel() == 2);
+    CHECK(processOne(split, juce::MidiMessage::noteOn(1, 60, (juce::uint8) 100), kept).getChannel() == 3);
+
+    //Filtered by kind, channel and note range
+    const auto filter = MidiTransforms::Program().filter(MidiTransforms::notes, 0x0001, 48, 72);
+    processOne(filter, juce::MidiMessage::noteOn(1, 60, (juce::uint8) 100), kept);
+    CHECK(kept);
+    processOne(filter, juce::MidiMessage::noteOn(2, 60, (juce::uint8) 100), kept);
+    CHECK(!kept);
+    processOne(filter, juce::MidiMessage::noteOn(1, 80, (juce::uint8) 100), kept);
+    CHECK(!kept);
+    processOne(filter, juce::MidiMessage::pitchWheel(1, 0), kept);
+    CHECK(!kept);
+    processOne(filter, juce::MidiMessage::midiClock(), kept);
+    CHECK(!kept);
+}
+
+TEST_CASE("Note offs follow their note on when the program changes")
+{
+    MidiTransforms::Pipeline pipeline;
+    pipeline.prepare(64);
+    pipeline.setProgram(MidiTransforms::Program().transpose(5).split(64, 1, 2));
+
+    juce::MidiBuffer midi;
+    midi.addEvent(juce::MidiMessage::noteOn(1, 60, (juce::uint8) 100), 10);
+    midi.addEvent(juce::MidiMessage::noteOn(1, 70, (juce::uint8) 100), 20);
+    pipeline.process(midi, 512);
+
+    //Now the first note would be dropped and the second go elsewhere
+    pipeline.setProgram(MidiTransforms::Program().filter(MidiTransforms::notes, 0xffff, 70, 127).transpose(-12));
+
+    midi.clear();
+    midi.addEvent(juce::MidiMessage::noteOff(1, 60), 10);
+    midi.addEvent(juce::MidiMessage::noteOff(1, 70), 20);
+    midi.addEvent(juce::MidiMessage::noteOn(1, 60, (juce::uint8) 100), 30);
+    pipeline.process(midi, 512);
+
+    //Both end where they started, and the new note is filtered, so its note off is too
+    REQUIRE(midi.getNumEvents() == 2);
+    auto it = midi.begin();
+    const auto first = (*it).getMessage();
+    const auto second = (*++it).getMessage();
+    CHECK((first.isNoteOff() && first.getNoteNumber() == 65 && first.getChannel() == 2));
+    CHECK((second.isNoteOff() && second.getNoteNumber() == 75 && second.getChannel() == 2));
+
+    midi.clear();
+    midi.addEvent(juce::MidiMessage::noteOff(1, 60), 0);
+    pipeline.process(midi, 512);
+    CHECK(midi.isEmpty());
+}
+
+TEST_CASE("A delay holds channel messages across blocks, and not clock")
+{
+    constexpr int blockSize = 100;
+
+    MidiTransforms::Pipeline pipeline;
+    pipeline.prepare(256);
+    pipeline.setProgram(MidiTransforms::Program().delay(250));
+
+    auto events = runPipeline(pipeline, 10, blockSize, [](juce::MidiBuffer& midi, int block)
+    {
+        midi.addEvent(juce::MidiMessage::midiClock(), 0);
+
+        if (block < 5)
+        {
+            midi.addEvent(juce::MidiMessage::noteOn(1, 60 + block, (juce::uint8) 100), 40);
+            midi.addEvent(juce::MidiMessage::noteOff(1, 60 + block), 90);
+        }
+    });
+
+    std::vector<TimedEvent> notes;
+
+    for (const auto& event: events)
+    {
+        if (event.message.isMidiClock())
+            CHECK(event.time % blockSize == 0);
+        else
+            notes.push_back(event);
+    }
+
+    REQUIRE(notes.size() == 10);
+
+    for (int block = 0; block < 5; ++block)
+    {
+        const auto& noteOn = notes[(size_t) block * 2];
+        const auto& noteOff = notes[(size_t) block * 2 + 1];
+        CHECK((noteOn.message.isNoteOn() && noteOn.message.getNoteNumber() == 60 + block));
+        CHECK(noteOn.time == block * blockSize + 40 + 250);
+        CHECK((noteOff.message.isNoteOff() && noteOff.message.getNoteNumber() == 60 + block));
+        CHECK(noteOff.time == block * blockSize + 90 + 250);
+    }
+}
+
+TEST_CASE("MIDI transforms allocate nothing and take no locks on the audio thread")
+{
+    REQUIRE(PluginHelpers::areAudioThreadHooksInstalled());
+
+    MidiTransforms::Pipeline pipeline;
+    pipeline.prepare(256);
+
+    juce::MidiBuffer midi;
+    midi.ensureSize(4096);
+
+    PluginHelpers::resetAudioThreadViolations();
+    {
+        PluginHelpers::ScopedAudioThread audioThread;
+
+        for (int block = 0; block < 200; ++block)
+        {
+            //Building the program is part of the audio thread's work too
+            pipeline.setProgram(MidiTransforms::Program()
+                                    .transpose(block % 12)
+                                    .velocityCurve((float) (block % 5) / 5.0f)
+                                    .split(60, 1, 2)
+                                    .delay(block % 300));
+
+            midi.clear();
+            midi.addEvent(juce::MidiMessage::noteOn(1, 60, (juce::uint8) 100), 0);
+            midi.addEvent(juce::MidiMessage::noteOff(1, 60), 200);
+            midi.addEvent(juce::MidiMessage::midiClock(), 300);
+            pipeline.process(midi, 512);
+        }
+    }
+
+    CHECK(PluginHelpers::getAudioThreadViolations().total() == 0);
+}
+
+TEST_CASE("The sequencer post-processes its own notes and passes incoming MIDI through")
+{
+    constexpr int blockSize = 480;
+    constexpr int numBlocks = 200;
+
+    //Two sequencers playing the same, one of them an octave up and 10 ms late
+    RandomWalkSequencer plain;
+    RandomWalkSequencer processed;
+
+    for (auto* sequencer: { &plain, &processed })
+    {
+        sequencer->prepareToPlay(48000.0, blockSize);
+        sequencer->setRate(3);
+        sequencer->setRoot(60);
+        sequencer->setManualStepMode(true);
+
+        for (int step = 0; step < 16; ++step)
+            sequencer->setSequenceValue(step, step - 8);
+
+        sequencer->setPlaying(true);
+    }
+
+    processed.setPostTranspose(12);
+    processed.setOutputDelay(10.0f);
+
+    std::vector<TimedEvent> plainNotes;
+    std::vector<TimedEvent> processedNotes;
+    juce::MidiBuffer midi;
+    midi.ensureSize(4096);
+
+    for (int block = 0; block < numBlocks; ++block)
+    {
+        midi.clear();
+        plain.processBlock(midi, blockSize, TimingContext());
+
+        for (const auto metadata: midi)
+            if (metadata.getMessage().isNoteOn())
+                plainNotes.push_back({ (juce::int64) block * blockSize + metadata.samplePosition, metadata.getMessage() });
+
+        midi.clear();
+
+        if (block == 3)
+            midi.addEvent(juce::MidiMessage::noteOn(16, 40, (juce::uint8) 100), 7);
+
+        processed.processBlock(midi, blockSize, TimingContext());
+
+        for (const auto metadata: midi)
+            if (metadata.getMessage().isNoteOn())
+                processedNotes.push_back({ (juce::int64) block * blockSize + metadata.samplePosition, metadata.getMessage() });
+    }
+
+    //The incoming note, untouched
+    REQUIRE(!processedNotes.empty());
+    auto incoming = std::find_if(processedNotes.begin(), processedNotes.end(),
+                                 [](const TimedEvent& e) { return e.message.getChannel() == 16; });
+    REQUIRE(incoming != processedNotes.end());
+    CHECK(incoming->message.getNoteNumber() == 40);
+    CHECK(incoming->time == 3 * blockSize + 7);
+    processedNotes.erase(incoming);
+
+    //Ours, an octave up and 480 samples late, apart from those pushed past the end
+    REQUIRE(plainNotes.size() > 8);
+    REQUIRE(processedNotes.size() >= plainNotes.size() - 1);
+
+    for (size_t i = 0; i < processedNotes.size(); ++i)
+    {
+        CHECK(processedNotes[i].message.getNoteNumber() == plainNotes[i].message.getNoteNumber() + 12);
+        CHECK(processedNotes[i].time == plainNotes[i].time + 480);
+    }
+
+    RandomWalkSequencer restored;
+    restored.restoreStateFromXml(*processed.createStateXml());
+    CHECK(restored.getPostTranspose() == 12);
+    CHECK(restored.getOutputDelay() == 10.0f);
+}
@@ -0,0 +1,152 @@
+#include <catch2/catch_test_macros.hpp>
+#include "RandomWalkSequencer.h"
+
+namespace
+{
+//Runs the sequencer for a number of samples and collects everything it sends
+std::vector<juce::MidiMessage> runSequencer(RandomWalkSequencer& sequencer, int totalSamples, int blockSize)
+{
+    std::vector<juce::MidiMessage> messages;
+    juce::MidiBuffer midi;
+
+    for (int blockStart = 0; blockStart < totalSamples; blockStart += blockSize)
+    {
+        midi.clear();
+        sequencer.processBlock(midi, blockSize, {});
+
+        for (const auto metadata: midi)
+            messages.push_back(metadata.getMessage().withTimeStamp(blockStart + metadata.samplePosition));
+    }
+
+    return messages;
+}
+
+//Quarter-beat steps at 120 BPM, 6000 samples each at 48 kHz
+void prepare(RandomWalkSequencer& sequencer)
+{
+    sequencer.prepareToPlay(48000.0, 512);
+    sequencer.setRate(3);
+    sequencer.setDensity(16);
+    sequencer.setPlaying(true);
+}
+} // namespace
+
+TEST_CASE("MPE channel allocator hands out the least recently used channel")
+{
+    MpeChannelAllocator allocator;
+
+    auto first = allocator.allocate();
+    auto second = allocator.allocate();
+    CHECK(first == 2);
+    CHECK(second == 3);
+
+    //A released channel goes to the back of the queue
+    allocator.release(first);
+    CHECK(!allocator.isBusy(first));
+    CHECK(allocator.allocate() == 4);
+
+    //Fill the zone, then the oldest note's channel gets stolen
+    for (int channel = 5; channel <= 16; ++channel)
+        CHECK(allocator.allocate() == channel);
+
+    CHECK(allocator.allocate() == 2);
+    CHECK(allocator.allocate() == 3);
+
+    allocator.setNumMemberChannels(2);
+    CHECK(allocator.allocate() == 2);
+    CHECK(allocator.allocate() == 3);
+    CHECK(allocator.allocate() == 2);
+}
+
+TEST_CASE("Notes are sent on the selected output channel")
+{
+    RandomWalkSequencer sequencer;
+    prepare(sequencer);
+    sequencer.setOutputChannel(5);
+
+    int numNotes = 0;
+
+    for (const auto& message: runSequencer(sequencer, 48000, 512))
+    {
+        if (message.isNoteOnOrOff())
+        {
+            CHECK(message.getChannel() == 5);
+            ++numNotes;
+        }
+    }
+
+    CHECK(numNotes > 0);
+}
+
+TEST_CASE("MPE mode gives every note its own member channel and expression")
+{
+    RandomWalkSequencer sequencer;
+    prepare(sequencer);
+    sequencer.setMpeMode(true);
+
+    for (int step = 0; step < 16; ++step)
+    {
+        sequencer.setStepExpression(RandomWalkSequencer::glideLane, step, 1.0f);
+        sequencer.setStepExpression(RandomWalkSequencer::pressureLane, step, 1.0f);
+        sequencer.setStepExpression(RandomWalkSequencer::timbreLane, step, 0.0f);
+    }
+
+    auto messages = runSequencer(sequencer, 48000, 256);
+
+    //The zone configuration comes first, on the master channel
+    REQUIRE(!messages.empty());
+    CHECK(messages.front().isController());
+    CHECK(messages.front().getChannel() == 1);
+
+    int previousChannel = -1;
+    int noteChannel = -1;
+    int lastBend = -1;
+    int numNotes = 0;
+
+    for (size_t i = 0; i < messages.size(); ++i)
+    {
+        const auto& message = messages[i];
+
+        if (message.isNoteOn())
+        {
+            noteChannel = message.getChannel();
+            CHECK(noteChannel >= 2);
+            CHECK(noteChannel != previousChannel);
+
+            //Centred bend, pressure and timbre are sent on the member channel first
+            REQUIRE(i >= 3);
+            CHECK(messages[i - 3].isPitchWheel());
+            CHECK(messages[i - 3].getPitchWheelValue() == 8192);
+            CHECK(messages[i - 2].isChannelPressure());
+            CHECK(messages[i - 2].getChannelPressureValue() == 127);
+            CHECK(messages[i - 1].isControllerOfType(74));
+            CHECK(messages[i - 1].getControllerValue() == 0);
+
+            for (int back = 1; back <= 3; ++back)
+                CHECK(messages[i - (size_t) back].getChannel() == noteChannel);
+
+            lastBend = 8192;
+            ++numNotes;
+        }
+        else if (message.isPitchWheel() && noteChannel > 0)
+        {
+            //The glide ramps upwards on the note's own channel
+            CHECK(message.getChannel() == noteChannel);
+            CHECK(message.getPitchWheelValue() >= lastBend);
+            lastBend = message.getPitchWheelValue();
+        }
+        else if (message.isNoteOff())
+        {
+            CHECK(message.getChannel() == noteChannel);
+
+            //A full glide reaches maxGlideSemitones out of the 48 semitone MPE range
+            CHECK(lastBend == 8192 + juce::roundToInt(8191.0f * RandomWalkSequencer::maxGlideSemitones
+                                                      / RandomWalkSequencer::mpePitchbendRange));
+
+            previousChannel = noteChannel;
+            noteChannel = -1;
+        }
+    }
+
+    CHECK(numNotes >= 7);
+}
@@ -0,0 +1,119 @@
+#include <catch2/catch_test_macros.hpp>
+#include <shared_plugin_helpers/shared_plugin_helpers.h>
+
+namespace
+{
+//A processor with float parameters, added in the given order
+struct TestProcessor : PluginHelpers::ProcessorBase
+{
+    explicit TestProcessor(const juce::StringArray& ids)
+    {
+        for (const auto& id: ids)
+            addParameter(new juce::AudioParameterFloat({id, 1}, id, 0.0f, 1.0f, 0.5f));
+    }
+
+    void process(juce::AudioBuffer<float>&, juce::MidiBuffer&) override {}
+
+    float getValue(const juce::String& id) const
+    {
+        for (auto* param: getParameters())
+            if (dynamic_cast<juce::AudioProcessorParameterWithID*>(param)->paramID == id)
+                return param->getValue();
+
+        return -1.0f;
+    }
+};
+
+juce::StringArray makeIDs(int numParams)
+{
+    juce::StringArray ids;
+
+    for (int index = 0; index < numParams; ++index)
+        ids.add("param" + juce::String(index));
+
+    return ids;
+}
+
+void setValues(TestProcessor& processor)
+{
+    const auto& params = processor.getParameters();
+
+    for (int index = 0; index < params.size(); ++index)
+        params[index]->setValue((float) (index % 10) / 10.0f);
+}
+} // namespace
+
+TEST_CASE("Parameters restore from a packed state, through XML and binary")
+{
+    TestProcessor source(makeIDs(1000));
+    setValues(source);
+    const auto params = PluginHelpers::saveParamsTree(source);
+
+    //The way NewPluginTemplate stores it, and the way MaxParametersPlugin does
+    auto xml = params.createXml();
+    REQUIRE(xml != nullptr);
+    const auto fromXml = juce::ValueTree::fromXml(*xml);
+
+    juce::MemoryOutputStream stream;
+    params.writeToStream(stream);
+    const auto fromBinary = juce::ValueTree::readFromData(stream.getData(), stream.getDataSize());
+
+    for (const auto& tree: { fromXml, fromBinary })
+    {
+        TestProcessor destination(makeIDs(1000));
+        PluginHelpers::loadParamsTree(destination, tree);
+
+        for (int index = 0; index < 1000; ++index)
+            CHECK(destination.getParameters()[index]->getValue() == source.getParameters()[index]->getValue());
+    }
+}
+
+TEST_CASE("Parameters restore by ID after parameters are added, removed and reordered")
+{
+    TestProcessor source(makeIDs(100));
+    setValues(source);
+    const auto params = PluginHelpers::saveParamsTree(source);
+
+    //The first ten reversed, the last one gone, and a new one in front
+    auto ids = makeIDs(99);
+
+    for (int index = 0; index < 5; ++index)
+        ids.getReference(index).swapWith(ids.getReference(9 - index));
+
+    ids.insert(0, "added");
+
+    TestProcessor destination(ids);
+    const PluginHelpers::ParameterIndex index(destination);
+    CHECK(index.getNumParameters() == 100);
+    CHECK(index.indexOf("param9") == 1);
+    CHECK(index.indexOf("param99") == -1);
+
+    index.load(params);
+
+    for (int i = 0; i < 99; ++i)
+        CHECK(destination.getValue("param" + juce::String(i)) == source.getValue("param" + juce::String(i)));
+
+    //Untouched by the state
+    CHECK(destination.getValue("added") == 0.5f);
+}
+
+TEST_CASE("Parameters restore from a child tree per parameter, as states were saved before")
+{
+    TestProcessor source(makeIDs(50));
+    setValues(source);
+
+    auto params = juce::ValueTree("Params");
+
+    for (auto* param: source.getParameters())
+    {
+        auto paramTree = juce::ValueTree(dynamic_cast<juce::AudioProcessorParameterWithID*>(param)->paramID);
+        paramTree.setProperty("Value", param->getValue(), nullptr);
+        params.appendChild(paramTree, nullptr);
+    }
+
+    TestProcessor destination(makeIDs(50));
+    PluginHelpers::loadParamsTree(destination, juce::ValueTree::fromXml(*params.createXml()));
+
+    for (int index = 0; index < 50; ++index)
+        CHECK(destination.getParameters()[index]->getValue() == source.getParameters()[index]->getValue());
+}
@@ -0,0 +1,222 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "SequencerTestHelpers.h"
+
+using namespace SequencerTestHelpers;
+
+namespace
+{
+using Morph = RandomWalkSequencer::Morph;
+
+MorphedStep makeStep(int note, int velocity, float gate, bool enabled = true)
+{
+    MorphedStep step;
+    step.enabled = enabled;
+    step.note = note;
+    step.velocity = (juce::uint8) velocity;
+    step.gate = gate;
+    return step;
+}
+
+//Fills both slots: A plays the root on every step, B an octave up
+void fillSlots(Morph& morph)
+{
+    for (int step = 0; step < 16; ++step)
+    {
+        morph.setStep(Morph::slotA, step, makeStep(0, 80, 0.2f));
+        morph.setStep(Morph::slotB, step, makeStep(12, 120, 0.8f));
+    }
+}
+
+//Manual step mode with both slots filled and morphing on
+void prepareMorph(RandomWalkSequencer& sequencer)
+{
+    prepare(sequencer);
+    sequencer.setManualStepMode(true);
+    fillSlots(sequencer.getMorph());
+    sequencer.setMorphEnabled(true);
+}
+} // namespace
+
+TEST_CASE("Interpolating morphs glide every step from A to B")
+{
+    Morph morph;
+    fillSlots(morph);
+
+    auto start = morph.getStep(3, 0.0f, Morph::interpolateMode);
+    CHECK(start.note == 0);
+    CHECK(start.velocity == 80);
+    CHECK(start.gate == Catch::Approx(0.2f));
+
+    auto middle = morph.getStep(3, 0.5f, Morph::interpolateMode);
+    CHECK(middle.note == 6);
+    CHECK(middle.velocity == 100);
+    CHECK(middle.gate == Catch::Approx(0.5f));
+
+    auto end = morph.getStep(3, 1.0f, Morph::interpolateMode);
+    CHECK(end.note == 12);
+    CHECK(end.velocity == 120);
+    CHECK(end.gate == Catch::Approx(0.8f));
+
+    //A step that's on or off comes from the nearer slot
+    morph.setStep(Morph::slotB, 3, makeStep(12, 120, 0.8f, false));
+    CHECK(morph.getStep(3, 0.4f, Morph::interpolateMode).enabled);
+    CHECK(!morph.getStep(3, 0.6f, Morph::interpolateMode).enabled);
+}
+
+TEST_CASE("Crossfading morphs switch steps one by one, spread over the loop")
+{
+    Morph morph;
+    fillSlots(morph);
+
+    for (int switched = 0; switched <= 16; ++switched)
+    {
+        const float position = (float) switched / 16.0f;
+        int numSwitched = 0;
+        int switchedPerQuarter[4] = {};
+
+        for (int step = 0; step < 16; ++step)
+        {
+            auto morphed = morph.getStep(step, position, Morph::crossfadeMode);
+
+            //Steps are either A or B, never in between
+            REQUIRE((morphed.note == 0 || morphed.note == 12));
+
+            if (morphed.note == 12)
+            {
+                ++numSwitched;
+                ++switchedPerQuarter[step / 4];
+            }
+        }
+
+        CHECK(numSwitched == switched);
+
+        //Never more than one switched step apart between the quarters of the loop
+        for (int quarter = 0; quarter < 4; ++quarter)
+            CHECK(std::abs(switchedPerQuarter[quarter] - switched / 4) <= 1);
+    }
+}
+
+TEST_CASE("The sequencer morphs over the chosen number of bars")
+{
+    RandomWalkSequencer sequencer;
+    prepareMorph(sequencer);
+
+    juce::int64 position = 0;
+    auto notes = playNotes(sequencer, position, 4);
+    CHECK(notes == std::vector<int> { 60, 60, 60, 60 });
+
+    //Instant morphs jump straight to the control
+    sequencer.setMorphAmount(1.0f);
+    notes = playNotes(sequencer, position, 2);
+    CHECK(notes == std::vector<int> { 72, 72 });
+
+    //Over two bars, the notes rise a step at a time and arrive after 32 steps
+    sequencer.setMorphBars(2);
+    sequencer.setMorphAmount(0.0f);
+    notes = playNotes(sequencer, position, 32);
+    REQUIRE(notes.size() == 32);
+
+    for (size_t i = 1; i < notes.size(); ++i)
+        CHECK(notes[i] <= notes[i - 1]);
+
+    CHECK(notes[15] == 66);
+    CHECK(notes.back() == 60);
+    CHECK(sequencer.getMorphPosition() == 0.0f);
+}
+
+TEST_CASE("Only the step about to play is morphed")
+{
+    RandomWalkSequencer sequencer;
+    prepareMorph(sequencer);
+
+    juce::int64 position = 0;
+    playNotes(sequencer, position, 3);
+
+    //Editing a slot during playback changes the very next note
+    for (int step = 0; step < 16; ++step)
+        sequencer.getMorph().setStep(Morph::slotA, step, makeStep(7, 80, 0.5f));
+
+    CHECK(playNotes(sequencer, position, 1) == std::vector<int> { 67 });
+
+    //Disabled steps of the morph are skipped in manual step mode
+    for (int step = 0; step < 16; ++step)
+        sequencer.getMorph().setStep(Morph::slotA, step, makeStep(step, 80, 0.5f, step % 2 == 0));
+
+    auto notes = playNotes(sequencer, position, 8);
+    REQUIRE(notes.size() == 8);
+
+    for (auto note: notes)
+        CHECK((note - 60) % 2 == 0);
+}
+
+TEST_CASE("Morphing allocates nothing on the audio thread")
+{
+    REQUIRE(PluginHelpers::areAudioThreadHooksInstalled());
+
+    RandomWalkSequencer sequencer;
+    prepareMorph(sequencer);
+    sequencer.setMorphBars(1);
+    sequencer.setMorphMode(Morph::crossfadeMode);
+
+    //Sweep the control back and forth, as automation would
+    auto sweepMorph = [&sequencer](int block) { sequencer.setMorphAmount((float) (block % 100) / 99.0f); };
+
+    CHECK(countAudioThreadViolations(sequencer, 500, sweepMorph) == 0);
+}
+
+TEST_CASE("The morph slots and settings are saved with the state")
+{
+    RandomWalkSequencer sequencer;
+
+    for (int step = 0; step < 16; ++step)
+        sequencer.setSequenceValue(step, step - 8);
+
+    sequencer.storeMorphSlot(Morph::slotA);
+    sequencer.getMorph().setStep(Morph::slotB, 5, makeStep(-3, 110, 0.7f, false));
+    sequencer.setMorphEnabled(true);
+    sequencer.setMorphAmount(0.25f);
+    sequencer.setMorphBars(4);
+    sequencer.setMorphMode(Morph::crossfadeMode);
+
+    RandomWalkSequencer restored;
+    restored.restoreStateFromXml(*sequencer.createStateXml());
+
+    CHECK(restored.isMorphEnabled());
+    CHECK(restored.getMorphAmount() == Catch::Approx(0.25f));
+    CHECK(restored.getMorphBars() == 4);
+    CHECK(restored.getMorphMode() == Morph::crossfadeMode);
+
+    for (int step = 0; step < 16; ++step)
+        CHECK(restored.getMorph().getStoredStep(Morph::slotA, step).note == step - 8);
+
+    auto stored = restored.getMorph().getStoredStep(Morph::slotB, 5);
+    CHECK(stored.note == -3);
+    CHECK(stored.velocity == 110);
+    CHECK(stored.gate == Catch::Approx(0.7f));
+    CHECK(!stored.enabled);
+
+    //Recalling a slot puts it back in the pattern
+    restored.setSequenceValue(0, 5);
+    restored.recallMorphSlot(Morph::slotA);
+    CHECK(restored.getSequenceValue(0) == -8);
+}
+
+TEST_CASE("Morph bars snap to the lengths the editor offers")
+{
+    RandomWalkSequencer sequencer;
+
+    const std::pair<int, int> cases[] = { { -1, 0 }, { 0, 0 }, { 1, 1 }, { 3, 2 }, { 8, 8 }, { 12, 8 }, { 32, 16 } };
+
+    for (const auto& [numBars, expected]: cases)
+    {
+        sequencer.setMorphBars(numBars);
+        CHECK(sequencer.getMorphBars() == expected);
+    }
+
+    //A state from a host or an older version is snapped the same way
+    auto state = sequencer.createStateXml();
+    state->setAttribute("morphBars", 3);
+    sequencer.restoreStateFromXml(*state);
+    CHECK(sequencer.getMorphBars() == 2);
+}
@@ -0,0 +1,180 @@
+#include <catch2/catch_test_macros.hpp>
+#include "PluginProcessor.h"
+
+namespace
+{
+//A host transport that the test can start, stop and re-tempo between blocks
+struct FakePlayHead : public juce::AudioPlayHead
+{
+    juce::Optional<PositionInfo> getPosition() const override
+    {
+        PositionInfo info;
+        info.setIsPlaying(isPlaying);
+        info.setBpm(bpm);
+        info.setTimeInSamples(timeInSamples);
+        return info;
+    }
+
+    bool isPlaying = false;
+    double bpm = 120.0;
+    juce::int64 timeInSamples = 0;
+};
+
+//Runs one block through the plugin processor and returns the number of note ons
+int processBlock(AudioPluginAudioProcessor& processor, FakePlayHead& playHead, int blockSize)
+{
+    juce::AudioBuffer<float> buffer(2, blockSize);
+    juce::MidiBuffer midi;
+
+    processor.processBlock(buffer, midi);
+
+    if (playHead.isPlaying)
+        playHead.timeInSamples += blockSize;
+
+    int noteOns = 0;
+
+    for (const auto metadata: midi)
+        if (metadata.getMessage().isNoteOn())
+            ++noteOns;
+
+    return noteOns;
+}
+} // namespace
+
+TEST_CASE("Plugin processor forwards the host transport to the sequencer")
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 480;
+
+    AudioPluginAudioProcessor processor;
+    FakePlayHead playHead;
+    processor.setPlayHead(&playHead);
+    processor.prepareToPlay(sampleRate, blockSize);
+
+    auto& sequencer = processor.getSequencer();
+    sequencer.setSyncToHostTransport(true);
+    sequencer.setDensity(16);
+
+    processBlock(processor, playHead, blockSize);
+    CHECK(!sequencer.getIsPlaying());
+
+    SECTION("Starting and stopping the host starts and stops the sequencer")
+    {
+        playHead.isPlaying = true;
+        processBlock(processor, playHead, blockSize);
+        CHECK(sequencer.getIsPlaying());
+
+        playHead.isPlaying = false;
+        processBlock(processor, playHead, blockSize);
+        CHECK(!sequencer.getIsPlaying());
+    }
+
+    SECTION("The step clock follows the host tempo")
+    {
+        //Quarter-beat steps at 150 BPM are 4800 samples long at 48 kHz,
+        //and the first step fires one step after the host starts
+        sequencer.setRate(3);
+        playHead.bpm = 150.0;
+        playHead.isPlaying = true;
+
+        int noteOns = 0;
+
+        for (int block = 0; block < 105; ++block)
+            noteOns += processBlock(processor, playHead, blockSize);
+
+        CHECK(noteOns == 10);
+    }
+
+    processor.setPlayHead(nullptr);
+    processor.releaseResources();
+}
+
+TEST_CASE("Plugin processor state round-trips through the sequencer")
+{
+    AudioPluginAudioProcessor source;
+    source.getSequencer().setRate(4);
+    source.getSequencer().setDensity(7);
+    source.getSequencer().setInternalBpm(93.0);
+    source.getSequencer().setSequenceValue(5, -3);
+
+    juce::MemoryBlock state;
+    source.getStateInformation(state);
+
+    AudioPluginAudioProcessor destination;
+    destination.setStateInformation(state.getData(), (int) state.getSize());
+
+    auto& sequencer = destination.getSequencer();
+    CHECK(sequencer.getRate() == 4);
+    CHECK(sequencer.getDensity() == 7);
+    CHECK(sequencer.getInternalBpm() == 93.0);
+    CHECK(sequencer.getSequenceValue(5) == -3);
+}
+
+TEST_CASE("Plugin processor leaves the first pattern until something needs it")
+{
+    AudioPluginAudioProcessor source;
+    source.getSequencer().setMonoMode();
+    source.getSequencer().setSequenceValue(2, 7);
+
+    juce::MemoryBlock state;
+    source.getStateInformation(state);
+
+    SECTION("A restored pattern is kept when the processor is prepared")
+    {
+        AudioPluginAudioProcessor restored;
+        restored.setStateInformation(state.getData(), (int) state.getSize());
+        restored.prepareToPlay(48000.0, 512);
+
+        for (int step = 0; step < 16; ++step)
+            CHECK(restored.getSequencer().getSequenceValue(step) == (step == 2 ? 7 : 0));
+    }
+
+    SECTION("A pattern set before preparing is kept too")
+    {
+        AudioPluginAudioProcessor processor;
+        processor.getSequencer().setMonoMode();
+        processor.prepareToPlay(48000.0, 512);
+
+        for (int step = 0; step < 16; ++step)
+            CHECK(processor.getSequencer().getSequenceValue(step) == 0);
+    }
+
+    SECTION("Editing a step before preparing keeps the edit")
+    {
+        AudioPluginAudioProcessor processor;
+        processor.getSequencer().setSequenceValue(4, -5);
+        processor.prepareToPlay(48000.0, 512);
+
+        CHECK(processor.getSequencer().getSequenceValue(4) == -5);
+    }
+
+    SECTION("Saving leaves a pattern that's still to come, and restoring generates one")
+    {
+        AudioPluginAudioProcessor fresh;
+        juce::MemoryBlock freshState;
+        fresh.getStateInformation(freshState);
+
+        for (int step = 0; step < 16; ++step)
+            CHECK(fresh.getSequencer().getSequenceValue(step) == 0);
+
+        AudioPluginAudioProcessor restored;
+        restored.setStateInformation(freshState.getData(), (int) freshState.getSize());
+
+        int restoredPattern[16];
+        bool anyOffRoot = false;
+
+        for (int step = 0; step < 16; ++step)
+        {
+            restoredPattern[step] = restored.getSequencer().getSequenceValue(step);
+            anyOffRoot = anyOffRoot || restoredPattern[step] != 0;
+        }
+
+        CHECK(anyOffRoot);
+
+        //And it's the pattern the restored instance keeps
+        restored.prepareToPlay(48000.0, 512);
+
+        for (int step = 0; step < 16; ++step)
+            CHECK(restored.getSequencer().getSequenceValue(step) == restoredPattern[step]);
+    }
+}
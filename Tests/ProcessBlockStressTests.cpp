@@ -0,0 +1,316 @@
+#include <catch2/catch_test_macros.hpp>
+#include <thread>
+#include "RandomWalkSequencer.h"
+
+namespace
+{
+//Step lengths in beats, matching the editor's rate menu
+constexpr double rateInBeats[] = {1.0 / 32.0, 1.0 / 16.0, 1.0 / 8.0, 1.0 / 4.0, 1.0 / 3.0,
+                                  1.0 / 2.0, 1.0, 2.0, 3.0, 4.0};
+constexpr int numRates = 10;
+
+constexpr double sampleRates[] = {8000.0, 22050.0, 44100.0, 48000.0, 88200.0,
+                                  96000.0, 192000.0, 384000.0, 768000.0};
+
+constexpr int maxBlockSize = 8192;
+
+//Checks the structural invariants of the sequencer's output, block by block
+struct OutputChecker
+{
+    void checkBlock(const juce::MidiBuffer& midi, int numSamples)
+    {
+        for (const auto metadata: midi)
+        {
+            if (metadata.samplePosition < 0 || metadata.samplePosition >= numSamples)
+                ++eventsOutsideBlock;
+
+            auto message = metadata.getMessage();
+
+            if (message.isNoteOn())
+            {
+                //The sequencer is monophonic: a new note must wait for the previous note off
+                if (openNote >= 0)
+                    ++overlappingNotes;
+
+                openNote = message.getNoteNumber();
+                ++noteOns;
+            }
+            else if (message.isNoteOff())
+            {
+                if (openNote != message.getNoteNumber())
+                    ++unmatchedNoteOffs;
+
+                openNote = -1;
+            }
+        }
+    }
+
+    int noteOns = 0;
+    int openNote = -1;
+    int eventsOutsideBlock = 0;
+    int overlappingNotes = 0;
+    int unmatchedNoteOffs = 0;
+};
+
+//Drives processBlock with the given block size, keeping track of the worst block time
+struct BlockDriver
+{
+    explicit BlockDriver(RandomWalkSequencer& sequencerToUse)
+        : sequencer(sequencerToUse)
+    {
+        midi.ensureSize(maxBlockSize * 8);
+    }
+
+    void process(int numSamples)
+    {
+        midi.clear();
+
+        auto start = juce::Time::getHighResolutionTicks();
+        sequencer.processBlock(midi, numSamples, {});
+        auto elapsed = juce::Time::highResolutionTicksToSeconds(
+            juce::Time::getHighResolutionTicks() - start);
+
+        worstBlockSeconds = juce::jmax(worstBlockSeconds, elapsed);
+        checker.checkBlock(midi, numSamples);
+        elapsedSamples += numSamples;
+    }
+
+    RandomWalkSequencer& sequencer;
+    juce::MidiBuffer midi;
+    OutputChecker checker;
+    double worstBlockSeconds = 0.0;
+    juce::int64 elapsedSamples = 0;
+};
+
+//Mixes tiny, small and huge blocks, like FL Studio or REAPER can send
+int nextBlockSize(juce::Random& random, int style)
+{
+    switch (style)
+    {
+        case 0:
+            return 1 + random.nextInt(16);
+        case 1:
+            return 17 + random.nextInt(512 - 16);
+        case 2:
+            return 513 + random.nextInt(maxBlockSize - 512);
+        default:
+            return 1 + random.nextInt(maxBlockSize);
+    }
+}
+
+//Stops the sequencer and flushes any note that's still sounding
+void stopAndFlush(RandomWalkSequencer& sequencer, BlockDriver& driver)
+{
+    sequencer.setPlaying(false);
+    driver.process(1);
+}
+
+void checkStructuralInvariants(const OutputChecker& checker)
+{
+    CHECK(checker.eventsOutsideBlock == 0);
+    CHECK(checker.overlappingNotes == 0);
+    CHECK(checker.unmatchedNoteOffs == 0);
+    CHECK(checker.openNote == -1);
+}
+
+//Generous, but catches anything that scales badly with block size or step count
+constexpr double maxSecondsPerBlock = 0.005;
+} // namespace
+
+TEST_CASE("Stress: step count follows elapsed time for random block sizes and sample rates")
+{
+    juce::Random random(0x5eed);
+
+    for (int segment = 0; segment < 36; ++segment)
+    {
+        auto sampleRate = sampleRates[random.nextInt(juce::numElementsInArray(sampleRates))];
+        auto bpm = 30.0 + random.nextInt(271);
+        auto rate = random.nextInt(numRates);
+        auto blockStyle = segment % 4;
+
+        INFO("segment " << segment << ": " << sampleRate << " Hz, " << bpm << " BPM, rate " << rate
+                        << ", block style " << blockStyle);
+
+        RandomWalkSequencer sequencer;
+        sequencer.prepareToPlay(sampleRate, maxBlockSize);
+        sequencer.setInternalBpm(bpm);
+        sequencer.setRate(rate);
+        sequencer.setDensity(16);
+        sequencer.setGate(0.1f + 0.9f * random.nextFloat());
+        sequencer.setPlaying(true);
+
+        BlockDriver driver(sequencer);
+
+        for (int block = 0; block < 1500; ++block)
+        {
+            driver.process(nextBlockSize(random, blockStyle));
+
+            //Flip parameters that don't change the step clock
+            if (random.nextInt(50) == 0)
+                sequencer.setOffset(random.nextInt(16));
+
+            if (random.nextInt(50) == 0)
+                sequencer.setGate(0.1f + 0.9f * random.nextFloat());
+
+            if (random.nextInt(50) == 0)
+                sequencer.setRoot(24 + random.nextInt(80));
+        }
+
+        //Every step in density mode with all 16 steps plays a note, and step k starts at
+        //exactly floor(k * stepLength) samples, where stepLength = num / den. So the notes
+        //played are the steps with k * num < elapsed * den, not counting the start at k = 0
+        auto num = (juce::int64) sampleRate * 60 * juce::roundToInt(rateInBeats[rate] * 960.0);
+        auto den = (juce::int64) 960 * (juce::int64) bpm;
+        auto expectedSteps = ((juce::int64) driver.elapsedSamples * den - 1) / num;
+
+        CHECK(driver.checker.noteOns == expectedSteps);
+
+        stopAndFlush(sequencer, driver);
+        checkStructuralInvariants(driver.checker);
+        CHECK(driver.worstBlockSeconds < maxSecondsPerBlock);
+    }
+}
+
+TEST_CASE("Stress: invariants hold with mid-stream tempo, parameter and transport changes")
+{
+    juce::Random random(0xc0ffee);
+
+    for (int session = 0; session < 12; ++session)
+    {
+        auto sampleRate = sampleRates[random.nextInt(juce::numElementsInArray(sampleRates))];
+        INFO("session " << session << ": " << sampleRate << " Hz");
+
+        RandomWalkSequencer sequencer;
+        sequencer.prepareToPlay(sampleRate, maxBlockSize);
+        sequencer.setPlaying(true);
+
+        BlockDriver driver(sequencer);
+
+        for (int block = 0; block < 4000; ++block)
+        {
+            driver.process(nextBlockSize(random, 3));
+
+            switch (random.nextInt(40))
+            {
+                case 0:
+                    sequencer.setInternalBpm(30.0 + random.nextInt(271));
+                    break;
+                case 1:
+                    sequencer.setRate(random.nextInt(numRates));
+                    break;
+                case 2:
+                    sequencer.setDensity(1 + random.nextInt(16));
+                    break;
+                case 3:
+                    sequencer.setOffset(random.nextInt(16));
+                    break;
+                case 4:
+                    sequencer.setGate(0.1f + 0.9f * random.nextFloat());
+                    break;
+                case 5:
+                    sequencer.setManualStepMode(!sequencer.isManualStepMode());
+                    break;
+                case 6:
+                    sequencer.toggleStepEnabled(random.nextInt(16));
+                    break;
+                case 7:
+                    sequencer.setPlaying(!sequencer.getIsPlaying());
+                    break;
+                case 8:
+                    sequencer.randomizeSequence(random.nextInt(4));
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        stopAndFlush(sequencer, driver);
+        checkStructuralInvariants(driver.checker);
+        CHECK(driver.worstBlockSeconds < maxSecondsPerBlock);
+    }
+}
+
+TEST_CASE("Stress: play, stop and manual step mode from the message thread while the audio thread plays")
+{
+    RandomWalkSequencer sequencer;
+    sequencer.prepareToPlay(48000.0, maxBlockSize);
+    sequencer.setInternalBpm(300.0);
+    sequencer.setRate(0);
+    sequencer.setPlaying(true);
+
+    BlockDriver driver(sequencer);
+    std::atomic<bool> done {false};
+
+    //The editor's play button and manual step toggle, pressed as fast as they can be
+    std::thread messageThread([&]
+    {
+        juce::Random random(0xb0a7);
+
+        while (!done)
+        {
+            if (random.nextBool())
+                sequencer.setPlaying(!sequencer.getIsPlaying());
+            else
+                sequencer.setManualStepMode(!sequencer.isManualStepMode());
+
+            std::this_thread::yield();
+        }
+    });
+
+    juce::Random random(0xa0d10);
+
+    for (int block = 0; block < 5000; ++block)
+        driver.process(nextBlockSize(random, 1));
+
+    done = true;
+    messageThread.join();
+
+    stopAndFlush(sequencer, driver);
+    checkStructuralInvariants(driver.checker);
+    CHECK(driver.checker.noteOns > 0);
+}
+
+TEST_CASE("Starting playback takes effect at the start of the next block")
+{
+    RandomWalkSequencer sequencer;
+    sequencer.prepareToPlay(48000.0, maxBlockSize);
+    sequencer.setInternalBpm(120.0);
+    sequencer.setRate(0);
+    sequencer.setDensity(16);
+    sequencer.setGate(1.0f);
+
+    BlockDriver driver(sequencer);
+    driver.process(512);
+    driver.process(512);
+
+    //Asking to play changes nothing the audio thread owns until its next block
+    sequencer.setPlaying(true);
+    CHECK(sequencer.getIsPlaying());
+    CHECK(sequencer.getCurrentStep() == 0);
+
+    const auto start = driver.elapsedSamples;
+    juce::int64 firstNote = -1;
+
+    while (firstNote < 0 && driver.elapsedSamples < start + 4096)
+    {
+        const auto blockStart = driver.elapsedSamples;
+        driver.process(512);
+
+        for (const auto metadata: driver.midi)
+            if (firstNote < 0 && metadata.getMessage().isNoteOn())
+                firstNote = blockStart + metadata.samplePosition;
+    }
+
+    //The first step starts one step, of 750 samples, after the block that started playing
+    CHECK(firstNote == start + 750);
+    CHECK(sequencer.getCurrentStep() == 0);
+
+    //Stopping turns the note off at the start of the next block
+    sequencer.setPlaying(false);
+    CHECK(!sequencer.getIsPlaying());
+    REQUIRE(driver.checker.openNote >= 0);
+
+    driver.process(512);
+    CHECK(driver.checker.openNote == -1);
+    CHECK((*driver.midi.begin()).samplePosition == 0);
+}
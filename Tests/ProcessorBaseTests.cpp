@@ -0,0 +1,159 @@
+#include <catch2/catch_test_macros.hpp>
+#include <shared_plugin_helpers/shared_plugin_helpers.h>
+#include <thread>
+
+namespace
+{
+constexpr double sampleRate = 44100.0;
+constexpr int blockSize = 64;
+
+//Counts its blocks, and optionally takes its time over them, allocates in them or emits notes
+struct TestProcessor : PluginHelpers::ProcessorBase
+{
+    TestProcessor() { setRateAndBufferSizeDetails(sampleRate, blockSize); }
+
+    void process(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midi) override
+    {
+        ++numProcessed;
+        wasCheckingAudioThread = PluginHelpers::isCheckingAudioThread();
+
+        if (sleepMilliseconds > 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(sleepMilliseconds));
+
+        if (allocate)
+            scratch = std::make_unique<float[]>((size_t) buffer.getNumSamples());
+
+        for (int note = 0; note < notesToEmit; ++note)
+            midi.addEvent(juce::MidiMessage::noteOn(1, 60 + note, (juce::uint8) 100), 0);
+
+        buffer.clear();
+    }
+
+    int numProcessed = 0;
+    bool wasCheckingAudioThread = false;
+    int sleepMilliseconds = 0;
+    bool allocate = false;
+    int notesToEmit = 0;
+    std::unique_ptr<float[]> scratch;
+};
+
+void processBlocks(TestProcessor& processor, int numBlocks)
+{
+    juce::AudioBuffer<float> buffer(2, blockSize);
+    juce::MidiBuffer midi;
+
+    for (int block = 0; block < numBlocks; ++block)
+        processor.processBlock(buffer, midi);
+}
+
+juce::uint64 getHistogramTotal(const PluginHelpers::BlockProfiler::Stats& stats)
+{
+    juce::uint64 total = 0;
+
+    for (auto count: stats.histogram)
+        total += count;
+
+    return total;
+}
+} // namespace
+
+TEST_CASE("ProcessorBase calls process, and measures nothing until profiling is enabled")
+{
+    TestProcessor processor;
+    processBlocks(processor, 10);
+
+    CHECK(processor.numProcessed == 10);
+    CHECK(processor.wasCheckingAudioThread);
+    CHECK(!PluginHelpers::isCheckingAudioThread());
+
+    const auto stats = processor.getProfiler().getStats();
+    CHECK(stats.blocksProcessed == 0);
+    CHECK(getHistogramTotal(stats) == 0);
+}
+
+TEST_CASE("ProcessorBase profiles every block once enabled")
+{
+    TestProcessor processor;
+    processor.getProfiler().setEnabled(true);
+    processBlocks(processor, 100);
+
+    const auto stats = processor.getProfiler().getStats();
+    CHECK(stats.blocksProcessed == 100);
+    CHECK(getHistogramTotal(stats) == 100);
+    CHECK(stats.lastBlockSize == blockSize);
+    CHECK(stats.worstBlockMicros >= stats.meanBlockMicros);
+    CHECK(stats.worstLoadPercent >= stats.lastLoadPercent);
+}
+
+TEST_CASE("ProcessorBase counts blocks that overrun their deadline")
+{
+    //64 samples at 44.1kHz last about 1.45ms
+    TestProcessor processor;
+    processor.getProfiler().setEnabled(true);
+    processor.sleepMilliseconds = 3;
+    processBlocks(processor, 3);
+
+    const auto stats = processor.getProfiler().getStats();
+    CHECK(stats.overruns == 3);
+    CHECK(stats.worstLoadPercent > 100.0);
+    CHECK(stats.histogram.back() == 3);
+}
+
+TEST_CASE("ProcessorBase counts allocations made inside process")
+{
+    REQUIRE(PluginHelpers::areAudioThreadHooksInstalled());
+
+    TestProcessor processor;
+    processor.getProfiler().setEnabled(true);
+    processBlocks(processor, 5);
+    CHECK(processor.getProfiler().getStats().violations == 0);
+
+    processor.allocate = true;
+    processBlocks(processor, 5);
+    CHECK(processor.getProfiler().getStats().violations >= 5);
+}
+
+TEST_CASE("ProcessorBase counts the MIDI events process emits")
+{
+    TestProcessor processor;
+    processor.getProfiler().setEnabled(true);
+    processor.notesToEmit = 2;
+
+    //The buffer keeps the earlier blocks' events, which don't count again
+    processBlocks(processor, 10);
+    CHECK(processor.getProfiler().getStats().eventsEmitted == 20);
+}
+
+TEST_CASE("ProcessorBase profiling allocates nothing and takes no locks on the audio thread")
+{
+    REQUIRE(PluginHelpers::areAudioThreadHooksInstalled());
+
+    TestProcessor processor;
+    processor.getProfiler().setEnabled(true);
+    juce::AudioBuffer<float> buffer(2, blockSize);
+    juce::MidiBuffer midi;
+
+    PluginHelpers::resetAudioThreadViolations();
+
+    for (int block = 0; block < 1000; ++block)
+        processor.processBlock(buffer, midi);
+
+    CHECK(PluginHelpers::getAudioThreadViolations().total() == 0);
+}
+
+TEST_CASE("ProcessorBase profiler stats can be reset")
+{
+    TestProcessor processor;
+    auto& profiler = processor.getProfiler();
+    profiler.setEnabled(true);
+    processBlocks(processor, 20);
+    REQUIRE(profiler.getStats().blocksProcessed == 20);
+
+    //Cleared by the audio thread, at the next measured block
+    profiler.requestReset();
+    processBlocks(processor, 1);
+
+    const auto stats = profiler.getStats();
+    CHECK(stats.blocksProcessed == 1);
+    CHECK(getHistogramTotal(stats) == 1);
+}
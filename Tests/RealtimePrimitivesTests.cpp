@@ -0,0 +1,337 @@
+#include <catch2/catch_test_macros.hpp>
+#include <thread>
+#include "RandomWalkSequencer.h"
+
+namespace
+{
+//A snapshot whose fields all hold the same number, so a torn read shows up as a mismatch
+struct Stamped
+{
+    juce::uint32 values[24] {};
+
+    void stamp(juce::uint32 value) noexcept
+    {
+        for (auto& v: values)
+            v = value;
+    }
+
+    bool isConsistent() const noexcept
+    {
+        for (auto v: values)
+            if (v != values[0])
+                return false;
+
+        return true;
+    }
+};
+
+//Tells the test how many of them are still alive
+struct Tracked
+{
+    explicit Tracked(std::atomic<int>& numAliveToUse, int valueToUse)
+        : numAlive(numAliveToUse)
+        , value(valueToUse)
+    {
+        ++numAlive;
+    }
+
+    ~Tracked()
+    {
+        --numAlive;
+        value = -1;
+    }
+
+    std::atomic<int>& numAlive;
+    std::atomic<int> value;
+};
+} // namespace
+
+TEST_CASE("SPSC queue is first in, first out, and fails rather than waits")
+{
+    Realtime::SpscQueue<int, 4> queue;
+    int value = 0;
+
+    CHECK(!queue.pop(value));
+
+    for (int i = 0; i < 4; ++i)
+        CHECK(queue.push(i));
+
+    //All four slots are usable
+    CHECK(!queue.push(4));
+    CHECK(queue.getNumReady() == 4);
+    CHECK(queue.getFreeSpace() == 0);
+
+    REQUIRE(queue.pop(value));
+    CHECK(value == 0);
+    CHECK(queue.push(4));
+
+    queue.discardAll();
+    CHECK(queue.getNumReady() == 0);
+    CHECK(!queue.pop(value));
+
+    //The positions wrap around the array
+    for (int i = 0; i < 10; ++i)
+    {
+        REQUIRE(queue.push(i));
+        REQUIRE(queue.pop(value));
+        CHECK(value == i);
+    }
+}
+
+TEST_CASE("SPSC queue delivers everything in order across threads")
+{
+    constexpr int numItems = 200000;
+    Realtime::SpscQueue<int, 64> queue;
+
+    std::thread producer([&queue]
+    {
+        for (int i = 0; i < numItems; ++i)
+            while (!queue.push(i))
+                std::this_thread::yield();
+    });
+
+    int expected = 0;
+    bool inOrder = true;
+
+    while (expected < numItems)
+    {
+        int value = 0;
+
+        if (queue.pop(value))
+            inOrder = inOrder && value == expected++;
+        else
+            std::this_thread::yield();
+    }
+
+    producer.join();
+    CHECK(inOrder);
+    CHECK(queue.getNumReady() == 0);
+}
+
+TEST_CASE("Triple buffer reads are never torn and never go back in time")
+{
+    constexpr juce::uint32 numWrites = 200000;
+    Realtime::TripleBuffer<Stamped> buffer;
+
+    CHECK(!buffer.update());
+    CHECK(buffer.getReadBuffer().values[0] == 0);
+
+    std::thread writer([&buffer]
+    {
+        for (juce::uint32 i = 1; i <= numWrites; ++i)
+        {
+            buffer.getWriteBuffer().stamp(i);
+            buffer.publish();
+        }
+    });
+
+    juce::uint32 last = 0;
+    bool consistent = true;
+    bool monotonic = true;
+
+    while (last < numWrites)
+    {
+        const auto& snapshot = buffer.read();
+        consistent = consistent && snapshot.isConsistent();
+        monotonic = monotonic && snapshot.values[0] >= last;
+        last = snapshot.values[0];
+    }
+
+    writer.join();
+    CHECK(consistent);
+    CHECK(monotonic);
+
+    //Nothing new since the last write was read
+    CHECK(!buffer.update());
+}
+
+TEST_CASE("SeqLock reads are never torn")
+{
+    constexpr juce::uint32 numWrites = 200000;
+    Realtime::SeqLock<Stamped> lock;
+    const auto initialVersion = lock.getVersion();
+
+    std::atomic<bool> done {false};
+    std::atomic<bool> consistent {true};
+
+    //Two readers, one retrying and one taking what it can, the way the audio thread does
+    std::thread retryingReader([&]
+    {
+        while (!done)
+            if (!lock.read().isConsistent())
+                consistent = false;
+    });
+
+    std::thread tryingReader([&]
+    {
+        Stamped value;
+
+        while (!done)
+            if (lock.tryRead(value) && !value.isConsistent())
+                consistent = false;
+    });
+
+    Stamped value;
+
+    for (juce::uint32 i = 1; i <= numWrites; ++i)
+    {
+        value.stamp(i);
+        lock.write(value);
+    }
+
+    done = true;
+    retryingReader.join();
+    tryingReader.join();
+
+    CHECK(consistent);
+    CHECK(lock.getVersion() == initialVersion + numWrites);
+    CHECK(lock.read().values[0] == numWrites);
+}
+
+TEST_CASE("Atomic swap keeps an object alive while it's being read")
+{
+    std::atomic<int> numAlive {0};
+    Realtime::AtomicSwap<Tracked> swap(std::make_unique<Tracked>(numAlive, 1));
+
+    {
+        Realtime::AtomicSwap<Tracked>::ReadScope scope(swap);
+        REQUIRE(scope);
+        CHECK(scope->value == 1);
+
+        //Swapped out under the reader, so it stays
+        swap.publish(std::make_unique<Tracked>(numAlive, 2));
+        CHECK(numAlive == 2);
+        CHECK(swap.getNumRetired() == 1);
+        CHECK(scope->value == 1);
+    }
+
+    //The reader is done with it now
+    swap.collectGarbage();
+    CHECK(numAlive == 1);
+    CHECK(swap.getNumRetired() == 0);
+
+    {
+        Realtime::AtomicSwap<Tracked>::ReadScope scope(swap);
+        CHECK(scope->value == 2);
+    }
+
+    //Nobody reading, so the old one goes straight away
+    swap.publish(std::make_unique<Tracked>(numAlive, 3));
+    CHECK(numAlive == 1);
+}
+
+TEST_CASE("Atomic swap never frees an object under a reader on another thread")
+{
+    std::atomic<int> numAlive {0};
+
+    {
+        Realtime::AtomicSwap<Tracked> swap(std::make_unique<Tracked>(numAlive, 0));
+        std::atomic<bool> done {false};
+        std::atomic<bool> valid {true};
+
+        std::thread reader([&]
+        {
+            while (!done)
+            {
+                Realtime::AtomicSwap<Tracked>::ReadScope scope(swap);
+
+                //Read twice, so a free in between would show
+                const auto first = scope->value.load();
+                std::this_thread::yield();
+
+                if (first < 0 || scope->value.load() != first)
+                    valid = false;
+            }
+        });
+
+        for (int i = 1; i <= 20000; ++i)
+            swap.publish(std::make_unique<Tracked>(numAlive, i));
+
+        done = true;
+        reader.join();
+
+        CHECK(valid);
+        swap.collectGarbage();
+        CHECK(numAlive == 1);
+    }
+
+    CHECK(numAlive == 0);
+}
+
+TEST_CASE("Real-time primitives allocate nothing and take no locks on the audio thread")
+{
+    REQUIRE(PluginHelpers::areAudioThreadHooksInstalled());
+
+    Realtime::SpscQueue<Stamped, 16> queue;
+    Realtime::TripleBuffer<Stamped> buffer;
+    Realtime::SeqLock<Stamped> lock;
+    Realtime::AtomicSwap<Stamped> swap(std::make_unique<Stamped>());
+
+    PluginHelpers::resetAudioThreadViolations();
+    {
+        PluginHelpers::ScopedAudioThread audioThread;
+        Stamped value;
+
+        for (juce::uint32 i = 0; i < 1000; ++i)
+        {
+            value.stamp(i);
+            queue.push(value);
+            queue.pop(value);
+            buffer.write(value);
+            value = buffer.read();
+            lock.write(value);
+            lock.tryRead(value);
+
+            Realtime::AtomicSwap<Stamped>::ReadScope scope(swap);
+            value.values[0] += scope->values[0];
+        }
+    }
+
+    CHECK(PluginHelpers::getAudioThreadViolations().total() == 0);
+}
+
+TEST_CASE("The sequencer's profiler stats are published as a consistent set")
+{
+    constexpr int blockSize = 64;
+
+    RandomWalkSequencer sequencer;
+    sequencer.prepareToPlay(44100.0, blockSize);
+    sequencer.getProfiler().setEnabled(true);
+    sequencer.setPlaying(true);
+
+    std::atomic<bool> done {false};
+    std::atomic<bool> consistent {true};
+
+    std::thread audioThread([&]
+    {
+        juce::MidiBuffer midi;
+        midi.ensureSize(4096);
+
+        for (int block = 0; block < 20000; ++block)
+        {
+            midi.clear();
+            sequencer.processBlock(midi, blockSize, {});
+        }
+
+        done = true;
+    });
+
+    //The UI reads the stats and edits the pattern meanwhile, as the editor would
+    for (int edit = 0; !done; ++edit)
+    {
+        sequencer.setSequenceValue(edit % 16, edit % 25 - 12);
+
+        const auto stats = sequencer.getProfiler().getStats();
+        juce::uint64 total = 0;
+
+        for (auto count: stats.histogram)
+            total += count;
+
+        if (total != stats.blocksProcessed)
+            consistent = false;
+    }
+
+    audioThread.join();
+    CHECK(consistent);
+    CHECK(sequencer.getProfiler().getStats().blocksProcessed == 20000);
+}
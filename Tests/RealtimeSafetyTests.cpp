@@ -0,0 +1,112 @@
+#include <catch2/catch_test_macros.hpp>
+#include "RandomWalkSequencer.h"
+
+namespace
+{
+//Runs the sequencer for a number of blocks, flipping UI-side state between blocks
+//the way the editor would, and returns the violations counted inside processBlock
+PluginHelpers::AudioThreadViolations runBlocks(RandomWalkSequencer& sequencer,
+                                               int numBlocks,
+                                               int blockSize)
+{
+    juce::MidiBuffer midi;
+    midi.ensureSize(8192);
+
+    PluginHelpers::resetAudioThreadViolations();
+
+    for (int block = 0; block < numBlocks; ++block)
+    {
+        midi.clear();
+
+        //Some incoming MIDI to pass through
+        if (block % 7 == 0)
+            midi.addEvent(juce::MidiMessage::noteOn(1, 60, (juce::uint8) 100), blockSize / 2);
+
+        sequencer.processBlock(midi, blockSize, {});
+
+        if (block % 500 == 250)
+            sequencer.setPlaying(false);
+        else if (block % 500 == 300)
+            sequencer.setPlaying(true);
+
+        if (block % 300 == 0)
+            sequencer.setRate(block / 300 % 10);
+    }
+
+    return PluginHelpers::getAudioThreadViolations();
+}
+} // namespace
+
+TEST_CASE("Audio thread checker counts allocations only on marked threads")
+{
+    REQUIRE(PluginHelpers::areAudioThreadHooksInstalled());
+
+    PluginHelpers::resetAudioThreadViolations();
+
+    //Volatile, so the compiler can't elide the allocations under test
+    {
+        char* volatile unmarked = new char[64];
+        delete[] unmarked;
+    }
+
+    CHECK(PluginHelpers::getAudioThreadViolations().total() == 0);
+
+    {
+        PluginHelpers::ScopedAudioThread audioThread;
+        char* volatile marked = new char[64];
+        delete[] marked;
+    }
+
+    auto violations = PluginHelpers::getAudioThreadViolations();
+    CHECK(violations.allocations == 1);
+    CHECK(violations.deallocations == 1);
+
+    PluginHelpers::resetAudioThreadViolations();
+
+    {
+        PluginHelpers::ScopedAudioThread audioThread;
+        PluginHelpers::ScopedAudioThreadAllowance allowance;
+        char* volatile allowed = new char[64];
+        delete[] allowed;
+    }
+
+    CHECK(PluginHelpers::getAudioThreadViolations().total() == 0);
+}
+
+TEST_CASE("RandomWalkSequencer::processBlock does not allocate or lock")
+{
+    REQUIRE(PluginHelpers::areAudioThreadHooksInstalled());
+
+    constexpr int blockSize = 256;
+
+    RandomWalkSequencer sequencer;
+    sequencer.prepareToPlay(48000.0, blockSize);
+    sequencer.setInternalBpm(300.0);
+    sequencer.setGate(0.3f);
+    sequencer.setPlaying(true);
+
+    auto violations = runBlocks(sequencer, 5000, blockSize);
+
+    CHECK(violations.allocations == 0);
+    CHECK(violations.deallocations == 0);
+    CHECK(violations.lockAcquisitions == 0);
+}
+
+TEST_CASE("RandomWalkSequencer stays real-time safe with profiling enabled")
+{
+    REQUIRE(PluginHelpers::areAudioThreadHooksInstalled());
+
+    constexpr int blockSize = 64;
+
+    RandomWalkSequencer sequencer;
+    sequencer.prepareToPlay(44100.0, blockSize);
+    sequencer.getProfiler().setEnabled(true);
+    sequencer.setManualStepMode(true);
+    sequencer.toggleStepEnabled(3);
+    sequencer.setPlaying(true);
+
+    auto violations = runBlocks(sequencer, 5000, blockSize);
+
+    CHECK(violations.total() == 0);
+    CHECK(sequencer.getProfiler().getStats().blocksProcessed == 5000);
+}
@@ -0,0 +1,136 @@
+#include <catch2/catch_test_macros.hpp>
+#include "RandomWalkSequencer.h"
+
+namespace
+{
+//Pattern and loop image storage for a configuration
+template <int Steps, int Lanes>
+struct Buffers
+{
+    int notes[Steps] {};
+    bool enabled[Steps] {};
+    float values[Lanes * Steps] {};
+
+    int imageNotes[Steps] {};
+    juce::uint8 imageVelocities[Steps] {};
+    bool imagePlays[Steps] {};
+    float imageValues[Lanes * Steps] {};
+
+    StepPattern getPattern() const { return { notes, enabled, values }; }
+    LoopImage getImage() { return { imageNotes, imageVelocities, imagePlays, imageValues }; }
+};
+
+//Renders every offset, density and mode with the specialised and the generic path,
+//and checks that they agree
+template <int Steps, int Lanes>
+void checkMatchesGenericPath()
+{
+    juce::Random random(Steps * 100 + Lanes);
+    Buffers<Steps, Lanes> specialised, generic;
+
+    for (int i = 0; i < Steps; ++i)
+    {
+        specialised.notes[i] = random.nextInt(25) - 12;
+        specialised.enabled[i] = random.nextBool();
+    }
+
+    for (auto& value: specialised.values)
+        value = random.nextFloat();
+
+    auto render = SequencerEngines::getRenderLoop(Steps, Lanes);
+    REQUIRE(render != nullptr);
+
+    for (int mode = 0; mode < 2; ++mode)
+    {
+        for (int offset = 0; offset < Steps; ++offset)
+        {
+            for (int density = 1; density <= Steps; density += 5)
+            {
+                LoopParameters parameters { 60, offset, density, mode == 1 };
+
+                auto image = specialised.getImage();
+                render(specialised.getPattern(), parameters, image);
+
+                auto genericImage = generic.getImage();
+                SequencerEngines::renderLoopGeneric(Steps, Lanes, specialised.getPattern(), parameters, genericImage);
+
+                for (int i = 0; i < Steps; ++i)
+                {
+                    REQUIRE(specialised.imageNotes[i] == generic.imageNotes[i]);
+                    REQUIRE(specialised.imageVelocities[i] == generic.imageVelocities[i]);
+                    REQUIRE(specialised.imagePlays[i] == generic.imagePlays[i]);
+
+                    for (int lane = 0; lane < Lanes - 1; ++lane)
+                        REQUIRE(specialised.imageValues[lane * Steps + i] == generic.imageValues[lane * Steps + i]);
+                }
+            }
+        }
+    }
+}
+} // namespace
+
+TEST_CASE("Specialised loop renderers match the generic path")
+{
+    checkMatchesGenericPath<16, 1>();
+    checkMatchesGenericPath<16, 4>();
+    checkMatchesGenericPath<16, 8>();
+    checkMatchesGenericPath<32, 1>();
+    checkMatchesGenericPath<32, 4>();
+    checkMatchesGenericPath<32, 8>();
+    checkMatchesGenericPath<64, 1>();
+    checkMatchesGenericPath<64, 4>();
+    checkMatchesGenericPath<64, 8>();
+}
+
+TEST_CASE("Configurations without a specialisation use the generic path")
+{
+    CHECK(SequencerEngines::getRenderLoop(16, 3) == nullptr);
+    CHECK(SequencerEngines::getRenderLoop(24, 1) == nullptr);
+
+    int notes[12] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+    bool enabled[12] {};
+    int imageNotes[12] {};
+    juce::uint8 imageVelocities[12] {};
+    bool imagePlays[12] {};
+
+    LoopImage image { imageNotes, imageVelocities, imagePlays, nullptr };
+    SequencerEngines::renderLoop(12, 1, { notes, enabled, nullptr }, { 60, 5, 4, false }, image);
+
+    CHECK(imageNotes[0] == 65);
+    CHECK(imageNotes[7] == 60);
+    CHECK(imagePlays[3]);
+    CHECK(!imagePlays[4]);
+}
+
+TEST_CASE("The rate table and pattern generators are resolved at compile time")
+{
+    using Engine = SequencerEngine<16, 1>;
+
+    static_assert(Engine::getStepLengthInBeats(0) == 1.0 / 32.0, "Fastest rate is a 1/32 beat");
+    static_assert(Engine::getStepLengthInBeats(3) == 0.25, "Rate 3 is a quarter beat");
+    static_assert(Engine::getStepLengthInBeats(9) == 4.0, "Slowest rate is four beats");
+
+    RandomWalkSequencer sequencer;
+    sequencer.setRate(4);
+    CHECK(sequencer.getRateInSeconds() == (float) (1.0 / 3.0));
+
+    juce::Random random(1);
+    int sequence[16] {};
+
+    //Descending patterns start a step either side of +6
+    Engine::generatePattern(Engine::descendingPattern, sequence, random);
+    CHECK((sequence[0] == 5 || sequence[0] == 7));
+
+    //Arpeggios only use chord tones
+    Engine::generatePattern(Engine::arpeggioPattern, sequence, random);
+
+    for (auto value: sequence)
+        CHECK((value == 0 || value == 4 || value == 7 || value == 12 || value == -8 || value == -5));
+
+    //Unknown pattern types fall back to a random walk, which fills every step
+    std::fill(std::begin(sequence), std::end(sequence), 100);
+    Engine::generatePattern(99, sequence, random);
+
+    for (auto value: sequence)
+        CHECK(value != 100);
+}
@@ -0,0 +1,150 @@
+#include <catch2/catch_test_macros.hpp>
+#include "PluginProcessor.h"
+
+namespace
+{
+//Finds one of the processor's parameters the way a host would, by its ID
+juce::RangedAudioParameter* findParameter(juce::AudioProcessor& processor, const juce::String& parameterID)
+{
+    for (auto* parameter: processor.getParameters())
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter))
+            if (ranged->getParameterID() == parameterID)
+                return ranged;
+
+    return nullptr;
+}
+
+//Sets a parameter from its plain value, like host automation would
+void automate(juce::AudioProcessor& processor, const juce::String& parameterID, float value)
+{
+    auto* parameter = findParameter(processor, parameterID);
+    REQUIRE(parameter != nullptr);
+    parameter->setValue(parameter->convertTo0to1(value));
+}
+
+//A note on or off, at its position from the start of playback
+struct TimedNote
+{
+    bool isNoteOn;
+    juce::int64 position;
+};
+} // namespace
+
+TEST_CASE("Host automation reaches the sequencer")
+{
+    AudioPluginAudioProcessor processor;
+    auto& sequencer = processor.getSequencer();
+
+    automate(processor, "rate", 6.0f);
+    automate(processor, "density", 5.0f);
+    automate(processor, "offset", 11.0f);
+    automate(processor, "gate", 0.25f);
+    automate(processor, "root", 48.0f);
+    automate(processor, "bpm", 97.0f);
+
+    CHECK(sequencer.getRate() == 6);
+    CHECK(sequencer.getDensity() == 5);
+    CHECK(sequencer.getOffset() == 11);
+    CHECK(std::abs(sequencer.getGate() - 0.25f) < 0.001f);
+    CHECK(sequencer.getRoot() == 48);
+    CHECK(std::abs(sequencer.getInternalBpm() - 97.0) < 0.001);
+}
+
+TEST_CASE("Loading state updates the host parameters")
+{
+    AudioPluginAudioProcessor source;
+    source.getSequencer().setDensity(3);
+    source.getSequencer().setRoot(60);
+
+    juce::MemoryBlock state;
+    source.getStateInformation(state);
+
+    AudioPluginAudioProcessor destination;
+    destination.setStateInformation(state.getData(), (int) state.getSize());
+
+    auto& parameters = destination.getSequencerParameters();
+    CHECK(parameters.density->get() == 3);
+    CHECK(parameters.root->get() == 60);
+}
+
+TEST_CASE("A gate change only affects notes that start after it")
+{
+    constexpr int blockSize = 100;
+
+    //Quarter-beat steps at 120 BPM are 6000 samples long at 48 kHz
+    RandomWalkSequencer sequencer;
+    sequencer.prepareToPlay(48000.0, blockSize);
+    sequencer.setRate(3);
+    sequencer.setGate(0.75f);
+    sequencer.setPlaying(true);
+
+    std::vector<TimedNote> notes;
+    juce::MidiBuffer midi;
+    bool gateChanged = false;
+
+    for (juce::int64 blockStart = 0; blockStart < 18000; blockStart += blockSize)
+    {
+        midi.clear();
+        sequencer.processBlock(midi, blockSize, {});
+
+        for (const auto metadata: midi)
+            notes.push_back({metadata.getMessage().isNoteOn(), blockStart + metadata.samplePosition});
+
+        //Shorten the gate while the first note is sounding
+        if (!gateChanged && !notes.empty())
+        {
+            sequencer.setGate(0.25f);
+            gateChanged = true;
+        }
+    }
+
+    REQUIRE(notes.size() >= 4);
+
+    //The first note keeps the gate it started with...
+    CHECK(notes[0].isNoteOn);
+    CHECK(!notes[1].isNoteOn);
+    CHECK(notes[1].position - notes[0].position == 4500);
+
+    //...and the next one gets the new gate
+    CHECK(notes[2].isNoteOn);
+    CHECK(!notes[3].isNoteOn);
+    CHECK(notes[3].position - notes[2].position == 1500);
+}
+
+TEST_CASE("Host automation on the audio thread doesn't allocate or lock")
+{
+    REQUIRE(PluginHelpers::areAudioThreadHooksInstalled());
+
+    constexpr int blockSize = 128;
+
+    AudioPluginAudioProcessor processor;
+    processor.prepareToPlay(48000.0, blockSize);
+    processor.getSequencer().setPlaying(true);
+
+    auto* gate = findParameter(processor, "gate");
+    auto* density = findParameter(processor, "density");
+    REQUIRE(gate != nullptr);
+    REQUIRE(density != nullptr);
+
+    juce::AudioBuffer<float> buffer(2, blockSize);
+    juce::MidiBuffer midi;
+    midi.ensureSize(4096);
+
+    PluginHelpers::resetAudioThreadViolations();
+
+    for (int block = 0; block < 2000; ++block)
+    {
+        midi.clear();
+
+        //Some hosts deliver automation on the audio thread, right before processBlock
+        {
+            PluginHelpers::ScopedAudioThread audioThread;
+            gate->setValue((float) (block % 10) / 10.0f);
+            density->setValue((float) (block % 16) / 15.0f);
+        }
+
+        processor.processBlock(buffer, midi);
+    }
+
+    CHECK(PluginHelpers::getAudioThreadViolations().total() == 0);
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "RandomWalkSequencer.h"
+
+//Helpers shared by the tests that drive a RandomWalkSequencer from a fake host
+namespace SequencerTestHelpers
+{
+//A playing host block at a timeline position, at 120 BPM
+inline TimingContext hostBlock(juce::int64 timeInSamples)
+{
+    TimingContext timing;
+    timing.hasHostPosition = true;
+    timing.hostIsPlaying = true;
+    timing.hostBpm = 120.0;
+    timing.timeInSamples = timeInSamples;
+    return timing;
+}
+
+//Sixteenth notes at the host's 120 BPM and 48 kHz: a step every 6000 samples, 16 steps to the bar
+inline void prepare(RandomWalkSequencer& sequencer, int blockSize = 512)
+{
+    sequencer.prepareToPlay(48000.0, blockSize);
+    sequencer.setSyncToHostTransport(true);
+    sequencer.setRate(3);
+    sequencer.setRoot(60);
+}
+
+//Processes blocks until a number of note ons came out, and returns their note numbers
+//Pass a pause between blocks to give a background worker time to keep up
+inline std::vector<int> playNotes(RandomWalkSequencer& sequencer,
+                                  juce::int64& position,
+                                  int numNotes,
+                                  int millisecondsBetweenBlocks = 0)
+{
+    std::vector<int> notes;
+    juce::MidiBuffer midi;
+
+    for (int block = 0; block < 100000 && (int) notes.size() < numNotes; ++block)
+    {
+        midi.clear();
+        sequencer.processBlock(midi, 512, hostBlock(position));
+        position += 512;
+
+        for (const auto metadata: midi)
+            if (metadata.getMessage().isNoteOn())
+                notes.push_back(metadata.getMessage().getNoteNumber());
+
+        if (millisecondsBetweenBlocks > 0)
+            juce::Thread::sleep(millisecondsBetweenBlocks);
+    }
+
+    return notes;
+}
+
+//Plays a number of blocks from the start of the timeline and returns how many allocations
+//and locks the audio thread made; beforeBlock runs ahead of each block, e.g. to automate a setting
+template <typename BeforeBlock>
+juce::int64 countAudioThreadViolations(RandomWalkSequencer& sequencer, int numBlocks, BeforeBlock beforeBlock)
+{
+    juce::MidiBuffer midi;
+    midi.ensureSize(8192);
+
+    PluginHelpers::resetAudioThreadViolations();
+
+    for (int block = 0; block < numBlocks; ++block)
+    {
+        beforeBlock(block);
+
+        midi.clear();
+        sequencer.processBlock(midi, 512, hostBlock((juce::int64) block * 512));
+    }
+
+    return PluginHelpers::getAudioThreadViolations().total();
+}
+
+inline juce::int64 countAudioThreadViolations(RandomWalkSequencer& sequencer, int numBlocks)
+{
+    return countAudioThreadViolations(sequencer, numBlocks, [](int) {});
+}
+} // namespace SequencerTestHelpers
@@ -0,0 +1,124 @@
+#include <catch2/catch_test_macros.hpp>
+#include "RandomWalkSequencer.h"
+
+TEST_CASE("Step lengths in samples are exact fractions")
+{
+    //Quarter beats at 120 BPM and 48 kHz
+    auto quarterBeats = StepClock::getSampleLength(48000.0, 120.0, { 240, 1 });
+    CHECK(quarterBeats.numerator == 6000);
+    CHECK(quarterBeats.denominator == 1);
+
+    //1/3 beat at 133 BPM and 44.1 kHz is 6631 11/19 samples
+    auto tripletBeats = StepClock::getSampleLength(44100.0, 133.0, { 320, 1 });
+    CHECK(tripletBeats.numerator == 126000);
+    CHECK(tripletBeats.denominator == 19);
+
+    //Septuplets don't divide 960 ticks, so they use the ticks' denominator
+    auto septuplets = StepClock::getSampleLength(48000.0, 120.0, { 960, 7 });
+    CHECK(septuplets.numerator == 24000);
+    CHECK(septuplets.denominator == 7);
+
+    //Dotted eighths
+    auto dottedEighths = StepClock::getSampleLength(44100.0, 90.0, { 720, 1 });
+    CHECK(dottedEighths.toDouble() == 22050.0);
+
+    CHECK(!StepClock::getSampleLength(0.0, 120.0, { 240, 1 }).isValid());
+}
+
+TEST_CASE("Step clock starts every step at its exact grid position")
+{
+    juce::Random random(7);
+
+    for (auto ticks: { StepClock::Ticks { 320, 1 }, StepClock::Ticks { 960, 7 }, StepClock::Ticks { 192, 1 } })
+    {
+        auto length = StepClock::getSampleLength(44100.0, 97.5, ticks);
+
+        StepClock clock;
+        clock.setStepLength(length);
+        clock.restart();
+
+        juce::int64 position = 0;
+        juce::int64 step = 0;
+
+        for (int block = 0; block < 20000; ++block)
+        {
+            const int blockSize = 1 + random.nextInt(2048);
+            int samplePosition = 0;
+
+            while (samplePosition < blockSize)
+            {
+                if (clock.isStepDue())
+                {
+                    clock.startNextStep();
+                    REQUIRE(position + samplePosition == length.getStepStart(++step));
+                }
+
+                auto segment = (int) juce::jmin((juce::int64) (blockSize - samplePosition), clock.getSamplesUntilNextStep());
+                clock.advance(segment);
+                samplePosition += segment;
+            }
+
+            position += blockSize;
+        }
+
+        //Lining up with the grid mid-stream continues the same grid
+        StepClock aligned;
+        aligned.setStepLength(length);
+        aligned.alignToStep(step + 1, length.getStepStart(step + 1) - position);
+
+        for (int i = 1; i <= 1000; ++i)
+        {
+            auto wait = aligned.getSamplesUntilNextStep();
+            position += wait;
+            aligned.advance(wait);
+            aligned.startNextStep();
+            REQUIRE(position == length.getStepStart(step + i));
+        }
+    }
+}
+
+TEST_CASE("Soak: the sequencer doesn't drift from the grid in a billion samples")
+{
+    constexpr int blockSize = 4096;
+    constexpr juce::int64 totalSamples = 1000000000;
+
+    //1/3 beat steps at 133 BPM, 6631 11/19 samples each, which used to lose a fraction
+    //of a sample on every step
+    RandomWalkSequencer sequencer;
+    sequencer.prepareToPlay(44100.0, blockSize);
+    sequencer.setInternalBpm(133.0);
+    sequencer.setRate(4);
+    sequencer.setDensity(16);
+    sequencer.setGate(0.5f);
+    sequencer.setPlaying(true);
+
+    const StepClock::SampleLength length { 126000, 19 };
+
+    juce::MidiBuffer midi;
+    midi.ensureSize(1024);
+
+    juce::int64 blockStart = 0;
+    juce::int64 numNotes = 0;
+    juce::int64 numMisplacedNotes = 0;
+
+    while (blockStart < totalSamples)
+    {
+        midi.clear();
+        sequencer.processBlock(midi, blockSize, {});
+
+        for (const auto metadata: midi)
+        {
+            if (metadata.getMessage().isNoteOn())
+            {
+                //The first step starts one step after the transport starts
+                if (blockStart + metadata.samplePosition != length.getStepStart(++numNotes))
+                    ++numMisplacedNotes;
+            }
+        }
+
+        blockStart += blockSize;
+    }
+
+    CHECK(numMisplacedNotes == 0);
+    CHECK(numNotes == (blockStart * length.denominator - 1) / length.numerator);
+}
@@ -0,0 +1,91 @@
+#include <catch2/catch_test_macros.hpp>
+#include <shared_processing_code/shared_processing_code.h>
+#include <shared_plugin_helpers/shared_plugin_helpers.h>
+
+TEST_CASE("White noise fills every channel with the same noise, within its gain")
+{
+    WhiteNoise::Oscillator oscillator(1);
+    juce::AudioBuffer<float> buffer(3, 1000);
+    buffer.clear();
+    oscillator.process(buffer);
+
+    double sum = 0.0;
+    double sumOfSquares = 0.0;
+
+    for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+    {
+        const auto value = buffer.getSample(0, sample);
+        CHECK(value >= -0.5f);
+        CHECK(value < 0.5f);
+        CHECK(buffer.getSample(1, sample) == value);
+        CHECK(buffer.getSample(2, sample) == value);
+
+        sum += value;
+        sumOfSquares += value * value;
+    }
+
+    //Uniform in [-0.5, 0.5): a mean near 0 and a variance near 1/12
+    const auto mean = sum / buffer.getNumSamples();
+    CHECK(std::abs(mean) < 0.05);
+    CHECK(std::abs(sumOfSquares / buffer.getNumSamples() - mean * mean - 1.0 / 12.0) < 0.01);
+}
+
+TEST_CASE("White noise is the same sequence whatever the block sizes")
+{
+    WhiteNoise::Oscillator whole(7);
+    WhiteNoise::Oscillator split(7);
+
+    std::vector<float> expected(1000);
+    whole.fill(expected.data(), (int) expected.size());
+
+    //Blocks that start and end anywhere in a group of lanes, and single samples
+    std::vector<float> actual;
+    juce::AudioBuffer<float> buffer(1, 64);
+
+    for (int block = 0; actual.size() < expected.size(); ++block)
+    {
+        if (block % 5 == 4)
+        {
+            actual.push_back(split.getNextSample());
+            continue;
+        }
+
+        buffer.setSize(1, 1 + (block * 13) % 37, false, false, true);
+        split.process(buffer);
+        actual.insert(actual.end(), buffer.getReadPointer(0), buffer.getReadPointer(0) + buffer.getNumSamples());
+    }
+
+    actual.resize(expected.size());
+    CHECK(actual == expected);
+}
+
+TEST_CASE("White noise instances are independent")
+{
+    WhiteNoise::Oscillator first;
+    WhiteNoise::Oscillator second;
+
+    std::vector<float> a(256);
+    std::vector<float> b(256);
+    first.fill(a.data(), (int) a.size());
+    second.fill(b.data(), (int) b.size());
+
+    CHECK(a != b);
+}
+
+TEST_CASE("White noise allocates nothing and takes no locks on the audio thread")
+{
+    REQUIRE(PluginHelpers::areAudioThreadHooksInstalled());
+
+    WhiteNoise::Oscillator oscillator;
+    juce::AudioBuffer<float> buffer(2, 512);
+
+    PluginHelpers::resetAudioThreadViolations();
+    {
+        PluginHelpers::ScopedAudioThread audioThread;
+
+        for (int block = 0; block < 100; ++block)
+            oscillator.process(buffer);
+    }
+
+    CHECK(PluginHelpers::getAudioThreadViolations().total() == 0);
+}